@@ -28,16 +28,30 @@ extern "C" {
 #endif
 
 /**
- * Start a dump of the external flash memory content via xmodem transfer,
- * blocking function.
+ * Transfer protocols available for backup and restore.
  */
-void eflash_dump();
+enum backupProtocol
+{
+    BACKUP_XMODEM = 0,    ///< XMODEM-1K, stop-and-wait
+    BACKUP_XSTREAM        ///< Streaming with sliding window
+};
 
 /**
- * Start a restore of the external flash memory content via xmodem transfer,
- * blocking function.
+ * Start a dump of the external flash memory content, blocking function.
+ *
+ * @param proto: transfer protocol.
  */
-void eflash_restore();
+void eflash_dump(const enum backupProtocol proto);
+
+/**
+ * Start a restore of the external flash memory content, blocking function.
+ *
+ * @param proto: transfer protocol.
+ * @return zero on success, -1 if the transfer failed, the stream was corrupted
+ * or it ended before its end record. In this case the memory is left
+ * partially restored.
+ */
+int eflash_restore(const enum backupProtocol proto);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,109 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef CONTACT_INDEX_H
+#define CONTACT_INDEX_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <cps.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Hash index of the M17 contacts of the codeplug, mapping an encoded M17
+ * address to the position of the corresponding contact. It allows to resolve
+ * the callsign of an incoming transmission to a contact in constant time,
+ * without scanning the whole contact list.
+ *
+ * The index is built when the codeplug is loaded and kept up to date by the
+ * codeplug backends on contact insertion, modification and removal. Lookups can be done
+ * from any thread.
+ */
+
+/**
+ * Build the index scanning all the contacts of the currently open codeplug,
+ * replacing the existing one.
+ *
+ * @return 0 on success, -1 if the index could not be allocated.
+ */
+int contactIndex_build();
+
+/**
+ * Release the memory used by the index.
+ */
+void contactIndex_clear();
+
+/**
+ * Find the contact having a given M17 address.
+ *
+ * @param address: M17 address, in base-40 encoded form.
+ * @return position of the contact in the codeplug or -1 if not found.
+ */
+int contactIndex_lookupM17(const uint8_t address[6]);
+
+/**
+ * Update the index after the insertion of a contact in the codeplug.
+ *
+ * @param contact: the new contact.
+ * @param pos: position of the new contact in the contact list.
+ */
+void contactIndex_inserted(const contact_t *contact, uint16_t pos);
+
+/**
+ * Update the index after a contact of the codeplug has been overwritten.
+ *
+ * @param pos: position of the contact in the contact list.
+ * @param prev: previous content of the contact.
+ * @param contact: new content of the contact.
+ */
+void contactIndex_written(uint16_t pos, const contact_t *prev,
+                          const contact_t *contact);
+
+/**
+ * Update the index after the removal of a contact from the codeplug. If the
+ * removed contact shared its address with other ones, the codeplug is scanned
+ * to index the first of them.
+ *
+ * @param pos: position of the removed contact in the contact list.
+ */
+void contactIndex_removed(uint16_t pos);
+
+/**
+ * Mark the index as out of date, for modifications which are not tracked one
+ * by one. All the lookups fail until the index is built again.
+ */
+void contactIndex_invalidate();
+
+/**
+ * Get the amount of memory used by the index.
+ *
+ * @return size of the index, in bytes.
+ */
+size_t contactIndex_size();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONTACT_INDEX_H */
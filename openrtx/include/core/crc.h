@@ -37,6 +37,15 @@ extern "C" {
  */
 uint16_t crc_ccitt(const void *data, const size_t len);
 
+/**
+ * Compute the IEEE 802.3 32-bit CRC over a given block of data.
+ *
+ * @param data: input data.
+ * @param len: data length, in bytes.
+ * @return CRC-32.
+ */
+uint32_t crc_32(const void *data, const size_t len);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,164 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef CTCSS_DECODER_H
+#define CTCSS_DECODER_H
+
+#ifndef __cplusplus
+#error This header is C++ only!
+#endif
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <interfaces/audio.h>
+#include <cps.h>
+
+/**
+ * Software CTCSS decoder working on the RX baseband signal.
+ *
+ * The input signal is low-pass filtered and decimated to 1kHz, then a bank of
+ * Goertzel filters computes the power of every tone of the ctcss_tone table
+ * over a 100ms window. The strongest tone is detected when it carries a large
+ * enough fraction of the total signal energy; several windows are computed
+ * in parallel, staggered by 25ms, to bring the detection time below 150ms.
+ */
+class CtcssDecoder
+{
+public:
+
+    static constexpr uint32_t SAMPLE_RATE = 8000;   ///< Input sample rate, in Hz
+
+    /**
+     * Constructor.
+     */
+    CtcssDecoder();
+
+    /**
+     * Destructor.
+     */
+    ~CtcssDecoder();
+
+    /**
+     * Reset the decoder state, clearing the filters and the detection status.
+     */
+    void reset();
+
+    /**
+     * Set the tone to be detected.
+     *
+     * @param tone: tone frequency in tenths of Hz, as stored in the ctcss_tone
+     * table.
+     */
+    void setTone(const uint16_t tone);
+
+    /**
+     * Process a block of baseband samples.
+     *
+     * @param samples: pointer to the sample buffer.
+     * @param len: number of samples in the buffer.
+     */
+    void process(const stream_sample_t *samples, const size_t len);
+
+    /**
+     * Check if the tone set with setTone() is being received. Detection is
+     * confirmed over two consecutive windows and released only after the tone
+     * has been missing for 75ms, to avoid chattering.
+     *
+     * @return true if the tone is being received.
+     */
+    bool toneDetected() const
+    {
+        return detected;
+    }
+
+    /**
+     * Get the tone detected in the last analysis window.
+     *
+     * @return index of the tone in the ctcss_tone table or -1 if no tone has
+     * been detected.
+     */
+    int8_t lastTone() const
+    {
+        return lastIndex;
+    }
+
+private:
+
+    static constexpr size_t   NUM_TONES   = MAX_TONE_INDEX;
+    static constexpr size_t   NUM_BIQUADS = 3;      // 6th order low-pass
+    static constexpr uint32_t DECIMATION  = 8;      // 1kHz after decimation
+    static constexpr size_t   WINDOW      = 100;    // 100ms analysis window
+    static constexpr size_t   HOP         = 25;     // New decision every 25ms
+    static constexpr size_t   NUM_WINDOWS = WINDOW / HOP;
+    static constexpr uint8_t  OPEN_COUNT  = 2;      // Windows to confirm a tone
+    static constexpr uint8_t  HANG_COUNT  = 3;      // Windows to drop a tone
+    static constexpr float    THRESHOLD   = 0.45f;  // Minimum tone energy share
+
+    /**
+     * State of a biquad section in transposed direct form II.
+     */
+    struct Biquad
+    {
+        float b0, b1, b2, a1, a2;
+        float z1, z2;
+    };
+
+    /**
+     * Goertzel filter bank running over one analysis window.
+     */
+    struct Window
+    {
+        std::array< float, NUM_TONES > s1;
+        std::array< float, NUM_TONES > s2;
+        float  energy;
+        int    pos;
+    };
+
+    /**
+     * Feed one decimated sample to the Goertzel filter banks.
+     *
+     * @param sample: decimated and DC-free baseband sample.
+     */
+    void goertzel(const float sample);
+
+    /**
+     * Compute the detection result at the end of an analysis window and reset
+     * it for the next one.
+     *
+     * @param window: window to be evaluated.
+     */
+    void evaluate(Window& window);
+
+    std::array< Biquad, NUM_BIQUADS > lpf;      ///< Anti-alias filter
+    std::array< float, NUM_TONES >    coeff;    ///< Goertzel coefficients
+    std::array< Window, NUM_WINDOWS > windows;  ///< Staggered windows
+    uint32_t decimCount;                        ///< Decimation counter
+    float    dcIn;                              ///< DC blocker previous input
+    float    dcOut;                             ///< DC blocker previous output
+    int8_t   target;                            ///< Index of the wanted tone
+    int8_t   lastIndex;                         ///< Last detected tone
+    uint8_t  hits;                              ///< Consecutive matches
+    uint8_t  misses;                            ///< Consecutive misses
+    bool     detected;                          ///< Tone detection status
+};
+
+#endif /* CTCSS_DECODER_H */
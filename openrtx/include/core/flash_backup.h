@@ -0,0 +1,130 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef FLASH_BACKUP_H
+#define FLASH_BACKUP_H
+
+#include <interfaces/nvmem.h>
+#include <sys/types.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Backup and restore of a nonvolatile memory device, using a sparse and
+ * compressed stream format.
+ *
+ * The stream begins with a header followed by one record per memory sector.
+ * Each record carries the sector number and the CRC-32 of the sector content,
+ * followed by the sector data: nothing for erased sectors, LZ-compressed data
+ * or, when compression does not help, raw data. The stream is terminated by
+ * an end record.
+ *
+ * Records are self-contained, thus an interrupted backup can be resumed from
+ * any sector. During restore, sectors whose content is already equal to the
+ * one of the backup are neither erased nor written, so that restarting an
+ * interrupted restore only writes the missing sectors.
+ */
+
+#define FLASH_BACKUP_SECTOR 4096        ///< Size of a backup sector, in bytes
+
+/**
+ * Statistics of a backup or restore operation.
+ */
+struct backupStats
+{
+    uint32_t sectors;       ///< Sectors processed
+    uint32_t erased;        ///< Erased sectors
+    uint32_t compressed;    ///< Sectors stored in compressed form
+    uint32_t skipped;       ///< Sectors not written during restore, as unchanged
+    uint32_t written;       ///< Sectors written during restore
+    size_t   streamSize;    ///< Size of the backup stream, in bytes
+};
+
+/**
+ * Backup or restore context.
+ */
+struct flashBackup
+{
+    const struct nvmDevice *dev;            ///< Memory device
+    uint32_t                numSectors;     ///< Number of sectors in the stream
+    uint32_t                sector;         ///< Next sector to be processed
+    uint32_t                state;          ///< Stream processing state
+    size_t                  pos;            ///< Position inside the record
+    size_t                  len;            ///< Length of the record
+    struct backupStats      stats;          ///< Operation statistics
+    uint8_t                 record[16 + FLASH_BACKUP_SECTOR];   ///< Record buffer
+    uint8_t                 data[FLASH_BACKUP_SECTOR];          ///< Sector data
+    uint8_t                 work[FLASH_BACKUP_SECTOR];          ///< Working buffer
+};
+
+/**
+ * Start a backup of a memory device.
+ *
+ * @param ctx: backup context.
+ * @param dev: memory device, its size must be a multiple of the sector size.
+ * @param first: first sector to be saved, used to resume a backup.
+ * @return zero on success, a negative error code otherwise.
+ */
+int flashBackup_startExport(struct flashBackup *ctx,
+                            const struct nvmDevice *dev, uint32_t first);
+
+/**
+ * Get the next chunk of the backup stream.
+ *
+ * @param ctx: backup context.
+ * @param buf: destination buffer.
+ * @param len: maximum number of bytes to be read.
+ * @return number of bytes read, zero at the end of the stream, a negative
+ * error code on failure.
+ */
+ssize_t flashBackup_read(struct flashBackup *ctx, void *buf, size_t len);
+
+/**
+ * Start the restore of a memory device.
+ *
+ * @param ctx: restore context.
+ * @param dev: memory device.
+ * @return zero on success, a negative error code otherwise.
+ */
+int flashBackup_startImport(struct flashBackup *ctx,
+                            const struct nvmDevice *dev);
+
+/**
+ * Process the next chunk of the backup stream, restoring the sectors as soon
+ * as they are complete. Data following the end of the stream is ignored.
+ *
+ * @param ctx: restore context.
+ * @param data: stream data.
+ * @param len: number of bytes.
+ * @return zero if more data is expected, one when the end of the stream has
+ * been reached, a negative error code on failure.
+ */
+int flashBackup_write(struct flashBackup *ctx, const void *data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FLASH_BACKUP_H */
@@ -134,6 +134,16 @@ void gfx_renderRows(uint8_t startRow, uint8_t endRow);
  */
 void gfx_render();
 
+/**
+ * Copy to the display only the framebuffer rows whose content changed since the
+ * last call to this function. Rows are marked as dirty by the drawing
+ * functions and their content is checked before being sent, thus redrawing a
+ * row with the same content does not cause a display update.
+ *
+ * @return true if at least one row has been sent to the display.
+ */
+bool gfx_renderDirty();
+
 /**
  * Clears a portion of the screen content
  * This results in a black screen on color displays
@@ -214,6 +224,14 @@ void gfx_drawCircle(point_t start, uint16_t r, color_t color);
  */
 uint8_t gfx_getFontHeight(fontSize_t size);
 
+/**
+ * Computes the maximum number of pixel rows a glyph of the font extends below
+ * the text baseline.
+ * @param size: text font size, defined as enum.
+ * @return font descent, in pixels
+ */
+uint8_t gfx_getFontDescent(fontSize_t size);
+
 /**
  * Prints text on the screen at the specified coordinates.
  * Reads text from a given char buffer
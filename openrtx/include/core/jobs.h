@@ -0,0 +1,85 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Scheduler for the periodic housekeeping jobs run by the device management
+ * thread. Each job is registered with its own period and the thread sleeps
+ * until the earliest deadline, instead of polling all the jobs at a fixed
+ * rate.
+ *
+ * Jobs are run sequentially from the context of the thread calling
+ * jobs_run(), this module is not thread safe and jobs must be registered
+ * either before the scheduler starts or from within a job.
+ */
+
+/**
+ * Maximum number of jobs which can be registered.
+ */
+#define MAX_NUM_JOBS 8
+
+/**
+ * Function type of a periodic job.
+ */
+typedef void (*job_t)();
+
+/**
+ * Register a new periodic job. The job is run for the first time at the next
+ * call of jobs_run().
+ *
+ * @param job: function to be called.
+ * @param period: job period, in milliseconds.
+ * @return job identifier, or -1 if there is no room left for a new job.
+ */
+int jobs_register(job_t job, uint32_t period);
+
+/**
+ * Change the period of an already registered job. The new period is applied
+ * starting from the next run of the job.
+ *
+ * @param id: job identifier.
+ * @param period: new job period, in milliseconds.
+ */
+void jobs_setPeriod(int id, uint32_t period);
+
+/**
+ * Run all the jobs whose deadline has expired. A job which fell behind by
+ * more than one period is run only once and then rescheduled from the
+ * current time.
+ *
+ * @param now: current time, in milliseconds.
+ * @return time of the earliest deadline among all the registered jobs.
+ */
+long long jobs_run(long long now);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* JOBS_H */
@@ -0,0 +1,114 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef NOISE_SQUELCH_H
+#define NOISE_SQUELCH_H
+
+#ifndef __cplusplus
+#error This header is C++ only!
+#endif
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <interfaces/audio.h>
+
+/**
+ * Noise squelch working on the RX baseband signal.
+ *
+ * The power of the discriminator noise above the voice band is measured on
+ * each block of samples and compared with the noise floor, tracked while the
+ * squelch is closed. A received carrier quiets the noise and opens the
+ * squelch at the end of the first block in which the quieting exceeds the
+ * opening threshold.
+ */
+class NoiseSquelch
+{
+public:
+
+    static constexpr uint32_t SAMPLE_RATE = 8000;   ///< Input sample rate, in Hz
+
+    /**
+     * Constructor.
+     */
+    NoiseSquelch();
+
+    /**
+     * Destructor.
+     */
+    ~NoiseSquelch();
+
+    /**
+     * Reset the squelch state, forgetting the noise floor.
+     */
+    void reset();
+
+    /**
+     * Process a block of baseband samples and update the squelch status.
+     *
+     * @param samples: pointer to the sample buffer.
+     * @param len: number of samples in the buffer.
+     */
+    void process(const stream_sample_t *samples, const size_t len);
+
+    /**
+     * Get the noise quieting measured on the last block.
+     *
+     * @return noise power below the noise floor, in dB.
+     */
+    float quieting() const
+    {
+        return lastQuieting;
+    }
+
+    /**
+     * Check if the noise squelch is open.
+     *
+     * @return true if the noise is quieted by a received signal.
+     */
+    bool isOpen() const
+    {
+        return open;
+    }
+
+private:
+
+    static constexpr size_t NUM_BIQUADS = 2;        // 4th order high-pass
+    static constexpr float  OPEN_DB     = 6.0f;     // Quieting to open
+    static constexpr float  CLOSE_DB    = 3.0f;     // Quieting to close
+    static constexpr float  FLOOR_DECAY = 0.02f;    // Noise floor tracking
+
+    /**
+     * State of a biquad section in transposed direct form II.
+     */
+    struct Biquad
+    {
+        float b0, b1, b2, a1, a2;
+        float z1, z2;
+    };
+
+    std::array< Biquad, NUM_BIQUADS > hpf;          ///< Noise band filter
+    float noiseFloor;                               ///< Noise power with no signal
+    float lastQuieting;                             ///< Quieting of the last block
+    bool  open;                                     ///< Squelch status
+};
+
+#endif /* NOISE_SQUELCH_H */
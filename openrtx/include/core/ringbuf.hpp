@@ -27,6 +27,8 @@
 
 #include <pthread.h>
 #include <cstdint>
+#include <cstddef>
+#include <atomic>
 
 /**
  * Class implementing a statically allocated circular buffer with blocking and
@@ -201,4 +203,239 @@ private:
     pthread_cond_t  not_full;   ///< Queue not full condition.
 };
 
+/**
+ * Class implementing a statically allocated circular buffer for the case of a
+ * single producer and a single consumer thread. The interface is the same of
+ * RingBuffer but push and pop are wait-free: the read and write indices are
+ * atomic, free-running counters masked by the buffer size, which thus has to
+ * be a power of two.
+ * The mutex is taken only by the blocking functions, when the buffer is full
+ * (push) or empty (pop) and the caller has to be put to sleep.
+ *
+ * WARNING: push() must be called only by the producer thread, while pop() and
+ * eraseElement() must be called only by the consumer thread. reset() can be
+ * called only when neither of the two threads is accessing the buffer.
+ */
+template < typename T, size_t N >
+class SPSCRingBuffer
+{
+public:
+
+    static_assert((N != 0) && ((N & (N - 1)) == 0),
+                  "SPSCRingBuffer size must be a power of two");
+
+    /**
+     * Constructor.
+     */
+    SPSCRingBuffer() : readPos(0), writePos(0), prodWaiting(false),
+                       consWaiting(false)
+    {
+        pthread_mutex_init(&mutex, NULL);
+        pthread_cond_init(&not_empty, NULL);
+        pthread_cond_init(&not_full, NULL);
+    }
+
+    /**
+     * Destructor.
+     */
+    ~SPSCRingBuffer()
+    {
+        pthread_mutex_destroy(&mutex);
+        pthread_cond_destroy(&not_empty);
+        pthread_cond_destroy(&not_full);
+    }
+
+    /**
+     * Push an element to the buffer. To be called only by the producer thread.
+     *
+     * @param elem: element to be pushed.
+     * @param blocking: if set to true, when the buffer is full this function
+     * blocks the execution flow until at least one empty slot is available.
+     * @return true if the element has been successfully pushed to the queue,
+     * false if the queue is full.
+     */
+    bool push(const T& elem, bool blocking)
+    {
+        const size_t wr = writePos.load(std::memory_order_relaxed);
+
+        if((wr - readPos.load(std::memory_order_acquire)) >= N)
+        {
+            if(blocking == false)
+                return false;
+
+            pthread_mutex_lock(&mutex);
+
+            while(true)
+            {
+                prodWaiting.store(true, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+
+                if((wr - readPos.load(std::memory_order_acquire)) < N)
+                    break;
+
+                pthread_cond_wait(&not_full, &mutex);
+            }
+
+            prodWaiting.store(false, std::memory_order_relaxed);
+            pthread_mutex_unlock(&mutex);
+        }
+
+        data[wr & MASK] = elem;
+        writePos.store(wr + 1, std::memory_order_release);
+
+        // Wake up the consumer only if it is sleeping on an empty buffer
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(consWaiting.load(std::memory_order_relaxed))
+            wakeup(consWaiting, &not_empty);
+
+        return true;
+    }
+
+    /**
+     * Pop an element from the buffer. To be called only by the consumer thread.
+     *
+     * @param elem: place where to store the popped element.
+     * @param blocking: if set to true, when the buffer is empty this function
+     * blocks the execution flow until at least one element is available.
+     * @return true if the element has been successfully popped from the queue,
+     * false if the queue is empty.
+     */
+    bool pop(T& elem, bool blocking)
+    {
+        const size_t rd = readPos.load(std::memory_order_relaxed);
+
+        if(writePos.load(std::memory_order_acquire) == rd)
+        {
+            if(blocking == false)
+                return false;
+
+            pthread_mutex_lock(&mutex);
+
+            while(true)
+            {
+                consWaiting.store(true, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+
+                if(writePos.load(std::memory_order_acquire) != rd)
+                    break;
+
+                pthread_cond_wait(&not_empty, &mutex);
+            }
+
+            consWaiting.store(false, std::memory_order_relaxed);
+            pthread_mutex_unlock(&mutex);
+        }
+
+        elem = data[rd & MASK];
+        release(rd);
+
+        return true;
+    }
+
+    /**
+     * Check if the buffer is empty.
+     *
+     * @return true if the buffer is empty.
+     */
+    bool empty() const
+    {
+        return writePos.load(std::memory_order_acquire)
+            == readPos.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Check if the buffer is full.
+     *
+     * @return true if the buffer is full.
+     */
+    bool full() const
+    {
+        return (writePos.load(std::memory_order_acquire)
+              - readPos.load(std::memory_order_acquire)) >= N;
+    }
+
+    /**
+     * Discard one element from the buffer's tail, creating a new empty slot.
+     * In case the buffer is full calling this function unlocks the eventual
+     * producer thread waiting to push data. To be called only by the consumer
+     * thread.
+     */
+    void eraseElement()
+    {
+        const size_t rd = readPos.load(std::memory_order_relaxed);
+
+        // Nothing to erase
+        if(writePos.load(std::memory_order_acquire) == rd)
+            return;
+
+        release(rd);
+    }
+
+    /**
+     * Reset the buffer to its empty state discarding all the elements stored.
+     *
+     * Note: as for RingBuffer the reset is "lazy" and has to be done when
+     * neither the producer nor the consumer are accessing the buffer.
+     */
+    void reset()
+    {
+        readPos.store(0, std::memory_order_relaxed);
+        writePos.store(0, std::memory_order_relaxed);
+    }
+
+private:
+
+    /**
+     * Advance the read pointer, freeing one slot, and wake up the producer if
+     * it is sleeping on a full buffer.
+     *
+     * @param rd: current value of the read pointer.
+     */
+    inline void release(const size_t rd)
+    {
+        readPos.store(rd + 1, std::memory_order_release);
+
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(prodWaiting.load(std::memory_order_relaxed))
+            wakeup(prodWaiting, &not_full);
+    }
+
+    /**
+     * Signal a condition holding the mutex, to avoid losing the wakeup of a
+     * thread which is about to go to sleep. The waiting flag is cleared here,
+     * so that the following calls do not signal again before the woken thread
+     * gets to run.
+     *
+     * @param waiting: flag of the thread waiting on the condition.
+     * @param cond: condition to be signalled.
+     */
+    inline void wakeup(std::atomic< bool >& waiting, pthread_cond_t *cond)
+    {
+        pthread_mutex_lock(&mutex);
+        waiting.store(false, std::memory_order_relaxed);
+        pthread_cond_signal(cond);
+        pthread_mutex_unlock(&mutex);
+    }
+
+    static constexpr size_t MASK = N - 1;
+
+    #ifdef PLATFORM_LINUX
+    // Keep the two indices on separate cache lines to avoid false sharing
+    // between producer and consumer cores.
+    static constexpr size_t CACHE_LINE = 64;
+    #else
+    static constexpr size_t CACHE_LINE = alignof(size_t);
+    #endif
+
+    alignas(CACHE_LINE) std::atomic< size_t > readPos;   ///< Read pointer, written by the consumer.
+    alignas(CACHE_LINE) std::atomic< size_t > writePos;  ///< Write pointer, written by the producer.
+    alignas(CACHE_LINE) std::atomic< bool >   prodWaiting;  ///< Producer sleeping on full buffer.
+    std::atomic< bool >                       consWaiting;  ///< Consumer sleeping on empty buffer.
+    T               data[N];    ///< Data storage.
+
+    pthread_mutex_t mutex;      ///< Mutex for the blocking calls.
+    pthread_cond_t  not_empty;  ///< Queue not empty condition.
+    pthread_cond_t  not_full;   ///< Queue not full condition.
+};
+
 #endif  // RINGBUF_H
@@ -0,0 +1,137 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#ifndef __cplusplus
+#error This header is C++ only!
+#endif
+
+#include <type_traits>
+#include <cstdint>
+#include <cstring>
+#include <atomic>
+
+/**
+ * Class implementing a versioned snapshot of a data structure, published by a
+ * single writer thread and read by any number of threads without locking.
+ *
+ * The data is double buffered: each publication writes the buffer not holding
+ * the current snapshot and then advances the generation counter, selecting
+ * the new buffer. Each buffer is guarded by its own sequence counter, odd
+ * while the buffer is being written, so that a reader overtaken by two
+ * publications during its copy notices it and retries.
+ */
+template < typename T >
+class SeqLock
+{
+public:
+
+    static_assert(std::is_trivially_copyable< T >::value,
+                  "SeqLock data must be trivially copyable");
+
+    /**
+     * Constructor.
+     */
+    SeqLock() : bufGen{0, 0}, gen(0)
+    {
+        seq[0].store(0, std::memory_order_relaxed);
+        seq[1].store(0, std::memory_order_relaxed);
+        memset(buffers, 0x00, sizeof(buffers));
+    }
+
+    /**
+     * Destructor.
+     */
+    ~SeqLock() { }
+
+    /**
+     * Publish a new snapshot of the data. To be called only by the writer
+     * thread, never blocks.
+     *
+     * @param value: new data.
+     */
+    void publish(const T& value)
+    {
+        const uint32_t next = gen.load(std::memory_order_relaxed) + 1;
+        const uint32_t idx  = next & 1;
+        const uint32_t s    = seq[idx].load(std::memory_order_relaxed);
+
+        seq[idx].store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        memcpy(&buffers[idx], &value, sizeof(T));
+        bufGen[idx] = next;
+        seq[idx].store(s + 2, std::memory_order_release);
+
+        gen.store(next, std::memory_order_release);
+    }
+
+    /**
+     * Get a consistent copy of the latest snapshot.
+     *
+     * @param value: destination of the copy.
+     * @return generation of the snapshot.
+     */
+    uint32_t read(T& value) const
+    {
+        while(true)
+        {
+            const uint32_t g   = gen.load(std::memory_order_acquire);
+            const uint32_t idx = g & 1;
+            const uint32_t s   = seq[idx].load(std::memory_order_acquire);
+
+            // Buffer being rewritten: the writer is already two generations
+            // ahead, start again from the latest one.
+            if((s & 1) != 0)
+                continue;
+
+            memcpy(&value, &buffers[idx], sizeof(T));
+            const uint32_t copyGen = bufGen[idx];
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            // Retry also if the buffer has been rewritten since the generation
+            // was read, keeping the returned generations monotonic.
+            if((seq[idx].load(std::memory_order_relaxed) == s) && (copyGen == g))
+                return g;
+        }
+    }
+
+    /**
+     * Get the generation of the latest snapshot, incremented at each
+     * publication.
+     *
+     * @return current generation.
+     */
+    uint32_t generation() const
+    {
+        return gen.load(std::memory_order_acquire);
+    }
+
+private:
+
+    T                       buffers[2];     ///< Snapshot buffers
+    uint32_t                bufGen[2];      ///< Generation held by each buffer
+    std::atomic< uint32_t > seq[2];         ///< Per-buffer sequence counters
+    std::atomic< uint32_t > gen;            ///< Current generation
+};
+
+#endif /* SEQLOCK_H */
@@ -95,6 +95,26 @@ enum DeviceStatus
     SHUTDOWN
 };
 
+/**
+ * Flags identifying the groups of radio state fields changed since the last
+ * update. They are carried by the payload of EVENT_STATUS events, so that the
+ * UI can skip redrawing the elements not depending on them.
+ */
+enum StateChange
+{
+    STATE_CHG_TIME     = 1 << 0,    ///< Current time
+    STATE_CHG_BATTERY  = 1 << 1,    ///< Battery voltage and charge level
+    STATE_CHG_RSSI     = 1 << 2,    ///< RSSI
+    STATE_CHG_VOLUME   = 1 << 3,    ///< Volume level
+    STATE_CHG_PTT      = 1 << 4,    ///< PTT status
+    STATE_CHG_RTX      = 1 << 5,    ///< Microphone level, while transmitting
+    STATE_CHG_CHANNEL  = 1 << 6,    ///< Current channel, bank and RTX status
+    STATE_CHG_SETTINGS = 1 << 7,    ///< User settings
+    STATE_CHG_RTX_STATUS = 1 << 8,  ///< RTX status, like M17 stream data
+    STATE_CHG_GPS      = 1 << 9,    ///< GPS data
+    STATE_CHG_ALL      = 0x3FF
+};
+
 extern state_t state;
 extern pthread_mutex_t state_mutex;
 
@@ -111,10 +131,22 @@ void state_init();
 void state_terminate();
 
 /**
- * Update radio state fetching data from device drivers.
+ * Update radio state fetching data from device drivers, meant to be called
+ * every 100ms.
  */
 void state_task();
 
+/**
+ * Update battery voltage and charge level, meant to be called every second.
+ */
+void state_updateBattery();
+
+/**
+ * Update volume level from the volume knob position, meant to be called
+ * every 50ms.
+ */
+void state_updateVolume();
+
 /**
  * Reset the fields of radio state containing user settings and VFO channel.
  */
@@ -44,12 +44,27 @@ void ui_saveState();
 
 /**
  * This function advances the User Interface FSM, basing on the
- * current radio state and the keys pressed.
+ * current radio state and the keys pressed. It has to be called also
+ * periodically without pending events, to run the UI timers.
  *
  * @param sync_rtx: If true RTX needs to be synchronized
  */
 void ui_updateFSM(bool *sync_rtx);
 
+/**
+ * Check if there are events waiting to be processed by the UI FSM.
+ *
+ * @return true if at least one event is pending.
+ */
+bool ui_eventPending();
+
+/**
+ * Check if the UI is in standby, with the display backlight turned off.
+ *
+ * @return true if the UI is in standby.
+ */
+bool ui_isStandby();
+
 /**
  * This function redraws the GUI based on the last radio state.
  *
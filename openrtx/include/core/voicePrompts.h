@@ -330,6 +330,14 @@ bool vp_isPlaying();
  */
 bool vp_sequenceNotEmpty();
 
+/**
+ * Check if a voice prompt or a beep is being played or is about to start.
+ * While busy, vp_tick() has to be called every 25ms.
+ *
+ * @return true if vp_tick() has some work to do.
+ */
+bool vp_isBusy();
+
 /**
  * play a beep at a given frequency for a given duration.
  */
@@ -43,9 +43,10 @@ void xmodem_sendPacket(const void *data, size_t size, uint8_t blockNum);
  *
  * @param data: pointer to a buffer for payload data.
  * @param expectedBlockNum: expected block number, for sanity check.
- * @return number of bytes received or zero in case of errors.
+ * @return number of bytes received, zero in case of errors or -1 if the sender
+ * terminated the transfer.
  */
-size_t xmodem_receivePacket(void *data, uint8_t expectedBlockNum);
+ssize_t xmodem_receivePacket(void *data, uint8_t expectedBlockNum);
 
 /**
  * Send data using the XMODEM protocol, blocking function.
@@ -63,7 +64,8 @@ ssize_t xmodem_sendData(size_t size, int (*callback)(uint8_t *, size_t));
  * Receive data using the XMODEM protocol, blocking function.
  * Transfer starts immediately when this function is called.
  *
- * @param size: expected data size, in bytes.
+ * @param size: expected data size, in bytes. The transfer ends earlier if the
+ * sender terminates it.
  * @param callback: callback function invoked when a new data block is recevied.
  * @return number of bytes received.
  */
@@ -0,0 +1,140 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef XSTREAM_H
+#define XSTREAM_H
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Streaming data transfer protocol with a sliding window, alternative to
+ * XMODEM for bulk transfers over links with a long round trip time, like USB
+ * CDC.
+ *
+ * The sender keeps up to XSTREAM_WINDOW blocks in flight without waiting for
+ * their acknowledgement. Each frame is protected by a CRC-32: the receiver
+ * drops the corrupted ones, stores the blocks arriving out of order and asks
+ * for the retransmission of the missing ones only. Acknowledgements are
+ * cumulative and carry the sequence number of the next expected block.
+ */
+
+#define XSTREAM_BLOCK_SIZE  1024    ///< Maximum payload of a data frame
+#define XSTREAM_WINDOW      8       ///< Blocks in flight, at most 32
+#define XSTREAM_HDR_SIZE    8       ///< Size of the frame header
+#define XSTREAM_FRAME_SIZE  (XSTREAM_HDR_SIZE + XSTREAM_BLOCK_SIZE + 4)
+
+/**
+ * Serial port used for the transfer.
+ */
+struct xstreamPort
+{
+    /**
+     * Read data, waiting at most timeout milliseconds for the data to arrive.
+     * Return the number of bytes read, zero on timeout or a negative error
+     * code.
+     */
+    ssize_t (*read)(void *buf, size_t len, uint32_t timeout);
+
+    /**
+     * Write data, blocking until all of it has been sent.
+     * Return the number of bytes written or a negative error code.
+     */
+    ssize_t (*write)(const void *buf, size_t len);
+};
+
+/**
+ * Transfer statistics.
+ */
+struct xstreamStats
+{
+    uint32_t blocks;        ///< Data blocks transferred
+    uint32_t retransmits;   ///< Data blocks sent more than once
+    uint32_t naks;          ///< Retransmission requests
+    uint32_t timeouts;      ///< Expired timeouts
+    uint32_t badFrames;     ///< Frames dropped due to bad CRC or header
+};
+
+/**
+ * Transfer context.
+ */
+struct xstream
+{
+    const struct xstreamPort *port;         ///< Serial port
+    struct xstreamStats       stats;        ///< Transfer statistics
+    uint32_t                  timeout;      ///< Retransmission timeout, in ms
+    uint32_t                  rxSeq;        ///< Sequence number of last frame
+    uint16_t                  rxLen;        ///< Payload size of last frame
+    size_t                    rxPos;        ///< Bytes in the reception buffer
+    uint32_t                  present;      ///< Blocks held in the window
+    uint32_t                  nakSent;      ///< Blocks already requested
+    uint16_t                  blockLen[XSTREAM_WINDOW];
+    uint8_t                   rxFrame[XSTREAM_FRAME_SIZE];
+    uint8_t                   txFrame[XSTREAM_FRAME_SIZE];
+    uint8_t                   window[XSTREAM_WINDOW][XSTREAM_BLOCK_SIZE];
+};
+
+/**
+ * Initialize a transfer context.
+ *
+ * @param ctx: transfer context.
+ * @param port: serial port to be used.
+ */
+void xstream_init(struct xstream *ctx, const struct xstreamPort *port);
+
+/**
+ * Send data, blocking function.
+ * Data transfer begins when the start command from the receiving endpoint is
+ * detected.
+ *
+ * @param ctx: transfer context.
+ * @param size: data size.
+ * @param callback: pointer to a callback function in charge of providing data
+ * for the new blocks being sent.
+ * @return number of bytes sent or a negative value on failure.
+ */
+ssize_t xstream_sendData(struct xstream *ctx, size_t size,
+                         int (*callback)(uint8_t *, size_t));
+
+/**
+ * Receive data, blocking function.
+ * Transfer starts immediately when this function is called and ends when the
+ * sender terminates it.
+ *
+ * @param ctx: transfer context.
+ * @param size: maximum data size, in bytes. Exceeding data is discarded.
+ * @param callback: callback function invoked, in order, for each new data
+ * block received. Returning a negative value aborts the transfer.
+ * @return number of bytes received or a negative value on failure.
+ */
+ssize_t xstream_receiveData(struct xstream *ctx, size_t size,
+                            int (*callback)(uint8_t *, size_t));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* XSTREAM_H */
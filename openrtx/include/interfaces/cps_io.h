@@ -200,6 +200,48 @@ int cps_deleteBankHeader(uint16_t pos);
  */
 int cps_deleteBankData(uint16_t bank_pos, uint16_t pos);
 
+/**
+ * Find the first channel, in alphabetical order, whose name starts with a
+ * given prefix. The comparison is case insensitive.
+ *
+ * @param prefix: prefix to be searched.
+ * @return position of the channel in the channel list, -1 if not found.
+ */
+int cps_findChannelByName(const char *prefix);
+
+/**
+ * Find the channel whose RX frequency is the nearest to a given one.
+ *
+ * @param freq: frequency to be searched, in Hz.
+ * @return position of the channel in the channel list, -1 if the channel list
+ * is empty.
+ */
+int cps_findChannelByFreq(freq_t freq);
+
+/**
+ * Start a batch of codeplug modifications. Until the batch is committed or
+ * aborted, all the read, write, insert and delete operations act on a copy of
+ * the codeplug held in RAM and the nonvolatile memory is left untouched.
+ *
+ * @return 0 on success, -1 on failure or if a batch is already in progress
+ */
+int cps_beginBatch();
+
+/**
+ * Commit the current batch of modifications, writing the whole modified
+ * codeplug to nonvolatile memory in a single pass. If the commit fails the
+ * stored codeplug is left unchanged and the batch is kept open.
+ *
+ * @return 0 on success, -1 on failure
+ */
+int cps_commitBatch();
+
+/**
+ * Discard the current batch of modifications, leaving the codeplug stored in
+ * nonvolatile memory unchanged.
+ */
+void cps_abortBatch();
+
 #ifdef __cplusplus
 }
 #endif
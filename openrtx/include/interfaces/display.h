@@ -83,6 +83,29 @@ void display_renderRows(uint8_t startRow, uint8_t endRow, void *fb);
  */
 void display_render(void *fb);
 
+/**
+ * Start copying a given section, between two given rows, of framebuffer content
+ * to the display and return without waiting for the transfer to complete. The
+ * framebuffer content must not be modified until display_waitRender() returns.
+ * If a previous transfer is still in progress, this function waits for its
+ * completion before starting the new one.
+ * NOTE: only the drivers of targets with CONFIG_GFX_DOUBLE_BUFFER enabled are
+ * required to provide this function.
+ *
+ * @param startRow: first row of the framebuffer section to be copied
+ * @param endRow: last row of the framebuffer section to be copied
+ * @param fb: pointer to frameBuffer.
+ */
+void display_renderRowsAsync(uint8_t startRow, uint8_t endRow, void *fb);
+
+/**
+ * Block the caller until the transfer started by display_renderRowsAsync()
+ * completes. Returns immediately if no transfer is in progress.
+ * NOTE: only the drivers of targets with CONFIG_GFX_DOUBLE_BUFFER enabled are
+ * required to provide this function.
+ */
+void display_waitRender();
+
 /**
  * Set display contrast.
  * NOTE: not all the display controllers support contrast control, thus on some
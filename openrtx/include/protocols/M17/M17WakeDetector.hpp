@@ -0,0 +1,98 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef M17_WAKE_DETECTOR_H
+#define M17_WAKE_DETECTOR_H
+
+#ifndef __cplusplus
+#error This header is C++ only!
+#endif
+
+#include <cstdint>
+#include <cstddef>
+#include <M17/M17Constants.hpp>
+
+namespace M17
+{
+
+/**
+ * Detector for the M17 preamble, used to decide whether to wake up the
+ * demodulator from a short window of baseband samples.
+ *
+ * The preamble is a sequence of alternating outer symbols which, after pulse
+ * shaping, is a tone at half the symbol rate. The window is correlated with
+ * the in-phase and quadrature preamble templates and the energy of the
+ * correlation is compared with the total energy of the window: the resulting
+ * score is close to one when the window falls inside a preamble and close to
+ * zero on noise and on random symbol data, regardless of the signal level.
+ */
+class M17WakeDetector
+{
+public:
+
+    static constexpr uint32_t SAMPLE_RATE = 24000;  ///< Input sample rate, in Hz
+
+    /**
+     * Number of samples in a period of the preamble tone: the length of the
+     * analysed window is rounded down to a multiple of this value.
+     */
+    static constexpr size_t PREAMBLE_PERIOD = 2 * SAMPLE_RATE / M17_SYMBOL_RATE;
+
+    /**
+     * Constructor.
+     */
+    M17WakeDetector();
+
+    /**
+     * Destructor.
+     */
+    ~M17WakeDetector();
+
+    /**
+     * Analyse a window of baseband samples.
+     *
+     * @param samples: pointer to the sample buffer.
+     * @param len: number of samples in the buffer.
+     * @return true if the window contains an M17 preamble.
+     */
+    bool process(const int16_t *samples, const size_t len);
+
+    /**
+     * Get the preamble score of the last analysed window.
+     *
+     * @return fraction of the window energy matching the preamble, between
+     * zero and one.
+     */
+    float score() const
+    {
+        return lastScore;
+    }
+
+private:
+
+    static constexpr float THRESHOLD = 0.5f;        // Minimum preamble score
+
+    float lastScore;                                ///< Score of the last window
+};
+
+}      // namespace M17
+
+#endif /* M17_WAKE_DETECTOR_H */
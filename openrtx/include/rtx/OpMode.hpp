@@ -64,19 +64,25 @@ public:
 
     /**
      * Update the internal FSM.
-     * Application code has to call this function periodically, to ensure proper
-     * functionality.
+     * Application code has to call this function again not later than the
+     * returned deadline, or earlier when a new configuration is applied.
      *
      * @param status: pointer to the rtxStatus_t structure containing the current
      * RTX status. Internal FSM may change the current value of the opStatus flag.
      * @param newCfg: flag used inform the internal FSM that a new RTX configuration
      * has been applied.
+     * @return time, in ms since boot, of the next update. Update steps paced by
+     * a blocking operation, like the transfer of a block of samples, return
+     * the current time to be called again immediately.
      */
-    virtual void update(rtxStatus_t *const status, const bool newCfg)
+    virtual long long update(rtxStatus_t *const status, const bool newCfg)
     {
         (void) status;
         (void) newCfg;
-        sleepFor(0u, 30u);
+
+        // Nothing to do until a new configuration is applied, the deadline
+        // only allows to notice the device shutdown.
+        return getTick() + IDLE_PERIOD;
     }
 
     /**
@@ -98,6 +104,10 @@ public:
     {
         return false;
     }
+
+protected:
+
+    static constexpr long long IDLE_PERIOD = 1000;  ///< Update period with no mode active, in ms
 };
 
 #endif /* OPMODE_H */
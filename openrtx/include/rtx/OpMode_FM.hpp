@@ -22,6 +22,11 @@
 #define OPMODE_FM_H
 
 #include <audio_path.h>
+#include <audio_stream.h>
+#include <ctcss_decoder.hpp>
+#include <noise_squelch.hpp>
+#include <rtx.h>
+#include <memory>
 #include "OpMode.hpp"
 
 /**
@@ -62,15 +67,16 @@ public:
 
     /**
      * Update the internal FSM.
-     * Application code has to call this function periodically, to ensure proper
-     * functionality.
+     * Application code has to call this function again not later than the
+     * returned deadline, or earlier when a new configuration is applied.
      *
      * @param status: pointer to the rtxStatus_t structure containing the current
      * RTX status. Internal FSM may change the current value of the opStatus flag.
      * @param newCfg: flag used inform the internal FSM that a new RTX configuration
      * has been applied.
+     * @return time, in ms since boot, of the next update.
      */
-    virtual void update(rtxStatus_t *const status, const bool newCfg) override;
+    virtual long long update(rtxStatus_t *const status, const bool newCfg) override;
 
     /**
      * Get the mode identifier corresponding to the OpMode class.
@@ -91,11 +97,49 @@ public:
 
 private:
 
+    /**
+     * Start sampling the baseband signal for the software squelch decoders.
+     * On platforms not providing baseband sampling the tone squelch falls
+     * back to the decoder of the radio chip and the RF squelch to the RSSI.
+     */
+    void startBasebandSampling();
+
+    /**
+     * Stop sampling the baseband signal.
+     */
+    void stopBasebandSampling();
+
+    /**
+     * Feed a new block of baseband samples to the noise squelch and, when
+     * tone squelch is enabled, to the CTCSS decoder. Blocking function.
+     *
+     * @param status: pointer to the current RTX status.
+     * @return true if a block has been processed, pacing the update.
+     */
+    bool processBaseband(const rtxStatus_t *const status);
+
     bool   rfSqlOpen;   ///< Flag for RF squelch status (analog squelch).
     bool   sqlOpen;     ///< Flag for squelch status.
     bool   enterRx;     ///< Flag for RX management.
     pathId rxAudioPath; ///< Audio path ID for RX
     pathId txAudioPath; ///< Audio path ID for TX
+
+    static constexpr size_t   BASEBAND_BUF_SIZE    = 240;     ///< 30ms of samples
+    static constexpr uint32_t BASEBAND_SAMPLE_RATE = 8000;    ///< Sample rate
+    static constexpr rssi_t   STRONG_SIGNAL        = 10;      ///< dB above squelch
+    static constexpr unsigned UPDATE_PERIOD        = 30;      ///< ms, when not paced
+
+    static_assert(BASEBAND_SAMPLE_RATE == CtcssDecoder::SAMPLE_RATE, "");
+    static_assert(BASEBAND_SAMPLE_RATE == NoiseSquelch::SAMPLE_RATE, "");
+
+    CtcssDecoder                         ctcss;       ///< Software CTCSS decoder.
+    NoiseSquelch                         noiseSql;    ///< Baseband noise squelch.
+    std::unique_ptr< stream_sample_t[] > basebandBuf; ///< Baseband sample buffer.
+    pathId                               basebandPath;///< Audio path for baseband sampling.
+    streamId                             basebandId;  ///< Baseband sampling stream.
+    bool                                 noBaseband;  ///< Baseband sampling not available.
+    bool                                 rssiSqlOpen; ///< Flag for RSSI squelch status.
+    bool                                 toneSqlOpen; ///< Flag for tone squelch status.
 };
 
 #endif /* OPMODE_FM_H */
@@ -25,9 +25,39 @@
 #include <M17/M17FrameEncoder.hpp>
 #include <M17/M17Demodulator.hpp>
 #include <M17/M17Modulator.hpp>
+#include <M17/M17WakeDetector.hpp>
 #include <audio_path.h>
+#include <array>
 #include "OpMode.hpp"
 
+/*
+ * Duty cycle of the receiver while no M17 signal is present: every
+ * CONFIG_M17_WAKE_PERIOD milliseconds the front-end is powered up, the RSSI is
+ * checked and a window of CONFIG_M17_WAKE_WINDOW milliseconds of baseband is
+ * searched for the M17 preamble.
+ *
+ * The default period is the one of the RSSI-only check this scheme replaces:
+ * the RX on-time is about 10%, the 5ms settling time plus the preamble search
+ * window. Signals above the squelch threshold are caught by the
+ * RSSI check, weaker ones only when the window falls on their preamble. A
+ * preamble is never missed when period plus window does not exceed the 40ms
+ * preamble length, for example with a 30ms period, at the cost of about one
+ * third of the continuous RX current.
+ */
+#ifndef CONFIG_M17_WAKE_PERIOD
+#define CONFIG_M17_WAKE_PERIOD 100
+#endif
+
+#ifndef CONFIG_M17_WAKE_WINDOW
+#define CONFIG_M17_WAKE_WINDOW 5
+#endif
+
+/*
+ * Define CONFIG_M17_WAKE_STATS to print on the console the duty cycle of the
+ * receiver every 10 seconds and the time taken to lock on a signal after the
+ * detection of its preamble.
+ */
+
 /**
  * Specialisation of the OpMode class for the management of M17 operating mode.
  */
@@ -65,15 +95,16 @@ public:
 
     /**
      * Update the internal FSM.
-     * Application code has to call this function periodically, to ensure proper
-     * functionality.
+     * Application code has to call this function again not later than the
+     * returned deadline, or earlier when a new configuration is applied.
      *
      * @param status: pointer to the rtxStatus_t structure containing the current
      * RTX status. Internal FSM may change the current value of the opStatus flag.
      * @param newCfg: flag used inform the internal FSM that a new RTX configuration
      * has been applied.
+     * @return time, in ms since boot, of the next update.
      */
-    virtual void update(rtxStatus_t *const status, const bool newCfg) override;
+    virtual long long update(rtxStatus_t *const status, const bool newCfg) override;
 
     /**
      * Get the mode identifier corresponding to the OpMode class.
@@ -104,16 +135,18 @@ private:
      *
      * @param status: pointer to the rtxStatus_t structure containing the
      * current RTX status.
+     * @return time, in ms since boot, of the next update.
      */
-    void offState(rtxStatus_t *const status);
+    long long offState(rtxStatus_t *const status);
 
     /**
      * Function handling the RX operating state.
      *
      * @param status: pointer to the rtxStatus_t structure containing the
      * current RTX status.
+     * @return time, in ms since boot, of the next update.
      */
-    void rxState(rtxStatus_t *const status);
+    long long rxState(rtxStatus_t *const status);
 
     /**
      * Function handling the TX operating state.
@@ -137,6 +170,14 @@ private:
      */
     bool compareCallsigns(const std::string& localCs, const std::string& incomingCs);
 
+    /**
+     * Acquire a short window of baseband samples and search it for the M17
+     * preamble. The RX front-end has to be already powered.
+     *
+     * @return true if an M17 preamble has been detected.
+     */
+    bool detectPreamble();
+
 
     bool startRx;                      ///< Flag for RX management.
     bool startTx;                      ///< Flag for TX management.
@@ -158,12 +199,24 @@ private:
      * Timestamp (in ticks) until which we treat squelch as open.
      */
     long long squelchHoldUntil;
-    // RF–power–gate / RSSI polling constants and state
-    static constexpr unsigned RSSI_CHECK_INTERVAL_MS = 100;  ///< ms between RSSI scans when squelch closed
-    static constexpr unsigned RADIO_SETTLE_MS         =   5;   ///< ms to wait after radio_enableRx()
+    // RF–power–gate / wake-up polling constants and state
+    static constexpr unsigned WAKE_PERIOD_MS  = CONFIG_M17_WAKE_PERIOD;  ///< ms between wake-up scans when squelch closed
+    static constexpr unsigned RADIO_SETTLE_MS = 5;                       ///< ms to wait after radio_enableRx()
+    static constexpr unsigned PTT_POLL_MS     = 30;                      ///< ms between PTT checks when off
+    static constexpr size_t   WAKE_SAMPLES    = CONFIG_M17_WAKE_WINDOW
+                                              * M17::M17WakeDetector::SAMPLE_RATE / 1000;
     long long              nextRssiCheckTime;             ///< tick when we’ll re-enable & poll RSSI
     bool                   rfPowered;                     ///< true if RX front-end is currently powered
 
+    M17::M17WakeDetector wakeDetector;                        ///< Preamble detector for wake-up
+    std::array< stream_sample_t, WAKE_SAMPLES > wakeBuf;      ///< Wake-up baseband window
+    #ifdef CONFIG_M17_WAKE_STATS
+    long long statStart;               ///< Start of the duty cycle statistics
+    long long statOnTime;              ///< Front-end on time during scans, in ms
+    long long wakeTime;                ///< Time of the last preamble detection
+    unsigned  statWakes;               ///< Number of scans performed
+    #endif
+
     pathId rxAudioPath;                ///< Audio path ID for RX
     pathId txAudioPath;                ///< Audio path ID for TX
     M17::M17Modulator    modulator;    ///< M17 modulator.
@@ -66,6 +66,7 @@ typedef struct
     char     M17_src[10];              /**  M17 LSF source             */
     char     M17_link[10];             /**  M17 LSF traffic originator */
     char     M17_refl[10];             /**  M17 LSF reflector module   */
+    int32_t  M17_srcContact;           /**  Contact of M17_src, or -1  */
     char       logMessage[10];
     
     bool     historyEnabled;
@@ -112,8 +113,8 @@ enum opstatus
 
 /**
  * Initialise rtx stage.
- * @param m: pointer to the mutex protecting the shared configuration data
- * structure.
+ * @param m: pointer to the mutex used to wake up the RTX task when a new
+ * configuration is posted.
  */
 void rtx_init(pthread_mutex_t *m);
 
@@ -123,23 +124,34 @@ void rtx_init(pthread_mutex_t *m);
 void rtx_terminate();
 
 /**
- * Post a new RTX configuration on the internal message queue. Data structure
- * \b must be protected by the same mutex whose pointer has been passed as a
- * parameter to rtx_init(). This driver only copies its content into the internal
- * data structure, eventual garbage collection has to be performed by caller.
+ * Post a new RTX configuration on the internal message queue. The structure
+ * is copied before returning, so the caller can modify or release it right
+ * after. To be called always by the same thread.
+ * The RTX task is woken up to apply the new configuration.
  * @param cfg: pointer to a structure containing the new RTX configuration.
  */
 void rtx_configure(const rtxStatus_t *cfg);
 
 /**
- * Obtain a copy of the RTX driver's internal status data structure.
+ * Obtain a consistent copy of the RTX driver's internal status data structure.
+ * This function is thread-safe and never blocks.
  * @return copy of the RTX driver's internal status data structure.
  */
 rtxStatus_t rtx_getCurrentStatus();
 
 /**
- * High-level code is in charge of calling this function periodically, since it
- * contains all the RTX management functionalities.
+ * Get the generation of the RTX driver's status, incremented each time the
+ * status changes. Comparing it with the value read previously allows to know
+ * if the status has changed in the meantime.
+ * @return current generation of the RTX status.
+ */
+uint32_t rtx_getStatusGeneration();
+
+/**
+ * High-level code is in charge of calling this function in a loop, since it
+ * contains all the RTX management functionalities. The function blocks until
+ * the deadline requested by the current operating mode expires or a new
+ * configuration is posted.
  */
 void rtx_task();
 
@@ -233,6 +233,8 @@ typedef struct ui_state_t
     char new_time_buf[9];
 #endif
     char new_callsign[10];
+    // Channel name prefix typed in the channel menu
+    char search_prefix[10];
     freq_t new_offset;
     // Which state to return to when we exit menu
     uint8_t last_main_state;
@@ -0,0 +1,128 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef UI_WIDGET_H
+#define UI_WIDGET_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <graphics.h>
+
+/**
+ * Retained widgets for the default UI.
+ *
+ * A widget is a rectangular area of the screen holding a text line, a bar, an
+ * icon or a list row, together with a hash of the inputs (state fields,
+ * strings, colors) its content was last drawn from. Drawing functions compute
+ * the hash of the current inputs and redraw the widget only when it differs
+ * from the stored one, clearing the widget area first.
+ *
+ * Frames can be full or partial: a full frame starts from a cleared screen and
+ * redraws all the widgets, a partial frame only the ones whose inputs changed.
+ * In partial frames the widgets not depending on any of the state fields
+ * changed since the previous frame can be skipped altogether, see
+ * widget_needsCheck().
+ */
+typedef struct
+{
+    point_t  pos;           ///< Top left corner of the widget area
+    uint16_t width;         ///< Width of the widget area
+    uint16_t height;        ///< Height of the widget area
+    uint32_t inputs;        ///< Hash of the inputs of the last drawn content
+    uint32_t frame;         ///< Full frame the input hash refers to
+}
+widget_t;
+
+/**
+ * Initial value for the hash of the widget inputs.
+ */
+#define WIDGET_HASH_INIT 2166136261u
+
+/**
+ * Set the screen area occupied by a widget and invalidate its content.
+ *
+ * @param widget: pointer to the widget.
+ * @param pos: top left corner of the widget area.
+ * @param width: width of the widget area.
+ * @param height: height of the widget area.
+ */
+void widget_setArea(widget_t *widget, point_t pos, uint16_t width,
+                    uint16_t height);
+
+/**
+ * Start drawing a new frame. When the frame is full, the content of all the
+ * widgets is invalidated and the caller is in charge of clearing the screen.
+ *
+ * @param full: true if the whole screen is being redrawn.
+ * @param changes: bitmask of the state fields changed since the previous
+ * frame, see the StateChange enum.
+ */
+void widget_beginFrame(bool full, uint32_t changes);
+
+/**
+ * Check if the frame being drawn is a full one. Static decorations drawn
+ * outside of the widgets have to be drawn only in full frames.
+ *
+ * @return true if the frame being drawn is a full one.
+ */
+bool widget_fullFrame();
+
+/**
+ * Check if the widgets depending on a given set of state fields have to be
+ * checked for changes in the frame being drawn.
+ *
+ * @param deps: bitmask of the state fields the widgets depend on.
+ * @return true if the frame is full or if any of the state fields changed.
+ */
+bool widget_needsCheck(uint32_t deps);
+
+/**
+ * Add a block of data to the hash of the inputs of a widget.
+ *
+ * @param hash: current hash value, WIDGET_HASH_INIT for the first block.
+ * @param data: pointer to the data.
+ * @param len: length of the data, in bytes.
+ * @return the updated hash value.
+ */
+uint32_t widget_hash(uint32_t hash, const void *data, size_t len);
+
+/**
+ * Add a string to the hash of the inputs of a widget.
+ *
+ * @param hash: current hash value, WIDGET_HASH_INIT for the first block.
+ * @param str: null-terminated string.
+ * @return the updated hash value.
+ */
+uint32_t widget_hashString(uint32_t hash, const char *str);
+
+/**
+ * Check if a widget has to be redrawn given the hash of its current inputs.
+ * If so, the input hash is stored and, in partial frames, the widget area is
+ * cleared.
+ *
+ * @param widget: pointer to the widget.
+ * @param inputs: hash of the current inputs of the widget.
+ * @return true if the widget content has to be drawn.
+ */
+bool widget_update(widget_t *widget, uint32_t inputs);
+
+#endif /* UI_WIDGET_H */
@@ -33,6 +33,7 @@
 #include <stdio.h>
 #include <errno.h>
 #include <dsp.h>
+#include <ringbuf.hpp>
 
 #define BUF_SIZE 4
 
@@ -44,14 +45,9 @@ static bool             running;
 static bool             reqStop;
 static pthread_t        codecThread;
 static pthread_attr_t   codecAttr;
-static pthread_mutex_t  data_mutex  = PTHREAD_MUTEX_INITIALIZER;
 static pthread_mutex_t  init_mutex  = PTHREAD_MUTEX_INITIALIZER;
-static pthread_cond_t   wakeup_cond = PTHREAD_COND_INITIALIZER;
 
-static uint8_t          readPos;
-static uint8_t          writePos;
-static uint8_t          numElements;
-static uint64_t         dataBuffer[BUF_SIZE];
+static RingBuffer< uint64_t, BUF_SIZE > dataBuffer;
 
 #ifdef PLATFORM_MOD17
 static const uint8_t micGainPre  = 4;
@@ -78,10 +74,8 @@ void codec_init()
     if(initCnt > 0)
         return;
 
-    running     = false;
-    readPos     = 0;
-    writePos    = 0;
-    numElements = 0;
+    running = false;
+    dataBuffer.reset();
 }
 
 void codec_terminate()
@@ -131,23 +125,9 @@ int codec_popFrame(uint8_t *frame, const bool blocking)
     uint64_t element;
 
     // No data available and non-blocking call: just return false.
-    if((numElements == 0) && (blocking == false))
+    if(dataBuffer.pop(element, blocking) == false)
         return -EAGAIN;
 
-    // Blocking call: wait until some data is pushed
-    pthread_mutex_lock(&data_mutex);
-    while(numElements == 0)
-    {
-        pthread_cond_wait(&wakeup_cond, &data_mutex);
-    }
-
-    element      = dataBuffer[readPos];
-    readPos      = (readPos + 1) % BUF_SIZE;
-    numElements -= 1;
-    pthread_mutex_unlock(&data_mutex);
-
-    // Do memcpy after mutex unlock to reduce execution time spent inside the
-    // critical section
     memcpy(frame, &element, 8);
 
     return 0;
@@ -158,29 +138,13 @@ int codec_pushFrame(const uint8_t *frame, const bool blocking)
     if(running == false)
         return -EPERM;
 
-    // Copy data to a temporary variable before mutex lock to reduce execution
-    // time spent inside the critical section
     uint64_t element;
     memcpy(&element, frame, 8);
 
-
     // No space available and non-blocking call: return
-    if((numElements >= BUF_SIZE) && (blocking == false))
+    if(dataBuffer.push(element, blocking) == false)
         return -EAGAIN;
 
-    // Blocking call: wait until there is some free space
-    pthread_mutex_lock(&data_mutex);
-    while(numElements >= BUF_SIZE)
-    {
-        pthread_cond_wait(&wakeup_cond, &data_mutex);
-    }
-
-    // There is free space, push data into the queue
-    dataBuffer[writePos] = element;
-    writePos = (writePos + 1) % BUF_SIZE;
-    numElements += 1;
-
-    pthread_mutex_unlock(&data_mutex);
     return 0;
 }
 
@@ -236,24 +200,9 @@ static void *encodeFunc(void *arg)
         uint64_t frame = 0;
         codec2_encode(codec2, ((uint8_t*) &frame), audio.data);
 
-        pthread_mutex_lock(&data_mutex);
-
         // If buffer is full erase the oldest frame
-        if(numElements >= BUF_SIZE)
-        {
-            readPos = (readPos + 1) % BUF_SIZE;
-        }
-
-        dataBuffer[writePos] = frame;
-        writePos = (writePos + 1) % BUF_SIZE;
-
-        if(numElements == 0)
-            pthread_cond_signal(&wakeup_cond);
-
-        if(numElements < BUF_SIZE)
-            numElements += 1;
-
-        pthread_mutex_unlock(&data_mutex);
+        if(dataBuffer.full()) dataBuffer.eraseElement();
+        dataBuffer.push(frame, false);
     }
 
     audioStream_terminate(iStream);
@@ -302,22 +251,7 @@ static void *decodeFunc(void *arg)
 
         // Try popping data from the queue
         uint64_t frame   = 0;
-        bool     newData = false;
-
-        pthread_mutex_lock(&data_mutex);
-
-        if(numElements != 0)
-        {
-            frame        = dataBuffer[readPos];
-            readPos      = (readPos + 1) % BUF_SIZE;
-            if(numElements >= BUF_SIZE)
-                pthread_cond_signal(&wakeup_cond);
-
-            numElements -= 1;
-            newData      = true;
-        }
-
-        pthread_mutex_unlock(&data_mutex);
+        bool     newData = dataBuffer.pop(frame, false);
 
         stream_sample_t *audioBuf = outputStream_getIdleBuffer(oStream);
         if(audioBuf == NULL)
@@ -391,10 +325,8 @@ static bool startThread(const pathId path, void *(*func) (void *))
     audioPath = path;
     pthread_mutex_unlock(&init_mutex);
 
-    readPos     = 0;
-    writePos    = 0;
-    numElements = 0;
-    reqStop     = false;
+    dataBuffer.reset();
+    reqStop = false;
 
     pthread_attr_init(&codecAttr);
 
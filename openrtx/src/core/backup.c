@@ -18,56 +18,149 @@
  *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
  ***************************************************************************/
 
+#include <interfaces/delays.h>
+#include <interfaces/nvmem.h>
+#include <flash_backup.h>
+#include <usb_vcom.h>
 #include <backup.h>
+#include <xstream.h>
 #include <xmodem.h>
 #include <string.h>
 #include "W25Qx.h"
 
-#if defined(PLATFORM_GD77) || defined(PLATFORM_DM1801)
-static const size_t EFLASH_SIZE = 1024*1024;    // 1 MB
-#else
-static const size_t EFLASH_SIZE = 16*1024*1024; // 16 MB
-#endif
+static struct flashBackup backup;
+static struct xstream     xfer;
+static bool restoreFailed;
+static bool restoreDone;
 
-size_t  memAddr = 0;
+static ssize_t vcomRead(void *buf, size_t len, uint32_t timeout)
+{
+    long long deadline = getTick() + timeout;
+    ssize_t   ret;
+
+    while(true)
+    {
+        ret = vcom_readBlock(buf, len);
+        if((ret != 0) || (getTick() >= deadline))
+            break;
+
+        sleepFor(0, 1);
+    }
+
+    return ret;
+}
+
+static const struct xstreamPort vcomPort =
+{
+    .read  = vcomRead,
+    .write = vcom_writeBlock
+};
 
 static int getDataCallback(uint8_t *ptr, size_t size)
 {
-    if((memAddr + size) > EFLASH_SIZE) return -1;
-    W25Qx_readData(memAddr, ptr, size);
-    memAddr += size;
+    ssize_t ret = flashBackup_read(&backup, ptr, size);
+    if(ret < 0)
+        return -1;
+
+    // Stream shorter than expected, flash content changed during the transfer
+    if((size_t) ret != size)
+        return -1;
+
     return 0;
 }
 
-static void writeDataCallback(uint8_t *ptr, size_t size)
+static int writeDataCallback(uint8_t *ptr, size_t size)
 {
-    // Trigger sector erase on each 4kB address boundary
-    if((memAddr % 0x1000) == 0)
-    {
-        W25Qx_erase(memAddr, 0x1000);
-    }
+    // Errors are sticky: once the stream is broken, the remaining data is
+    // discarded and the already restored sectors are left untouched.
+    if(restoreFailed)
+        return -1;
 
-    for(size_t written = 0; written < size; )
+    int ret = flashBackup_write(&backup, ptr, size);
+    if(ret < 0)
     {
-        size_t toWrite = size - written;
-        if(toWrite > 256) toWrite = 256;
-        W25Qx_writePage(memAddr, ptr, toWrite);
-        written += toWrite;
-        memAddr += toWrite;
-        ptr     += toWrite;
+        restoreFailed = true;
+        return -1;
     }
+
+    if(ret > 0)
+        restoreDone = true;
+
+    return 0;
 }
 
-void eflash_dump()
+static void xmodemWriteCallback(uint8_t *ptr, size_t size)
 {
-    memAddr = 0;
-    W25Qx_wakeup();
-    xmodem_sendData(EFLASH_SIZE, getDataCallback);
+    // XMODEM cannot abort from the receiving side, the failure is reported
+    // once the sender terminates the transfer.
+    writeDataCallback(ptr, size);
+}
+
+void eflash_dump(const enum backupProtocol proto)
+{
+    const struct nvmDevice *dev = nvm_getDesc(0)->dev;
+    uint8_t buf[256];
+    ssize_t ret;
+
+    W25Qx_wakeup(dev);
+
+    // XMODEM needs the total size in advance: run a first pass to compute
+    // the size of the compressed stream.
+    if(flashBackup_startExport(&backup, dev, 0) < 0)
+        return;
+
+    do
+    {
+        ret = flashBackup_read(&backup, buf, sizeof(buf));
+    }
+    while(ret > 0);
+
+    if(ret < 0)
+        return;
+
+    size_t streamSize = backup.stats.streamSize;
+    flashBackup_startExport(&backup, dev, 0);
+
+    if(proto == BACKUP_XSTREAM)
+    {
+        xstream_init(&xfer, &vcomPort);
+        xstream_sendData(&xfer, streamSize, getDataCallback);
+    }
+    else
+    {
+        xmodem_sendData(streamSize, getDataCallback);
+    }
 }
 
-void eflash_restore()
+int eflash_restore(const enum backupProtocol proto)
 {
-    memAddr = 0;
-    W25Qx_wakeup();
-    xmodem_receiveData(EFLASH_SIZE, writeDataCallback);
+    const struct nvmDevice *dev = nvm_getDesc(0)->dev;
+    ssize_t ret;
+
+    W25Qx_wakeup(dev);
+
+    if(flashBackup_startImport(&backup, dev) < 0)
+        return -1;
+
+    restoreFailed = false;
+    restoreDone   = false;
+
+    // The stream size is not known in advance, the transfer is terminated by
+    // the sender and the padding after the end record is ignored.
+    if(proto == BACKUP_XSTREAM)
+    {
+        xstream_init(&xfer, &vcomPort);
+        ret = xstream_receiveData(&xfer, SIZE_MAX, writeDataCallback);
+    }
+    else
+    {
+        ret = xmodem_receiveData(SIZE_MAX, xmodemWriteCallback);
+    }
+
+    // A stream ending before its end record leaves the flash partially
+    // restored
+    if((ret < 0) || restoreFailed || (restoreDone == false))
+        return -1;
+
+    return 0;
 }
@@ -0,0 +1,411 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <interfaces/cps_io.h>
+#include <contact_index.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define EMPTY_SLOT  0xFFFF
+#define MIN_SLOTS   16
+
+/**
+ * Index slot, 8 bytes: the full address is stored so that lookups never need
+ * to access the codeplug.
+ */
+typedef struct
+{
+    uint8_t  address[6];    // Encoded M17 address
+    uint16_t pos;           // Contact position, EMPTY_SLOT if unused
+}
+slot_t;
+
+/**
+ * Open addressing hash table with linear probing.
+ */
+typedef struct
+{
+    slot_t  *slots;
+    uint32_t numSlots;      // Always a power of two
+    uint32_t used;
+    uint32_t dups;          // Contacts not indexed due to a duplicate address
+    bool     valid;
+}
+index_t;
+
+static index_t         idx   = { NULL, 0, 0, 0, false };
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * \internal
+ * Compute the home slot of an address.
+ */
+static inline uint32_t _hash(const index_t *index, const uint8_t *address)
+{
+    uint64_t key = 0;
+    for(uint8_t i = 0; i < 6; i++)
+        key = (key << 8) | address[i];
+
+    // Fibonacci hashing, the upper bits are the best mixed ones
+    key *= 0x9E3779B97F4A7C15ULL;
+    return (uint32_t) (key >> 32) & (index->numSlots - 1);
+}
+
+/**
+ * \internal
+ * Find the slot holding an address.
+ *
+ * @return slot number or -1 if not found.
+ */
+static int32_t _find(const index_t *index, const uint8_t *address)
+{
+    if(index->numSlots == 0)
+        return -1;
+
+    uint32_t mask = index->numSlots - 1;
+    uint32_t i    = _hash(index, address);
+
+    while(index->slots[i].pos != EMPTY_SLOT)
+    {
+        if(memcmp(index->slots[i].address, address, 6) == 0)
+            return i;
+
+        i = (i + 1) & mask;
+    }
+
+    return -1;
+}
+
+/**
+ * \internal
+ * Allocate a new slot table.
+ *
+ * @return 0 on success, -1 on failure.
+ */
+static int _alloc(index_t *index, uint32_t numSlots)
+{
+    index->slots = (slot_t *) malloc(numSlots * sizeof(slot_t));
+    if(index->slots == NULL)
+        return -1;
+
+    for(uint32_t i = 0; i < numSlots; i++)
+        index->slots[i].pos = EMPTY_SLOT;
+
+    index->numSlots = numSlots;
+    index->used     = 0;
+    return 0;
+}
+
+/**
+ * \internal
+ * Add an entry to the table, without growing it. If the address is already
+ * present the contact with the lowest position is kept.
+ */
+static void _put(index_t *index, const uint8_t *address, uint16_t pos)
+{
+    uint32_t mask = index->numSlots - 1;
+    uint32_t i    = _hash(index, address);
+
+    while(index->slots[i].pos != EMPTY_SLOT)
+    {
+        if(memcmp(index->slots[i].address, address, 6) == 0)
+        {
+            if(pos < index->slots[i].pos)
+                index->slots[i].pos = pos;
+
+            index->dups++;
+            return;
+        }
+
+        i = (i + 1) & mask;
+    }
+
+    memcpy(index->slots[i].address, address, 6);
+    index->slots[i].pos = pos;
+    index->used++;
+}
+
+/**
+ * \internal
+ * Add an entry to the table, doubling its size if the load factor would
+ * exceed 75%.
+ *
+ * @return 0 on success, -1 on failure.
+ */
+static int _insert(index_t *index, const uint8_t *address, uint16_t pos)
+{
+    if(4 * (index->used + 1) > 3 * index->numSlots)
+    {
+        index_t  newIndex;
+        uint32_t numSlots = (index->numSlots == 0) ? MIN_SLOTS
+                                                   : 2 * index->numSlots;
+        if(_alloc(&newIndex, numSlots) < 0)
+            return -1;
+
+        for(uint32_t i = 0; i < index->numSlots; i++)
+        {
+            const slot_t *s = &index->slots[i];
+            if(s->pos != EMPTY_SLOT)
+                _put(&newIndex, s->address, s->pos);
+        }
+
+        free(index->slots);
+        index->slots    = newIndex.slots;
+        index->numSlots = newIndex.numSlots;
+    }
+
+    _put(index, address, pos);
+    return 0;
+}
+
+/**
+ * \internal
+ * Remove the entry in a given slot, moving back the following entries of the
+ * probe sequence to keep it free of holes.
+ */
+static void _erase(index_t *index, uint32_t slot)
+{
+    uint32_t mask = index->numSlots - 1;
+    uint32_t hole = slot;
+    uint32_t i    = slot;
+
+    index->slots[hole].pos = EMPTY_SLOT;
+    index->used--;
+
+    while(true)
+    {
+        i = (i + 1) & mask;
+        if(index->slots[i].pos == EMPTY_SLOT)
+            return;
+
+        // Move the entry in the hole only if its home slot does not lie
+        // cyclically between the hole and its current position.
+        uint32_t home = _hash(index, index->slots[i].address);
+        if(((i - home) & mask) >= ((i - hole) & mask))
+        {
+            index->slots[hole]     = index->slots[i];
+            index->slots[i].pos    = EMPTY_SLOT;
+            hole = i;
+        }
+    }
+}
+
+/**
+ * \internal
+ * Look in the codeplug for another contact having an address which was just
+ * dropped from the index, adding it back if found. Needed only when the
+ * dropped entry may have hidden a duplicate.
+ */
+static void _restore(const uint8_t *address)
+{
+    contact_t contact;
+
+    for(uint32_t pos = 0; pos < EMPTY_SLOT; pos++)
+    {
+        if(cps_readContact(&contact, pos) < 0)
+            return;
+
+        if(contact.mode != OPMODE_M17)
+            continue;
+
+        if(memcmp(contact.info.m17.address, address, 6) != 0)
+            continue;
+
+        pthread_mutex_lock(&mutex);
+        if(idx.valid && (_insert(&idx, address, pos) < 0))
+            idx.valid = false;
+        pthread_mutex_unlock(&mutex);
+
+        return;
+    }
+}
+
+int contactIndex_build()
+{
+    index_t   newIndex = { NULL, 0, 0, 0, true };
+    contact_t contact;
+
+    for(uint32_t pos = 0; pos < EMPTY_SLOT; pos++)
+    {
+        if(cps_readContact(&contact, pos) < 0)
+            break;
+
+        if(contact.mode != OPMODE_M17)
+            continue;
+
+        if(_insert(&newIndex, contact.info.m17.address, pos) < 0)
+        {
+            free(newIndex.slots);
+            contactIndex_invalidate();
+            return -1;
+        }
+    }
+
+    pthread_mutex_lock(&mutex);
+    slot_t *oldSlots = idx.slots;
+    idx = newIndex;
+    pthread_mutex_unlock(&mutex);
+
+    free(oldSlots);
+    return 0;
+}
+
+void contactIndex_clear()
+{
+    pthread_mutex_lock(&mutex);
+    slot_t *oldSlots = idx.slots;
+    idx.slots    = NULL;
+    idx.numSlots = 0;
+    idx.used     = 0;
+    idx.dups     = 0;
+    idx.valid    = false;
+    pthread_mutex_unlock(&mutex);
+
+    free(oldSlots);
+}
+
+int contactIndex_lookupM17(const uint8_t address[6])
+{
+    int ret = -1;
+
+    pthread_mutex_lock(&mutex);
+    if(idx.valid)
+    {
+        int32_t slot = _find(&idx, address);
+        if(slot >= 0)
+            ret = idx.slots[slot].pos;
+    }
+    pthread_mutex_unlock(&mutex);
+
+    return ret;
+}
+
+void contactIndex_inserted(const contact_t *contact, uint16_t pos)
+{
+    pthread_mutex_lock(&mutex);
+
+    if(idx.valid)
+    {
+        for(uint32_t i = 0; i < idx.numSlots; i++)
+        {
+            if((idx.slots[i].pos != EMPTY_SLOT) && (idx.slots[i].pos >= pos))
+                idx.slots[i].pos++;
+        }
+
+        if((contact->mode == OPMODE_M17) &&
+           (_insert(&idx, contact->info.m17.address, pos) < 0))
+            idx.valid = false;
+    }
+
+    pthread_mutex_unlock(&mutex);
+}
+
+void contactIndex_written(uint16_t pos, const contact_t *prev,
+                          const contact_t *contact)
+{
+    bool    wasM17  = (prev->mode == OPMODE_M17);
+    bool    isM17   = (contact->mode == OPMODE_M17);
+    bool    restore = false;
+    uint8_t address[6];
+
+    if(wasM17 && isM17 &&
+       (memcmp(prev->info.m17.address, contact->info.m17.address, 6) == 0))
+        return;
+
+    if((wasM17 == false) && (isM17 == false))
+        return;
+
+    pthread_mutex_lock(&mutex);
+
+    if(idx.valid)
+    {
+        if(wasM17)
+        {
+            int32_t slot = _find(&idx, prev->info.m17.address);
+            if((slot >= 0) && (idx.slots[slot].pos == pos))
+            {
+                memcpy(address, prev->info.m17.address, 6);
+                _erase(&idx, slot);
+                restore = (idx.dups > 0);
+            }
+        }
+
+        if(isM17 && (_insert(&idx, contact->info.m17.address, pos) < 0))
+            idx.valid = false;
+    }
+
+    pthread_mutex_unlock(&mutex);
+
+    if(restore)
+        _restore(address);
+}
+
+void contactIndex_removed(uint16_t pos)
+{
+    bool    restore = false;
+    uint8_t address[6];
+
+    pthread_mutex_lock(&mutex);
+
+    if(idx.valid)
+    {
+        for(uint32_t i = 0; i < idx.numSlots; i++)
+        {
+            if(idx.slots[i].pos == pos)
+            {
+                memcpy(address, idx.slots[i].address, 6);
+                _erase(&idx, i);
+                restore = (idx.dups > 0);
+                break;
+            }
+        }
+
+        // Erasing may move entries around, renumber in a separate pass
+        for(uint32_t i = 0; i < idx.numSlots; i++)
+        {
+            if((idx.slots[i].pos != EMPTY_SLOT) && (idx.slots[i].pos > pos))
+                idx.slots[i].pos--;
+        }
+    }
+
+    pthread_mutex_unlock(&mutex);
+
+    if(restore)
+        _restore(address);
+}
+
+void contactIndex_invalidate()
+{
+    pthread_mutex_lock(&mutex);
+    idx.valid = false;
+    pthread_mutex_unlock(&mutex);
+}
+
+size_t contactIndex_size()
+{
+    pthread_mutex_lock(&mutex);
+    size_t size = idx.numSlots * sizeof(slot_t);
+    pthread_mutex_unlock(&mutex);
+
+    return size;
+}
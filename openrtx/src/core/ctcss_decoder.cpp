@@ -0,0 +1,213 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <ctcss_decoder.hpp>
+#include <cmath>
+
+CtcssDecoder::CtcssDecoder() : target(-1)
+{
+    static constexpr float fc = 270.0f;     // Low-pass cutoff frequency
+    static constexpr float decimRate = SAMPLE_RATE / DECIMATION;
+
+    // Butterworth low-pass built from biquad sections, each with the Q of one
+    // of the conjugate pole pairs.
+    const float w0   = 2.0f * M_PI * fc / SAMPLE_RATE;
+    const float cosW = std::cos(w0);
+    const float sinW = std::sin(w0);
+
+    for(size_t i = 0; i < NUM_BIQUADS; i++)
+    {
+        float theta = M_PI * (2.0f * i + 1.0f) / (4.0f * NUM_BIQUADS);
+        float q     = 1.0f / (2.0f * std::sin(theta));
+        float alpha = sinW / (2.0f * q);
+        float a0    = 1.0f + alpha;
+
+        lpf[i].b0 = ((1.0f - cosW) / 2.0f) / a0;
+        lpf[i].b1 = (1.0f - cosW) / a0;
+        lpf[i].b2 = lpf[i].b0;
+        lpf[i].a1 = (-2.0f * cosW) / a0;
+        lpf[i].a2 = (1.0f - alpha) / a0;
+    }
+
+    for(size_t i = 0; i < NUM_TONES; i++)
+    {
+        float freq = static_cast< float >(ctcss_tone[i]) / 10.0f;
+        coeff[i]   = 2.0f * std::cos(2.0f * M_PI * freq / decimRate);
+    }
+
+    reset();
+}
+
+CtcssDecoder::~CtcssDecoder()
+{
+
+}
+
+void CtcssDecoder::reset()
+{
+    for(auto& biquad : lpf)
+    {
+        biquad.z1 = 0.0f;
+        biquad.z2 = 0.0f;
+    }
+
+    // Windows start staggered, the ones with a negative position skip the
+    // first samples.
+    for(size_t i = 0; i < NUM_WINDOWS; i++)
+    {
+        windows[i].s1.fill(0.0f);
+        windows[i].s2.fill(0.0f);
+        windows[i].energy = 0.0f;
+        windows[i].pos    = -static_cast< int >(i * HOP);
+    }
+
+    decimCount = 0;
+    dcIn       = 0.0f;
+    dcOut      = 0.0f;
+    lastIndex  = -1;
+    hits       = 0;
+    misses     = 0;
+    detected   = false;
+}
+
+void CtcssDecoder::setTone(const uint16_t tone)
+{
+    int8_t index = -1;
+
+    for(size_t i = 0; i < NUM_TONES; i++)
+    {
+        if(ctcss_tone[i] == tone)
+            index = i;
+    }
+
+    if(index == target)
+        return;
+
+    target   = index;
+    hits     = 0;
+    misses   = 0;
+    detected = false;
+}
+
+void CtcssDecoder::process(const stream_sample_t *samples, const size_t len)
+{
+    for(size_t i = 0; i < len; i++)
+    {
+        float value = static_cast< float >(samples[i]);
+
+        for(auto& biquad : lpf)
+        {
+            float out = biquad.b0 * value + biquad.z1;
+            biquad.z1 = biquad.b1 * value - biquad.a1 * out + biquad.z2;
+            biquad.z2 = biquad.b2 * value - biquad.a2 * out;
+            value     = out;
+        }
+
+        decimCount += 1;
+        if(decimCount < DECIMATION)
+            continue;
+
+        decimCount = 0;
+
+        // DC blocker with a cutoff frequency of about 3Hz
+        float sample = value - dcIn + 0.98f * dcOut;
+        dcIn  = value;
+        dcOut = sample;
+
+        goertzel(sample);
+    }
+}
+
+void CtcssDecoder::goertzel(const float sample)
+{
+    for(auto& window : windows)
+    {
+        if(window.pos < 0)
+        {
+            window.pos += 1;
+            continue;
+        }
+
+        for(size_t i = 0; i < NUM_TONES; i++)
+        {
+            float s0 = sample + coeff[i] * window.s1[i] - window.s2[i];
+            window.s2[i] = window.s1[i];
+            window.s1[i] = s0;
+        }
+
+        window.energy += sample * sample;
+        window.pos    += 1;
+
+        if(static_cast< size_t >(window.pos) == WINDOW)
+            evaluate(window);
+    }
+}
+
+void CtcssDecoder::evaluate(Window& window)
+{
+    float  maxPower = 0.0f;
+    int8_t maxIndex = -1;
+
+    for(size_t i = 0; i < NUM_TONES; i++)
+    {
+        float s1    = window.s1[i];
+        float s2    = window.s2[i];
+        float power = (s1 * s1) + (s2 * s2) - (coeff[i] * s1 * s2);
+
+        if(power > maxPower)
+        {
+            maxPower = power;
+            maxIndex = i;
+        }
+    }
+
+    // A pure tone has a Goertzel power of WINDOW * energy / 2, compare the
+    // strongest one against this value.
+    float share = 0.0f;
+    if(window.energy > 0.0f)
+        share = (2.0f * maxPower) / (WINDOW * window.energy);
+
+    lastIndex = (share >= THRESHOLD) ? maxIndex : -1;
+
+    if((lastIndex >= 0) && (lastIndex == target))
+    {
+        misses = 0;
+        if(hits < OPEN_COUNT)
+            hits += 1;
+
+        if(hits >= OPEN_COUNT)
+            detected = true;
+    }
+    else
+    {
+        hits = 0;
+        if(misses < HANG_COUNT)
+            misses += 1;
+
+        if(misses >= HANG_COUNT)
+            detected = false;
+    }
+
+    window.s1.fill(0.0f);
+    window.s2.fill(0.0f);
+    window.energy = 0.0f;
+    window.pos    = 0;
+}
@@ -0,0 +1,574 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <flash_backup.h>
+#include <nvmem_access.h>
+#include <string.h>
+#include <errno.h>
+#include <crc.h>
+
+#define BACKUP_MAGIC    0x42585452    // "RTXB"
+#define BACKUP_VERSION  1
+#define END_SECTOR      0xFFFFFFFF
+
+#define LZ_MIN_MATCH    3
+#define LZ_MAX_MATCH    18
+#define LZ_HASH_BITS    11
+
+enum sectorType
+{
+    SECTOR_ERASED = 0,
+    SECTOR_RAW    = 1,
+    SECTOR_LZ     = 2
+};
+
+enum streamState
+{
+    EXPORT_HEADER = 0,
+    EXPORT_SECTORS,
+    EXPORT_END,
+    IMPORT_HEADER,
+    IMPORT_RECORD,
+    IMPORT_PAYLOAD,
+    IMPORT_DONE
+};
+
+/**
+ * Header of the backup stream.
+ */
+struct streamHdr
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t sectorSize;
+    uint32_t numSectors;
+};
+
+/**
+ * Header of a sector record.
+ */
+struct sectorHdr
+{
+    uint32_t sector;
+    uint32_t crc;
+    uint16_t type;
+    uint16_t size;
+};
+
+
+static inline uint32_t lzHash(const uint8_t *ptr)
+{
+    uint32_t val = ptr[0] | (ptr[1] << 8) | (ptr[2] << 16);
+    return (val * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+/**
+ * \internal
+ * Compress a sector with an LZSS scheme: groups of eight items are preceded by
+ * a flag byte, each item is either a literal byte or a 16-bit back reference
+ * made of a 12-bit offset and a 4-bit length.
+ *
+ * @param src: sector data.
+ * @param dst: destination buffer.
+ * @param maxLen: maximum size of the compressed data.
+ * @param head: hash table, 2^LZ_HASH_BITS entries.
+ * @return size of the compressed data or zero if it would exceed maxLen.
+ */
+static size_t lzCompress(const uint8_t *src, uint8_t *dst, size_t maxLen,
+                         uint16_t *head)
+{
+    size_t  in      = 0;
+    size_t  out     = 0;
+    size_t  flagPos = 0;
+    uint8_t bit     = 8;
+
+    memset(head, 0x00, sizeof(uint16_t) << LZ_HASH_BITS);
+
+    while(in < FLASH_BACKUP_SECTOR)
+    {
+        if(bit == 8)
+        {
+            if(out >= maxLen)
+                return 0;
+
+            flagPos      = out++;
+            dst[flagPos] = 0;
+            bit          = 0;
+        }
+
+        size_t matchLen = 0;
+        size_t matchOff = 0;
+
+        if((in + LZ_MIN_MATCH) <= FLASH_BACKUP_SECTOR)
+        {
+            uint32_t hash = lzHash(&src[in]);
+            uint32_t cand = head[hash];
+            head[hash]    = in + 1;
+
+            if(cand != 0)
+            {
+                cand -= 1;
+
+                size_t maxMatch = FLASH_BACKUP_SECTOR - in;
+                if(maxMatch > LZ_MAX_MATCH)
+                    maxMatch = LZ_MAX_MATCH;
+
+                size_t len = 0;
+                while((len < maxMatch) && (src[cand + len] == src[in + len]))
+                    len++;
+
+                if(len >= LZ_MIN_MATCH)
+                {
+                    matchLen = len;
+                    matchOff = in - cand;
+                }
+            }
+        }
+
+        if(matchLen > 0)
+        {
+            if((out + 2) > maxLen)
+                return 0;
+
+            uint16_t token = (matchOff - 1) | ((matchLen - LZ_MIN_MATCH) << 12);
+            dst[out++]     = token & 0xFF;
+            dst[out++]     = token >> 8;
+            dst[flagPos]  |= (1 << bit);
+
+            for(size_t i = in + 1; (i < in + matchLen) &&
+                ((i + LZ_MIN_MATCH) <= FLASH_BACKUP_SECTOR); i++)
+                head[lzHash(&src[i])] = i + 1;
+
+            in += matchLen;
+        }
+        else
+        {
+            if(out >= maxLen)
+                return 0;
+
+            dst[out++] = src[in++];
+        }
+
+        bit++;
+    }
+
+    return out;
+}
+
+/**
+ * \internal
+ * Decompress a sector.
+ *
+ * @return true if the compressed data is well formed and decodes exactly to
+ * one sector.
+ */
+static bool lzDecompress(const uint8_t *src, size_t len, uint8_t *dst)
+{
+    size_t in  = 0;
+    size_t out = 0;
+
+    while(out < FLASH_BACKUP_SECTOR)
+    {
+        if(in >= len)
+            return false;
+
+        uint8_t flags = src[in++];
+
+        for(uint8_t bit = 0; (bit < 8) && (out < FLASH_BACKUP_SECTOR); bit++)
+        {
+            if((flags & (1 << bit)) != 0)
+            {
+                if((in + 2) > len)
+                    return false;
+
+                uint16_t token = src[in] | (src[in + 1] << 8);
+                size_t   off   = (token & 0x0FFF) + 1;
+                size_t   num   = (token >> 12) + LZ_MIN_MATCH;
+                in += 2;
+
+                if((off > out) || ((out + num) > FLASH_BACKUP_SECTOR))
+                    return false;
+
+                // Byte by byte, source and destination may overlap
+                for(size_t i = 0; i < num; i++, out++)
+                    dst[out] = dst[out - off];
+            }
+            else
+            {
+                if(in >= len)
+                    return false;
+
+                dst[out++] = src[in++];
+            }
+        }
+    }
+
+    return (in == len);
+}
+
+static bool isErased(const uint8_t *data)
+{
+    for(size_t i = 0; i < FLASH_BACKUP_SECTOR; i++)
+    {
+        if(data[i] != 0xFF)
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * \internal
+ * Build the record of the next sector to be saved.
+ */
+static int buildSector(struct flashBackup *ctx)
+{
+    struct sectorHdr hdr;
+    uint8_t *payload = &ctx->record[sizeof(struct sectorHdr)];
+    uint32_t addr    = ctx->sector * FLASH_BACKUP_SECTOR;
+
+    int ret = nvm_devRead(ctx->dev, addr, ctx->data, FLASH_BACKUP_SECTOR);
+    if(ret < 0)
+        return ret;
+
+    hdr.sector = ctx->sector;
+    hdr.crc    = crc_32(ctx->data, FLASH_BACKUP_SECTOR);
+
+    if(isErased(ctx->data))
+    {
+        hdr.type = SECTOR_ERASED;
+        hdr.size = 0;
+        ctx->stats.erased += 1;
+    }
+    else
+    {
+        size_t size = lzCompress(ctx->data, payload, FLASH_BACKUP_SECTOR - 1,
+                                 (uint16_t *) ctx->work);
+        if(size > 0)
+        {
+            hdr.type = SECTOR_LZ;
+            hdr.size = size;
+            ctx->stats.compressed += 1;
+        }
+        else
+        {
+            hdr.type = SECTOR_RAW;
+            hdr.size = FLASH_BACKUP_SECTOR;
+            memcpy(payload, ctx->data, FLASH_BACKUP_SECTOR);
+        }
+    }
+
+    memcpy(ctx->record, &hdr, sizeof(struct sectorHdr));
+    ctx->len            = sizeof(struct sectorHdr) + hdr.size;
+    ctx->sector        += 1;
+    ctx->stats.sectors += 1;
+
+    return 0;
+}
+
+/**
+ * \internal
+ * Build the next record of the backup stream.
+ *
+ * @return zero on success, one at the end of the stream, a negative error code
+ * on failure.
+ */
+static int nextRecord(struct flashBackup *ctx)
+{
+    ctx->pos = 0;
+
+    switch(ctx->state)
+    {
+        case EXPORT_HEADER:
+        {
+            struct streamHdr hdr =
+            {
+                .magic      = BACKUP_MAGIC,
+                .version    = BACKUP_VERSION,
+                .reserved   = 0,
+                .sectorSize = FLASH_BACKUP_SECTOR,
+                .numSectors = ctx->numSectors
+            };
+
+            memcpy(ctx->record, &hdr, sizeof(struct streamHdr));
+            ctx->len   = sizeof(struct streamHdr);
+            ctx->state = EXPORT_SECTORS;
+        }
+            break;
+
+        case EXPORT_SECTORS:
+            if(ctx->sector < ctx->numSectors)
+                return buildSector(ctx);
+
+            memset(ctx->record, 0x00, sizeof(struct sectorHdr));
+            memset(ctx->record, 0xFF, sizeof(uint32_t));
+            ctx->len   = sizeof(struct sectorHdr);
+            ctx->state = EXPORT_END;
+            break;
+
+        default:
+            ctx->len = 0;
+            return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * \internal
+ * Decode a sector record and write the sector, if its content changed.
+ */
+static int restoreSector(struct flashBackup *ctx, const struct sectorHdr *hdr)
+{
+    const uint8_t *payload = &ctx->record[sizeof(struct sectorHdr)];
+    uint32_t addr = hdr->sector * FLASH_BACKUP_SECTOR;
+    bool needErase = (ctx->dev->info->device_info & NVM_ERASE) != 0;
+
+    switch(hdr->type)
+    {
+        case SECTOR_ERASED:
+            memset(ctx->data, 0xFF, FLASH_BACKUP_SECTOR);
+            ctx->stats.erased += 1;
+            break;
+
+        case SECTOR_RAW:
+            memcpy(ctx->data, payload, FLASH_BACKUP_SECTOR);
+            break;
+
+        case SECTOR_LZ:
+            if(lzDecompress(payload, hdr->size, ctx->data) == false)
+                return -EIO;
+
+            ctx->stats.compressed += 1;
+            break;
+    }
+
+    if(crc_32(ctx->data, FLASH_BACKUP_SECTOR) != hdr->crc)
+        return -EIO;
+
+    ctx->stats.sectors += 1;
+
+    // Leave unchanged sectors untouched
+    int ret = nvm_devRead(ctx->dev, addr, ctx->work, FLASH_BACKUP_SECTOR);
+    if(ret < 0)
+        return ret;
+
+    if(memcmp(ctx->work, ctx->data, FLASH_BACKUP_SECTOR) == 0)
+    {
+        ctx->stats.skipped += 1;
+        return 0;
+    }
+
+    if(needErase)
+    {
+        ret = nvm_devErase(ctx->dev, addr, FLASH_BACKUP_SECTOR);
+        if(ret < 0)
+            return ret;
+    }
+
+    if((needErase == false) || (hdr->type != SECTOR_ERASED))
+    {
+        ret = nvm_devWrite(ctx->dev, addr, ctx->data, FLASH_BACKUP_SECTOR);
+        if(ret < 0)
+            return ret;
+    }
+
+    ctx->stats.written += 1;
+
+    return 0;
+}
+
+/**
+ * \internal
+ * Process a complete record of the backup stream.
+ */
+static int processRecord(struct flashBackup *ctx)
+{
+    switch(ctx->state)
+    {
+        case IMPORT_HEADER:
+        {
+            struct streamHdr hdr;
+            memcpy(&hdr, ctx->record, sizeof(struct streamHdr));
+
+            if((hdr.magic != BACKUP_MAGIC) || (hdr.version != BACKUP_VERSION) ||
+               (hdr.sectorSize != FLASH_BACKUP_SECTOR))
+                return -EINVAL;
+
+            if(((uint64_t) hdr.numSectors * FLASH_BACKUP_SECTOR) > ctx->dev->size)
+                return -EINVAL;
+
+            ctx->numSectors = hdr.numSectors;
+            ctx->state      = IMPORT_RECORD;
+            ctx->len        = sizeof(struct sectorHdr);
+            ctx->pos        = 0;
+        }
+            break;
+
+        case IMPORT_RECORD:
+        case IMPORT_PAYLOAD:
+        {
+            struct sectorHdr hdr;
+            memcpy(&hdr, ctx->record, sizeof(struct sectorHdr));
+
+            if(hdr.sector == END_SECTOR)
+            {
+                ctx->state = IMPORT_DONE;
+                break;
+            }
+
+            if(ctx->state == IMPORT_RECORD)
+            {
+                size_t size = 0;
+                switch(hdr.type)
+                {
+                    case SECTOR_ERASED: size = 0;                   break;
+                    case SECTOR_RAW:    size = FLASH_BACKUP_SECTOR; break;
+                    case SECTOR_LZ:     size = hdr.size;            break;
+                    default:            return -EINVAL;
+                }
+
+                if((hdr.sector >= ctx->numSectors) || (hdr.size != size) ||
+                   (size > FLASH_BACKUP_SECTOR))
+                    return -EINVAL;
+
+                // Wait for the payload, if any
+                if(size > 0)
+                {
+                    ctx->len   = sizeof(struct sectorHdr) + size;
+                    ctx->state = IMPORT_PAYLOAD;
+                    break;
+                }
+            }
+
+            int ret = restoreSector(ctx, &hdr);
+            if(ret < 0)
+                return ret;
+
+            ctx->state = IMPORT_RECORD;
+            ctx->len   = sizeof(struct sectorHdr);
+            ctx->pos   = 0;
+        }
+            break;
+
+        default:
+            break;
+    }
+
+    return 0;
+}
+
+
+int flashBackup_startExport(struct flashBackup *ctx,
+                            const struct nvmDevice *dev, uint32_t first)
+{
+    if((dev->size % FLASH_BACKUP_SECTOR) != 0)
+        return -EINVAL;
+
+    memset(&ctx->stats, 0x00, sizeof(struct backupStats));
+    ctx->dev        = dev;
+    ctx->numSectors = dev->size / FLASH_BACKUP_SECTOR;
+    ctx->sector     = first;
+    ctx->state      = EXPORT_HEADER;
+    ctx->pos        = 0;
+    ctx->len        = 0;
+
+    return 0;
+}
+
+ssize_t flashBackup_read(struct flashBackup *ctx, void *buf, size_t len)
+{
+    uint8_t *dst   = (uint8_t *) buf;
+    size_t   total = 0;
+
+    while(total < len)
+    {
+        if(ctx->pos == ctx->len)
+        {
+            int ret = nextRecord(ctx);
+            if(ret < 0)
+                return ret;
+
+            if(ret > 0)
+                break;
+        }
+
+        size_t size = ctx->len - ctx->pos;
+        if(size > (len - total))
+            size = len - total;
+
+        memcpy(&dst[total], &ctx->record[ctx->pos], size);
+        ctx->pos += size;
+        total    += size;
+    }
+
+    ctx->stats.streamSize += total;
+
+    return total;
+}
+
+int flashBackup_startImport(struct flashBackup *ctx,
+                            const struct nvmDevice *dev)
+{
+    uint32_t eraseSize = dev->info->erase_size;
+
+    if(((dev->info->device_info & NVM_ERASE) != 0) &&
+       ((eraseSize == 0) || ((FLASH_BACKUP_SECTOR % eraseSize) != 0)))
+        return -EINVAL;
+
+    memset(&ctx->stats, 0x00, sizeof(struct backupStats));
+    ctx->dev        = dev;
+    ctx->numSectors = 0;
+    ctx->sector     = 0;
+    ctx->state      = IMPORT_HEADER;
+    ctx->pos        = 0;
+    ctx->len        = sizeof(struct streamHdr);
+
+    return 0;
+}
+
+int flashBackup_write(struct flashBackup *ctx, const void *data, size_t len)
+{
+    const uint8_t *src = (const uint8_t *) data;
+
+    while((len > 0) && (ctx->state != IMPORT_DONE))
+    {
+        size_t size = ctx->len - ctx->pos;
+        if(size > len)
+            size = len;
+
+        memcpy(&ctx->record[ctx->pos], src, size);
+        ctx->pos              += size;
+        ctx->stats.streamSize += size;
+        src                   += size;
+        len                   -= size;
+
+        if(ctx->pos < ctx->len)
+            break;
+
+        int ret = processRecord(ctx);
+        if(ret < 0)
+            return ret;
+    }
+
+    return (ctx->state == IMPORT_DONE) ? 1 : 0;
+}
@@ -23,6 +23,8 @@
 #include <minmea.h>
 #include <stdio.h>
 #include <state.h>
+#include <event.h>
+#include <ui.h>
 #include <string.h>
 #include <stdbool.h>
 
@@ -187,9 +189,13 @@ void gps_task()
 
     // Update GPS data inside radio state
     pthread_mutex_lock(&state_mutex);
+    bool changed   = memcmp(&state.gps_data, &gps_data, sizeof(gps_t)) != 0;
     state.gps_data = gps_data;
     pthread_mutex_unlock(&state_mutex);
 
+    if(changed)
+        ui_pushEvent(EVENT_STATUS, STATE_CHG_GPS);
+
     // Synchronize RTC with GPS UTC clock, only when fix is done
     #ifdef CONFIG_RTC
     if(state.gps_set_time)
@@ -94,10 +94,22 @@ static const GFXfont fonts[] = { TomThumb,            // 5pt
  *
  * For more details about endianness and bitfield structs see the following web
  * page: http://mjfrazer.org/mjfrazer/bitfields/
+ *
+ * When CONFIG_PIX_FMT_RGB565_BE is defined, pixels are stored in big endian
+ * order, that is the byte order expected by the display controller: this
+ * allows the display driver to send the framebuffer content as it is.
  */
 
 #define PIXEL_T rgb565_t
 #define FB_SIZE (CONFIG_SCREEN_HEIGHT * CONFIG_SCREEN_WIDTH)
+#define FB_PIX_PER_ELEM 1
+#define HASH_UNIT_ROWS  1
+
+#ifdef CONFIG_PIX_FMT_RGB565_BE
+#define PIX_ORDER(x) __builtin_bswap16(x)
+#else
+#define PIX_ORDER(x) (x)
+#endif
 
 typedef struct
 {
@@ -123,10 +135,26 @@ static rgb565_t _true2highColor(color_t true_color)
  * This specialization is meant for black and white pixel format.
  * It is suitable for monochromatic displays with 1 bit per pixel,
  * it will have RGB and grayscale counterparts
+ *
+ * By default pixels are stored by rows, eight horizontally adjacent pixels per
+ * byte. When CONFIG_PIX_FMT_BW_PAGED is defined, pixels are instead stored in
+ * the page-major order used by most monochrome display controllers: each byte
+ * holds eight vertically adjacent pixels, with the topmost one in the least
+ * significant bit, and the bytes of a page are stored column after column.
  */
 
 #define PIXEL_T uint8_t
 #define FB_SIZE (((CONFIG_SCREEN_HEIGHT * CONFIG_SCREEN_WIDTH) / 8 ) + 1)
+#define FB_PIX_PER_ELEM 8
+
+#ifdef CONFIG_PIX_FMT_BW_PAGED
+#if (CONFIG_SCREEN_HEIGHT % 8) != 0
+#error Paged framebuffer requires a screen height multiple of eight
+#endif
+#define HASH_UNIT_ROWS  8
+#else
+#define HASH_UNIT_ROWS  1
+#endif
 
 typedef enum
 {
@@ -149,60 +177,471 @@ static bw_t _color2bw(color_t true_color)
 #error Please define a pixel format type into hwconfig.h or meson.build
 #endif
 
-static PIXEL_T __attribute__((section(".bss.fb"))) framebuffer[FB_SIZE];
+#ifdef CONFIG_GFX_DOUBLE_BUFFER
+/*
+ * Double buffering: drawing functions work on the back buffer while the front
+ * one is being sent to the display, the two are swapped at each render. Each
+ * buffer is padded to a multiple of four bytes, to keep both of them aligned.
+ */
+#define FB_STRIDE (((FB_SIZE * sizeof(PIXEL_T) + 3) & ~3) / sizeof(PIXEL_T))
+
+static PIXEL_T __attribute__((section(".bss.fb"), aligned(4))) fbMem[2][FB_STRIDE];
+static PIXEL_T *framebuffer = fbMem[0];
+#else
+static PIXEL_T __attribute__((section(".bss.fb"), aligned(4))) framebuffer[FB_SIZE];
+#endif
 static char text[32];
 
+/*
+ * Dirty rows tracking: each drawing primitive marks the framebuffer rows it
+ * touches in a bitmap. When rendering, a hash of each dirty row is compared
+ * with the one of the content last sent to the display, so that rows being
+ * redrawn with the same content are not sent again. With the paged layout the
+ * rows of a page are not contiguous in memory, thus the hash covers the whole
+ * page.
+ */
+#define ROW_BYTES   ((CONFIG_SCREEN_WIDTH * sizeof(PIXEL_T)) / FB_PIX_PER_ELEM)
+#define UNIT_BYTES  (ROW_BYTES * HASH_UNIT_ROWS)
+#define HASH_UNITS  (CONFIG_SCREEN_HEIGHT / HASH_UNIT_ROWS)
+#define DIRTY_WORDS ((CONFIG_SCREEN_HEIGHT + 31) / 32)
+
+static uint32_t dirtyRows[DIRTY_WORDS];
+static uint32_t rowHash[HASH_UNITS];
+static bool     rowHashValid = false;
+
+static inline void markRowDirty(int16_t row)
+{
+    dirtyRows[row >> 5] |= 1u << (row & 0x1F);
+}
+
+static inline void markRowsDirty(int16_t startRow, int16_t endRow)
+{
+    if(startRow < 0) startRow = 0;
+    if(endRow >= CONFIG_SCREEN_HEIGHT) endRow = CONFIG_SCREEN_HEIGHT - 1;
+
+    for(int16_t row = startRow; row <= endRow; row++)
+        markRowDirty(row);
+}
+
+static inline bool isRowDirty(int16_t row)
+{
+    return (dirtyRows[row >> 5] & (1u << (row & 0x1F))) != 0;
+}
+
+static inline bool isUnitDirty(int16_t unit)
+{
+    for(int16_t row = unit * HASH_UNIT_ROWS; row < (unit + 1) * HASH_UNIT_ROWS; row++)
+    {
+        if(isRowDirty(row))
+            return true;
+    }
+
+    return false;
+}
+
+/**
+ * \internal
+ * Compute the FNV-1a hash of the framebuffer section holding a given hash unit,
+ * processing it in 32-bit words. Multiplication only carries bits upwards, so
+ * the high half is folded back at each step: otherwise changes to the same top
+ * bit of two different words would cancel out.
+ */
+static uint32_t hashUnit(int16_t unit)
+{
+    const uint8_t  *ptr  = ((const uint8_t *) framebuffer) + (unit * UNIT_BYTES);
+    const uint32_t *word = (const uint32_t *) ptr;
+    uint32_t hash = 2166136261u;
+
+    for(size_t i = 0; i < (UNIT_BYTES / sizeof(uint32_t)); i++)
+    {
+        hash ^= word[i];
+        hash *= 16777619u;
+        hash ^= hash >> 16;
+    }
+
+    return hash;
+}
+
+
+#ifdef CONFIG_PIX_FMT_RGB565
+typedef uint16_t __attribute__((may_alias)) pix16_t;
+typedef uint32_t __attribute__((may_alias)) pix32_t;
+
+static inline uint16_t _pixelValue(color_t color)
+{
+    rgb565_t pixel = _true2highColor(color);
+    uint16_t value;
+    memcpy(&value, &pixel, sizeof(value));
+
+    return PIX_ORDER(value);
+}
+#endif
+
+/**
+ * \internal
+ * Fill an horizontal span of pixels, ends included. Coordinates are clipped
+ * once and the color is converted once for the whole span.
+ *
+ * @param x0: start column.
+ * @param x1: end column.
+ * @param y: row.
+ * @param color: fill color.
+ */
+static inline void _fillHSpan(int16_t x0, int16_t x1, int16_t y, color_t color)
+{
+    if((y < 0) || (y >= CONFIG_SCREEN_HEIGHT)) return;
+    if(x0 < 0) x0 = 0;
+    if(x1 >= CONFIG_SCREEN_WIDTH) x1 = CONFIG_SCREEN_WIDTH - 1;
+    if(x1 < x0) return;
+
+#ifdef CONFIG_PIX_FMT_RGB565
+    // Blending needs the old value of each pixel
+    if(color.alpha < 255)
+    {
+        for(int16_t x = x0; x <= x1; x++)
+        {
+            point_t pos = {x, y};
+            gfx_setPixel(pos, color);
+        }
+
+        return;
+    }
+
+    markRowDirty(y);
+
+    pix16_t  *ptr   = ((pix16_t *) framebuffer) + x0 + y * CONFIG_SCREEN_WIDTH;
+    uint16_t  value = _pixelValue(color);
+    size_t    len   = x1 - x0 + 1;
+
+    // Short spans, typical of lines and circles, are filled directly
+    if(len < 4)
+    {
+        while(len-- > 0)
+            *ptr++ = value;
+
+        return;
+    }
+
+    // Align to a 32-bit boundary, then fill two pixels at a time
+    if((((uintptr_t) ptr) & 0x02) != 0)
+    {
+        *ptr++ = value;
+        len--;
+    }
+
+    pix32_t  *wptr  = (pix32_t *) ptr;
+    uint32_t  value2 = ((uint32_t) value << 16) | value;
+    for(; len >= 2; len -= 2)
+        *wptr++ = value2;
+
+    if(len > 0)
+        *((pix16_t *) wptr) = value;
+
+#elif defined CONFIG_PIX_FMT_BW
+    // Ignore more than half transparent pixels
+    if(color.alpha < 128) return;
+
+    markRowDirty(y);
+
+    #ifdef CONFIG_PIX_FMT_BW_PAGED
+    uint8_t *ptr = &framebuffer[x0 + (y / 8) * CONFIG_SCREEN_WIDTH];
+    uint8_t  bit = 1 << (y % 8);
+
+    if(_color2bw(color) == BLACK)
+    {
+        for(int16_t x = x0; x <= x1; x++)
+            *ptr++ |= bit;
+    }
+    else
+    {
+        for(int16_t x = x0; x <= x1; x++)
+            *ptr++ &= ~bit;
+    }
+    #else
+    uint32_t first = x0 + y * CONFIG_SCREEN_WIDTH;
+    uint32_t last  = x1 + y * CONFIG_SCREEN_WIDTH;
+    uint32_t cell0 = first / 8;
+    uint32_t cell1 = last / 8;
+    uint8_t  value = (_color2bw(color) == BLACK) ? 0xFF : 0x00;
+    uint8_t  mask0 = 0xFF << (first % 8);
+    uint8_t  mask1 = 0xFF >> (7 - (last % 8));
+
+    if(cell0 == cell1)
+    {
+        uint8_t mask = mask0 & mask1;
+        framebuffer[cell0] = (framebuffer[cell0] & ~mask) | (value & mask);
+        return;
+    }
+
+    framebuffer[cell0] = (framebuffer[cell0] & ~mask0) | (value & mask0);
+    memset(&framebuffer[cell0 + 1], value, cell1 - cell0 - 1);
+    framebuffer[cell1] = (framebuffer[cell1] & ~mask1) | (value & mask1);
+    #endif
+#endif
+}
+
+/**
+ * \internal
+ * Fill a vertical span of pixels, ends included. Coordinates are clipped
+ * once and the color is converted once for the whole span.
+ *
+ * @param x: column.
+ * @param y0: start row.
+ * @param y1: end row.
+ * @param color: fill color.
+ */
+static inline void _fillVSpan(int16_t x, int16_t y0, int16_t y1, color_t color)
+{
+    if((x < 0) || (x >= CONFIG_SCREEN_WIDTH)) return;
+    if(y0 < 0) y0 = 0;
+    if(y1 >= CONFIG_SCREEN_HEIGHT) y1 = CONFIG_SCREEN_HEIGHT - 1;
+    if(y1 < y0) return;
+
+#ifdef CONFIG_PIX_FMT_RGB565
+    if(color.alpha < 255)
+    {
+        for(int16_t y = y0; y <= y1; y++)
+        {
+            point_t pos = {x, y};
+            gfx_setPixel(pos, color);
+        }
+
+        return;
+    }
+
+    markRowsDirty(y0, y1);
+
+    pix16_t  *ptr   = ((pix16_t *) framebuffer) + x + y0 * CONFIG_SCREEN_WIDTH;
+    uint16_t  value = _pixelValue(color);
+    for(int16_t y = y0; y <= y1; y++)
+    {
+        *ptr = value;
+        ptr += CONFIG_SCREEN_WIDTH;
+    }
+
+#elif defined CONFIG_PIX_FMT_BW
+    if(color.alpha < 128) return;
+
+    markRowsDirty(y0, y1);
+
+    #ifdef CONFIG_PIX_FMT_BW_PAGED
+    // Vertical spans are contiguous bits in the paged layout
+    uint8_t *ptr   = &framebuffer[x + (y0 / 8) * CONFIG_SCREEN_WIDTH];
+    uint8_t *last  = &framebuffer[x + (y1 / 8) * CONFIG_SCREEN_WIDTH];
+    uint8_t  value = (_color2bw(color) == BLACK) ? 0xFF : 0x00;
+    uint8_t  mask0 = 0xFF << (y0 % 8);
+    uint8_t  mask1 = 0xFF >> (7 - (y1 % 8));
+
+    if(ptr == last)
+    {
+        uint8_t mask = mask0 & mask1;
+        *ptr = (*ptr & ~mask) | (value & mask);
+        return;
+    }
+
+    *ptr = (*ptr & ~mask0) | (value & mask0);
+    for(ptr += CONFIG_SCREEN_WIDTH; ptr < last; ptr += CONFIG_SCREEN_WIDTH)
+        *ptr = value;
+    *last = (*last & ~mask1) | (value & mask1);
+    #else
+    uint32_t idx   = x + y0 * CONFIG_SCREEN_WIDTH;
+    uint8_t  value = _color2bw(color);
+    for(int16_t y = y0; y <= y1; y++)
+    {
+        uint8_t bit = idx % 8;
+        framebuffer[idx / 8] = (framebuffer[idx / 8] & ~(1 << bit))
+                             | (value << bit);
+        idx += CONFIG_SCREEN_WIDTH;
+    }
+    #endif
+#endif
+}
+
+
+/**
+ * \internal
+ * Send a section of the framebuffer to the display.
+ *
+ * With double buffering the transfer runs in background and the buffers are
+ * swapped. Before returning, the rows drawn since the previous swap are copied
+ * into the new back buffer: this keeps the two buffers in sync, so that drawing
+ * can continue from the content of the frame being sent.
+ *
+ * @param startRow: first row to be sent.
+ * @param endRow: row after the last one to be sent.
+ */
+static void _sendRows(uint8_t startRow, uint8_t endRow)
+{
+#ifdef CONFIG_GFX_DOUBLE_BUFFER
+    PIXEL_T *front = framebuffer;
+    PIXEL_T *back  = (front == fbMem[0]) ? fbMem[1] : fbMem[0];
+
+    // Waits for the completion of the previous transfer, reading from the
+    // back buffer, before starting the new one.
+    display_renderRowsAsync(startRow, endRow, front);
+
+    int16_t lastUnit = -1;
+    for(int16_t row = 0; row < CONFIG_SCREEN_HEIGHT; row++)
+    {
+        int16_t unit = row / HASH_UNIT_ROWS;
+        if((unit == lastUnit) || (isRowDirty(row) == false))
+            continue;
+
+        size_t offset = unit * UNIT_BYTES;
+        memcpy(((uint8_t *) back) + offset, ((uint8_t *) front) + offset,
+               UNIT_BYTES);
+        lastUnit = unit;
+    }
+
+    framebuffer = back;
+#else
+    if((startRow == 0) && (endRow == CONFIG_SCREEN_HEIGHT))
+        display_render(framebuffer);
+    else
+        display_renderRows(startRow, endRow, framebuffer);
+#endif
+}
 
 void gfx_init()
 {
     display_init();
 
+    #ifdef CONFIG_GFX_DOUBLE_BUFFER
+    memset(fbMem, 0x00, sizeof(fbMem));
+    #endif
+
     // Clear text buffer
     memset(text, 0x00, 32);
 }
 
 void gfx_terminate()
 {
+    #ifdef CONFIG_GFX_DOUBLE_BUFFER
+    display_waitRender();
+    #endif
+
     display_terminate();
 }
 
 void gfx_renderRows(uint8_t startRow, uint8_t endRow)
 {
-    display_renderRows(startRow, endRow, framebuffer);
+    _sendRows(startRow, endRow);
+
+    // Rows outside the rendered range stay dirty, they are still to be sent
+    for(uint8_t row = startRow; (row < endRow) && (row < CONFIG_SCREEN_HEIGHT); row++)
+        dirtyRows[row >> 5] &= ~(1u << (row & 0x1F));
+
+    rowHashValid = false;
 }
 
 void gfx_render()
 {
-    display_render(framebuffer);
+    _sendRows(0, CONFIG_SCREEN_HEIGHT);
+
+    // Row hashes are not updated by a full render, compute them again at the
+    // next partial one.
+    memset(dirtyRows, 0x00, sizeof(dirtyRows));
+    rowHashValid = false;
+}
+
+bool gfx_renderDirty()
+{
+    bool    changed     = false;
+    bool    unitChanged = false;
+    int16_t lastUnit    = -1;
+    int16_t runStart    = -1;
+    int16_t runEnd      = -1;
+
+    for(int16_t row = 0; row <= CONFIG_SCREEN_HEIGHT; row++)
+    {
+        bool rowChanged = false;
+
+        if(row < CONFIG_SCREEN_HEIGHT)
+        {
+            // Rows sharing the same hash unit are checked only once. After a
+            // full render the hashes of the clean units are stale and have to
+            // be refreshed as well, as their content is now on the display.
+            int16_t unit = row / HASH_UNIT_ROWS;
+            if(unit != lastUnit)
+            {
+                bool unitDirty = isUnitDirty(unit);
+                unitChanged    = false;
+                lastUnit       = unit;
+
+                if(unitDirty || (rowHashValid == false))
+                {
+                    uint32_t hash = hashUnit(unit);
+                    unitChanged   = unitDirty && ((rowHashValid == false) ||
+                                                  (hash != rowHash[unit]));
+                    rowHash[unit] = hash;
+                }
+            }
+
+            rowChanged = unitChanged && isRowDirty(row);
+        }
+
+        if(rowChanged)
+        {
+            changed = true;
+            if(runStart < 0)
+                runStart = row;
+
+            runEnd = row + 1;
+            continue;
+        }
+
+        #if defined(CONFIG_PIX_FMT_RGB565) && !defined(CONFIG_GFX_DOUBLE_BUFFER)
+        // End of a run of changed rows, send them to the display
+        if(runStart >= 0)
+        {
+            display_renderRows(runStart, row, framebuffer);
+            runStart = -1;
+        }
+        #endif
+    }
+
+    #ifdef CONFIG_PIX_FMT_BW
+    // Partial rendering on monochrome displays works by pages, whose size
+    // depends on the controller: send the whole framebuffer if any row changed.
+    runStart = 0;
+    runEnd   = CONFIG_SCREEN_HEIGHT;
+    #endif
+
+    #if defined(CONFIG_PIX_FMT_BW) || defined(CONFIG_GFX_DOUBLE_BUFFER)
+    // Only one transfer is sent, with double buffering it runs in background
+    // and covers all the rows between the first and the last changed one.
+    if(changed)
+        _sendRows(runStart, runEnd);
+    #else
+    (void) runEnd;
+    #endif
+
+    memset(dirtyRows, 0x00, sizeof(dirtyRows));
+    rowHashValid = true;
+
+    return changed;
 }
 
 void gfx_clearRows(uint8_t startRow, uint8_t endRow)
 {
-    if(endRow < startRow)
-        return;
+    static const color_t black = {0, 0, 0, 255};
 
-    uint16_t start = startRow * CONFIG_SCREEN_WIDTH * sizeof(PIXEL_T);
-    uint16_t height = endRow - startRow * CONFIG_SCREEN_WIDTH * sizeof(PIXEL_T);
     // Set the specified rows to 0x00 = make the screen black
-    memset(framebuffer + start, 0x00, height);
+    for(int16_t y = startRow; y <= endRow; y++)
+        _fillHSpan(0, CONFIG_SCREEN_WIDTH - 1, y, black);
 }
 
 void gfx_clearScreen()
 {
     // Set the whole framebuffer to 0x00 = make the screen black
     memset(framebuffer, 0x00, FB_SIZE * sizeof(PIXEL_T));
+    memset(dirtyRows, 0xFF, sizeof(dirtyRows));
 }
 
 void gfx_fillScreen(color_t color)
 {
     for(int16_t y = 0; y < CONFIG_SCREEN_HEIGHT; y++)
-    {
-        for(int16_t x = 0; x < CONFIG_SCREEN_WIDTH; x++)
-        {
-            point_t pos = {x, y};
-            gfx_setPixel(pos, color);
-        }
-    }
+        _fillHSpan(0, CONFIG_SCREEN_WIDTH - 1, y, color);
 }
 
 inline void gfx_setPixel(point_t pos, color_t color)
@@ -211,29 +650,40 @@ inline void gfx_setPixel(point_t pos, color_t color)
         pos.x < 0 || pos.y < 0)
         return; // off the screen
 
+    markRowDirty(pos.y);
+
 #ifdef CONFIG_PIX_FMT_RGB565
     // Blend old pixel value and new one
     if (color.alpha < 255)
     {
         uint8_t alpha = color.alpha;
+        pix16_t *ptr = ((pix16_t *) framebuffer) + pos.x + pos.y*CONFIG_SCREEN_WIDTH;
+        uint16_t value = PIX_ORDER(*ptr);
         rgb565_t new_pixel = _true2highColor(color);
-        rgb565_t old_pixel = framebuffer[pos.x + pos.y*CONFIG_SCREEN_WIDTH];
+        rgb565_t old_pixel;
         rgb565_t pixel;
+        memcpy(&old_pixel, &value, sizeof(value));
         pixel.r = ((255-alpha)*old_pixel.r+alpha*new_pixel.r)/255;
         pixel.g = ((255-alpha)*old_pixel.g+alpha*new_pixel.g)/255;
         pixel.b = ((255-alpha)*old_pixel.b+alpha*new_pixel.b)/255;
-        framebuffer[pos.x + pos.y*CONFIG_SCREEN_WIDTH] = pixel;
+        memcpy(&value, &pixel, sizeof(value));
+        *ptr = PIX_ORDER(value);
     }
     else
     {
-        framebuffer[pos.x + pos.y*CONFIG_SCREEN_WIDTH] = _true2highColor(color);
+        ((pix16_t *) framebuffer)[pos.x + pos.y*CONFIG_SCREEN_WIDTH] = _pixelValue(color);
     }
 #elif defined CONFIG_PIX_FMT_BW
     // Ignore more than half transparent pixels
     if (color.alpha >= 128)
     {
+        #ifdef CONFIG_PIX_FMT_BW_PAGED
+        uint16_t cell = pos.x + (pos.y / 8)*CONFIG_SCREEN_WIDTH;
+        uint16_t elem = pos.y % 8;
+        #else
         uint16_t cell = (pos.x + pos.y*CONFIG_SCREEN_WIDTH) / 8;
         uint16_t elem = (pos.x + pos.y*CONFIG_SCREEN_WIDTH) % 8;
+        #endif
         framebuffer[cell] &= ~(1 << elem);
         framebuffer[cell] |= (_color2bw(color) << elem);
     }
@@ -242,6 +692,27 @@ inline void gfx_setPixel(point_t pos, color_t color)
 
 void gfx_drawLine(point_t start, point_t end, color_t color)
 {
+    // Fast path for horizontal and vertical lines
+    if(start.y == end.y)
+    {
+        if(start.x <= end.x)
+            _fillHSpan(start.x, end.x, start.y, color);
+        else
+            _fillHSpan(end.x, start.x, start.y, color);
+
+        return;
+    }
+
+    if(start.x == end.x)
+    {
+        if(start.y <= end.y)
+            _fillVSpan(start.x, start.y, end.y, color);
+        else
+            _fillVSpan(start.x, end.y, start.y, color);
+
+        return;
+    }
+
     int16_t steep = abs(end.y - start.y) > abs(end.x - start.x);
 
     if (steep)
@@ -282,15 +753,21 @@ void gfx_drawLine(point_t start, point_t end, color_t color)
     else
         ystep = -1;
 
+    // Draw the line as a sequence of straight runs of pixels
+    int16_t runStart = start.x;
     for (; start.x<=end.x; start.x++)
     {
-        point_t pos = {start.y, start.x};
-        if (steep)
-            gfx_setPixel(pos, color);
-        else
-            gfx_setPixel(start, color);
-
         err -= dy;
+        if ((err < 0) || (start.x == end.x))
+        {
+            if (steep)
+                _fillVSpan(start.y, runStart, start.x, color);
+            else
+                _fillHSpan(runStart, start.x, start.y, color);
+
+            runStart = start.x + 1;
+        }
+
         if (err < 0)
         {
             start.y += ystep;
@@ -305,22 +782,64 @@ void gfx_drawRect(point_t start, uint16_t width, uint16_t height, color_t color,
     if(height == 0) return;
     uint16_t x_max = start.x + width - 1;
     uint16_t y_max = start.y + height - 1;
-    bool perimeter = 0;
     if(x_max > (CONFIG_SCREEN_WIDTH - 1)) x_max = CONFIG_SCREEN_WIDTH - 1;
     if(y_max > (CONFIG_SCREEN_HEIGHT - 1)) y_max = CONFIG_SCREEN_HEIGHT - 1;
-    for(int16_t y = start.y; y <= y_max; y++)
+    if((x_max < start.x) || (y_max < start.y)) return;
+
+    if(fill)
     {
-        for(int16_t x = start.x; x <= x_max; x++)
+        // Single column rectangles are faster to fill as vertical spans
+        if(x_max == start.x)
         {
-            if(y == start.y || y == y_max || x == start.x || x == x_max) perimeter = 1;
-            else perimeter = 0;
-            // If fill is false, draw only rectangle perimeter
-            if(fill || perimeter)
-            {
-                point_t pos = {x, y};
-                gfx_setPixel(pos, color);
-            }
+            _fillVSpan(start.x, start.y, y_max, color);
+            return;
         }
+
+        for(int16_t y = start.y; y <= y_max; y++)
+            _fillHSpan(start.x, x_max, y, color);
+
+        return;
+    }
+
+    // If fill is false, draw only rectangle perimeter
+    _fillHSpan(start.x, x_max, start.y, color);
+    if(y_max > start.y)
+        _fillHSpan(start.x, x_max, y_max, color);
+
+    if(y_max > start.y + 1)
+    {
+        _fillVSpan(start.x, start.y + 1, y_max - 1, color);
+        if(x_max > start.x)
+            _fillVSpan(x_max, start.y + 1, y_max - 1, color);
+    }
+}
+
+/**
+ * \internal
+ * Draw the eight symmetric copies of a run of circle points going from
+ * (x0, y) to (x1, y), relative to the circle center.
+ */
+static void _drawCircleRuns(point_t c, int16_t x0, int16_t x1, int16_t y,
+                            color_t color)
+{
+    // Points on the axes are mirrored on themselves, draw them only once
+    int16_t xm      = (x0 == 0) ? 1 : x0;
+    bool    mirrorY = (y != 0);
+
+    _fillHSpan(c.x + x0, c.x + x1, c.y + y, color);
+    _fillHSpan(c.x - x1, c.x - xm, c.y + y, color);
+    if(mirrorY)
+    {
+        _fillHSpan(c.x + x0, c.x + x1, c.y - y, color);
+        _fillHSpan(c.x - x1, c.x - xm, c.y - y, color);
+    }
+
+    _fillVSpan(c.x + y, c.y + x0, c.y + x1, color);
+    _fillVSpan(c.x + y, c.y - x1, c.y - xm, color);
+    if(mirrorY)
+    {
+        _fillVSpan(c.x - y, c.y + x0, c.y + x1, color);
+        _fillVSpan(c.x - y, c.y - x1, c.y - xm, color);
     }
 }
 
@@ -331,22 +850,18 @@ void gfx_drawCircle(point_t start, uint16_t r, color_t color)
     int16_t ddF_y = -2 * r;
     int16_t x     = 0;
     int16_t y     = r;
+    int16_t runX  = 0;
 
-    point_t pos = start;
-    pos.y += r;
-    gfx_setPixel(pos, color);
-    pos.y -= 2 * r;
-    gfx_setPixel(pos, color);
-    pos.y += r;
-    pos.x += r;
-    gfx_setPixel(pos, color);
-    pos.x -= 2 * r;
-    gfx_setPixel(pos, color);
-
+    /*
+     * Within each octant, consecutive points sharing the same y coordinate
+     * form a straight run: draw it as a span when y is about to change.
+     */
     while (x < y)
     {
         if (f >= 0)
         {
+            _drawCircleRuns(start, runX, x, y, color);
+            runX = x + 1;
             y--;
             ddF_y += 2;
             f += ddF_y;
@@ -355,32 +870,9 @@ void gfx_drawCircle(point_t start, uint16_t r, color_t color)
         x++;
         ddF_x += 2;
         f += ddF_x;
-
-        pos.x = start.x + x;
-        pos.y = start.y + y;
-        gfx_setPixel(pos, color);
-        pos.x = start.x - x;
-        pos.y = start.y + y;
-        gfx_setPixel(pos, color);
-        pos.x = start.x + x;
-        pos.y = start.y - y;
-        gfx_setPixel(pos, color);
-        pos.x = start.x - x;
-        pos.y = start.y - y;
-        gfx_setPixel(pos, color);
-        pos.x = start.x + y;
-        pos.y = start.y + x;
-        gfx_setPixel(pos, color);
-        pos.x = start.x - y;
-        pos.y = start.y + x;
-        gfx_setPixel(pos, color);
-        pos.x = start.x + y;
-        pos.y = start.y - x;
-        gfx_setPixel(pos, color);
-        pos.x = start.x - y;
-        pos.y = start.y - x;
-        gfx_setPixel(pos, color);
     }
+
+    _drawCircleRuns(start, runX, x, y, color);
 }
 
 void gfx_drawHLine(int16_t y, uint16_t height, color_t color)
@@ -395,20 +887,233 @@ void gfx_drawVLine(int16_t x, uint16_t width, color_t color)
     gfx_drawRect(start, width, CONFIG_SCREEN_HEIGHT, color, 1);
 }
 
+/*
+ * Glyph cache: glyph bitmaps are decoded, the first time they are drawn, into
+ * a list of horizontal runs of lit pixels which are then drawn as spans.
+ * Decoded glyphs are kept in a fixed size pool and looked up through a small
+ * direct mapped table: when the pool is exhausted it is flushed as a whole.
+ */
+#define GLYPH_CACHE_SLOTS 64
+
+#ifdef PLATFORM_LINUX
+#define GLYPH_RUN_POOL 4096
+#else
+#define GLYPH_RUN_POOL 1024
+#endif
+
+typedef struct
+{
+    uint8_t x;      ///< Run start column, relative to the glyph origin
+    uint8_t y;      ///< Run row, relative to the glyph origin
+    uint8_t len;    ///< Run length in pixels
+}
+glyphRun_t;
+
+typedef struct
+{
+    uint8_t  font;  ///< Font index plus one, zero for an empty slot
+    uint8_t  chr;   ///< Character
+    uint16_t first; ///< Index of the first run in the pool
+    uint16_t count; ///< Number of runs
+}
+glyphSlot_t;
+
+static glyphRun_t  glyphRuns[GLYPH_RUN_POOL];
+static glyphSlot_t glyphSlots[GLYPH_CACHE_SLOTS];
+static uint16_t    glyphRunsUsed = 0;
+
+/**
+ * \internal
+ * Decode the bitmap of a glyph into a list of horizontal runs.
+ *
+ * @param f: font the glyph belongs to.
+ * @param glyph: glyph to be decoded.
+ * @param runs: destination buffer.
+ * @param maxRuns: capacity of the destination buffer.
+ * @return number of runs decoded or -1 if the buffer is too small.
+ */
+static int _decodeGlyph(const GFXfont *f, const GFXglyph *glyph,
+                        glyphRun_t *runs, size_t maxRuns)
+{
+    const uint8_t *bitmap = &f->bitmap[glyph->bitmapOffset];
+    uint8_t bits = 0, bit = 0;
+    size_t count = 0;
+
+    for(uint8_t yy = 0; yy < glyph->height; yy++)
+    {
+        int16_t runStart = -1;
+
+        for(uint8_t xx = 0; xx < glyph->width; xx++)
+        {
+            if(!(bit++ & 7))
+                bits = *bitmap++;
+
+            if(bits & 0x80)
+            {
+                if(runStart < 0)
+                    runStart = xx;
+            }
+            else if(runStart >= 0)
+            {
+                if(count >= maxRuns)
+                    return -1;
+
+                runs[count].x   = runStart;
+                runs[count].y   = yy;
+                runs[count].len = xx - runStart;
+                count++;
+                runStart = -1;
+            }
+
+            bits <<= 1;
+        }
+
+        if(runStart >= 0)
+        {
+            if(count >= maxRuns)
+                return -1;
+
+            runs[count].x   = runStart;
+            runs[count].y   = yy;
+            runs[count].len = glyph->width - runStart;
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * \internal
+ * Get the decoded runs of a glyph, decoding it if not already in cache.
+ *
+ * @param font: index of the font in the font table.
+ * @param chr: character.
+ * @param glyph: glyph corresponding to the character.
+ * @param count: pointer to the variable where to store the number of runs.
+ * @return pointer to the first run or NULL if the glyph does not fit the cache.
+ */
+static const glyphRun_t *_getGlyphRuns(uint8_t font, uint8_t chr,
+                                       const GFXglyph *glyph, uint16_t *count)
+{
+    glyphSlot_t *slot = &glyphSlots[(chr + font * 37) % GLYPH_CACHE_SLOTS];
+
+    if((slot->font == (font + 1)) && (slot->chr == chr))
+    {
+        *count = slot->count;
+        return &glyphRuns[slot->first];
+    }
+
+    int ret = _decodeGlyph(&fonts[font], glyph, &glyphRuns[glyphRunsUsed],
+                           GLYPH_RUN_POOL - glyphRunsUsed);
+    if(ret < 0)
+    {
+        // Pool exhausted: flush the whole cache and try again
+        memset(glyphSlots, 0x00, sizeof(glyphSlots));
+        glyphRunsUsed = 0;
+        slot->font    = 0;
+
+        ret = _decodeGlyph(&fonts[font], glyph, glyphRuns, GLYPH_RUN_POOL);
+        if(ret < 0)
+            return NULL;
+    }
+
+    slot->font  = font + 1;
+    slot->chr   = chr;
+    slot->first = glyphRunsUsed;
+    slot->count = ret;
+    glyphRunsUsed += ret;
+
+    *count = slot->count;
+    return &glyphRuns[slot->first];
+}
+
+/**
+ * \internal
+ * Draw a glyph with its top left corner at the given position. Clipping is
+ * resolved once per glyph: glyphs completely outside the screen are skipped
+ * and only the ones crossing its borders are clipped run by run. Text is never
+ * drawn on the first row and column of the screen.
+ *
+ * @param font: index of the font in the font table.
+ * @param chr: character.
+ * @param glyph: glyph corresponding to the character.
+ * @param x: column of the top left corner of the glyph.
+ * @param y: row of the top left corner of the glyph.
+ * @param color: text color.
+ */
+static void _drawGlyph(uint8_t font, uint8_t chr, const GFXglyph *glyph,
+                       int16_t x, int16_t y, color_t color)
+{
+    if((glyph->width == 0) || (glyph->height == 0))
+        return;
+
+    if((x >= CONFIG_SCREEN_WIDTH) || (y >= CONFIG_SCREEN_HEIGHT) ||
+       ((x + glyph->width) <= 1)  || ((y + glyph->height) <= 1))
+        return;
+
+    bool clip = (x < 1) || (y < 1) ||
+                ((x + glyph->width)  > CONFIG_SCREEN_WIDTH) ||
+                ((y + glyph->height) > CONFIG_SCREEN_HEIGHT);
+
+    uint16_t count;
+    const glyphRun_t *runs = _getGlyphRuns(font, chr, glyph, &count);
+
+    if(runs == NULL)
+    {
+        // Glyph too big for the cache, draw it pixel by pixel
+        const uint8_t *bitmap = &fonts[font].bitmap[glyph->bitmapOffset];
+        uint8_t bits = 0, bit = 0;
+
+        for(uint8_t yy = 0; yy < glyph->height; yy++)
+        {
+            for(uint8_t xx = 0; xx < glyph->width; xx++)
+            {
+                if(!(bit++ & 7))
+                    bits = *bitmap++;
+
+                point_t pos = {x + xx, y + yy};
+                if((bits & 0x80) && (pos.x > 0) && (pos.y > 0))
+                    gfx_setPixel(pos, color);
+
+                bits <<= 1;
+            }
+        }
+
+        return;
+    }
+
+    for(uint16_t i = 0; i < count; i++)
+    {
+        int16_t ry  = y + runs[i].y;
+        int16_t rx0 = x + runs[i].x;
+        int16_t rx1 = rx0 + runs[i].len - 1;
+
+        if(clip)
+        {
+            if((ry < 1) || (ry >= CONFIG_SCREEN_HEIGHT)) continue;
+            if(rx0 < 1) rx0 = 1;
+        }
+
+        _fillHSpan(rx0, rx1, ry, color);
+    }
+}
+
 /**
  * Compute the pixel size of the first text line
  * @param f: font used as the source of glyphs
  * @param text: the input text
  * @param length: the length of the input text, used for boundary checking
  */
-static inline uint16_t get_line_size(GFXfont f, const char *text, uint16_t length)
+static inline uint16_t get_line_size(const GFXfont *f, const char *text,
+                                     uint16_t length)
 {
     uint16_t line_size = 0;
     for(unsigned i = 0; i < length && text[i] != '\n' && text[i] != '\r'; i++)
     {
-        GFXglyph glyph = f.glyph[text[i] - f.first];
-        if (line_size + glyph.xAdvance < CONFIG_SCREEN_WIDTH)
-            line_size += glyph.xAdvance;
+        uint8_t xAdvance = f->glyph[text[i] - f->first].xAdvance;
+        if (line_size + xAdvance < CONFIG_SCREEN_WIDTH)
+            line_size += xAdvance;
         else
             break;
     }
@@ -439,20 +1144,37 @@ static inline uint16_t get_reset_x(textAlign_t alignment, uint16_t line_size,
 
 uint8_t gfx_getFontHeight(fontSize_t size)
 {
-    GFXfont f = fonts[size];
-    GFXglyph glyph = f.glyph['|' - f.first];
-    return glyph.height;
+    const GFXfont *f = &fonts[size];
+    return f->glyph['|' - f->first].height;
+}
+
+uint8_t gfx_getFontDescent(fontSize_t size)
+{
+    const GFXfont *f = &fonts[size];
+    int16_t descent  = 0;
+
+    for(uint16_t c = f->first; c <= f->last; c++)
+    {
+        const GFXglyph *glyph = &f->glyph[c - f->first];
+        int16_t bottom = glyph->yOffset + glyph->height;
+
+        if(bottom > descent)
+            descent = bottom;
+    }
+
+    return descent;
 }
 
 point_t gfx_printBuffer(point_t start, fontSize_t size, textAlign_t alignment,
                         color_t color, const char *buf)
 {
-    GFXfont f = fonts[size];
+    const GFXfont *f = &fonts[size];
 
     size_t len = strlen(buf);
 
-    // Compute size of the first row in pixels
-    uint16_t line_size = get_line_size(f, buf, len);
+    // Compute size of the first row in pixels, it is reused when wrapping
+    uint16_t first_line_size = get_line_size(f, buf, len);
+    uint16_t line_size = first_line_size;
     uint16_t reset_x = get_reset_x(alignment, line_size, start.x);
     start.x = reset_x;
     // Save initial start.y value to calculate vertical size
@@ -463,15 +1185,8 @@ point_t gfx_printBuffer(point_t start, fontSize_t size, textAlign_t alignment,
     for(unsigned i = 0; i < len; i++)
     {
         char c = buf[i];
-        GFXglyph glyph = f.glyph[c - f.first];
-        uint8_t *bitmap = f.bitmap;
-
-        uint16_t bo = glyph.bitmapOffset;
-        uint8_t w = glyph.width, h = glyph.height;
-        int8_t xo = glyph.xOffset,
-               yo = glyph.yOffset;
-        uint8_t xx, yy, bits = 0, bit = 0;
-        line_h = h;
+        const GFXglyph *glyph = &f->glyph[c - f->first];
+        line_h = glyph->height;
 
         // Handle newline and carriage return
         if (c == '\n')
@@ -485,7 +1200,7 @@ point_t gfx_printBuffer(point_t start, fontSize_t size, textAlign_t alignment,
             line_size = get_line_size(f, &buf[i+1], len-(i+1));
             start.x = reset_x = get_reset_x(alignment, line_size, start.x);
           }
-          start.y += f.yAdvance;
+          start.y += f->yAdvance;
           continue;
         }
         else if (c == '\r')
@@ -495,44 +1210,17 @@ point_t gfx_printBuffer(point_t start, fontSize_t size, textAlign_t alignment,
         }
 
         // Handle wrap around
-        if (start.x + glyph.xAdvance > CONFIG_SCREEN_WIDTH)
+        if (start.x + glyph->xAdvance > CONFIG_SCREEN_WIDTH)
         {
-            // Compute size of the first row in pixels
-            line_size = get_line_size(f, buf, len);
+            line_size = first_line_size;
             start.x = reset_x = get_reset_x(alignment, line_size, start.x);
-            start.y += f.yAdvance;
+            start.y += f->yAdvance;
         }
 
-        // Draw bitmap
-        for (yy = 0; yy < h; yy++)
-        {
-            for (xx = 0; xx < w; xx++)
-            {
-                if (!(bit++ & 7))
-                {
-                    bits = bitmap[bo++];
-                }
-
-                if (bits & 0x80)
-                {
-                    if (start.y + yo + yy < CONFIG_SCREEN_HEIGHT &&
-                        start.x + xo + xx < CONFIG_SCREEN_WIDTH &&
-                        start.y + yo + yy > 0 &&
-                        start.x + xo + xx > 0)
-                    {
-                        point_t pos;
-                        pos.x = start.x + xo + xx;
-                        pos.y = start.y + yo + yy;
-                        gfx_setPixel(pos, color);
-
-                    }
-                }
-
-                bits <<= 1;
-            }
-        }
+        _drawGlyph(size, (uint8_t) c, glyph, start.x + glyph->xOffset,
+                   start.y + glyph->yOffset, color);
 
-        start.x += glyph.xAdvance;
+        start.x += glyph->xAdvance;
     }
     // Calculate text size
     point_t text_size = {0, 0};
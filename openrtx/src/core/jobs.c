@@ -0,0 +1,84 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <stddef.h>
+#include <jobs.h>
+
+typedef struct
+{
+    job_t     job;          // Job function
+    uint32_t  period;       // Job period, in ms
+    long long deadline;     // Time of the next run
+}
+jobEntry_t;
+
+static jobEntry_t jobs[MAX_NUM_JOBS];
+static uint8_t    numJobs = 0;
+
+// Longest time between two runs of the scheduler when no job is registered
+static const uint32_t maxSleep = 1000;
+
+int jobs_register(job_t job, uint32_t period)
+{
+    if((job == NULL) || (numJobs >= MAX_NUM_JOBS))
+        return -1;
+
+    jobs[numJobs].job      = job;
+    jobs[numJobs].period   = period;
+    jobs[numJobs].deadline = 0;
+
+    return numJobs++;
+}
+
+void jobs_setPeriod(int id, uint32_t period)
+{
+    if((id < 0) || (id >= numJobs))
+        return;
+
+    // The deadline already set is kept, jobs_run() adds the new period to it
+    // after the next run. This holds also when called from inside the job.
+    jobs[id].period = period;
+}
+
+long long jobs_run(long long now)
+{
+    long long next = now + maxSleep;
+
+    for(uint8_t i = 0; i < numJobs; i++)
+    {
+        jobEntry_t *entry = &jobs[i];
+
+        if(now >= entry->deadline)
+        {
+            entry->job();
+
+            // Keep a steady rate, unless the job is late by a whole period
+            entry->deadline += entry->period;
+            if(entry->deadline <= now)
+                entry->deadline = now + entry->period;
+        }
+
+        if(entry->deadline < next)
+            next = entry->deadline;
+    }
+
+    return next;
+}
@@ -0,0 +1,112 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <noise_squelch.hpp>
+#include <cmath>
+
+NoiseSquelch::NoiseSquelch()
+{
+    static constexpr float fc = 3000.0f;    // High-pass cutoff frequency
+
+    // Butterworth high-pass built from biquad sections, each with the Q of one
+    // of the conjugate pole pairs.
+    const float w0   = 2.0f * M_PI * fc / SAMPLE_RATE;
+    const float cosW = std::cos(w0);
+    const float sinW = std::sin(w0);
+
+    for(size_t i = 0; i < NUM_BIQUADS; i++)
+    {
+        float theta = M_PI * (2.0f * i + 1.0f) / (4.0f * NUM_BIQUADS);
+        float q     = 1.0f / (2.0f * std::sin(theta));
+        float alpha = sinW / (2.0f * q);
+        float a0    = 1.0f + alpha;
+
+        hpf[i].b0 = ((1.0f + cosW) / 2.0f) / a0;
+        hpf[i].b1 = -(1.0f + cosW) / a0;
+        hpf[i].b2 = hpf[i].b0;
+        hpf[i].a1 = (-2.0f * cosW) / a0;
+        hpf[i].a2 = (1.0f - alpha) / a0;
+    }
+
+    reset();
+}
+
+NoiseSquelch::~NoiseSquelch()
+{
+
+}
+
+void NoiseSquelch::reset()
+{
+    for(auto& biquad : hpf)
+    {
+        biquad.z1 = 0.0f;
+        biquad.z2 = 0.0f;
+    }
+
+    noiseFloor   = 0.0f;
+    lastQuieting = 0.0f;
+    open         = false;
+}
+
+void NoiseSquelch::process(const stream_sample_t *samples, const size_t len)
+{
+    if(len == 0)
+        return;
+
+    float power = 0.0f;
+
+    for(size_t i = 0; i < len; i++)
+    {
+        float value = static_cast< float >(samples[i]);
+
+        for(auto& biquad : hpf)
+        {
+            float out = biquad.b0 * value + biquad.z1;
+            biquad.z1 = biquad.b1 * value - biquad.a1 * out + biquad.z2;
+            biquad.z2 = biquad.b2 * value - biquad.a2 * out;
+            value     = out;
+        }
+
+        power += value * value;
+    }
+
+    power /= static_cast< float >(len);
+
+    // The noise floor follows any increase of the noise immediately. While
+    // the squelch is closed it also slowly follows decreases, to adapt to
+    // changes of the receiver gain.
+    if(power > noiseFloor)
+        noiseFloor = power;
+    else if(open == false)
+        noiseFloor += (power - noiseFloor) * FLOOR_DECAY;
+
+    if(power > 0.0f)
+        lastQuieting = 10.0f * std::log10(noiseFloor / power);
+    else
+        lastQuieting = (noiseFloor > 0.0f) ? 100.0f : 0.0f;
+
+    if((open == false) && (lastQuieting >= OPEN_DB))
+        open = true;
+
+    if((open == true) && (lastQuieting < CLOSE_DB))
+        open = false;
+}
@@ -23,6 +23,7 @@
 #include <interfaces/display.h>
 #include <interfaces/delays.h>
 #include <interfaces/cps_io.h>
+#include <contact_index.h>
 #include <peripherals/gps.h>
 #include <voicePrompts.h>
 #include <graphics.h>
@@ -68,6 +69,13 @@ void openrtx_init()
         }
     }
 
+    #if defined(CONFIG_M17) && defined(PLATFORM_LINUX)
+    // Index the M17 contacts, for callsign resolution on RX. Only the file
+    // based codeplugs of the linux target can hold M17 contacts, the native
+    // ones of the radios store DMR contacts only.
+    contactIndex_build();
+    #endif
+
     // Display splash screen, turn on backlight after a suitable time to
     // hide random pixels during render process
     ui_drawSplashScreen();
@@ -32,7 +32,6 @@
 
 state_t state;
 pthread_mutex_t state_mutex;
-static long long int lastUpdate = 0;
 
 // Commonly used frequency steps, expressed in Hz
 const uint32_t freq_steps[] = { 1000, 5000, 6250, 10000, 12500, 15000,
@@ -41,6 +40,9 @@ const size_t n_freq_steps   = sizeof(freq_steps) / sizeof(freq_steps[0]);
 
 static bool volume_changed;
 static uint8_t prev_volume;
+static bool prev_ptt;
+static uint32_t prev_rtxGen;
+static uint8_t  prev_micLevel;
 
 void state_init()
 {
@@ -107,14 +109,63 @@ void state_terminate()
 
 void state_task()
 {
-    // Update radio state once every 100ms
-    if((getTick() - lastUpdate) < 100)
-        return;
+    // Fields changed by this update
+    uint32_t changes = 0;
 
-    lastUpdate = getTick();
+    pthread_mutex_lock(&state_mutex);
+
+    rssi_t oldRssi = state.rssi;
+    state.rssi     = rtx_getRssi();
+
+    #ifdef CONFIG_RTC
+    datetime_t time = platform_getCurrentTime();
+    if(memcmp(&time, &state.time, sizeof(datetime_t)) != 0)
+        changes |= STATE_CHG_TIME;
+
+    state.time = time;
+    #endif
+
+    if(state.rssi != oldRssi)
+        changes |= STATE_CHG_RSSI;
+
+    pthread_mutex_unlock(&state_mutex);
+
+    bool ptt = platform_getPttStatus();
+    if(ptt != prev_ptt)
+    {
+        prev_ptt = ptt;
+        changes |= STATE_CHG_PTT;
+    }
+
+    // Microphone level is shown only while transmitting
+    if(ptt)
+    {
+        uint8_t micLevel = platform_getMicLevel();
+        if(micLevel != prev_micLevel)
+        {
+            prev_micLevel = micLevel;
+            changes |= STATE_CHG_RTX;
+        }
+    }
+
+    uint32_t rtxGen = rtx_getStatusGeneration();
+    if(rtxGen != prev_rtxGen)
+    {
+        prev_rtxGen = rtxGen;
+        changes |= STATE_CHG_RTX_STATUS;
+    }
+
+    if(changes != 0)
+        ui_pushEvent(EVENT_STATUS, changes);
+}
 
+void state_updateBattery()
+{
     pthread_mutex_lock(&state_mutex);
 
+    uint16_t oldVbat   = state.v_bat;
+    uint8_t  oldCharge = state.charge;
+
     /*
      * Low-pass filtering with a time constant of 10s when updated at 1Hz
      * Original computation: state.v_bat = 0.02*vbat + 0.98*state.v_bat
@@ -132,6 +183,20 @@ void state_task()
     state.v_bat  += (vbat * 2) / 100;
     #endif
 
+    state.charge = battery_getCharge(state.v_bat);
+
+    bool changed = (state.v_bat != oldVbat) || (state.charge != oldCharge);
+
+    pthread_mutex_unlock(&state_mutex);
+
+    if(changed)
+        ui_pushEvent(EVENT_STATUS, STATE_CHG_BATTERY);
+}
+
+void state_updateVolume()
+{
+    pthread_mutex_lock(&state_mutex);
+
     /*
      * Update volume level, as a 50% average between previous value and a new
      * read of the knob position. This gives a good reactivity while preventing
@@ -140,21 +205,16 @@ void state_task()
     uint16_t vol = platform_getVolumeLevel() + state.volume;
     state.volume = vol / 2;
 
-    if(state.volume != prev_volume) {
+    bool changed = (state.volume != prev_volume);
+    if(changed) {
         prev_volume = state.volume;
         state.volume_changed = true;
-    } 
-    
-    state.charge = battery_getCharge(state.v_bat);
-    state.rssi = rtx_getRssi();
-
-    #ifdef CONFIG_RTC
-    state.time = platform_getCurrentTime();
-    #endif
+    }
 
     pthread_mutex_unlock(&state_mutex);
 
-    ui_pushEvent(EVENT_STATUS, 0);
+    if(changed)
+        ui_pushEvent(EVENT_STATUS, STATE_CHG_VOLUME);
 }
 
 void state_resetSettingsAndVfo()
@@ -33,6 +33,7 @@
 #include <utils.h>
 #include <input.h>
 #include <backup.h>
+#include <jobs.h>
 #ifdef CONFIG_GPS
 #include <peripherals/gps.h>
 #include <gps.h>
@@ -46,6 +47,35 @@
 /* Mutex for concurrent access to RTX state variable */
 pthread_mutex_t rtx_mutex;
 
+/* UI thread update periods, in ms */
+#define UI_PERIOD_FAST     25      // Menu navigation, voice prompts and beeps
+#define UI_PERIOD_IDLE     50      // Display on, no user activity
+#define UI_PERIOD_STANDBY  100     // Display in standby
+#define UI_FAST_TIMEOUT    2000    // Fast update time after the last keypress
+#define UI_TIMER_PERIOD    1000    // UI timers check without pending events
+
+/**
+ * \internal
+ * Compute the time to wait before the next update of the UI thread.
+ * The keyboard is polled, thus the period has to stay short enough to catch
+ * even quick keypresses while in standby.
+ *
+ * @param now: current time.
+ * @param fastUntil: end of the fast update period following user activity.
+ * @return period in ms.
+ */
+static uint32_t _ui_updatePeriod(long long now, long long fastUntil)
+{
+    // Beep durations are counted in vp_tick() calls
+    if((now < fastUntil) || vp_isBusy())
+        return UI_PERIOD_FAST;
+
+    if(ui_isStandby())
+        return UI_PERIOD_STANDBY;
+
+    return UI_PERIOD_IDLE;
+}
+
 /**
  * \internal Thread managing user input and UI
  */
@@ -58,6 +88,7 @@ void *ui_threadFunc(void *arg)
     long long uiFastUntil = 0;
     bool        sync_rtx = true;
     long long   time     = 0;
+    long long   timerCheck = 0;
 
     // Load initial state and update the UI
     ui_saveState();
@@ -71,27 +102,30 @@ void *ui_threadFunc(void *arg)
     {
         time = getTick();
 
-        bool keyEvent = false;
         if(input_scanKeyboard(&kbd_msg))
         {
             ui_pushEvent(EVENT_KBD, kbd_msg.value);
-            keyEvent = true;
+            uiFastUntil = time + UI_FAST_TIMEOUT;
         }
+
+        // Run the UI FSM only when there is some event to process, state
+        // changes are notified by the main thread through status events.
+        // Without events, the FSM still runs once per second for the timers.
+        if(ui_eventPending() || (time >= timerCheck))
         {
-            ui_pushEvent(EVENT_KBD, kbd_msg.value);
+            timerCheck = time + UI_TIMER_PERIOD;
+            pthread_mutex_lock(&state_mutex);   // Lock r/w access to radio state
+            ui_updateFSM(&sync_rtx);            // Update UI FSM
+            ui_saveState();                     // Save local state copy
+            pthread_mutex_unlock(&state_mutex); // Unlock r/w access to radio state
         }
 
-        pthread_mutex_lock(&state_mutex);   // Lock r/w access to radio state
-        ui_updateFSM(&sync_rtx);            // Update UI FSM
-        ui_saveState();                     // Save local state copy
-        pthread_mutex_unlock(&state_mutex); // Unlock r/w access to radio state
-
         vp_tick();                           // continue playing voice prompts in progress if any.
 
-        // If synchronization needed take mutex and update RTX configuration
+        // If synchronization needed update RTX configuration, the structure
+        // is copied by the RTX driver
         if(sync_rtx)
         {
-            pthread_mutex_lock(&rtx_mutex);
             rtx_cfg.opMode      = state.channel.mode;
             rtx_cfg.bandwidth   = state.channel.bandwidth;
             rtx_cfg.rxFrequency = state.channel.rx_frequency;
@@ -117,20 +151,18 @@ void *ui_threadFunc(void *arg)
             strncpy(rtx_cfg.source_address,      state.settings.callsign, 10);
             strncpy(rtx_cfg.destination_address, state.settings.m17_dest, 10);
 
-            pthread_mutex_unlock(&rtx_mutex);
-
             rtx_configure(&rtx_cfg);
             sync_rtx = false;
         }
 
-        // Update UI and render on screen, if necessary
+        // Update UI and render on screen only the rows that changed
         if(ui_updateGUI() == true)
         {
-            gfx_render();
+            gfx_renderDirty();
         }
 
-        // 40Hz update rate for keyboard and UI
-        time += 25;
+        // 40Hz update rate during user interaction, lower when idle
+        time += _ui_updatePeriod(time, uiFastUntil);
         sleepUntil(time);
     }
 
@@ -140,6 +172,34 @@ void *ui_threadFunc(void *arg)
     return NULL;
 }
 
+/**
+ * \internal Housekeeping job checking if power off is requested.
+ */
+static void pwrButton_task()
+{
+    pthread_mutex_lock(&state_mutex);
+    if(platform_pwrButtonStatus() == false)
+        state.devStatus = SHUTDOWN;
+    pthread_mutex_unlock(&state_mutex);
+}
+
+#if defined(CONFIG_GPS) && !defined(MD3x0_ENABLE_DBG)
+#define GPS_PERIOD_ON   20      // NMEA sentences polling period
+#define GPS_PERIOD_OFF  500     // GPS turned off, only check the settings
+
+static int gpsJob;
+
+/**
+ * \internal Housekeeping job for the GPS, polling often only when it is on.
+ */
+static void gps_job()
+{
+    gps_task();
+    jobs_setPeriod(gpsJob, state.settings.gps_enabled ? GPS_PERIOD_ON
+                                                      : GPS_PERIOD_OFF);
+}
+#endif
+
 /**
  * \internal Thread managing the device and update the global state variable.
  */
@@ -147,33 +207,28 @@ void *main_thread(void *arg)
 {
     (void) arg;
 
-    long long time     = 0;
-
-    while(state.devStatus != SHUTDOWN)
-    {
-        time = getTick();
-
-        #if defined(PLATFORM_TTWRPLUS)
-        pmu_handleIRQ();
-        #endif
+    #if defined(PLATFORM_TTWRPLUS)
+    jobs_register(pmu_handleIRQ, 10);
+    #endif
 
-        // Check if power off is requested
-        pthread_mutex_lock(&state_mutex);
-        if(platform_pwrButtonStatus() == false)
-            state.devStatus = SHUTDOWN;
-        pthread_mutex_unlock(&state_mutex);
+    jobs_register(pwrButton_task, 50);
 
-        // Run GPS task
-        #if defined(CONFIG_GPS) && !defined(MD3x0_ENABLE_DBG)
-        gps_task();
-        #endif
+    // NMEA sentences are received under interrupt, polling for a complete one
+    // faster than this does not catch more of them.
+    #if defined(CONFIG_GPS) && !defined(MD3x0_ENABLE_DBG)
+    if(state.gpsDetected)
+        gpsJob = jobs_register(gps_job, GPS_PERIOD_ON);
+    #endif
 
-        // Run state update task
-        state_task();
+    jobs_register(state_updateVolume,  50);
+    jobs_register(state_task,          100);
+    jobs_register(state_updateBattery, 1000);
 
-        // Run this loop once every 5ms
-        time += 5;
-        sleepUntil(time);
+    while(state.devStatus != SHUTDOWN)
+    {
+        // Run the expired jobs and sleep until the next deadline
+        long long next = jobs_run(getTick());
+        sleepUntil(next);
     }
 
     #if defined(CONFIG_GPS)
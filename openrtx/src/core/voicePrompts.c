@@ -649,6 +649,11 @@ bool vp_sequenceNotEmpty()
     return (vpCurrentSequence.length > 0);
 }
 
+bool vp_isBusy()
+{
+    return voicePromptActive || (vpStartTime > 0) || (currentBeepDuration > 0);
+}
+
 void vp_beep(uint16_t freq, uint16_t duration)
 {
     if (state.settings.vpLevel < vpBeep)
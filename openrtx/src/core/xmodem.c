@@ -23,6 +23,7 @@
 #include <stdlib.h>
 #include <xmodem.h>
 #include <string.h>
+#include <sched.h>
 #include <crc.h>
 
 #define SOH     (0x01)  // start of 128-byte data packet
@@ -49,7 +50,10 @@ static void waitForData(uint8_t *ptr, size_t size)
     while(curSize < size)
     {
         ssize_t recvd = vcom_readBlock(ptr + curSize, size - curSize);
-        if(recvd >= 0) curSize += recvd;
+        if(recvd > 0)
+            curSize += recvd;
+        else
+            sched_yield();  // Let other threads run while waiting
     }
 }
 
@@ -85,13 +89,14 @@ void xmodem_sendPacket(const void *data, size_t size, uint8_t blockNum)
     vcom_writeBlock(buf, 2);
 }
 
-size_t xmodem_receivePacket(void* data, uint8_t expectedBlockNum)
+ssize_t xmodem_receivePacket(void* data, uint8_t expectedBlockNum)
 {
     // Get first byte
     uint8_t status = 0;
     while((status != STX) && (status != SOH))
     {
         waitForData(&status, 1);
+        if(status == EOT) return -1;
     }
 
     // Get sequence number
@@ -204,7 +209,16 @@ ssize_t xmodem_receiveData(size_t size, void (*callback)(uint8_t *, size_t))
 
     while(rcvdSize < size)
     {
-        size_t blockSize = xmodem_receivePacket(dataBuf, blockNum);
+        ssize_t blockSize = xmodem_receivePacket(dataBuf, blockNum);
+
+        // Sender terminated the transfer early
+        if(blockSize < 0)
+        {
+            command = ACK;
+            vcom_writeBlock(&command, 1);
+            return rcvdSize;
+        }
+
         if(blockSize == 0)
         {
             // Bad packet, send NACK
@@ -214,7 +228,7 @@ ssize_t xmodem_receiveData(size_t size, void (*callback)(uint8_t *, size_t))
         {
             // New data arrived
             size_t delta = size - rcvdSize;
-            if(blockSize < delta) delta = blockSize;
+            if((size_t) blockSize < delta) delta = blockSize;
             callback(dataBuf, delta);
 
             rcvdSize += delta;
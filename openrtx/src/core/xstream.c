@@ -0,0 +1,462 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <interfaces/delays.h>
+#include <stdbool.h>
+#include <xstream.h>
+#include <string.h>
+#include <crc.h>
+
+#define SYNC            (0xA5)  // First byte of each frame
+#define DEF_TIMEOUT     1000    // Default retransmission timeout, in ms
+#define MAX_RETRIES     10      // Consecutive timeouts before giving up
+#define START_RETRIES   60      // Timeouts before giving up waiting the receiver
+
+enum frameType
+{
+    FRAME_START  = 1,   // Receiver ready
+    FRAME_DATA   = 2,   // Data block
+    FRAME_ACK    = 3,   // All the blocks before seq have been received
+    FRAME_NAK    = 4,   // Block seq is missing
+    FRAME_END    = 5,   // End of transfer, seq is the number of blocks
+    FRAME_ENDACK = 6,   // End of transfer acknowledged
+    FRAME_ABORT  = 7    // Transfer aborted
+};
+
+/*
+ * Frame layout, multi-byte fields are little endian:
+ *
+ * | sync | type | length (2) | sequence number (4) | payload | CRC-32 (4) |
+ *
+ * The CRC covers the header and the payload.
+ */
+
+static inline uint16_t frameLength(const uint8_t *frame)
+{
+    return frame[2] | (frame[3] << 8);
+}
+
+static inline uint32_t frameSeq(const uint8_t *frame)
+{
+    return frame[4] | (frame[5] << 8) | (frame[6] << 16)
+         | ((uint32_t) frame[7] << 24);
+}
+
+static bool headerValid(const uint8_t *frame)
+{
+    uint16_t len = frameLength(frame);
+
+    if((frame[0] != SYNC) || (frame[1] < FRAME_START) ||
+       (frame[1] > FRAME_ABORT))
+        return false;
+
+    // Only data frames carry a payload
+    if(frame[1] == FRAME_DATA)
+        return (len > 0) && (len <= XSTREAM_BLOCK_SIZE);
+
+    return len == 0;
+}
+
+/**
+ * \internal
+ * Build a frame and send it.
+ *
+ * @param ctx: transfer context.
+ * @param type: frame type.
+ * @param seq: sequence number.
+ * @param payload: frame payload, can be NULL if len is zero.
+ * @param len: payload size.
+ * @return zero on success, a negative error code otherwise.
+ */
+static int sendFrame(struct xstream *ctx, uint8_t type, uint32_t seq,
+                     const void *payload, uint16_t len)
+{
+    uint8_t *frame = ctx->txFrame;
+
+    frame[0] = SYNC;
+    frame[1] = type;
+    frame[2] = len & 0xFF;
+    frame[3] = len >> 8;
+    frame[4] = seq & 0xFF;
+    frame[5] = (seq >> 8)  & 0xFF;
+    frame[6] = (seq >> 16) & 0xFF;
+    frame[7] = seq >> 24;
+
+    if(len > 0)
+        memcpy(&frame[XSTREAM_HDR_SIZE], payload, len);
+
+    size_t   size = XSTREAM_HDR_SIZE + len;
+    uint32_t crc  = crc_32(frame, size);
+    frame[size++] = crc & 0xFF;
+    frame[size++] = (crc >> 8)  & 0xFF;
+    frame[size++] = (crc >> 16) & 0xFF;
+    frame[size++] = crc >> 24;
+
+    ssize_t ret = ctx->port->write(frame, size);
+    if(ret < 0)
+        return ret;
+
+    return 0;
+}
+
+static inline int sendBlock(struct xstream *ctx, uint32_t seq)
+{
+    uint32_t slot = seq % XSTREAM_WINDOW;
+    return sendFrame(ctx, FRAME_DATA, seq, ctx->window[slot],
+                     ctx->blockLen[slot]);
+}
+
+/**
+ * \internal
+ * Wait for a valid frame. Invalid data is dropped, resynchronising on the
+ * next frame header.
+ *
+ * @param ctx: transfer context.
+ * @param timeout: maximum waiting time, in ms.
+ * @return frame type, zero on timeout or a negative error code.
+ */
+static int receiveFrame(struct xstream *ctx, uint32_t timeout)
+{
+    uint8_t  *frame    = ctx->rxFrame;
+    long long deadline = getTick() + timeout;
+
+    while(true)
+    {
+        size_t size = XSTREAM_HDR_SIZE;
+        if(ctx->rxPos >= XSTREAM_HDR_SIZE)
+            size += frameLength(frame) + 4;
+
+        if(ctx->rxPos < size)
+        {
+            long long now  = getTick();
+            uint32_t  wait = (now < deadline) ? (deadline - now) : 0;
+
+            ssize_t ret = ctx->port->read(&frame[ctx->rxPos],
+                                          size - ctx->rxPos, wait);
+            if(ret < 0)
+                return ret;
+
+            if(ret == 0)
+            {
+                if(wait == 0)
+                    return 0;
+
+                continue;
+            }
+
+            ctx->rxPos += ret;
+
+            // Bad header, drop the first byte and look for the next frame
+            if((ctx->rxPos >= XSTREAM_HDR_SIZE) && (headerValid(frame) == false))
+            {
+                if(frame[0] == SYNC)
+                    ctx->stats.badFrames += 1;
+
+                ctx->rxPos -= 1;
+                memmove(frame, &frame[1], ctx->rxPos);
+            }
+
+            continue;
+        }
+
+        size_t   len = XSTREAM_HDR_SIZE + frameLength(frame);
+        uint32_t crc = frame[len] | (frame[len + 1] << 8)
+                     | (frame[len + 2] << 16)
+                     | ((uint32_t) frame[len + 3] << 24);
+
+        ctx->rxPos = 0;
+
+        if(crc_32(frame, len) != crc)
+        {
+            ctx->stats.badFrames += 1;
+            continue;
+        }
+
+        ctx->rxSeq = frameSeq(frame);
+        ctx->rxLen = frameLength(frame);
+
+        return frame[1];
+    }
+}
+
+
+void xstream_init(struct xstream *ctx, const struct xstreamPort *port)
+{
+    memset(&ctx->stats, 0x00, sizeof(struct xstreamStats));
+    ctx->port    = port;
+    ctx->timeout = DEF_TIMEOUT;
+    ctx->rxPos   = 0;
+    ctx->present = 0;
+    ctx->nakSent = 0;
+}
+
+ssize_t xstream_sendData(struct xstream *ctx, size_t size,
+                         int (*callback)(uint8_t *, size_t))
+{
+    uint32_t numBlocks = (size + XSTREAM_BLOCK_SIZE - 1) / XSTREAM_BLOCK_SIZE;
+    uint32_t base      = 0;
+    uint32_t next      = 0;
+    uint32_t retries   = 0;
+    int      ret;
+
+    // Wait for the start command from the receiver
+    do
+    {
+        ret = receiveFrame(ctx, ctx->timeout);
+        if(ret < 0)
+            return ret;
+
+        if((ret == 0) && (++retries > START_RETRIES))
+            return -1;
+    }
+    while(ret != FRAME_START);
+
+    retries = 0;
+
+    while(base < numBlocks)
+    {
+        // Keep the window full
+        while((next < numBlocks) && ((next - base) < XSTREAM_WINDOW))
+        {
+            uint32_t slot = next % XSTREAM_WINDOW;
+            size_t   len  = size - (next * XSTREAM_BLOCK_SIZE);
+            if(len > XSTREAM_BLOCK_SIZE)
+                len = XSTREAM_BLOCK_SIZE;
+
+            // Request data, stop transfer on failure
+            if(callback(ctx->window[slot], len) < 0)
+            {
+                sendFrame(ctx, FRAME_ABORT, next, NULL, 0);
+                return -1;
+            }
+
+            ctx->blockLen[slot] = len;
+            ret = sendBlock(ctx, next);
+            if(ret < 0)
+                return ret;
+
+            next++;
+        }
+
+        ret = receiveFrame(ctx, ctx->timeout);
+        if(ret < 0)
+            return ret;
+
+        switch(ret)
+        {
+            case FRAME_ACK:
+                if((ctx->rxSeq > base) && (ctx->rxSeq <= next))
+                {
+                    ctx->stats.blocks += ctx->rxSeq - base;
+                    base    = ctx->rxSeq;
+                    retries = 0;
+                }
+                break;
+
+            case FRAME_NAK:
+                ctx->stats.naks += 1;
+                if((ctx->rxSeq >= base) && (ctx->rxSeq < next))
+                {
+                    ret = sendBlock(ctx, ctx->rxSeq);
+                    ctx->stats.retransmits += 1;
+                }
+                break;
+
+            case FRAME_ABORT:
+                return -1;
+
+            case 0:
+                // No feedback: resend the oldest unacknowledged block
+                ctx->stats.timeouts += 1;
+                if(++retries > MAX_RETRIES)
+                {
+                    sendFrame(ctx, FRAME_ABORT, base, NULL, 0);
+                    return -1;
+                }
+
+                ret = sendBlock(ctx, base);
+                ctx->stats.retransmits += 1;
+                break;
+
+            default:
+                break;
+        }
+
+        if(ret < 0)
+            return ret;
+    }
+
+    // End of transfer. All the data has already been acknowledged, thus a
+    // missing confirmation of the end is not an error.
+    for(retries = 0; retries < MAX_RETRIES; retries++)
+    {
+        ret = sendFrame(ctx, FRAME_END, numBlocks, NULL, 0);
+        if(ret < 0)
+            return ret;
+
+        do
+        {
+            ret = receiveFrame(ctx, ctx->timeout);
+            if(ret < 0)
+                return ret;
+
+            if(ret == FRAME_ENDACK)
+                return size;
+        }
+        while(ret != 0);
+
+        ctx->stats.timeouts += 1;
+    }
+
+    return size;
+}
+
+ssize_t xstream_receiveData(struct xstream *ctx, size_t size,
+                            int (*callback)(uint8_t *, size_t))
+{
+    uint32_t expected = 0;
+    uint32_t retries  = 0;
+    size_t   rcvdSize = 0;
+    bool     started  = false;
+    int      ret;
+
+    ctx->present = 0;
+    ctx->nakSent = 0;
+
+    ret = sendFrame(ctx, FRAME_START, 0, NULL, 0);
+    if(ret < 0)
+        return ret;
+
+    while(true)
+    {
+        ret = receiveFrame(ctx, ctx->timeout);
+        if(ret < 0)
+            return ret;
+
+        uint32_t seq = ctx->rxSeq;
+
+        switch(ret)
+        {
+            case FRAME_DATA:
+            {
+                started = true;
+                retries = 0;
+
+                // Duplicate, the acknowledgement may have been lost
+                if(seq < expected)
+                {
+                    ret = sendFrame(ctx, FRAME_ACK, expected, NULL, 0);
+                    break;
+                }
+
+                if((seq - expected) >= XSTREAM_WINDOW)
+                    break;
+
+                uint32_t slot = seq % XSTREAM_WINDOW;
+                if((ctx->present & (1 << slot)) == 0)
+                {
+                    memcpy(ctx->window[slot], &ctx->rxFrame[XSTREAM_HDR_SIZE],
+                           ctx->rxLen);
+                    ctx->blockLen[slot] = ctx->rxLen;
+                    ctx->present       |= (1 << slot);
+                }
+
+                // Request the blocks skipped so far
+                for(uint32_t i = expected; (i < seq) && (ret >= 0); i++)
+                {
+                    uint32_t mask = 1 << (i % XSTREAM_WINDOW);
+                    if(((ctx->present | ctx->nakSent) & mask) == 0)
+                    {
+                        ret = sendFrame(ctx, FRAME_NAK, i, NULL, 0);
+                        ctx->nakSent    |= mask;
+                        ctx->stats.naks += 1;
+                    }
+                }
+
+                // Deliver the blocks received in order
+                bool delivered = false;
+                while((ctx->present & (1 << (expected % XSTREAM_WINDOW))) != 0)
+                {
+                    uint32_t pos  = expected % XSTREAM_WINDOW;
+                    size_t   len  = ctx->blockLen[pos];
+                    if(len > (size - rcvdSize))
+                        len = size - rcvdSize;
+
+                    // Consume data, stop transfer on failure
+                    if((len > 0) && (callback(ctx->window[pos], len) < 0))
+                    {
+                        sendFrame(ctx, FRAME_ABORT, expected, NULL, 0);
+                        return -1;
+                    }
+
+                    ctx->present      &= ~(1 << pos);
+                    ctx->nakSent      &= ~(1 << pos);
+                    ctx->stats.blocks += 1;
+                    rcvdSize          += len;
+                    expected          += 1;
+                    delivered          = true;
+                }
+
+                if(delivered && (ret >= 0))
+                    ret = sendFrame(ctx, FRAME_ACK, expected, NULL, 0);
+            }
+                break;
+
+            case FRAME_END:
+                if(seq <= expected)
+                {
+                    sendFrame(ctx, FRAME_ENDACK, expected, NULL, 0);
+                    return rcvdSize;
+                }
+
+                ret = sendFrame(ctx, FRAME_NAK, expected, NULL, 0);
+                break;
+
+            case FRAME_ABORT:
+                return -1;
+
+            case 0:
+                ctx->stats.timeouts += 1;
+                if(++retries > MAX_RETRIES)
+                {
+                    sendFrame(ctx, FRAME_ABORT, expected, NULL, 0);
+                    return -1;
+                }
+
+                if(started == false)
+                {
+                    ret = sendFrame(ctx, FRAME_START, 0, NULL, 0);
+                    break;
+                }
+
+                ret = sendFrame(ctx, FRAME_ACK, expected, NULL, 0);
+                if((ret >= 0) && (ctx->present != 0))
+                    ret = sendFrame(ctx, FRAME_NAK, expected, NULL, 0);
+                break;
+
+            default:
+                break;
+        }
+
+        if(ret < 0)
+            return ret;
+    }
+}
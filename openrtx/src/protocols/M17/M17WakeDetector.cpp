@@ -0,0 +1,89 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <M17/M17WakeDetector.hpp>
+#include <cmath>
+
+using namespace M17;
+
+/**
+ * \internal
+ * In-phase and quadrature templates of the preamble tone, one period long.
+ */
+static float preambleI[M17WakeDetector::PREAMBLE_PERIOD];
+static float preambleQ[M17WakeDetector::PREAMBLE_PERIOD];
+
+M17WakeDetector::M17WakeDetector() : lastScore(0.0f)
+{
+    for(size_t i = 0; i < PREAMBLE_PERIOD; i++)
+    {
+        float phase  = 2.0f * M_PI * static_cast< float >(i) / PREAMBLE_PERIOD;
+        preambleI[i] = std::cos(phase);
+        preambleQ[i] = std::sin(phase);
+    }
+}
+
+M17WakeDetector::~M17WakeDetector()
+{
+
+}
+
+bool M17WakeDetector::process(const int16_t *samples, const size_t len)
+{
+    // Analyse only whole periods of the preamble tone, so that both the
+    // templates and the tone itself have zero mean over the window.
+    const size_t num = len - (len % PREAMBLE_PERIOD);
+    lastScore = 0.0f;
+    if(num == 0)
+        return false;
+
+    float mean = 0.0f;
+    for(size_t i = 0; i < num; i++)
+        mean += static_cast< float >(samples[i]);
+
+    mean /= static_cast< float >(num);
+
+    float corrI  = 0.0f;
+    float corrQ  = 0.0f;
+    float energy = 0.0f;
+    size_t phase = 0;
+
+    for(size_t i = 0; i < num; i++)
+    {
+        float sample = static_cast< float >(samples[i]) - mean;
+        corrI  += sample * preambleI[phase];
+        corrQ  += sample * preambleQ[phase];
+        energy += sample * sample;
+
+        phase += 1;
+        if(phase >= PREAMBLE_PERIOD)
+            phase = 0;
+    }
+
+    if(energy <= 0.0f)
+        return false;
+
+    // A pure tone at the preamble frequency scores exactly one
+    lastScore = 2.0f * (corrI * corrI + corrQ * corrQ)
+              / (static_cast< float >(num) * energy);
+
+    return lastScore >= THRESHOLD;
+}
@@ -51,7 +51,9 @@ void _setVolume()
 }
 #endif
 
-OpMode_FM::OpMode_FM() : rfSqlOpen(false), sqlOpen(false), enterRx(true)
+OpMode_FM::OpMode_FM() : rfSqlOpen(false), sqlOpen(false), enterRx(true),
+                         basebandPath(-1), basebandId(-1), noBaseband(false),
+                         rssiSqlOpen(false), toneSqlOpen(false)
 {
 }
 
@@ -62,9 +64,13 @@ OpMode_FM::~OpMode_FM()
 void OpMode_FM::enable()
 {
     // When starting, close squelch and prepare for entering in RX mode.
-    rfSqlOpen = false;
-    sqlOpen   = false;
-    enterRx   = true;
+    rssiSqlOpen = false;
+    rfSqlOpen   = false;
+    toneSqlOpen = false;
+    sqlOpen     = false;
+    enterRx     = true;
+    noBaseband  = false;
+    basebandBuf = std::make_unique< stream_sample_t[] >(2 * BASEBAND_BUF_SIZE);
 }
 
 void OpMode_FM::disable()
@@ -72,17 +78,22 @@ void OpMode_FM::disable()
     // Clean shutdown.
     platform_ledOff(GREEN);
     platform_ledOff(RED);
+    stopBasebandSampling();
     audioPath_release(rxAudioPath);
     audioPath_release(txAudioPath);
     radio_disableRtx();
-    rfSqlOpen = false;
-    sqlOpen   = false;
-    enterRx   = false;
+    basebandBuf.reset();
+    rssiSqlOpen = false;
+    rfSqlOpen   = false;
+    toneSqlOpen = false;
+    sqlOpen     = false;
+    enterRx     = false;
 }
 
-void OpMode_FM::update(rtxStatus_t *const status, const bool newCfg)
+long long OpMode_FM::update(rtxStatus_t *const status, const bool newCfg)
 {
     (void) newCfg;
+    bool paced = false;
 
     #if defined(PLATFORM_TTWRPLUS)
     // Set output volume by changing the HR_C6000 DAC gain
@@ -92,6 +103,10 @@ void OpMode_FM::update(rtxStatus_t *const status, const bool newCfg)
     // RX logic
     if(status->opStatus == RX)
     {
+        // Process a new block of baseband samples, if available
+        startBasebandSampling();
+        paced = processBaseband(status);
+
         // RF squelch mechanism
         // This turns squelch (0 to 15) into RSSI (-127.0dbm to -61dbm)
         rssi_t squelch = -127 + (status->sqlLevel * 66) / 15;
@@ -99,12 +114,28 @@ void OpMode_FM::update(rtxStatus_t *const status, const bool newCfg)
 
         // Provide a bit of hysteresis, only change state if the RSSI has
         // moved more than 1dBm on either side of the current squelch setting.
-        if((rfSqlOpen == false) && (rssi > (squelch + 1))) rfSqlOpen = true;
-        if((rfSqlOpen == true)  && (rssi < (squelch - 1))) rfSqlOpen = false;
+        if((rssiSqlOpen == false) && (rssi > (squelch + 1))) rssiSqlOpen = true;
+        if((rssiSqlOpen == true)  && (rssi < (squelch - 1))) rssiSqlOpen = false;
+
+        // Close to the squelch level the RSSI alone is unreliable, the carrier
+        // has also to quiet the noise on the baseband. Strong signals and the
+        // fully open squelch setting rely on the RSSI only.
+        rfSqlOpen = rssiSqlOpen;
+        if((basebandId >= 0) && (status->sqlLevel > 0) &&
+           (rssi < (squelch + STRONG_SIGNAL)))
+        {
+            rfSqlOpen = rssiSqlOpen && noiseSql.isOpen();
+        }
+
+        // Tone squelch
+        if(status->rxToneEn == 0)
+            toneSqlOpen = false;
+        else if(noBaseband)
+            toneSqlOpen = radio_checkRxDigitalSquelch();
 
         // Local flags for current RF and tone squelch status
         bool rfSql   = ((status->rxToneEn == 0) && (rfSqlOpen == true));
-        bool toneSql = ((status->rxToneEn == 1) && radio_checkRxDigitalSquelch());
+        bool toneSql = ((status->rxToneEn == 1) && toneSqlOpen);
 
         // Audio control
         if((sqlOpen == false) && (rfSql || toneSql))
@@ -132,6 +163,7 @@ void OpMode_FM::update(rtxStatus_t *const status, const bool newCfg)
     if(platform_getPttStatus() && (status->opStatus != TX) &&
                                   (status->txDisable == 0))
     {
+        stopBasebandSampling();
         audioPath_release(rxAudioPath);
         radio_disableRtx();
 
@@ -155,7 +187,7 @@ void OpMode_FM::update(rtxStatus_t *const status, const bool newCfg)
     switch(status->opStatus)
     {
         case RX:
-            if(radio_checkRxDigitalSquelch())
+            if(toneSqlOpen)
             {
                 platform_ledOn(GREEN);  // Red + green LEDs ("orange"): tone squelch open
                 platform_ledOn(RED);
@@ -184,11 +216,75 @@ void OpMode_FM::update(rtxStatus_t *const status, const bool newCfg)
             break;
     }
 
-    // Sleep thread for 30ms for 33Hz update rate
-    sleepFor(0u, 30u);
+    // 33Hz update rate, unless the update has already been paced by the
+    // arrival of a block of baseband samples.
+    long long now = getTick();
+    if(paced == false)
+        return now + UPDATE_PERIOD;
+
+    return now;
 }
 
 bool OpMode_FM::rxSquelchOpen()
 {
     return sqlOpen;
 }
+
+void OpMode_FM::startBasebandSampling()
+{
+    if((basebandId >= 0) || noBaseband)
+        return;
+
+    basebandPath = audioPath_request(SOURCE_RTX, SINK_MCU, PRIO_RX);
+    if(audioPath_getStatus(basebandPath) != PATH_OPEN)
+    {
+        // Path not available right now, retry at next update
+        audioPath_release(basebandPath);
+        return;
+    }
+
+    basebandId = audioStream_start(basebandPath, basebandBuf.get(),
+                                   2 * BASEBAND_BUF_SIZE, BASEBAND_SAMPLE_RATE,
+                                   STREAM_INPUT | BUF_CIRC_DOUBLE);
+    if(basebandId < 0)
+    {
+        // No baseband sampling on this platform
+        audioPath_release(basebandPath);
+        noBaseband = true;
+        return;
+    }
+
+    ctcss.reset();
+    noiseSql.reset();
+}
+
+void OpMode_FM::stopBasebandSampling()
+{
+    if(basebandId < 0)
+        return;
+
+    audioStream_terminate(basebandId);
+    audioPath_release(basebandPath);
+    basebandId = -1;
+}
+
+bool OpMode_FM::processBaseband(const rtxStatus_t *const status)
+{
+    if((basebandId < 0) || (audioPath_getStatus(basebandPath) != PATH_OPEN))
+        return false;
+
+    dataBlock_t baseband = inputStream_getData(basebandId);
+    if(baseband.data == NULL)
+        return false;
+
+    noiseSql.process(baseband.data, baseband.len);
+
+    if(status->rxToneEn == 1)
+    {
+        ctcss.setTone(status->rxTone);
+        ctcss.process(baseband.data, baseband.len);
+        toneSqlOpen = ctcss.toneDetected();
+    }
+
+    return true;
+}
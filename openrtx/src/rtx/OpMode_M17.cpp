@@ -25,6 +25,8 @@
 #include <M17/M17Callsign.hpp>
 #include <OpMode_M17.hpp>
 #include <audio_codec.h>
+#include <contact_index.h>
+#include <algorithm>
 #include <errno.h>
 #include <rtx.h>
 
@@ -35,6 +37,10 @@
 extern mod17Calib_t mod17CalData;
 #endif
 
+#ifdef CONFIG_M17_WAKE_STATS
+#include <stdio.h>
+#endif
+
 using namespace std;
 using namespace M17;
 
@@ -56,6 +62,12 @@ void OpMode_M17::enable()
     squelchHoldUntil = 0;
     nextRssiCheckTime = getTick();
     rfPowered = false;
+    #ifdef CONFIG_M17_WAKE_STATS
+    statStart  = getTick();
+    statOnTime = 0;
+    statWakes  = 0;
+    wakeTime   = -1;
+    #endif
     codec_init();
     modulator.init();
     demodulator.init();
@@ -107,7 +119,7 @@ void OpMode_M17::blinkLed(rtxStatus_t *const status)
    blinkOn = !blinkOn;
 }
 
-void OpMode_M17::update(rtxStatus_t *const status, const bool newCfg)
+long long OpMode_M17::update(rtxStatus_t *const status, const bool newCfg)
 {
     (void) newCfg;
     #if defined(PLATFORM_MD3x0) || defined(PLATFORM_MDUV3x0)
@@ -129,15 +141,16 @@ void OpMode_M17::update(rtxStatus_t *const status, const bool newCfg)
     invertRxPhase = (mod17CalData.bb_rx_invert == 1) ? true : false;
     #endif
 
-    // Main FSM logic
+    // Main FSM logic, TX is paced by the audio codec and by the modulator
+    long long deadline = getTick();
     switch(status->opStatus)
     {
         case OFF:
-            offState(status);
+            deadline = offState(status);
             break;
 
         case RX:
-            rxState(status);
+            deadline = rxState(status);
             break;
 
         case TX:
@@ -173,9 +186,18 @@ void OpMode_M17::update(rtxStatus_t *const status, const bool newCfg)
             platform_ledOff(RED);
             break;
     }
+
+    // Do not skip the next blink while the receiver is sleeping
+    if((status->opStatus == RX) && (dataValid == false) &&
+       (blinkTimer > getTick()) && (blinkTimer < deadline))
+    {
+        deadline = blinkTimer;
+    }
+
+    return deadline;
 }
 
-void OpMode_M17::offState(rtxStatus_t *const status)
+long long OpMode_M17::offState(rtxStatus_t *const status)
 {
     radio_disableRtx();
 
@@ -185,22 +207,21 @@ void OpMode_M17::offState(rtxStatus_t *const status)
     if(startRx)
     {
         status->opStatus = RX;
-        return;
+        return getTick();
     }
 
     if(platform_getPttStatus() && (status->txDisable == 0))
     {
         startTx = true;
         status->opStatus = TX;
-        return;
+        return getTick();
     }
 
-    // Sleep for 30ms if there is nothing else to do in order to prevent the
-    // rtx thread looping endlessly and locking up all the other tasks
-    sleepFor(0, 30);
+    // Nothing else to do, check again the PTT later
+    return getTick() + PTT_POLL_MS;
 }
 
-void OpMode_M17::rxState(rtxStatus_t *const status)
+long long OpMode_M17::rxState(rtxStatus_t *const status)
 {
 
     if(startRx)
@@ -211,56 +232,87 @@ void OpMode_M17::rxState(rtxStatus_t *const status)
         samplingActive = false;
     }
 
-    
-        // RF squelch duty-cycling and hold logic
-        long long now = getTick();
-        // Convert SQL level to RSSI threshold (-127dBm to -61dBm)
-        rssi_t threshold = -127 + (status->sqlLevel * 66) / 15;
-
-        // Keep front-end powered if squelch physically open or in hold
-        if(rfSqlOpen || now < squelchHoldUntil) {
-            if(!rfPowered) {
-                radio_enableRx();
-                rfPowered = true;
-            }
-        } else {
-            // RF front-end off; perform periodic RSSI scans
-            if(now >= nextRssiCheckTime) {
-                // Power up RF and wait to settle
-                radio_enableRx();
-                rfPowered = true;
-                sleepFor(0, RADIO_SETTLE_MS);
-                // Measure RSSI
-                rssi_t rssi = rtx_getRssi();
-                // Apply hysteresis
-                if(!rfSqlOpen && rssi > (threshold + 1)) rfSqlOpen = true;
-                if(rfSqlOpen && rssi < (threshold - 1)) rfSqlOpen = false;
-                if(rfSqlOpen) squelchHoldUntil = now + SQUELCH_HOLD_MS;
-                // Power down
-                radio_disableRtx();
-                rfPowered = false;
-                nextRssiCheckTime = now + RSSI_CHECK_INTERVAL_MS;
-            }
-            // Sleep deeply until next scan
-            sleepUntil(nextRssiCheckTime);
-            return;
-        }
-        // Determine effective squelch
-        bool sqOpen = (rfSqlOpen || now < squelchHoldUntil);
-        // Manage baseband sampling based on effective squelch
-    // Manage baseband sampling based on effective squelch
-    if(sqOpen) {
-        if(!samplingActive) {
-            demodulator.startBasebandSampling();
-            samplingActive = true;
+    // RF squelch duty-cycling and hold logic
+    long long now = getTick();
+    // Convert SQL level to RSSI threshold (-127dBm to -61dBm)
+    rssi_t threshold = -127 + (status->sqlLevel * 66) / 15;
+
+    // Keep front-end powered if squelch physically open or in hold
+    if(rfSqlOpen || now < squelchHoldUntil) {
+        if(!rfPowered) {
+            radio_enableRx();
+            rfPowered = true;
         }
+
+        // Front-end is on, keep following the RSSI
+        rssi_t rssi = rtx_getRssi();
+        if(!rfSqlOpen && rssi > (threshold + 1)) rfSqlOpen = true;
+        if(rfSqlOpen && rssi < (threshold - 1)) rfSqlOpen = false;
     } else {
+        // Squelch just closed, stop the demodulator and power down
         if(samplingActive) {
             demodulator.stopBasebandSampling();
             samplingActive = false;
+            radio_disableRtx();
+            rfPowered = false;
+            nextRssiCheckTime = now + WAKE_PERIOD_MS;
         }
-        // No sampling -> skip DSP processing
-        return;
+
+        // RF front-end off; perform periodic wake-up scans
+        if(now >= nextRssiCheckTime) {
+            // Power up RF and wait to settle
+            radio_enableRx();
+            rfPowered = true;
+            sleepFor(0, RADIO_SETTLE_MS);
+            // Measure RSSI
+            rssi_t rssi = rtx_getRssi();
+            // Apply hysteresis
+            if(!rfSqlOpen && rssi > (threshold + 1)) rfSqlOpen = true;
+            if(rfSqlOpen && rssi < (threshold - 1)) rfSqlOpen = false;
+            if(rfSqlOpen) squelchHoldUntil = now + SQUELCH_HOLD_MS;
+            // Search for an M17 preamble too, catching signals below the
+            // RSSI threshold
+            if(!rfSqlOpen && detectPreamble()) {
+                squelchHoldUntil = getTick() + SQUELCH_HOLD_MS;
+                #ifdef CONFIG_M17_WAKE_STATS
+                wakeTime = now;
+                #endif
+            }
+            #ifdef CONFIG_M17_WAKE_STATS
+            statOnTime += getTick() - now;
+            statWakes  += 1;
+            if((now - statStart) >= 10000) {
+                long long elapsed = now - statStart;
+                printf("M17 wake: %u scans in %lld ms, duty-cycled RX current %lld%% of continuous RX\n",
+                       statWakes, elapsed, (100 * statOnTime) / elapsed);
+                statStart  = now;
+                statOnTime = 0;
+                statWakes  = 0;
+            }
+            #endif
+            // Keep the front-end on if the demodulator has to be started
+            if(rfSqlOpen || getTick() < squelchHoldUntil) return getTick();
+            // Power down
+            radio_disableRtx();
+            rfPowered = false;
+            nextRssiCheckTime = now + WAKE_PERIOD_MS;
+        }
+        // Going to TX is handled by the OFF state
+        if(platform_getPttStatus() && (status->txDisable == 0)) {
+            radio_disableRtx();
+            rfPowered = false;
+            status->opStatus = OFF;
+            return getTick();
+        }
+
+        // Sleep deeply until next scan, still polling the PTT
+        return std::min(nextRssiCheckTime, now + PTT_POLL_MS);
+    }
+
+    // Manage baseband sampling based on effective squelch
+    if(!samplingActive) {
+        demodulator.startBasebandSampling();
+        samplingActive = true;
     }
 
     bool newData = demodulator.update(invertRxPhase);
@@ -271,8 +323,20 @@ void OpMode_M17::rxState(rtxStatus_t *const status)
     {
         decoder.reset();
         locked = lock;
+
+        #ifdef CONFIG_M17_WAKE_STATS
+        if(wakeTime >= 0)
+            printf("M17 wake: preamble detected, demodulator locked after %lld ms\n",
+                   getTick() - wakeTime);
+        wakeTime = -1;
+        #endif
     }
 
+    // Keep the receiver awake while locked on a signal, also when it is below
+    // the RSSI squelch threshold
+    if(lock)
+        squelchHoldUntil = now + SQUELCH_HOLD_MS;
+
     if(locked)
     {
         // Process new data
@@ -325,6 +389,12 @@ void OpMode_M17::rxState(rtxStatus_t *const status)
                 else
                     strncpy(status->M17_src, src.c_str(), 10);
 
+                // Resolve the source to a contact, the UI shows its name
+                call_t srcAddr;
+                status->M17_srcContact = -1;
+                if(encode_callsign(std::string(status->M17_src), srcAddr))
+                    status->M17_srcContact = contactIndex_lookupM17(srcAddr.data());
+
                 // Check CAN on RX, if enabled.
                 // If check is disabled, force match to true.
                 bool canMatch =  (streamType.fields.CAN == status->can)
@@ -374,10 +444,43 @@ void OpMode_M17::rxState(rtxStatus_t *const status)
         extendedCall  = false;
         status->M17_link[0] = '\0';
         status->M17_refl[0] = '\0';
+        status->M17_srcContact = -1;
 
         codec_stop(rxAudioPath);
         audioPath_release(rxAudioPath);
     }
+
+    // Paced by the demodulator, waiting for a block of baseband samples
+    return getTick();
+}
+
+bool OpMode_M17::detectPreamble()
+{
+    pathId path = audioPath_request(SOURCE_RTX, SINK_MCU, PRIO_RX);
+    if(audioPath_getStatus(path) != PATH_OPEN)
+    {
+        audioPath_release(path);
+        return false;
+    }
+
+    streamId id = audioStream_start(path, wakeBuf.data(), wakeBuf.size(),
+                                    M17WakeDetector::SAMPLE_RATE,
+                                    STREAM_INPUT | BUF_LINEAR);
+    if(id < 0)
+    {
+        audioPath_release(path);
+        return false;
+    }
+
+    bool detected = false;
+    dataBlock_t baseband = inputStream_getData(id);
+    if(baseband.data != NULL)
+        detected = wakeDetector.process(baseband.data, baseband.len);
+
+    audioStream_terminate(id);
+    audioPath_release(path);
+
+    return detected;
 }
 
 void OpMode_M17::txLog(rtxStatus_t *const status)
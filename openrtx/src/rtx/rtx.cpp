@@ -21,13 +21,37 @@
 #include <interfaces/radio.h>
 #include <hwconfig.h>
 #include <string.h>
+#include <time.h>
 #include <rtx.h>
+#include <seqlock.hpp>
+#include <atomic>
 #include <OpMode_FM.hpp>
 #include <OpMode_M17.hpp>
 
+// RTX status flags written by the UI thread
+enum UiFlag
+{
+    UI_HISTORY     = 1 << 0,
+    UI_NIGHT_MODE  = 1 << 1,
+    UI_SHOW_SMETER = 1 << 2,
+    UI_MENU_ACTIVE = 1 << 3
+};
+
+#ifdef _MIOSIX
+#define CFG_POLL_PERIOD 30  // Maximum config pickup latency, in ms
+#endif
+
 static pthread_mutex_t   *cfgMutex;     // Mutex for incoming config messages
-static const rtxStatus_t *newCnf;       // Pointer for incoming config messages
+static pthread_cond_t     cfgCond;      // Signalled on incoming config messages
+static uint32_t           cfgGen;       // Generation of the last applied config
+static long long          nextUpdate;   // Deadline of the current opMode update
 static rtxStatus_t        rtxStatus;    // RTX driver status
+static rtxStatus_t        lastStatus;   // Last published RTX driver status
+
+static SeqLock< rtxStatus_t > cfgSnap;      // Incoming config messages
+static SeqLock< rtxStatus_t > statusSnap;   // RTX status published to readers
+static std::atomic< uint8_t > uiFlags;      // UI flags set from other threads
+static std::atomic< uint8_t > uiFlagsSet;   // UI flags written since last read
 static rssi_t             rssi;         // Current RSSI in dBm
 static bool               reinitFilter; // Flag for RSSI filter re-initialisation
 
@@ -38,12 +62,84 @@ static OpMode_FM  fmMode;               // FM mode handler
 static OpMode_M17 m17Mode;              // M17 mode handler
 #endif
 
+/**
+ * \internal
+ * Set one of the flags written by the UI thread, to be copied in the RTX
+ * status by the RTX task.
+ */
+static void setUiFlag(const uint8_t flag, const bool value)
+{
+    if(value)
+        uiFlags.fetch_or(flag);
+    else
+        uiFlags.fetch_and(~flag);
+
+    uiFlagsSet.fetch_or(flag);
+}
+
+/**
+ * \internal
+ * Copy in the RTX status the UI flags written since the last call.
+ */
+static void applyUiFlags()
+{
+    uint8_t set = uiFlagsSet.exchange(0);
+    if(set == 0)
+        return;
+
+    uint8_t value = uiFlags.load();
+    if(set & UI_HISTORY)     rtxStatus.historyEnabled = (value & UI_HISTORY) != 0;
+    if(set & UI_NIGHT_MODE)  rtxStatus.nightMode      = (value & UI_NIGHT_MODE) != 0;
+    if(set & UI_SHOW_SMETER) rtxStatus.showSMeter     = (value & UI_SHOW_SMETER) != 0;
+    if(set & UI_MENU_ACTIVE) rtxStatus.menuActive     = (value & UI_MENU_ACTIVE) != 0;
+}
+
+/**
+ * \internal
+ * Wait until a new configuration is posted or the deadline expires. Called
+ * with the configuration mutex locked, returns with the mutex locked.
+ *
+ * @param deadline: wait deadline, in ms since boot.
+ */
+static void waitConfig(const long long deadline)
+{
+    #ifdef _MIOSIX
+    // The kernel has no timed wait on condition variables: sleep in slices
+    // short enough to pick up a new configuration within CFG_POLL_PERIOD ms,
+    // the caller checks for it after each slice.
+    long long wakeup = getTick() + CFG_POLL_PERIOD;
+    if(wakeup > deadline)
+        wakeup = deadline;
+
+    pthread_mutex_unlock(cfgMutex);
+    sleepUntil(wakeup);
+    pthread_mutex_lock(cfgMutex);
+    #else
+    long long delta = deadline - getTick();
+    if(delta <= 0)
+        return;
+
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec  += delta / 1000;
+    ts.tv_nsec += (delta % 1000) * 1000000;
+    if(ts.tv_nsec >= 1000000000)
+    {
+        ts.tv_sec  += 1;
+        ts.tv_nsec -= 1000000000;
+    }
+
+    pthread_cond_timedwait(&cfgCond, cfgMutex, &ts);
+    #endif
+}
 
 void rtx_init(pthread_mutex_t *m)
 {
     // Initialise mutex for configuration access
-    cfgMutex = m;
-    newCnf   = NULL;
+    cfgMutex   = m;
+    cfgGen     = 0;
+    nextUpdate = 0;
+    pthread_cond_init(&cfgCond, NULL);
 
     /*
      * Default initialisation for rtx status
@@ -66,6 +162,7 @@ void rtx_init(pthread_mutex_t *m)
     rtxStatus.M17_dst[0]    = '\0';
     rtxStatus.M17_link[0]   = '\0';
     rtxStatus.M17_refl[0]   = '\0';
+    rtxStatus.M17_srcContact = -1;
     rtxStatus.historyEnabled = false;
     rtxStatus.notificationsEnabled = true;
     rtxStatus.nightMode = true;
@@ -82,6 +179,9 @@ void rtx_init(pthread_mutex_t *m)
      */
     rssi         = radio_getRssi();
     reinitFilter = false;
+
+    lastStatus = rtxStatus;
+    statusSnap.publish(lastStatus);
 }
 
 void rtx_terminate()
@@ -90,6 +190,7 @@ void rtx_terminate()
     rtxStatus.opMode   = OPMODE_NONE;
     currMode->disable();
     radio_terminate();
+    pthread_cond_destroy(&cfgCond);
 }
 
 void rtx_configure(const rtxStatus_t *cfg)
@@ -100,36 +201,51 @@ void rtx_configure(const rtxStatus_t *cfg)
      * always gets the most recent configuration.
      */
 
+    cfgSnap.publish(*cfg);
+
     pthread_mutex_lock(cfgMutex);
-    newCnf = cfg;
+    pthread_cond_signal(&cfgCond);
     pthread_mutex_unlock(cfgMutex);
 }
 
 rtxStatus_t rtx_getCurrentStatus()
 {
-    return rtxStatus;
+    rtxStatus_t status;
+    statusSnap.read(status);
+
+    return status;
+}
+
+uint32_t rtx_getStatusGeneration()
+{
+    return statusSnap.generation();
 }
 
 void rtx_task()
 {
-    // Check if there is a pending new configuration and, in case, read it.
+    // Wait for the deadline of the current opMode or for a new configuration,
+    // whichever comes first, and read the configuration if present.
     bool reconfigure = false;
-    if(pthread_mutex_trylock(cfgMutex) == 0)
-    {
-        if(newCnf != NULL)
-        {
-            // Copy new configuration and override opStatus flags
-            uint8_t tmp = rtxStatus.opStatus;
-            memcpy(&rtxStatus, newCnf, sizeof(rtxStatus_t));
-            rtxStatus.opStatus = tmp;
+    pthread_mutex_lock(cfgMutex);
 
-            reconfigure = true;
-            newCnf = NULL;
-        }
+    while((cfgSnap.generation() == cfgGen) && (getTick() < nextUpdate))
+        waitConfig(nextUpdate);
+
+    pthread_mutex_unlock(cfgMutex);
+
+    if(cfgSnap.generation() != cfgGen)
+    {
+        // Copy new configuration and override opStatus flags
+        uint8_t tmp = rtxStatus.opStatus;
+        cfgGen = cfgSnap.read(rtxStatus);
+        rtxStatus.opStatus = tmp;
 
-        pthread_mutex_unlock(cfgMutex);
+        reconfigure = true;
     }
 
+    // Flags written by the UI after the configuration take precedence
+    applyUiFlags();
+
     if(reconfigure)
     {
         // Force TX and RX tone squelch to off for OpModes different from FM.
@@ -224,7 +340,14 @@ void rtx_task()
      * Call is placed after RSSI update to allow handler's code have a fresh
      * version of the RSSI level.
      */
-    currMode->update(&rtxStatus, reconfigure);
+    nextUpdate = currMode->update(&rtxStatus, reconfigure);
+
+    // Publish the new status, if changed
+    if(memcmp(&rtxStatus, &lastStatus, sizeof(rtxStatus_t)) != 0)
+    {
+        lastStatus = rtxStatus;
+        statusSnap.publish(lastStatus);
+    }
 }
 
 rssi_t rtx_getRssi()
@@ -237,22 +360,22 @@ bool rtx_rxSquelchOpen()
     return currMode->rxSquelchOpen();
 }
 
-void    rtx_setHistory(bool value)
+void rtx_setHistory(bool value)
 {
-    rtxStatus.historyEnabled = value;
+    setUiFlag(UI_HISTORY, value);
 }
 
 void rtx_setNightMode(bool value)
 {
-    rtxStatus.nightMode = value;
+    setUiFlag(UI_NIGHT_MODE, value);
 }
 
 void rtx_setShowSMeter(bool value)
 {
-    rtxStatus.showSMeter = value;
+    setUiFlag(UI_SHOW_SMETER, value);
 }
 
 void rtx_setMenuActive(bool value)
 {
-    rtxStatus.menuActive = value;
+    setUiFlag(UI_MENU_ACTIVE, value);
 }
@@ -65,7 +65,9 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <math.h>
+#include <pthread.h>
 #include <ui/ui_default.h>
+#include <ui/ui_widget.h>
 #include <rtx.h>
 #include <interfaces/platform.h>
 #include <interfaces/display.h>
@@ -90,6 +92,7 @@ extern void _ui_drawMEMBottom();
 extern void _ui_drawMainVFO(ui_state_t* ui_state);
 extern void _ui_drawMainVFOInput(ui_state_t* ui_state);
 extern void _ui_drawMainMEM(ui_state_t* ui_state);
+extern void _ui_layoutMainWidgets();
 /* UI menu functions, their implementation is in "ui_menu.c" */
 extern void _ui_drawMenuTop(ui_state_t* ui_state);
 extern void _ui_drawMenuBank(ui_state_t* ui_state);
@@ -118,6 +121,7 @@ extern void _ui_drawSettingsReset2Defaults(ui_state_t* ui_state);
 extern void _ui_drawSettingsRadio(ui_state_t* ui_state);
 extern bool _ui_drawMacroMenu(ui_state_t* ui_state);
 extern void _ui_reset_menu_anouncement_tracking();
+extern void _ui_layoutMenuWidgets();
 
 const char *menu_items[] =
 {
@@ -297,14 +301,21 @@ static ui_state_t ui_state;
 static bool macro_menu = false;
 static bool layout_ready = false;
 static bool redraw_needed = true;
+static bool full_redraw = true;
+static uint32_t state_changes = STATE_CHG_ALL;
+static uint8_t drawn_screen = 0xFF;
 
 static bool standby = false;
 static long long last_event_tick = 0;
 
-// UI event queue
+// UI event queue: keyboard events are queued, status events are coalesced
+// into a single pending flag so that they can't crowd out the key presses.
+static pthread_mutex_t evQueue_mutex = PTHREAD_MUTEX_INITIALIZER;
 static uint8_t evQueue_rdPos;
 static uint8_t evQueue_wrPos;
 static event_t evQueue[MAX_NUM_EVENTS];
+static bool    evStatusPending;
+static uint32_t evStatusChanges;
 
 
 static void _ui_calculateLayout(layout_t *layout)
@@ -1190,6 +1201,20 @@ static void _ui_textInputDel(char *buf)
     ui_state.input_set = 0;
 }
 
+/**
+ * \internal
+ * Select, in the channel menu, the first channel whose name starts with the
+ * text typed so far.
+ */
+static void _ui_channelSearch(kbd_msg_t msg)
+{
+    _ui_textInputKeypad(ui_state.search_prefix, 9, msg, true);
+
+    int pos = cps_findChannelByName(ui_state.search_prefix);
+    if((pos >= 0) && (pos <= UINT8_MAX))
+        ui_state.menu_selected = pos;
+}
+
 static void _ui_numberInputKeypad(uint32_t *num, kbd_msg_t msg)
 {
     long long now = getTick();
@@ -1263,6 +1288,8 @@ void ui_init()
     last_event_tick = getTick();
     redraw_needed = true;
     _ui_calculateLayout(&layout);
+    _ui_layoutMainWidgets();
+    _ui_layoutMenuWidgets();
     layout_ready = true;
     // Initialize struct ui_state to all zeroes
     // This syntax is called compound literal
@@ -1298,6 +1325,19 @@ void ui_drawSplashScreen()
 
 void ui_saveState()
 {
+    // Flag the changes to the fields not updated by the state task
+    if((memcmp(&last_state.channel, &state.channel, sizeof(channel_t)) != 0) ||
+       (last_state.channel_index != state.channel_index) ||
+       (last_state.bank_enabled  != state.bank_enabled)  ||
+       (last_state.bank          != state.bank)          ||
+       (last_state.rtxStatus     != state.rtxStatus))
+    {
+        state_changes |= STATE_CHG_CHANNEL;
+    }
+
+    if(memcmp(&last_state.settings, &state.settings, sizeof(settings_t)) != 0)
+        state_changes |= STATE_CHG_SETTINGS;
+
     last_state = state;
 }
 
@@ -1364,21 +1404,95 @@ static vpGPSInfoFlags_t GetGPSDirectionOrSpeedChanged()
 }
 #endif // CONFIG_GPS
 
-void ui_updateFSM(bool *sync_rtx)
+/**
+ * \internal
+ * Pop an event from the UI event queue. Keyboard events are returned first, in
+ * order of arrival, then the pending status event, if any.
+ *
+ * @param event: pointer to the event to be filled.
+ * @return true if an event has been popped, false if the queue is empty.
+ */
+static bool _ui_popEvent(event_t *event)
+{
+    bool popped = true;
+
+    pthread_mutex_lock(&evQueue_mutex);
+
+    if(evQueue_rdPos != evQueue_wrPos)
+    {
+        *event        = evQueue[evQueue_rdPos];
+        evQueue_rdPos = (evQueue_rdPos + 1) % MAX_NUM_EVENTS;
+    }
+    else if(evStatusPending)
+    {
+        event->type     = EVENT_STATUS;
+        event->payload  = evStatusChanges;
+        evStatusPending = false;
+        evStatusChanges = 0;
+    }
+    else
+    {
+        popped = false;
+    }
+
+    pthread_mutex_unlock(&evQueue_mutex);
+
+    return popped;
+}
+
+#ifdef CONFIG_M17
+/**
+ * \internal
+ * Record the source of a newly received M17 stream in the history, once per
+ * stream.
+ */
+static void _ui_updateHistory()
 {
-    // Check for events
-    if(evQueue_wrPos == evQueue_rdPos) return;
+    static bool lastLsfOk = false;
+    static char lastSrc[10];
+
+    rtxStatus_t rtxStatus = rtx_getCurrentStatus();
+    bool newStream = rtxStatus.lsfOk &&
+                     ((lastLsfOk == false) ||
+                      (strncmp(rtxStatus.M17_src, lastSrc, 10) != 0));
+
+    lastLsfOk = rtxStatus.lsfOk;
+    strncpy(lastSrc, rtxStatus.M17_src, 10);
 
-    // Pop an event from the queue
-    uint8_t newTail = (evQueue_rdPos + 1) % MAX_NUM_EVENTS;
-    event_t event   = evQueue[evQueue_rdPos];
-    evQueue_rdPos   = newTail;
+    if(newStream == false)
+        return;
+
+    bool isInfo = (strncmp(rtxStatus.M17_dst, "INFO", 4) == 0);
+    bool isEcho = (strncmp(rtxStatus.M17_dst, "ECHO", 4) == 0);
+    bool isSelf = (strncmp(rtxStatus.M17_src, state.settings.callsign, 8) == 0);
+
+    if (!isInfo && !isEcho && !isSelf) {
+        datetime_t local_time = utcToLocalTime(state.time,
+                                               state.settings.utc_timezone);
+        history_add(rtxStatus.M17_src, local_time);
+    }
+}
+#endif
 
+static void _ui_fsm_processEvent(event_t event, bool *sync_rtx)
+{
     // There is some event to process, we need an UI redraw.
     // UI redraw request is cancelled if we're in standby mode.
     redraw_needed = true;
     if(standby) redraw_needed = false;
 
+    // Key presses can change anything on screen, status updates only the
+    // elements depending on the state fields they flag as changed.
+    if(event.type == EVENT_STATUS)
+        state_changes |= event.payload;
+    else
+        full_redraw = true;
+
+    #ifdef CONFIG_M17
+    if((event.type == EVENT_STATUS) && (event.payload & STATE_CHG_RTX_STATUS))
+        _ui_updateHistory();
+    #endif
+
     // Check if battery has enough charge to operate.
     // Check is skipped if there is an ongoing transmission, since the voltage
     // drop caused by the RF PA power absorption causes spurious triggers of
@@ -1841,6 +1955,17 @@ void ui_updateFSM(bool *sync_rtx)
                     }
                     // Reset menu selection
                     ui_state.menu_selected = 0;
+
+                    // Start from the channel nearest to the current frequency
+                    if(state.ui_screen == MENU_CHANNEL)
+                    {
+                        int pos = cps_findChannelByFreq(state.channel.rx_frequency);
+                        if((pos >= 0) && (pos <= UINT8_MAX))
+                            ui_state.menu_selected = pos;
+
+                        _ui_textInputReset(ui_state.search_prefix);
+                        ui_state.search_prefix[0] = '\0';
+                    }
                 }
                 else if(msg.keys & KEY_ESC)
                     _ui_menuBack(ui_state.last_main_state);
@@ -1914,6 +2039,12 @@ void ui_updateFSM(bool *sync_rtx)
                         state.ui_screen = MAIN_MEM;
                     }
                 }
+                else if((state.ui_screen == MENU_CHANNEL) &&
+                        input_isNumberPressed(msg))
+                {
+                    // Typing a name jumps to the matching channel
+                    _ui_channelSearch(msg);
+                }
                 else if(msg.keys & KEY_ESC)
                     _ui_menuBack(MENU_TOP);
                 break;
@@ -2574,14 +2705,36 @@ void ui_updateFSM(bool *sync_rtx)
             if(last_state.volume_changed) state.volume_changed = false;
             return;
         }
-
-        if (_ui_checkStandby(now - last_event_tick))
-        {
-            _ui_enterStandby();
-        }
     }
 }
 
+void ui_updateFSM(bool *sync_rtx)
+{
+    event_t event;
+
+    // Process all the pending events, the screen is redrawn only once
+    while(_ui_popEvent(&event))
+        _ui_fsm_processEvent(event, sync_rtx);
+
+    // Status events are sent only on changes, check the standby timer here
+    if(_ui_checkStandby(getTick() - last_event_tick))
+        _ui_enterStandby();
+}
+
+bool ui_eventPending()
+{
+    pthread_mutex_lock(&evQueue_mutex);
+    bool pending = (evQueue_rdPos != evQueue_wrPos) || evStatusPending;
+    pthread_mutex_unlock(&evQueue_mutex);
+
+    return pending;
+}
+
+bool ui_isStandby()
+{
+    return standby;
+}
+
 bool ui_updateGUI()
 {
     if(redraw_needed == false)
@@ -2590,9 +2743,18 @@ bool ui_updateGUI()
     if(!layout_ready)
     {
         _ui_calculateLayout(&layout);
+        _ui_layoutMainWidgets();
+        _ui_layoutMenuWidgets();
         layout_ready = true;
     }
 
+    // Redraw the whole screen when changing page, after a key press or with
+    // the macro menu overlay, otherwise only the widgets whose inputs changed.
+    bool full = full_redraw || macro_menu || (last_state.ui_screen != drawn_screen);
+    widget_beginFrame(full, state_changes);
+    if(full)
+        gfx_clearScreen();
+
     rtx_setMenuActive(!(last_state.ui_screen == MAIN_VFO || last_state.ui_screen == MAIN_VFO_INPUT));
     // Draw current GUI page
     switch(last_state.ui_screen)
@@ -2706,30 +2868,55 @@ bool ui_updateGUI()
     // If MACRO menu is active draw it
     if(macro_menu)
     {
+        // The overlay clears the screen, start a new full frame
         _ui_drawDarkOverlay();
+        widget_beginFrame(true, STATE_CHG_ALL);
         _ui_drawMacroMenu(&ui_state);
     }
 
+    drawn_screen  = last_state.ui_screen;
+    full_redraw   = false;
+    state_changes = 0;
     redraw_needed = false;
     return true;
 }
 
 bool ui_pushEvent(const uint8_t type, const uint32_t data)
 {
-    uint8_t newHead = (evQueue_wrPos + 1) % MAX_NUM_EVENTS;
+    bool pushed = true;
 
-    // Queue is full
-    if(newHead == evQueue_rdPos) return false;
+    pthread_mutex_lock(&evQueue_mutex);
 
-    // Preserve atomicity when writing the new element into the queue.
-    event_t event;
-    event.type    = type;
-    event.payload = data;
+    if(type == EVENT_STATUS)
+    {
+        // Status events carry the mask of the changed state fields, one
+        // pending is enough
+        evStatusPending  = true;
+        evStatusChanges |= data;
+    }
+    else
+    {
+        uint8_t newHead = (evQueue_wrPos + 1) % MAX_NUM_EVENTS;
 
-    evQueue[evQueue_wrPos] = event;
-    evQueue_wrPos = newHead;
+        if(newHead != evQueue_rdPos)
+        {
+            event_t event;
+            event.type    = type;
+            event.payload = data;
 
-    return true;
+            evQueue[evQueue_wrPos] = event;
+            evQueue_wrPos = newHead;
+        }
+        else
+        {
+            // Queue is full
+            pushed = false;
+        }
+    }
+
+    pthread_mutex_unlock(&evQueue_mutex);
+
+    return pushed;
 }
 
 void ui_terminate()
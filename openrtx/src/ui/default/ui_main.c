@@ -26,6 +26,70 @@
 #include <string.h>
 #include <ui/ui_strings.h>
 #include <utils.h>
+#include <ui/ui_widget.h>
+
+/*
+ * The main screens are split in horizontal bands, each one being a widget
+ * redrawn only when the data shown inside it changes.
+ */
+enum mainWidgets
+{
+    MAIN_TOP = 0,       // Top status bar
+    MAIN_LINE1,         // First text line
+    MAIN_LINE2,         // Second text line
+    MAIN_LINE34,        // Frequency or third and fourth text lines
+    MAIN_INPUT_RX,      // RX frequency input line
+    MAIN_INPUT_TX,      // TX frequency input line
+    MAIN_BOTTOM,        // S-meter, volume and squelch bar
+    MAIN_NUM_WIDGETS
+};
+
+static widget_t widgets[MAIN_NUM_WIDGETS];
+
+/**
+ * \internal
+ * Set the area of a widget spanning the whole screen width.
+ */
+static void _ui_setBand(enum mainWidgets widget, int16_t startRow, int16_t endRow)
+{
+    point_t  pos    = {0, startRow};
+    uint16_t height = (endRow > startRow) ? (endRow - startRow) : 0;
+    widget_setArea(&widgets[widget], pos, CONFIG_SCREEN_WIDTH, height);
+}
+
+/**
+ * \internal
+ * Compute the row after the end of a text line, including the glyph
+ * descenders below the baseline.
+ */
+static int16_t _ui_lineEnd(point_t pos, fontSize_t font)
+{
+    return pos.y + gfx_getFontDescent(font);
+}
+
+void _ui_layoutMainWidgets()
+{
+    int16_t bottomRow = CONFIG_SCREEN_HEIGHT - layout.bottom_h - layout.bottom_pad;
+    int16_t line1End  = _ui_lineEnd(layout.line1_pos, layout.line1_font);
+    int16_t line2End  = _ui_lineEnd(layout.line2_pos, layout.line2_font);
+    int16_t inputEnd  = _ui_lineEnd(layout.line2_pos, layout.input_font);
+    int16_t line4End  = _ui_lineEnd(layout.line4_pos, layout.line4_font);
+    int16_t freqEnd   = _ui_lineEnd(layout.line3_large_pos, layout.line3_large_font);
+
+    if(freqEnd > line4End)
+        line4End = freqEnd;
+
+    if(line4End > bottomRow)
+        line4End = bottomRow;
+
+    _ui_setBand(MAIN_TOP,      0,            layout.top_h);
+    _ui_setBand(MAIN_LINE1,    layout.top_h, line1End);
+    _ui_setBand(MAIN_LINE2,    line1End,     line2End);
+    _ui_setBand(MAIN_LINE34,   line2End,     line4End);
+    _ui_setBand(MAIN_INPUT_RX, layout.top_h, inputEnd);
+    _ui_setBand(MAIN_INPUT_TX, inputEnd,     bottomRow);
+    _ui_setBand(MAIN_BOTTOM,   bottomRow,    CONFIG_SCREEN_HEIGHT);
+}
 
 void _ui_drawMainBackground()
 {
@@ -37,24 +101,46 @@ void _ui_drawMainBackground()
 
 void _ui_drawMainTop(ui_state_t * ui_state)
 {
+    // History entries are added when the RTX status reports a new M17 stream
+    if(widget_needsCheck(STATE_CHG_TIME | STATE_CHG_BATTERY |
+                         STATE_CHG_SETTINGS | STATE_CHG_RTX_STATUS) == false)
+        return;
+
+    bool     newHistory = false;
+    uint32_t inputs     = WIDGET_HASH_INIT;
+
+    if(last_state.settings.history_enabled)
+    {
+        newHistory = is_new_history();
+        rtx_setHistory(newHistory);
+    }
 
 #ifdef CONFIG_RTC
-    // Print clock on top bar
     datetime_t local_time = utcToLocalTime(last_state.time,
                                            last_state.settings.utc_timezone);
+    inputs = widget_hash(inputs, &local_time, sizeof(local_time));
+#endif
+#ifdef CONFIG_BAT_NONE
+    inputs = widget_hash(inputs, &last_state.v_bat, sizeof(last_state.v_bat));
+#else
+    inputs = widget_hash(inputs, &last_state.settings.display_battery,
+                         sizeof(last_state.settings.display_battery));
+    inputs = widget_hash(inputs, &last_state.charge, sizeof(last_state.charge));
+#endif
+    inputs = widget_hash(inputs, &ui_state->input_locked,
+                         sizeof(ui_state->input_locked));
+    inputs = widget_hash(inputs, &last_state.settings.history_enabled,
+                         sizeof(last_state.settings.history_enabled));
+    inputs = widget_hash(inputs, &newHistory, sizeof(newHistory));
+
+    if(widget_update(&widgets[MAIN_TOP], inputs) == false)
+        return;
+
+#ifdef CONFIG_RTC
+    // Print clock on top bar
     gfx_print(layout.top_pos, layout.top_font, TEXT_ALIGN_CENTER,
               color_darkRed, "%02d:%02d:%02d", local_time.hour,
               local_time.minute, local_time.second);
-
-    // if(history_size(history_list)==0) {
-    //     history_add(history_list, "M0VVA", "NONE", local_time);
-    //     history_add(history_list, "G4XIX", "NONE", local_time);
-    //     history_add(history_list, "M7TFT", "NONE", local_time);
-    //     history_add(history_list, "G0WCZ", "NONE", local_time);
-    //     history_add(history_list, "2E0MXA", "NONE", local_time);
-    //     history_add(history_list, "MM7RBK", "NONE", local_time);
-    // }
-
 #endif
 
     // If the radio has no built-in battery, print input voltage
@@ -84,26 +170,37 @@ void _ui_drawMainTop(ui_state_t * ui_state)
     if (last_state.settings.history_enabled)
     {
         gfx_print(list_pos , layout.line1_font, TEXT_ALIGN_LEFT,
-            is_new_history() ? yellow_fab413 : color_black, "H");
-//            yellow_fab413, "H%d", history_size(history_list));
-        rtx_setHistory(is_new_history());
+            newHistory ? yellow_fab413 : color_black, "H");
     }
 }
 
-void _ui_drawBankChannel()
+/**
+ * \internal
+ * Format the bank number, channel number and channel name line.
+ */
+static void _ui_formatBankChannel(char *buf, size_t len)
 {
-    // Print Bank number, channel number and Channel name
     uint16_t b = (last_state.bank_enabled) ? last_state.bank : 0;
-    gfx_print(layout.line1_pos, layout.line1_font, TEXT_ALIGN_CENTER,
-              color_white, "%01d-%03d: %.12s",
-              b, last_state.channel_index + 1, last_state.channel.name);
+    sniprintf(buf, len, "%01d-%03d: %.12s", b, last_state.channel_index + 1,
+              last_state.channel.name);
 }
 
-void _ui_drawModeInfo(ui_state_t* ui_state)
+/**
+ * \internal
+ * Format the mode information line: bandwidth and tones for FM, talkgroup for
+ * DMR and destination for M17 when no stream is being received.
+ */
+static void _ui_formatModeInfo(ui_state_t* ui_state, char *buf, size_t len)
 {
     char bw_str[8] = { 0 };
     char encdec_str[9] = { 0 };
 
+    #ifndef CONFIG_M17
+    (void) ui_state;
+    #endif
+
+    buf[0] = '\0';
+
     switch(last_state.channel.mode)
     {
         case OPMODE_FM:
@@ -127,134 +224,196 @@ void _ui_drawModeInfo(ui_state_t* ui_state)
             else
                 sniprintf(encdec_str, 9, "  ");
 
-            // Print Bandwidth, Tone and encdec info
+            // Bandwidth, Tone and encdec info
             if (tone_tx_enable || tone_rx_enable)
             {
                 uint16_t tone = ctcss_tone[last_state.channel.fm.txTone];
-                gfx_print(layout.line2_pos, layout.line2_font, TEXT_ALIGN_CENTER,
-                          color_white, "%s %d.%d %s", bw_str, (tone / 10),
+                sniprintf(buf, len, "%s %d.%d %s", bw_str, (tone / 10),
                           (tone % 10), encdec_str);
             }
             else
             {
-                gfx_print(layout.line2_pos, layout.line2_font, TEXT_ALIGN_CENTER,
-                          color_white, "%s", bw_str );
+                sniprintf(buf, len, "%s", bw_str);
             }
             break;
 
         case OPMODE_DMR:
-            // Print talkgroup
-            gfx_print(layout.line2_pos, layout.line2_font, TEXT_ALIGN_CENTER,
-                    color_white, "DMR TG%s", "");
+            // Talkgroup
+            sniprintf(buf, len, "DMR TG%s", "");
             break;
 
         #ifdef CONFIG_M17
         case OPMODE_M17:
         {
-            // if(history_size(history_list) == 0) {
-            //     // Add some sample data
-                // history_add(history_list, "M0VVA", "MOD_A", utcToLocalTime(last_state.time, last_state.settings.utc_timezone));
-            //     history_add(history_list, "G4XIX", "MOD_B", utcToLocalTime(last_state.time, last_state.settings.utc_timezone));
-            //     // Cleanup above
-            // }
-
-            // Print M17 Destination ID on line 3 of 3
             rtxStatus_t rtxStatus = rtx_getCurrentStatus();
 
-            if(rtxStatus.lsfOk)
+            const char *dst = NULL;
+            if(ui_state->edit_mode)
             {
-                // Destination address
-                gfx_drawSymbol(layout.line2_pos, layout.line2_symbol_size, TEXT_ALIGN_LEFT,
-                               color_white, SYMBOL_CALL_RECEIVED);
-
-                gfx_print(layout.line2_pos, layout.line2_font, TEXT_ALIGN_CENTER,
-                          yellow_fab413, "%s", rtxStatus.M17_dst);
-
-                // Source address
-                gfx_drawSymbol(layout.line1_pos, layout.line1_symbol_size, TEXT_ALIGN_LEFT,
-                               color_white, SYMBOL_CALL_MADE);
-
-                gfx_print(layout.line1_pos, layout.line2_font, TEXT_ALIGN_CENTER,
-                          color_white, "%s", rtxStatus.M17_src);
-
-                // RF link (if present)
-                if(rtxStatus.M17_link[0] != '\0')
-                {
-                    gfx_drawSymbol(layout.line4_pos, layout.line3_symbol_size, TEXT_ALIGN_LEFT,
-                                   color_white, SYMBOL_ACCESS_POINT);
-
-                    gfx_print(layout.line4_pos, layout.line2_font, TEXT_ALIGN_CENTER,
-                              color_blue, "%s", rtxStatus.M17_link);
-                }
-
-                // Reflector (if present)
-                if(rtxStatus.M17_refl[0] != '\0')
-                {
-                    gfx_drawSymbol(layout.line3_pos, layout.line4_symbol_size, TEXT_ALIGN_LEFT,
-                                   color_white, SYMBOL_NETWORK);
-
-                    gfx_print(layout.line3_pos, layout.line2_font, TEXT_ALIGN_CENTER,
-                              color_white, "%s", rtxStatus.M17_refl);
-                }
-  		
-	       // NEW VERSION	
-                if (    rtxStatus.M17_dst != NULL && 
-			rtxStatus.M17_src != NULL && 
-			rtxStatus.M17_refl != NULL &&
-                	last_state.settings.callsign != NULL ) {
-                
-                    datetime_t local_time = utcToLocalTime(last_state.time, last_state.settings.utc_timezone);
-                
-                    bool isInfo = (strncmp(rtxStatus.M17_dst, "INFO", 4) == 0);
-                    bool isEcho = (strncmp(rtxStatus.M17_dst, "ECHO", 4) == 0);
-                    bool isSelf = (strncmp(rtxStatus.M17_src, last_state.settings.callsign, 8) == 0);
-                
-                    if (!isInfo && !isEcho && !isSelf) {
-                        history_add(rtxStatus.M17_src, local_time);
-	            }
-                }                  
-    
+                dst = ui_state->new_callsign;
             }
             else
             {
-                const char *dst = NULL;
-                if(ui_state->edit_mode)
-                {
-                    dst = ui_state->new_callsign;
-                }
+                if(strnlen(rtxStatus.destination_address, 10) == 0)
+                    dst = currentLanguage->broadcast;
                 else
-                {
-                    if(strnlen(rtxStatus.destination_address, 10) == 0)
-                        dst = currentLanguage->broadcast;
-                    else
-                        dst = rtxStatus.destination_address;
-                }
-
-                gfx_print(layout.line2_pos, layout.line2_font, TEXT_ALIGN_CENTER,
-                          color_white, "M17 #%s", dst);
+                    dst = rtxStatus.destination_address;
             }
+
+            sniprintf(buf, len, "M17 #%s", dst);
             break;
         }
         #endif
     }
 }
 
-void _ui_drawFrequency()
+/**
+ * \internal
+ * Format the current frequency, RX or TX depending on the PTT status.
+ */
+static void _ui_formatFrequency(char *buf, size_t len)
 {
     freq_t freq = platform_getPttStatus() ? last_state.channel.tx_frequency
                                           : last_state.channel.rx_frequency;
 
-    // Print big numbers frequency
-    char freq_str[16] = {0};
-    sniprintf(freq_str, sizeof(freq_str), "%lu.%06lu", (freq / 1000000lu), (freq % 1000000lu));
-    stripTrailingZeroes(freq_str);
+    sniprintf(buf, len, "%lu.%06lu", (freq / 1000000lu), (freq % 1000000lu));
+    stripTrailingZeroes(buf);
+}
+
+#ifdef CONFIG_M17
+/**
+ * \internal
+ * Draw the data of the M17 stream being received over the text lines.
+ */
+static void _ui_drawM17Stream(const rtxStatus_t *rtxStatus)
+{
+    // Lines are drawn differently than the channel data, tag their hashes
+    const uint32_t seed = widget_hashString(WIDGET_HASH_INIT, "M17");
+
+    // Source address, replaced by the contact name when known
+    uint32_t inputs = widget_hashString(seed, rtxStatus->M17_src);
+    inputs = widget_hash(inputs, &rtxStatus->M17_srcContact,
+                         sizeof(rtxStatus->M17_srcContact));
+    if(widget_update(&widgets[MAIN_LINE1], inputs))
+    {
+        const char *source = rtxStatus->M17_src;
+        contact_t contact;
+        if((rtxStatus->M17_srcContact >= 0) &&
+           (cps_readContact(&contact, rtxStatus->M17_srcContact) == 0))
+        {
+            contact.name[CPS_STR_SIZE - 1] = '\0';
+            source = contact.name;
+        }
+
+        gfx_drawSymbol(layout.line1_pos, layout.line1_symbol_size, TEXT_ALIGN_LEFT,
+                       color_white, SYMBOL_CALL_MADE);
+
+        gfx_print(layout.line1_pos, layout.line2_font, TEXT_ALIGN_CENTER,
+                  color_white, "%s", source);
+    }
+
+    // Destination address
+    inputs = widget_hashString(seed, rtxStatus->M17_dst);
+    if(widget_update(&widgets[MAIN_LINE2], inputs))
+    {
+        gfx_drawSymbol(layout.line2_pos, layout.line2_symbol_size, TEXT_ALIGN_LEFT,
+                       color_white, SYMBOL_CALL_RECEIVED);
+
+        gfx_print(layout.line2_pos, layout.line2_font, TEXT_ALIGN_CENTER,
+                  yellow_fab413, "%s", rtxStatus->M17_dst);
+    }
+
+    // Reflector and RF link
+    inputs = widget_hashString(seed, rtxStatus->M17_refl);
+    inputs = widget_hashString(inputs, rtxStatus->M17_link);
+    if(widget_update(&widgets[MAIN_LINE34], inputs) == false)
+        return;
+
+    if(rtxStatus->M17_link[0] != '\0')
+    {
+        gfx_drawSymbol(layout.line4_pos, layout.line3_symbol_size, TEXT_ALIGN_LEFT,
+                       color_white, SYMBOL_ACCESS_POINT);
+
+        gfx_print(layout.line4_pos, layout.line2_font, TEXT_ALIGN_CENTER,
+                  color_blue, "%s", rtxStatus->M17_link);
+    }
+
+    if(rtxStatus->M17_refl[0] != '\0')
+    {
+        gfx_drawSymbol(layout.line3_pos, layout.line4_symbol_size, TEXT_ALIGN_LEFT,
+                       color_white, SYMBOL_NETWORK);
+
+        gfx_print(layout.line3_pos, layout.line2_font, TEXT_ALIGN_CENTER,
+                  color_white, "%s", rtxStatus->M17_refl);
+    }
+}
+#endif
+
+/**
+ * \internal
+ * Draw a text line widget, redrawing it only if its text changed.
+ */
+static void _ui_drawTextWidget(enum mainWidgets widget, point_t pos,
+                               fontSize_t font, const char *text)
+{
+    uint32_t inputs = widget_hashString(WIDGET_HASH_INIT, text);
+    if(widget_update(&widgets[widget], inputs) && (text[0] != '\0'))
+        gfx_print(pos, font, TEXT_ALIGN_CENTER, color_white, "%s", text);
+}
+
+/**
+ * \internal
+ * Draw the text lines of the VFO and MEM main screens.
+ *
+ * @param showChannel: true to show bank and channel on the first line.
+ */
+static void _ui_drawMainMiddle(ui_state_t* ui_state, bool showChannel)
+{
+    // Frequency depends on PTT status, M17 data comes from the RTX status
+    uint32_t deps = STATE_CHG_CHANNEL | STATE_CHG_SETTINGS | STATE_CHG_PTT;
+    #ifdef CONFIG_M17
+    deps |= STATE_CHG_RTX_STATUS;
+    #endif
+
+    if(widget_needsCheck(deps) == false)
+        return;
+
+    char line1[32] = "";
+    char line2[32] = "";
+    char freq[16]  = "";
+
+    #ifdef CONFIG_M17
+    // Show M17 stream data instead of the channel data when receiving
+    rtxStatus_t status = rtx_getCurrentStatus();
+    if((last_state.channel.mode == OPMODE_M17) && status.lsfOk)
+    {
+        _ui_drawM17Stream(&status);
+        return;
+    }
+
+    // Show VFO frequency if the OpMode is not M17 or there is no valid LSF data
+    if((status.opMode != OPMODE_M17) || (status.lsfOk == false))
+    #endif
+    {
+        if(showChannel)
+            _ui_formatBankChannel(line1, sizeof(line1));
 
-    gfx_print(layout.line3_large_pos, layout.line3_large_font, TEXT_ALIGN_CENTER,
-              color_white, "%s", freq_str);
+        _ui_formatFrequency(freq, sizeof(freq));
+    }
+
+    _ui_formatModeInfo(ui_state, line2, sizeof(line2));
+
+    _ui_drawTextWidget(MAIN_LINE1,  layout.line1_pos, layout.line1_font, line1);
+    _ui_drawTextWidget(MAIN_LINE2,  layout.line2_pos, layout.line2_font, line2);
+    _ui_drawTextWidget(MAIN_LINE34, layout.line3_large_pos,
+                       layout.line3_large_font, freq);
 }
 
 void _ui_drawVFOMiddleInput(ui_state_t* ui_state)
 {
+    char rx_str[16] = "";
+    char tx_str[16] = "";
+
     // Add inserted number to string, skipping "Rx: "/"Tx: " and "."
     uint8_t insert_pos = ui_state->input_position + 3;
     if(ui_state->input_position > 3) insert_pos += 1;
@@ -264,8 +423,7 @@ void _ui_drawVFOMiddleInput(ui_state_t* ui_state)
     {
         if(ui_state->input_position == 0)
         {
-            gfx_print(layout.line2_pos, layout.input_font, TEXT_ALIGN_CENTER,
-                      color_white, ">Rx:%03lu.%04lu",
+            sniprintf(rx_str, sizeof(rx_str), ">Rx:%03lu.%04lu",
                       (unsigned long)ui_state->new_rx_frequency/1000000,
                       (unsigned long)(ui_state->new_rx_frequency%1000000)/100);
         }
@@ -275,25 +433,21 @@ void _ui_drawVFOMiddleInput(ui_state_t* ui_state)
             if(ui_state->input_position == 1)
                 strcpy(ui_state->new_rx_freq_buf, ">Rx:___.____");
             ui_state->new_rx_freq_buf[insert_pos] = input_char;
-            gfx_print(layout.line2_pos, layout.input_font, TEXT_ALIGN_CENTER,
-                      color_white, ui_state->new_rx_freq_buf);
+            strncpy(rx_str, ui_state->new_rx_freq_buf, sizeof(rx_str) - 1);
         }
-        gfx_print(layout.line3_large_pos, layout.input_font, TEXT_ALIGN_CENTER,
-                  color_white, " Tx:%03lu.%04lu",
+        sniprintf(tx_str, sizeof(tx_str), " Tx:%03lu.%04lu",
                   (unsigned long)last_state.channel.tx_frequency/1000000,
                   (unsigned long)(last_state.channel.tx_frequency%1000000)/100);
     }
     else if(ui_state->input_set == SET_TX)
     {
-        gfx_print(layout.line2_pos, layout.input_font, TEXT_ALIGN_CENTER,
-                  color_white, " Rx:%03lu.%04lu",
+        sniprintf(rx_str, sizeof(rx_str), " Rx:%03lu.%04lu",
                   (unsigned long)ui_state->new_rx_frequency/1000000,
                   (unsigned long)(ui_state->new_rx_frequency%1000000)/100);
         // Replace Rx frequency with underscorses
         if(ui_state->input_position == 0)
         {
-            gfx_print(layout.line3_large_pos, layout.input_font, TEXT_ALIGN_CENTER,
-                      color_white, ">Tx:%03lu.%04lu",
+            sniprintf(tx_str, sizeof(tx_str), ">Tx:%03lu.%04lu",
                       (unsigned long)ui_state->new_rx_frequency/1000000,
                       (unsigned long)(ui_state->new_rx_frequency%1000000)/100);
         }
@@ -302,14 +456,26 @@ void _ui_drawVFOMiddleInput(ui_state_t* ui_state)
             if(ui_state->input_position == 1)
                 strcpy(ui_state->new_tx_freq_buf, ">Tx:___.____");
             ui_state->new_tx_freq_buf[insert_pos] = input_char;
-            gfx_print(layout.line3_large_pos, layout.input_font, TEXT_ALIGN_CENTER,
-                      color_white, ui_state->new_tx_freq_buf);
+            strncpy(tx_str, ui_state->new_tx_freq_buf, sizeof(tx_str) - 1);
         }
     }
+
+    _ui_drawTextWidget(MAIN_INPUT_RX, layout.line2_pos, layout.input_font,
+                       rx_str);
+    _ui_drawTextWidget(MAIN_INPUT_TX, layout.line3_large_pos, layout.input_font,
+                       tx_str);
 }
 
 void _ui_drawMainBottom()
 {
+    uint32_t deps = STATE_CHG_RSSI | STATE_CHG_VOLUME | STATE_CHG_CHANNEL |
+                    STATE_CHG_SETTINGS;
+    if(last_state.channel.mode != OPMODE_FM)
+        deps |= STATE_CHG_RTX | STATE_CHG_RTX_STATUS;
+
+    if(widget_needsCheck(deps) == false)
+        return;
+
     // Squelch bar
     rssi_t   rssi = last_state.rssi;
     uint8_t  squelch = last_state.settings.sqlLevel;
@@ -319,6 +485,22 @@ void _ui_drawMainBottom()
     point_t meter_pos = { layout.horizontal_pad,
                           CONFIG_SCREEN_HEIGHT - meter_height - layout.bottom_pad};
     uint8_t mic_level = platform_getMicLevel();
+
+    uint32_t inputs = WIDGET_HASH_INIT;
+    inputs = widget_hash(inputs, &last_state.channel.mode,
+                         sizeof(last_state.channel.mode));
+    inputs = widget_hash(inputs, &last_state.rtxStatus,
+                         sizeof(last_state.rtxStatus));
+    inputs = widget_hash(inputs, &last_state.settings.showSMeter,
+                         sizeof(last_state.settings.showSMeter));
+    inputs = widget_hash(inputs, &rssi, sizeof(rssi));
+    inputs = widget_hash(inputs, &squelch, sizeof(squelch));
+    inputs = widget_hash(inputs, &volume, sizeof(volume));
+    inputs = widget_hash(inputs, &mic_level, sizeof(mic_level));
+
+    if(widget_update(&widgets[MAIN_BOTTOM], inputs) == false)
+        return;
+
     switch(last_state.channel.mode)
     {
         case OPMODE_FM:
@@ -369,23 +551,13 @@ void _ui_drawMainBottom()
 
 void _ui_drawMainVFO(ui_state_t* ui_state)
 {
-    gfx_clearScreen();
     _ui_drawMainTop(ui_state);
-    _ui_drawModeInfo(ui_state);
-
-    #ifdef CONFIG_M17
-    // Show VFO frequency if the OpMode is not M17 or there is no valid LSF data
-    rtxStatus_t status = rtx_getCurrentStatus();
-    if((status.opMode != OPMODE_M17) || (status.lsfOk == false))
-    #endif
-        _ui_drawFrequency();
-
+    _ui_drawMainMiddle(ui_state, false);
     _ui_drawMainBottom();
 }
 
 void _ui_drawMainVFOInput(ui_state_t* ui_state)
 {
-    gfx_clearScreen();
     _ui_drawMainTop(ui_state);
     _ui_drawVFOMiddleInput(ui_state);
     _ui_drawMainBottom();
@@ -393,19 +565,7 @@ void _ui_drawMainVFOInput(ui_state_t* ui_state)
 
 void _ui_drawMainMEM(ui_state_t* ui_state)
 {
-    gfx_clearScreen();
     _ui_drawMainTop(ui_state);
-    _ui_drawModeInfo(ui_state);
-
-    #ifdef CONFIG_M17
-    // Show channel data if the OpMode is not M17 or there is no valid LSF data
-    rtxStatus_t status = rtx_getCurrentStatus();
-    if((status.opMode != OPMODE_M17) || (status.lsfOk == false))
-    #endif
-    {
-        _ui_drawBankChannel();
-        _ui_drawFrequency();
-    }
-
+    _ui_drawMainMiddle(ui_state, true);
     _ui_drawMainBottom();
 }
@@ -24,6 +24,7 @@
 #include <inttypes.h>
 #include <utils.h>
 #include <ui/ui_default.h>
+#include <ui/ui_widget.h>
 #include <interfaces/nvmem.h>
 #include <interfaces/cps_io.h>
 #include <interfaces/platform.h>
@@ -156,12 +157,85 @@ static void announceMenuItemIfNeeded(char* name, char* value, bool editMode)
     vp_play();
 }
 
+/*
+ * Title and entries of list menus are drawn through widgets, so that only the
+ * rows whose content changed are redrawn.
+ */
+#define MAX_LIST_ROWS 16
+
+static widget_t titleWidget;
+static widget_t rowWidgets[MAX_LIST_ROWS];
+
+void _ui_layoutMenuWidgets()
+{
+    point_t pos = {0, 0};
+    widget_setArea(&titleWidget, pos, CONFIG_SCREEN_WIDTH, layout.top_h);
+
+    // Each row covers the rectangle drawn under the selected entry
+    pos.y = layout.line1_pos.y - layout.menu_h + 3;
+    for(uint8_t row = 0; row < MAX_LIST_ROWS; row++)
+    {
+        widget_setArea(&rowWidgets[row], pos, CONFIG_SCREEN_WIDTH, layout.menu_h);
+        pos.y += layout.menu_h;
+    }
+}
+
+/**
+ * \internal
+ * Print the menu title on the top bar.
+ */
+static void _ui_drawMenuTitle(const char *title)
+{
+    uint32_t inputs = widget_hashString(WIDGET_HASH_INIT, title);
+    if(widget_update(&titleWidget, inputs))
+    {
+        gfx_print(layout.top_pos, layout.top_font, TEXT_ALIGN_CENTER,
+                  color_white, title);
+    }
+}
+
+/**
+ * \internal
+ * Check if a list row has to be redrawn.
+ *
+ * @param row: index of the row on screen.
+ * @param entry: entry name.
+ * @param value: entry value, NULL if the list has no values.
+ * @param style: selection and edit mode status of the entry.
+ * @return true if the row content changed and has to be drawn.
+ */
+static bool _ui_updateListRow(uint8_t row, const char *entry, const char *value,
+                              uint8_t style)
+{
+    if(row >= MAX_LIST_ROWS)
+        return true;
+
+    uint32_t inputs = widget_hashString(WIDGET_HASH_INIT, entry);
+    if(value != NULL)
+        inputs = widget_hashString(inputs, value);
+
+    inputs = widget_hash(inputs, &style, sizeof(style));
+
+    return widget_update(&rowWidgets[row], inputs);
+}
+
+/**
+ * \internal
+ * Clear the list rows left empty at the end of the screen.
+ */
+static void _ui_clearListRows(uint8_t firstRow, uint8_t numRows)
+{
+    for(uint8_t row = firstRow; (row < numRows) && (row < MAX_LIST_ROWS); row++)
+        widget_update(&rowWidgets[row], WIDGET_HASH_INIT);
+}
+
 void _ui_drawMenuList(uint8_t selected, int (*getCurrentEntry)(char *buf, uint8_t max_len, uint8_t index))
 {
     point_t pos = layout.line1_pos;
     // Number of menu entries that fit in the screen height
     uint8_t entries_in_screen = (CONFIG_SCREEN_HEIGHT - 1 - pos.y) / layout.menu_h + 1;
     uint8_t scroll = 0;
+    uint8_t row = 0;
     char entry_buf[MAX_ENTRY_LEN] = "";
     color_t text_color = color_cyan;
     for(int item=0, result=0; (result == 0) && (pos.y < CONFIG_SCREEN_HEIGHT); item++)
@@ -173,20 +247,28 @@ void _ui_drawMenuList(uint8_t selected, int (*getCurrentEntry)(char *buf, uint8_
         result = (*getCurrentEntry)(entry_buf, sizeof(entry_buf), item+scroll);
         if(result != -1)
         {
-            text_color = color_cyan;
-            if(item + scroll == selected)
-            {
-                text_color = color_listSelected;
-                // Draw rectangle under selected item, compensating for text height
-                point_t rect_pos = {0, pos.y - layout.menu_h + 3};
-                gfx_drawRect(rect_pos, CONFIG_SCREEN_WIDTH, layout.menu_h, color_cyan, true);
+            bool is_selected = (item + scroll == selected);
+            if(is_selected)
                 announceMenuItemIfNeeded(entry_buf, NULL, false);
+
+            if(_ui_updateListRow(row, entry_buf, NULL, is_selected))
+            {
+                text_color = color_cyan;
+                if(is_selected)
+                {
+                    text_color = color_listSelected;
+                    // Draw rectangle under selected item, compensating for text height
+                    point_t rect_pos = {0, pos.y - layout.menu_h + 3};
+                    gfx_drawRect(rect_pos, CONFIG_SCREEN_WIDTH, layout.menu_h, color_cyan, true);
+                }
+                gfx_print(pos, layout.menu_font, TEXT_ALIGN_LEFT, text_color, entry_buf);
             }
-            gfx_print(pos, layout.menu_font, TEXT_ALIGN_LEFT, text_color, entry_buf);
-	    text_color = color_cyan;
+            row++;
             pos.y += layout.menu_h;
         }
     }
+
+    _ui_clearListRows(row, entries_in_screen);
 }
 
 void _ui_drawMenuListValue(ui_state_t* ui_state, uint8_t selected,
@@ -197,6 +279,7 @@ void _ui_drawMenuListValue(ui_state_t* ui_state, uint8_t selected,
     // Number of menu entries that fit in the screen height
     uint8_t entries_in_screen = (CONFIG_SCREEN_HEIGHT - 1 - pos.y) / layout.menu_h + 1;
     uint8_t scroll = 0;
+    uint8_t row = 0;
     char entry_buf[MAX_ENTRY_LEN] = "";
     char value_buf[MAX_ENTRY_LEN] = "";
     color_t text_color = color_list;
@@ -211,20 +294,13 @@ void _ui_drawMenuListValue(ui_state_t* ui_state, uint8_t selected,
         result = (*getCurrentValue)(value_buf, sizeof(value_buf), item+scroll);
         if(result != -1)
         {
-            text_color = color_list;
-            if(item + scroll == selected)
+            bool is_selected = (item + scroll == selected);
+            uint8_t style = 0;
+            if(is_selected)
+                style = ui_state->edit_mode ? 2 : 1;
+
+            if(is_selected)
             {
-                // Draw rectangle under selected item, compensating for text height
-                // If we are in edit mode, draw a hollow rectangle
-                text_color = color_listSelected;
-                bool full_rect = true;
-                if(ui_state->edit_mode)
-                {
-                    text_color = color_list;
-                    full_rect = false;
-                }
-                point_t rect_pos = {0, pos.y - layout.menu_h + 3};
-                gfx_drawRect(rect_pos, CONFIG_SCREEN_WIDTH, layout.menu_h, color_list, full_rect);
                 bool editModeChanged = priorEditMode != ui_state->edit_mode;
                 priorEditMode = ui_state->edit_mode;
                 // force the menu item to be spoken  when the edit mode changes.
@@ -238,11 +314,33 @@ void _ui_drawMenuListValue(ui_state_t* ui_state, uint8_t selected,
                                              ui_state->edit_mode);
                 }
             }
-            gfx_print(pos, layout.menu_font, TEXT_ALIGN_LEFT, text_color, entry_buf);
-            gfx_print(pos, layout.menu_font, TEXT_ALIGN_RIGHT, text_color, value_buf);
+
+            if(_ui_updateListRow(row, entry_buf, value_buf, style))
+            {
+                text_color = color_list;
+                if(is_selected)
+                {
+                    // Draw rectangle under selected item, compensating for text height
+                    // If we are in edit mode, draw a hollow rectangle
+                    text_color = color_listSelected;
+                    bool full_rect = true;
+                    if(ui_state->edit_mode)
+                    {
+                        text_color = color_list;
+                        full_rect = false;
+                    }
+                    point_t rect_pos = {0, pos.y - layout.menu_h + 3};
+                    gfx_drawRect(rect_pos, CONFIG_SCREEN_WIDTH, layout.menu_h, color_list, full_rect);
+                }
+                gfx_print(pos, layout.menu_font, TEXT_ALIGN_LEFT, text_color, entry_buf);
+                gfx_print(pos, layout.menu_font, TEXT_ALIGN_RIGHT, text_color, value_buf);
+            }
+            row++;
             pos.y += layout.menu_h;
         }
     }
+
+    _ui_clearListRows(row, entries_in_screen);
 }
 
 int _ui_getMenuTopEntryName(char *buf, uint8_t max_len, uint8_t index)
@@ -625,40 +723,32 @@ int _ui_getHistoryItem(char *buf, uint8_t max_len, uint8_t index)
 
 void _ui_drawMenuTop(ui_state_t* ui_state)
 {
-    gfx_clearScreen();
     // Print "Menu" on top bar
-    gfx_print(layout.top_pos, layout.top_font, TEXT_ALIGN_CENTER,
-              color_white, currentLanguage->menu);
+    _ui_drawMenuTitle(currentLanguage->menu);
     // Print menu entries
     _ui_drawMenuList(ui_state->menu_selected, _ui_getMenuTopEntryName);
 }
 
 void _ui_drawMenuBank(ui_state_t* ui_state)
 {
-    gfx_clearScreen();
     // Print "Bank" on top bar
-    gfx_print(layout.top_pos, layout.top_font, TEXT_ALIGN_CENTER,
-              color_white, currentLanguage->banks);
+    _ui_drawMenuTitle(currentLanguage->banks);
     // Print bank entries
     _ui_drawMenuList(ui_state->menu_selected, _ui_getBankName);
 }
 
 void _ui_drawMenuChannel(ui_state_t* ui_state)
 {
-    gfx_clearScreen();
     // Print "Channel" on top bar
-    gfx_print(layout.top_pos, layout.top_font, TEXT_ALIGN_CENTER,
-              color_white, currentLanguage->channels);
+    _ui_drawMenuTitle(currentLanguage->channels);
     // Print channel entries
     _ui_drawMenuList(ui_state->menu_selected, _ui_getChannelName);
 }
 
 void _ui_drawMenuContacts(ui_state_t* ui_state)
 {
-    gfx_clearScreen();
     // Print "Contacts" on top bar
-    gfx_print(layout.top_pos, layout.top_font, TEXT_ALIGN_CENTER,
-              color_white, currentLanguage->contacts);
+    _ui_drawMenuTitle(currentLanguage->contacts);
     // Print contact entries
     _ui_drawMenuList(ui_state->menu_selected, _ui_getContactName);
 }
@@ -833,20 +923,16 @@ void _ui_drawMenuGPS()
 
 void _ui_drawMenuSettings(ui_state_t* ui_state)
 {
-    gfx_clearScreen();
     // Print "Settings" on top bar
-    gfx_print(layout.top_pos, layout.top_font, TEXT_ALIGN_CENTER,
-              color_white, currentLanguage->settings);
+    _ui_drawMenuTitle(currentLanguage->settings);
     // Print menu entries
     _ui_drawMenuList(ui_state->menu_selected, _ui_getSettingsEntryName);
 }
 
 void _ui_drawMenuBackupRestore(ui_state_t* ui_state)
 {
-    gfx_clearScreen();
     // Print "Backup & Restore" on top bar
-    gfx_print(layout.top_pos, layout.top_font, TEXT_ALIGN_CENTER,
-              color_white, currentLanguage->backupAndRestore);
+    _ui_drawMenuTitle(currentLanguage->backupAndRestore);
     // Print menu entries
     _ui_drawMenuList(ui_state->menu_selected, _ui_getBackupRestoreEntryName);
 }
@@ -905,10 +991,8 @@ void _ui_drawMenuRestore(ui_state_t* ui_state)
 
 void _ui_drawMenuInfo(ui_state_t* ui_state)
 {
-    gfx_clearScreen();
     // Print "Info" on top bar
-    gfx_print(layout.top_pos, layout.top_font, TEXT_ALIGN_CENTER,
-              color_white, currentLanguage->info);
+    _ui_drawMenuTitle(currentLanguage->info);
     // Print menu entries
     _ui_drawMenuListValue(ui_state, ui_state->menu_selected, _ui_getInfoEntryName,
                            _ui_getInfoValueName);
@@ -951,10 +1035,8 @@ void _ui_drawMenuAbout(ui_state_t* ui_state)
 
 void _ui_drawSettingsDisplay(ui_state_t* ui_state)
 {
-    gfx_clearScreen();
     // Print "Display" on top bar
-    gfx_print(layout.top_pos, layout.top_font, TEXT_ALIGN_CENTER,
-              color_white, currentLanguage->display);
+    _ui_drawMenuTitle(currentLanguage->display);
     // Print display settings entries
     _ui_drawMenuListValue(ui_state, ui_state->menu_selected, _ui_getDisplayEntryName,
                            _ui_getDisplayValueName);
@@ -963,10 +1045,8 @@ void _ui_drawSettingsDisplay(ui_state_t* ui_state)
 #ifdef CONFIG_GPS
 void _ui_drawSettingsGPS(ui_state_t* ui_state)
 {
-    gfx_clearScreen();
     // Print "GPS Settings" on top bar
-    gfx_print(layout.top_pos, layout.top_font, TEXT_ALIGN_CENTER,
-              color_white, currentLanguage->gpsSettings);
+    _ui_drawMenuTitle(currentLanguage->gpsSettings);
     // Print display settings entries
     _ui_drawMenuListValue(ui_state, ui_state->menu_selected,
                           _ui_getSettingsGPSEntryName,
@@ -1036,15 +1116,21 @@ void _ui_drawSettingsTimeDateSet(ui_state_t* ui_state)
 #ifdef CONFIG_M17
 void _ui_drawSettingsM17(ui_state_t* ui_state)
 {
-    gfx_clearScreen();
     // Print "M17 Settings" on top bar
-    gfx_print(layout.top_pos, layout.top_font, TEXT_ALIGN_CENTER,
-              color_white, currentLanguage->m17settings);
-    gfx_printLine(1, 4, layout.top_h, CONFIG_SCREEN_HEIGHT - layout.bottom_h,
-                  layout.horizontal_pad, layout.menu_font,
-                  TEXT_ALIGN_LEFT, color_white, currentLanguage->callsign);
+    _ui_drawMenuTitle(currentLanguage->m17settings);
+    if(widget_fullFrame())
+    {
+        gfx_printLine(1, 4, layout.top_h, CONFIG_SCREEN_HEIGHT - layout.bottom_h,
+                      layout.horizontal_pad, layout.menu_font,
+                      TEXT_ALIGN_LEFT, color_white, currentLanguage->callsign);
+    }
+
     if((ui_state->edit_mode) && (ui_state->menu_selected == M17_CALLSIGN))
     {
+        // Callsign input changes only on key presses, redrawing the screen
+        if(widget_fullFrame() == false)
+            return;
+
         uint16_t rect_width = CONFIG_SCREEN_WIDTH - (layout.horizontal_pad * 2);
         uint16_t rect_height = (CONFIG_SCREEN_HEIGHT - (layout.top_h + layout.bottom_h))/2;
         point_t rect_origin = {(CONFIG_SCREEN_WIDTH - rect_width) / 2,
@@ -1065,10 +1151,8 @@ void _ui_drawSettingsM17(ui_state_t* ui_state)
 
 void _ui_drawSettingsAccessibility(ui_state_t* ui_state)
 {
-    gfx_clearScreen();
     // Print "Accessibility" on top bar
-    gfx_print(layout.top_pos, layout.top_font, TEXT_ALIGN_CENTER,
-              color_white, currentLanguage->accessibility);
+    _ui_drawMenuTitle(currentLanguage->accessibility);
     // Print accessibility settings entries
     _ui_drawMenuListValue(ui_state, ui_state->menu_selected, _ui_getAccessibilityEntryName,
                            _ui_getAccessibilityValueName);
@@ -1105,15 +1189,16 @@ void _ui_drawSettingsReset2Defaults(ui_state_t* ui_state)
 
 void _ui_drawSettingsRadio(ui_state_t* ui_state)
 {
-    gfx_clearScreen();
-
     // Print "Radio Settings" on top bar
-    gfx_print(layout.top_pos, layout.top_font, TEXT_ALIGN_CENTER,
-              color_white, currentLanguage->radioSettings);
+    _ui_drawMenuTitle(currentLanguage->radioSettings);
 
     // Handle the special case where a frequency is being input
     if ((ui_state->menu_selected == R_OFFSET) && (ui_state->edit_mode))
     {
+        // Frequency input changes only on key presses, redrawing the screen
+        if(widget_fullFrame() == false)
+            return;
+
         char buf[17] = { 0 };
         uint16_t rect_width = CONFIG_SCREEN_WIDTH - (layout.horizontal_pad * 2);
         uint16_t rect_height = (CONFIG_SCREEN_HEIGHT - (layout.top_h + layout.bottom_h))/2;
@@ -0,0 +1,96 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <ui/ui_widget.h>
+#include <string.h>
+
+static uint32_t frame   = 1;     // Current full frame, never zero
+static uint32_t changes = 0;     // State fields changed since the last frame
+static bool     full    = true;  // Frame being drawn is a full one
+
+void widget_setArea(widget_t *widget, point_t pos, uint16_t width,
+                    uint16_t height)
+{
+    widget->pos    = pos;
+    widget->width  = width;
+    widget->height = height;
+    widget->frame  = 0;
+}
+
+void widget_beginFrame(bool fullFrame, uint32_t changedFields)
+{
+    full    = fullFrame;
+    changes = changedFields;
+
+    if(full)
+    {
+        frame++;
+        if(frame == 0)
+            frame = 1;
+    }
+}
+
+bool widget_fullFrame()
+{
+    return full;
+}
+
+bool widget_needsCheck(uint32_t deps)
+{
+    return full || ((changes & deps) != 0);
+}
+
+uint32_t widget_hash(uint32_t hash, const void *data, size_t len)
+{
+    const uint8_t *ptr = (const uint8_t *) data;
+
+    for(size_t i = 0; i < len; i++)
+    {
+        hash ^= ptr[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+uint32_t widget_hashString(uint32_t hash, const char *str)
+{
+    // Include the terminator, so that consecutive strings are told apart
+    return widget_hash(hash, str, strlen(str) + 1);
+}
+
+bool widget_update(widget_t *widget, uint32_t inputs)
+{
+    if((widget->frame == frame) && (widget->inputs == inputs))
+        return false;
+
+    // In full frames the screen has already been cleared
+    if(full == false)
+    {
+        gfx_drawRect(widget->pos, widget->width, widget->height,
+                     (color_t) {0, 0, 0, 255}, true);
+    }
+
+    widget->inputs = inputs;
+    widget->frame  = frame;
+
+    return true;
+}
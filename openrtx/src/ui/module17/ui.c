@@ -20,6 +20,7 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <pthread.h>
 #include <ui/ui_mod17.h>
 #include <rtx.h>
 #include <interfaces/platform.h>
@@ -161,10 +162,14 @@ state_t last_state;
 static ui_state_t ui_state;
 static bool layout_ready = false;
 
-// UI event queue
+// UI event queue: keyboard events are queued, status events are coalesced
+// into a single pending flag so that they can't crowd out the key presses.
+static pthread_mutex_t evQueue_mutex = PTHREAD_MUTEX_INITIALIZER;
 static uint8_t evQueue_rdPos;
 static uint8_t evQueue_wrPos;
 static event_t evQueue[MAX_NUM_EVENTS];
+static bool    evStatusPending;
+static uint32_t evStatusChanges;
 
 static layout_t _ui_calculateLayout()
 {
@@ -496,16 +501,44 @@ void ui_saveState()
     last_state = state;
 }
 
-void ui_updateFSM(bool *sync_rtx)
+/**
+ * \internal
+ * Pop an event from the UI event queue. Keyboard events are returned first, in
+ * order of arrival, then the pending status event, if any.
+ *
+ * @param event: pointer to the event to be filled.
+ * @return true if an event has been popped, false if the queue is empty.
+ */
+static bool _ui_popEvent(event_t *event)
 {
-    // Check for events
-    if(evQueue_wrPos == evQueue_rdPos) return;
+    bool popped = true;
+
+    pthread_mutex_lock(&evQueue_mutex);
+
+    if(evQueue_rdPos != evQueue_wrPos)
+    {
+        *event        = evQueue[evQueue_rdPos];
+        evQueue_rdPos = (evQueue_rdPos + 1) % MAX_NUM_EVENTS;
+    }
+    else if(evStatusPending)
+    {
+        event->type     = EVENT_STATUS;
+        event->payload  = evStatusChanges;
+        evStatusPending = false;
+        evStatusChanges = 0;
+    }
+    else
+    {
+        popped = false;
+    }
 
-    // Pop an event from the queue
-    uint8_t newTail = (evQueue_rdPos + 1) % MAX_NUM_EVENTS;
-    event_t event   = evQueue[evQueue_rdPos];
-    evQueue_rdPos   = newTail;
+    pthread_mutex_unlock(&evQueue_mutex);
 
+    return popped;
+}
+
+static void _ui_fsm_processEvent(event_t event, bool *sync_rtx)
+{
     // Process pressed keys
     if(event.type == EVENT_KBD)
     {
@@ -850,6 +883,28 @@ void ui_updateFSM(bool *sync_rtx)
     }
 }
 
+void ui_updateFSM(bool *sync_rtx)
+{
+    event_t event;
+
+    while(_ui_popEvent(&event))
+        _ui_fsm_processEvent(event, sync_rtx);
+}
+
+bool ui_eventPending()
+{
+    pthread_mutex_lock(&evQueue_mutex);
+    bool pending = (evQueue_rdPos != evQueue_wrPos) || evStatusPending;
+    pthread_mutex_unlock(&evQueue_mutex);
+
+    return pending;
+}
+
+bool ui_isStandby()
+{
+    return false;
+}
+
 bool ui_updateGUI()
 {
     if(!layout_ready)
@@ -903,20 +958,40 @@ bool ui_updateGUI()
 
 bool ui_pushEvent(const uint8_t type, const uint32_t data)
 {
-    uint8_t newHead = (evQueue_wrPos + 1) % MAX_NUM_EVENTS;
+    bool pushed = true;
 
-    // Queue is full
-    if(newHead == evQueue_rdPos) return false;
+    pthread_mutex_lock(&evQueue_mutex);
 
-    // Preserve atomicity when writing the new element into the queue.
-    event_t event;
-    event.type    = type;
-    event.payload = data;
+    if(type == EVENT_STATUS)
+    {
+        // Status events carry the mask of the changed state fields, one
+        // pending is enough
+        evStatusPending  = true;
+        evStatusChanges |= data;
+    }
+    else
+    {
+        uint8_t newHead = (evQueue_wrPos + 1) % MAX_NUM_EVENTS;
 
-    evQueue[evQueue_wrPos] = event;
-    evQueue_wrPos = newHead;
+        if(newHead != evQueue_rdPos)
+        {
+            event_t event;
+            event.type    = type;
+            event.payload = data;
 
-    return true;
+            evQueue[evQueue_wrPos] = event;
+            evQueue_wrPos = newHead;
+        }
+        else
+        {
+            // Queue is full
+            pushed = false;
+        }
+    }
+
+    pthread_mutex_unlock(&evQueue_mutex);
+
+    return pushed;
 }
 
 void ui_terminate()
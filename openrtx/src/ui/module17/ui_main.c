@@ -59,6 +59,16 @@ static void _ui_drawModeInfo(ui_state_t* ui_state)
 
             if(rtxStatus.lsfOk)
             {
+                // Show the contact name in place of the source, when known
+                const char *src = rtxStatus.M17_src;
+                contact_t contact;
+                if((rtxStatus.M17_srcContact >= 0) &&
+                   (cps_readContact(&contact, rtxStatus.M17_srcContact) == 0))
+                {
+                    contact.name[CPS_STR_SIZE - 1] = '\0';
+                    src = contact.name;
+                }
+
                 gfx_drawSymbol(layout.line2_pos, layout.line2_symbol_font, TEXT_ALIGN_LEFT,
                                color_white, SYMBOL_CALL_RECEIVED);
                 gfx_print(layout.line2_pos, layout.line2_font, TEXT_ALIGN_CENTER,
@@ -66,7 +76,7 @@ static void _ui_drawModeInfo(ui_state_t* ui_state)
                 gfx_drawSymbol(layout.line1_pos, layout.line1_symbol_font, TEXT_ALIGN_LEFT,
                                color_white, SYMBOL_CALL_MADE);
                 gfx_print(layout.line1_pos, layout.line2_font, TEXT_ALIGN_CENTER,
-                          color_white, "%s", rtxStatus.M17_src);
+                          color_white, "%s", src);
 
                 if(rtxStatus.M17_link[0] != '\0')
                 {
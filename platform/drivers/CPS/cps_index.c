@@ -0,0 +1,537 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <interfaces/cps_io.h>
+#include <sys/stat.h>
+#include <strings.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include "cps_index.h"
+
+#define CPS_INDEX_MAGIC   0x49585452  // "RTXI"
+#define CPS_INDEX_VERSION 1
+
+/**
+ * Header of the index file. The size and modification time of the codeplug
+ * are used to detect whether the index is still valid.
+ */
+typedef struct
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;        // Number of channels
+    int64_t  cpsSize;      // Size of the codeplug file
+    int64_t  cpsTime;      // Modification time of the codeplug file, in ns
+}
+idxHeader_t;
+
+/**
+ * Entry of the frequency index, the key is stored to search without
+ * accessing the codeplug.
+ */
+typedef struct
+{
+    freq_t   freq;
+    uint16_t pos;
+}
+freqEntry_t;
+
+static char        *idxPath = NULL;     // Path of the index file
+static char        *cpsFile = NULL;     // Path of the codeplug file
+static uint16_t    *byName  = NULL;     // Channel positions, sorted by name
+static freqEntry_t *byFreq  = NULL;     // Channel positions, sorted by freq
+static uint16_t     count   = 0;
+static uint32_t     cap     = 0;
+static bool         valid   = false;
+
+/**
+ * \internal
+ * Compare two channel names. The order is case insensitive, ties are broken
+ * by the channel position to make it a total order.
+ */
+static int _cmpName(const char *a, uint16_t aPos, const char *b, uint16_t bPos)
+{
+    int ret = strncasecmp(a, b, CPS_STR_SIZE);
+    if(ret != 0)
+        return ret;
+
+    return (int) aPos - (int) bPos;
+}
+
+static int _cmpFreq(const freqEntry_t *a, const freqEntry_t *b)
+{
+    if(a->freq != b->freq)
+        return (a->freq < b->freq) ? -1 : 1;
+
+    return (int) a->pos - (int) b->pos;
+}
+
+/**
+ * \internal
+ * Read the name of a channel from the codeplug.
+ */
+static void _readName(uint16_t pos, char *name)
+{
+    channel_t channel;
+    name[0] = '\0';
+    if(cps_readChannel(&channel, pos) == 0)
+        memcpy(name, channel.name, CPS_STR_SIZE);
+}
+
+/**
+ * \internal
+ * Make room for a given number of entries.
+ */
+static bool _reserve(uint32_t size)
+{
+    if(size <= cap)
+        return true;
+
+    uint32_t newCap = (cap == 0) ? 64 : cap;
+    while(newCap < size)
+        newCap *= 2;
+
+    uint16_t    *names = realloc(byName, newCap * sizeof(uint16_t));
+    if(names == NULL)
+        return false;
+
+    byName = names;
+
+    freqEntry_t *freqs = realloc(byFreq, newCap * sizeof(freqEntry_t));
+    if(freqs == NULL)
+        return false;
+
+    byFreq = freqs;
+    cap    = newCap;
+    return true;
+}
+
+/**
+ * \internal
+ * Add the entries of a channel already present in the codeplug.
+ */
+static void _add(uint16_t pos, const channel_t *channel)
+{
+    // Name: binary search, reading the names of the probed entries
+    uint32_t lo = 0;
+    uint32_t hi = count;
+    while(lo < hi)
+    {
+        uint32_t mid = (lo + hi) / 2;
+        char name[CPS_STR_SIZE];
+        _readName(byName[mid], name);
+
+        if(_cmpName(name, byName[mid], channel->name, pos) < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    memmove(&byName[lo + 1], &byName[lo], (count - lo) * sizeof(uint16_t));
+    byName[lo] = pos;
+
+    // Frequency
+    freqEntry_t entry = { channel->rx_frequency, pos };
+    lo = 0;
+    hi = count;
+    while(lo < hi)
+    {
+        uint32_t mid = (lo + hi) / 2;
+        if(_cmpFreq(&byFreq[mid], &entry) < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    memmove(&byFreq[lo + 1], &byFreq[lo], (count - lo) * sizeof(freqEntry_t));
+    byFreq[lo] = entry;
+
+    count++;
+}
+
+/**
+ * \internal
+ * Remove the entries of a channel.
+ */
+static void _remove(uint16_t pos)
+{
+    for(uint32_t i = 0; i < count; i++)
+    {
+        if(byName[i] == pos)
+        {
+            memmove(&byName[i], &byName[i + 1],
+                    (count - i - 1) * sizeof(uint16_t));
+            break;
+        }
+    }
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+        if(byFreq[i].pos == pos)
+        {
+            memmove(&byFreq[i], &byFreq[i + 1],
+                    (count - i - 1) * sizeof(freqEntry_t));
+            break;
+        }
+    }
+
+    count--;
+}
+
+// Context of the name comparison used while sorting
+static const char *sortNames;
+
+static int _sortByName(const void *a, const void *b)
+{
+    uint16_t aPos = *((const uint16_t *) a);
+    uint16_t bPos = *((const uint16_t *) b);
+
+    return _cmpName(&sortNames[aPos * CPS_STR_SIZE], aPos,
+                    &sortNames[bPos * CPS_STR_SIZE], bPos);
+}
+
+static int _sortByFreq(const void *a, const void *b)
+{
+    return _cmpFreq((const freqEntry_t *) a, (const freqEntry_t *) b);
+}
+
+/**
+ * \internal
+ * Build the index reading all the channels of the codeplug.
+ */
+static bool _build()
+{
+    channel_t channel;
+    uint32_t  num = 0;
+
+    count = 0;
+    valid = false;
+
+    while((num < UINT16_MAX) && (cps_readChannel(&channel, num) == 0))
+        num++;
+
+    if(_reserve(num) == false)
+        return false;
+
+    char *names = malloc((num > 0 ? num : 1) * CPS_STR_SIZE);
+    if(names == NULL)
+        return false;
+
+    for(uint32_t i = 0; i < num; i++)
+    {
+        cps_readChannel(&channel, i);
+        memcpy(&names[i * CPS_STR_SIZE], channel.name, CPS_STR_SIZE);
+        byName[i]      = i;
+        byFreq[i].freq = channel.rx_frequency;
+        byFreq[i].pos  = i;
+    }
+
+    if(num > 0)
+    {
+        sortNames = names;
+        qsort(byName, num, sizeof(uint16_t), _sortByName);
+        qsort(byFreq, num, sizeof(freqEntry_t), _sortByFreq);
+    }
+
+    free(names);
+
+    count = num;
+    valid = true;
+    return true;
+}
+
+/**
+ * \internal
+ * Get the size and modification time of the codeplug file.
+ */
+static bool _cpsStat(int64_t *size, int64_t *time)
+{
+    struct stat st;
+    if(stat(cpsFile, &st) < 0)
+        return false;
+
+    *size = st.st_size;
+    #ifdef __APPLE__
+    *time = (int64_t) st.st_mtimespec.tv_sec * 1000000000 + st.st_mtimespec.tv_nsec;
+    #else
+    *time = (int64_t) st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+    #endif
+    return true;
+}
+
+/**
+ * \internal
+ * Load the index from its file.
+ */
+static bool _load()
+{
+    FILE *f = fopen(idxPath, "rb");
+    if(f == NULL)
+        return false;
+
+    idxHeader_t hdr;
+    int64_t     size;
+    int64_t     time;
+    bool        ok = false;
+
+    if((fread(&hdr, sizeof(idxHeader_t), 1, f) == 1) &&
+       (hdr.magic == CPS_INDEX_MAGIC) && (hdr.version == CPS_INDEX_VERSION) &&
+       _cpsStat(&size, &time) && (hdr.cpsSize == size) &&
+       (hdr.cpsTime == time) && _reserve(hdr.count))
+    {
+        ok = (hdr.count == 0) ||
+             ((fread(byName, sizeof(uint16_t), hdr.count, f) == hdr.count) &&
+              (fread(byFreq, sizeof(freqEntry_t), hdr.count, f) == hdr.count));
+    }
+
+    fclose(f);
+
+    if(ok)
+    {
+        count = hdr.count;
+        valid = true;
+    }
+
+    return ok;
+}
+
+/**
+ * \internal
+ * Save the index to its file, replacing the previous one atomically.
+ */
+static void _save()
+{
+    idxHeader_t hdr;
+    hdr.magic   = CPS_INDEX_MAGIC;
+    hdr.version = CPS_INDEX_VERSION;
+    hdr.count   = count;
+    if(_cpsStat(&hdr.cpsSize, &hdr.cpsTime) == false)
+        return;
+
+    size_t len = strlen(idxPath);
+    char  *tmpPath = malloc(len + 5);
+    if(tmpPath == NULL)
+        return;
+
+    memcpy(tmpPath, idxPath, len);
+    memcpy(tmpPath + len, ".tmp", 5);
+
+    FILE *f = fopen(tmpPath, "wb");
+    if(f != NULL)
+    {
+        // An empty channel list leaves the tables unallocated
+        bool ok = (fwrite(&hdr, sizeof(idxHeader_t), 1, f) == 1) &&
+                  ((count == 0) ||
+                   ((fwrite(byName, sizeof(uint16_t), count, f) == count) &&
+                    (fwrite(byFreq, sizeof(freqEntry_t), count, f) == count)));
+
+        if((fclose(f) == 0) && ok)
+            rename(tmpPath, idxPath);
+        else
+            remove(tmpPath);
+    }
+
+    free(tmpPath);
+}
+
+/**
+ * \internal
+ * Make sure the index is up to date before a search.
+ */
+static bool _ensureValid()
+{
+    if(valid)
+        return true;
+
+    if(idxPath == NULL)
+        return false;
+
+    return _build();
+}
+
+void cpsIndex_open(const char *cpsPath)
+{
+    cpsIndex_close();
+
+    size_t len = strlen(cpsPath);
+    cpsFile = strdup(cpsPath);
+    idxPath = malloc(len + 5);
+    if((cpsFile == NULL) || (idxPath == NULL))
+    {
+        free(cpsFile);
+        free(idxPath);
+        cpsFile = NULL;
+        idxPath = NULL;
+        return;
+    }
+
+    memcpy(idxPath, cpsPath, len);
+    memcpy(idxPath + len, ".idx", 5);
+
+    if(_load() == false)
+        _build();
+}
+
+void cpsIndex_sync()
+{
+    if(idxPath != NULL)
+        _ensureValid();
+}
+
+void cpsIndex_close()
+{
+    if((idxPath != NULL) && valid)
+        _save();
+
+    free(byName);
+    free(byFreq);
+    free(idxPath);
+    free(cpsFile);
+
+    byName  = NULL;
+    byFreq  = NULL;
+    idxPath = NULL;
+    cpsFile = NULL;
+    count   = 0;
+    cap     = 0;
+    valid   = false;
+}
+
+void cpsIndex_invalidate()
+{
+    valid = false;
+}
+
+void cpsIndex_inserted(uint16_t pos)
+{
+    if(valid == false)
+        return;
+
+    channel_t channel;
+    if((cps_readChannel(&channel, pos) < 0) || (_reserve(count + 1) == false))
+    {
+        valid = false;
+        return;
+    }
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+        if(byName[i] >= pos)
+            byName[i]++;
+
+        if(byFreq[i].pos >= pos)
+            byFreq[i].pos++;
+    }
+
+    _add(pos, &channel);
+}
+
+void cpsIndex_written(uint16_t pos, const channel_t *prev,
+                      const channel_t *channel)
+{
+    if(valid == false)
+        return;
+
+    // Nothing to do if the sorting keys did not change
+    if((prev->rx_frequency == channel->rx_frequency) &&
+       (strncasecmp(prev->name, channel->name, CPS_STR_SIZE) == 0))
+        return;
+
+    _remove(pos);
+    _add(pos, channel);
+}
+
+void cpsIndex_removed(uint16_t pos)
+{
+    if(valid == false)
+        return;
+
+    _remove(pos);
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+        if(byName[i] > pos)
+            byName[i]--;
+
+        if(byFreq[i].pos > pos)
+            byFreq[i].pos--;
+    }
+}
+
+int cps_findChannelByName(const char *prefix)
+{
+    if(_ensureValid() == false)
+        return -1;
+
+    size_t   len = strlen(prefix);
+    uint32_t lo  = 0;
+    uint32_t hi  = count;
+    char     name[CPS_STR_SIZE];
+
+    // First entry not sorting before the prefix
+    while(lo < hi)
+    {
+        uint32_t mid = (lo + hi) / 2;
+        _readName(byName[mid], name);
+
+        if(strncasecmp(name, prefix, len) < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    if(lo == count)
+        return -1;
+
+    _readName(byName[lo], name);
+    if(strncasecmp(name, prefix, len) != 0)
+        return -1;
+
+    return byName[lo];
+}
+
+int cps_findChannelByFreq(freq_t freq)
+{
+    if((_ensureValid() == false) || (count == 0))
+        return -1;
+
+    uint32_t lo = 0;
+    uint32_t hi = count;
+    while(lo < hi)
+    {
+        uint32_t mid = (lo + hi) / 2;
+        if(byFreq[mid].freq < freq)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    // Nearest between the first entry above and the last one below
+    if(lo == count)
+        return byFreq[count - 1].pos;
+
+    if((lo > 0) && ((freq - byFreq[lo - 1].freq) <= (byFreq[lo].freq - freq)))
+        return byFreq[lo - 1].pos;
+
+    return byFreq[lo].pos;
+}
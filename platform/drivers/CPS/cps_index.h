@@ -0,0 +1,91 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef CPS_INDEX_H
+#define CPS_INDEX_H
+
+#include <stdint.h>
+#include <cps.h>
+
+/**
+ * Secondary index of the channel list for the codeplug backends of hosted
+ * platforms, keeping the channels sorted by name and by RX frequency. It
+ * provides the implementation of cps_findChannelByName() and
+ * cps_findChannelByFreq().
+ *
+ * The index is stored alongside the codeplug, in a file with the same name
+ * plus the ".idx" extension, and is rebuilt when it does not match the
+ * codeplug file. While the codeplug is open the index is kept in RAM and
+ * updated by the backend on every channel modification.
+ */
+
+/**
+ * Load the index of a codeplug, building it if the index file is missing or
+ * out of date. To be called once the codeplug has been opened.
+ *
+ * @param cpsPath: path of the codeplug file.
+ */
+void cpsIndex_open(const char *cpsPath);
+
+/**
+ * Bring the index up to date, if needed. To be called before closing the
+ * codeplug.
+ */
+void cpsIndex_sync();
+
+/**
+ * Save the index to its file and release the memory. To be called after the
+ * codeplug file has been closed.
+ */
+void cpsIndex_close();
+
+/**
+ * Mark the index as out of date, for modifications which are not tracked one
+ * by one. The index is rebuilt at the next search.
+ */
+void cpsIndex_invalidate();
+
+/**
+ * Update the index after the insertion of a channel.
+ *
+ * @param pos: position of the new channel, already stored in the codeplug.
+ */
+void cpsIndex_inserted(uint16_t pos);
+
+/**
+ * Update the index after a channel has been overwritten.
+ *
+ * @param pos: position of the channel, the new data is already stored in the
+ * codeplug.
+ * @param prev: previous content of the channel.
+ * @param channel: new content of the channel.
+ */
+void cpsIndex_written(uint16_t pos, const channel_t *prev,
+                      const channel_t *channel);
+
+/**
+ * Update the index after the removal of a channel.
+ *
+ * @param pos: position of the removed channel.
+ */
+void cpsIndex_removed(uint16_t pos);
+
+#endif /* CPS_INDEX_H */
@@ -19,33 +19,239 @@
  ***************************************************************************/
 
 #include <interfaces/cps_io.h>
+#include <contact_index.h>
+#include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 #include <stdio.h>
 #include <time.h>
+#include "cps_index.h"
 
 #define CPS_CHUNK_SIZE 1024
+#define CPS_CACHE_SIZE 16
+
+/**
+ * Tag of a record cache entry, the decoded record is stored in a separate
+ * array at the same index.
+ */
+typedef struct
+{
+    uint32_t stamp;    //< Last access time, used for LRU replacement
+    uint16_t pos;      //< Position of the cached record
+    bool     valid;    //< Entry holds valid data
+}
+cacheTag_t;
 
 static FILE *cps_file = NULL;
 const char *default_author = "Codeplug author.";
 const char *default_descr = "Codeplug description.";
 
+// Cached copy of the codeplug header, kept in sync by _writeHeader()
+static cps_header_t cps_header;
+static bool         header_valid = false;
+
+// Cached bank headers and their absolute position inside the file. When the
+// index is not valid all the reads go to the file, this happens while the
+// codeplug layout is being modified.
+static bankHdr_t   *bank_hdr    = NULL;
+static long        *bank_offset = NULL;
+static bool         index_valid = false;
+
+// LRU caches of the most recently accessed channels and contacts
+static cacheTag_t   ch_tag[CPS_CACHE_SIZE];
+static channel_t    ch_data[CPS_CACHE_SIZE];
+static cacheTag_t   ct_tag[CPS_CACHE_SIZE];
+static contact_t    ct_data[CPS_CACHE_SIZE];
+static uint32_t     cache_clock = 0;
+
+// Name of the currently open codeplug, needed to replace it on batch commit
+static char        *cps_path = NULL;
+
 /**
- * Internal: read and validate codeplug header
+ * In-memory copy of a bank, used during batch editing.
+ */
+typedef struct
+{
+    bankHdr_t hdr;     //< Bank header, ch_count is the size of the ch array
+    uint32_t *ch;      //< Channel indices
+    uint16_t  cap;     //< Allocated size of the ch array
+}
+memBank_t;
+
+/**
+ * In-memory copy of the whole codeplug, used during batch editing.
+ */
+static struct
+{
+    bool         active;
+    cps_header_t header;
+    contact_t   *contacts;
+    channel_t   *channels;
+    memBank_t   *banks;
+    uint16_t     ctCap;
+    uint16_t     chCap;
+    uint16_t     bCap;
+    bool         ctChanged;     // Contact list modified, index to be rebuilt
+    bool         chChanged;     // Channel list modified
+}
+batch;
+
+/**
+ * \internal
+ * Look up a record in a cache and, if found, mark it as the most recently
+ * used one.
+ *
+ * @param tag: tag array of the cache.
+ * @param pos: record position.
+ * @return index of the cache entry or -1 if the record is not cached.
+ */
+static int _cacheFind(cacheTag_t *tag, uint16_t pos)
+{
+    for(int i = 0; i < CPS_CACHE_SIZE; i++)
+    {
+        if(tag[i].valid && (tag[i].pos == pos))
+        {
+            tag[i].stamp = ++cache_clock;
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * \internal
+ * Allocate a cache entry for a record, evicting the least recently used one
+ * if the cache is full.
+ *
+ * @param tag: tag array of the cache.
+ * @param pos: record position.
+ * @return index of the allocated cache entry.
+ */
+static int _cacheAlloc(cacheTag_t *tag, uint16_t pos)
+{
+    int victim = 0;
+    for(int i = 0; i < CPS_CACHE_SIZE; i++)
+    {
+        if(tag[i].valid == false)
+        {
+            victim = i;
+            break;
+        }
+
+        if(tag[i].stamp < tag[victim].stamp)
+            victim = i;
+    }
+
+    tag[victim].valid = true;
+    tag[victim].pos   = pos;
+    tag[victim].stamp = ++cache_clock;
+
+    return victim;
+}
+
+/**
+ * \internal
+ * Drop the bank index and all the cached records. To be called before any
+ * operation changing the codeplug layout.
+ */
+static void _invalidateIndex()
+{
+    index_valid = false;
+    memset(ch_tag, 0x00, sizeof(ch_tag));
+    memset(ct_tag, 0x00, sizeof(ct_tag));
+}
+
+/**
+ * \internal
+ * Read and validate the codeplug header from the file, updating the cached
+ * copy.
  *
- * @param header: pointer to the header struct to be populated
  * @return 0 on success, -1 on failure
  */
-int _readHeader(cps_header_t *header)
+static int _loadHeader()
 {
+    header_valid = false;
     fseek(cps_file, 0L, SEEK_SET);
-    fread(header, sizeof(cps_header_t), 1, cps_file);
+    if(fread(&cps_header, sizeof(cps_header_t), 1, cps_file) != 1)
+        return -1;
     // Validate magic number
-    if(header->magic != CPS_MAGIC)
+    if(cps_header.magic != CPS_MAGIC)
         return -1;
     // Validate version number
-    if(((header->version_number & 0xff00) >> 8) != CPS_VERSION_MAJOR ||
-        (header->version_number & 0x00ff) > CPS_VERSION_MINOR)
+    if(((cps_header.version_number & 0xff00) >> 8) != CPS_VERSION_MAJOR ||
+        (cps_header.version_number & 0x00ff) > CPS_VERSION_MINOR)
+        return -1;
+
+    header_valid = true;
+    return 0;
+}
+
+/**
+ * \internal
+ * Load the codeplug header and build the bank index, resolving the relative
+ * bank offsets to absolute file positions.
+ *
+ * @return 0 on success, -1 on failure
+ */
+static int _loadIndex()
+{
+    _invalidateIndex();
+    if(_loadHeader() < 0)
         return -1;
+
+    uint16_t nBanks = cps_header.b_count;
+    free(bank_hdr);
+    free(bank_offset);
+    bank_hdr    = NULL;
+    bank_offset = NULL;
+
+    if(nBanks > 0)
+    {
+        bank_hdr    = (bankHdr_t *) malloc(nBanks * sizeof(bankHdr_t));
+        bank_offset = (long *)      malloc(nBanks * sizeof(long));
+        if((bank_hdr == NULL) || (bank_offset == NULL))
+            return -1;
+
+        // Offsets are relative to the end of the offset table
+        long table = sizeof(cps_header_t)
+                   + cps_header.ct_count * sizeof(contact_t)
+                   + cps_header.ch_count * sizeof(channel_t);
+        long data  = table + nBanks * sizeof(uint32_t);
+
+        fseek(cps_file, table, SEEK_SET);
+        for(uint16_t i = 0; i < nBanks; i++)
+        {
+            uint32_t offset = 0;
+            fread(&offset, sizeof(uint32_t), 1, cps_file);
+            bank_offset[i] = data + offset;
+        }
+
+        for(uint16_t i = 0; i < nBanks; i++)
+        {
+            fseek(cps_file, bank_offset[i], SEEK_SET);
+            fread(&bank_hdr[i], sizeof(bankHdr_t), 1, cps_file);
+        }
+    }
+
+    index_valid = true;
+    return 0;
+}
+
+/**
+ * Internal: get the cached codeplug header and place the file position right
+ * after it
+ *
+ * @param header: pointer to the header struct to be populated
+ * @return 0 on success, -1 on failure
+ */
+int _readHeader(cps_header_t *header)
+{
+    if(header_valid == false)
+        return -1;
+
+    *header = cps_header;
+    fseek(cps_file, sizeof(cps_header_t), SEEK_SET);
     return 0;
 }
 
@@ -59,6 +265,7 @@ int _writeHeader(cps_header_t header)
 {
     fseek(cps_file, 0L, SEEK_SET);
     fwrite(&header, sizeof(cps_header_t), 1, cps_file);
+    cps_header = header;
     return 0;
 }
 
@@ -210,6 +417,532 @@ long _getBankDataOffset(uint16_t pos)
            offset;
 }
 
+/**
+ * \internal
+ * Make room in a dynamically allocated array for one more element.
+ *
+ * @param array: pointer to the array.
+ * @param cap: pointer to the current capacity of the array, in elements.
+ * @param count: number of elements currently stored.
+ * @param size: size of a single element.
+ * @return 0 on success, -1 on failure
+ */
+static int _batchGrow(void **array, uint16_t *cap, uint16_t count, size_t size)
+{
+    if(count == UINT16_MAX)
+        return -1;
+
+    if(count < *cap)
+        return 0;
+
+    uint32_t newCap = (*cap == 0) ? 16 : (2 * (*cap));
+    if(newCap > UINT16_MAX)
+        newCap = UINT16_MAX;
+
+    void *ptr = realloc(*array, newCap * size);
+    if(ptr == NULL)
+        return -1;
+
+    *array = ptr;
+    *cap   = newCap;
+    return 0;
+}
+
+/**
+ * \internal
+ * Release all the memory held by the batch.
+ */
+static void _batchFree()
+{
+    for(uint16_t i = 0; i < batch.header.b_count; i++)
+        free(batch.banks[i].ch);
+
+    free(batch.contacts);
+    free(batch.channels);
+    free(batch.banks);
+    memset(&batch, 0x00, sizeof(batch));
+}
+
+/**
+ * \internal
+ * Update the contact indices of all the channels after a contact insertion
+ * or removal.
+ *
+ * @param pos: position at which the contact was inserted or removed.
+ * @param add: if true a contact was inserted, otherwise it was removed.
+ */
+static void _batchCtNumbering(uint16_t pos, bool add)
+{
+    for(uint16_t i = 0; i < batch.header.ch_count; i++)
+    {
+        channel_t *c = &batch.channels[i];
+        uint16_t index;
+
+        if(c->mode == OPMODE_M17)
+            index = c->m17.contact_index;
+        else if(c->mode == OPMODE_DMR)
+            index = c->dmr.contact_index;
+        else
+            continue;
+
+        if(add && (index >= pos))
+            index++;
+        else if((add == false) && (index > pos))
+            index--;
+
+        if(c->mode == OPMODE_M17)
+            c->m17.contact_index = index;
+        else
+            c->dmr.contact_index = index;
+    }
+}
+
+/**
+ * \internal
+ * Update the channel indices of all the banks after a channel insertion or
+ * removal. On removal, the references to the deleted channel are dropped.
+ *
+ * @param pos: position at which the channel was inserted or removed.
+ * @param add: if true a channel was inserted, otherwise it was removed.
+ */
+static void _batchChNumbering(uint16_t pos, bool add)
+{
+    for(uint16_t i = 0; i < batch.header.b_count; i++)
+    {
+        memBank_t *b = &batch.banks[i];
+        uint16_t   n = 0;
+
+        for(uint16_t j = 0; j < b->hdr.ch_count; j++)
+        {
+            uint32_t ch = b->ch[j];
+            if(add && (ch >= pos))
+                ch++;
+            else if(add == false)
+            {
+                if(ch == pos)
+                    continue;
+                if(ch > pos)
+                    ch--;
+            }
+
+            b->ch[n++] = ch;
+        }
+
+        b->hdr.ch_count = n;
+    }
+}
+
+/**
+ * \internal
+ * Write the in-memory codeplug to a file, following the standard layout.
+ *
+ * @param file: destination file.
+ * @return 0 on success, -1 on failure
+ */
+static int _batchWrite(FILE *file)
+{
+    const cps_header_t *hdr = &batch.header;
+
+    if(fwrite(hdr, sizeof(cps_header_t), 1, file) != 1)
+        return -1;
+
+    if(fwrite(batch.contacts, sizeof(contact_t), hdr->ct_count, file)
+       != hdr->ct_count)
+        return -1;
+
+    if(fwrite(batch.channels, sizeof(channel_t), hdr->ch_count, file)
+       != hdr->ch_count)
+        return -1;
+
+    // Bank offsets are relative to the end of the offset table
+    uint32_t offset = 0;
+    for(uint16_t i = 0; i < hdr->b_count; i++)
+    {
+        if(fwrite(&offset, sizeof(uint32_t), 1, file) != 1)
+            return -1;
+
+        offset += sizeof(bankHdr_t)
+                + batch.banks[i].hdr.ch_count * sizeof(uint32_t);
+    }
+
+    for(uint16_t i = 0; i < hdr->b_count; i++)
+    {
+        const memBank_t *b = &batch.banks[i];
+
+        if(fwrite(&b->hdr, sizeof(bankHdr_t), 1, file) != 1)
+            return -1;
+
+        if(fwrite(b->ch, sizeof(uint32_t), b->hdr.ch_count, file)
+           != b->hdr.ch_count)
+            return -1;
+    }
+
+    return 0;
+}
+
+/*
+ * Batch counterparts of the codeplug access functions, operating on the
+ * in-memory copy of the codeplug.
+ */
+
+static int _batchReadContact(contact_t *contact, uint16_t pos)
+{
+    if(pos >= batch.header.ct_count)
+        return -1;
+
+    *contact = batch.contacts[pos];
+    return 0;
+}
+
+static int _batchReadChannel(channel_t *channel, uint16_t pos)
+{
+    if(pos >= batch.header.ch_count)
+        return -1;
+
+    *channel = batch.channels[pos];
+    return 0;
+}
+
+static int _batchReadBankHeader(bankHdr_t *b_header, uint16_t pos)
+{
+    if(pos >= batch.header.b_count)
+        return -1;
+
+    *b_header = batch.banks[pos].hdr;
+    return 0;
+}
+
+static int _batchReadBankData(uint16_t bank_pos, uint16_t pos)
+{
+    if(bank_pos >= batch.header.b_count)
+        return -1;
+
+    if(pos >= batch.banks[bank_pos].hdr.ch_count)
+        return -1;
+
+    return batch.banks[bank_pos].ch[pos];
+}
+
+static int _batchWriteContact(contact_t contact, uint16_t pos)
+{
+    if(pos >= batch.header.ct_count)
+        return -1;
+
+    batch.contacts[pos] = contact;
+    batch.ctChanged = true;
+    contactIndex_invalidate();
+    return 0;
+}
+
+static int _batchWriteChannel(channel_t channel, uint16_t pos)
+{
+    if(pos >= batch.header.ch_count)
+        return -1;
+
+    batch.channels[pos] = channel;
+    batch.chChanged = true;
+    cpsIndex_invalidate();
+    return 0;
+}
+
+static int _batchWriteBankHeader(bankHdr_t b_header, uint16_t pos)
+{
+    if(pos >= batch.header.b_count)
+        return -1;
+
+    // The channel count is owned by the bank data
+    b_header.ch_count = batch.banks[pos].hdr.ch_count;
+    batch.banks[pos].hdr = b_header;
+    return 0;
+}
+
+static int _batchWriteBankData(uint32_t ch, uint16_t bank_pos, uint16_t pos)
+{
+    if(bank_pos >= batch.header.b_count)
+        return -1;
+
+    if(pos >= batch.banks[bank_pos].hdr.ch_count)
+        return -1;
+
+    batch.banks[bank_pos].ch[pos] = ch;
+    return 0;
+}
+
+static int _batchInsertContact(contact_t contact, uint16_t pos)
+{
+    uint16_t count = batch.header.ct_count;
+    if(pos > count)
+        return -1;
+
+    if(_batchGrow((void **) &batch.contacts, &batch.ctCap, count,
+                  sizeof(contact_t)) < 0)
+        return -1;
+
+    memmove(&batch.contacts[pos + 1], &batch.contacts[pos],
+            (count - pos) * sizeof(contact_t));
+    batch.contacts[pos] = contact;
+    batch.header.ct_count++;
+    _batchCtNumbering(pos, true);
+    batch.ctChanged = true;
+    contactIndex_invalidate();
+
+    return 0;
+}
+
+static int _batchInsertChannel(channel_t channel, uint16_t pos)
+{
+    uint16_t count = batch.header.ch_count;
+    if(pos > count)
+        return -1;
+
+    if(_batchGrow((void **) &batch.channels, &batch.chCap, count,
+                  sizeof(channel_t)) < 0)
+        return -1;
+
+    memmove(&batch.channels[pos + 1], &batch.channels[pos],
+            (count - pos) * sizeof(channel_t));
+    batch.channels[pos] = channel;
+    batch.header.ch_count++;
+    _batchChNumbering(pos, true);
+    batch.chChanged = true;
+    cpsIndex_invalidate();
+
+    return 0;
+}
+
+static int _batchInsertBankHeader(bankHdr_t b_header, uint16_t pos)
+{
+    uint16_t count = batch.header.b_count;
+    if(pos > count)
+        return -1;
+
+    if(_batchGrow((void **) &batch.banks, &batch.bCap, count,
+                  sizeof(memBank_t)) < 0)
+        return -1;
+
+    memmove(&batch.banks[pos + 1], &batch.banks[pos],
+            (count - pos) * sizeof(memBank_t));
+
+    // A new bank is always empty, channels are added with insertBankData
+    memset(&batch.banks[pos], 0x00, sizeof(memBank_t));
+    batch.banks[pos].hdr = b_header;
+    batch.banks[pos].hdr.ch_count = 0;
+    batch.header.b_count++;
+
+    return 0;
+}
+
+static int _batchInsertBankData(uint32_t ch, uint16_t bank_pos, uint16_t pos)
+{
+    if(bank_pos >= batch.header.b_count)
+        return -1;
+
+    memBank_t *b = &batch.banks[bank_pos];
+    uint16_t   count = b->hdr.ch_count;
+    if(pos > count)
+        return -1;
+
+    if(_batchGrow((void **) &b->ch, &b->cap, count, sizeof(uint32_t)) < 0)
+        return -1;
+
+    memmove(&b->ch[pos + 1], &b->ch[pos], (count - pos) * sizeof(uint32_t));
+    b->ch[pos] = ch;
+    b->hdr.ch_count++;
+
+    return 0;
+}
+
+static int _batchDeleteContact(uint16_t pos)
+{
+    uint16_t count = batch.header.ct_count;
+    if(pos >= count)
+        return -1;
+
+    memmove(&batch.contacts[pos], &batch.contacts[pos + 1],
+            (count - pos - 1) * sizeof(contact_t));
+    batch.header.ct_count--;
+    _batchCtNumbering(pos, false);
+    batch.ctChanged = true;
+    contactIndex_invalidate();
+
+    return 0;
+}
+
+static int _batchDeleteChannel(uint16_t pos)
+{
+    uint16_t count = batch.header.ch_count;
+    if(pos >= count)
+        return -1;
+
+    memmove(&batch.channels[pos], &batch.channels[pos + 1],
+            (count - pos - 1) * sizeof(channel_t));
+    batch.header.ch_count--;
+    _batchChNumbering(pos, false);
+    batch.chChanged = true;
+    cpsIndex_invalidate();
+
+    return 0;
+}
+
+static int _batchDeleteBankHeader(uint16_t pos)
+{
+    uint16_t count = batch.header.b_count;
+    if(pos >= count)
+        return -1;
+
+    free(batch.banks[pos].ch);
+    memmove(&batch.banks[pos], &batch.banks[pos + 1],
+            (count - pos - 1) * sizeof(memBank_t));
+    batch.header.b_count--;
+
+    return 0;
+}
+
+static int _batchDeleteBankData(uint16_t bank_pos, uint16_t pos)
+{
+    if(bank_pos >= batch.header.b_count)
+        return -1;
+
+    memBank_t *b = &batch.banks[bank_pos];
+    uint16_t   count = b->hdr.ch_count;
+    if(pos >= count)
+        return -1;
+
+    memmove(&b->ch[pos], &b->ch[pos + 1], (count - pos - 1) * sizeof(uint32_t));
+    b->hdr.ch_count--;
+
+    return 0;
+}
+
+int cps_beginBatch()
+{
+    if((cps_file == NULL) || batch.active || (index_valid == false))
+        return -1;
+
+    const cps_header_t *hdr = &cps_header;
+    memset(&batch, 0x00, sizeof(batch));
+    batch.header = *hdr;
+    batch.ctCap  = hdr->ct_count;
+    batch.chCap  = hdr->ch_count;
+    batch.bCap   = hdr->b_count;
+
+    batch.contacts = (contact_t *) malloc(hdr->ct_count * sizeof(contact_t));
+    batch.channels = (channel_t *) malloc(hdr->ch_count * sizeof(channel_t));
+    batch.banks    = (memBank_t *) calloc(hdr->b_count,  sizeof(memBank_t));
+
+    if(((hdr->ct_count > 0) && (batch.contacts == NULL)) ||
+       ((hdr->ch_count > 0) && (batch.channels == NULL)) ||
+       ((hdr->b_count  > 0) && (batch.banks    == NULL)))
+    {
+        _batchFree();
+        return -1;
+    }
+
+    // Contacts and channels are contiguous, load them in one go
+    fseek(cps_file, sizeof(cps_header_t), SEEK_SET);
+    fread(batch.contacts, sizeof(contact_t), hdr->ct_count, cps_file);
+    fread(batch.channels, sizeof(channel_t), hdr->ch_count, cps_file);
+
+    for(uint16_t i = 0; i < hdr->b_count; i++)
+    {
+        memBank_t *b   = &batch.banks[i];
+        uint16_t count = bank_hdr[i].ch_count;
+
+        b->hdr = bank_hdr[i];
+        b->cap = count;
+        b->ch  = (uint32_t *) malloc(count * sizeof(uint32_t));
+        if((count > 0) && (b->ch == NULL))
+        {
+            _batchFree();
+            return -1;
+        }
+
+        fseek(cps_file, bank_offset[i] + sizeof(bankHdr_t), SEEK_SET);
+        fread(b->ch, sizeof(uint32_t), count, cps_file);
+    }
+
+    batch.active = true;
+    return 0;
+}
+
+int cps_commitBatch()
+{
+    if(batch.active == false)
+        return -1;
+
+    // Write the new codeplug aside and then atomically replace the old one
+    size_t len = strlen(cps_path);
+    char  *tmpPath = (char *) malloc(len + 5);
+    if(tmpPath == NULL)
+        return -1;
+
+    memcpy(tmpPath, cps_path, len);
+    memcpy(tmpPath + len, ".tmp", 5);
+
+    FILE *tmp = fopen(tmpPath, "w");
+    if(tmp == NULL)
+    {
+        free(tmpPath);
+        return -1;
+    }
+
+    // Data has to be on the storage before the rename, otherwise a power loss
+    // could leave an empty or truncated codeplug in place of the old one.
+    int ret = _batchWrite(tmp);
+    if((fflush(tmp) != 0) || (fsync(fileno(tmp)) != 0))
+        ret = -1;
+
+    if(fclose(tmp) != 0)
+        ret = -1;
+
+    if(ret == 0)
+        ret = rename(tmpPath, cps_path);
+
+    if(ret != 0)
+    {
+        remove(tmpPath);
+        free(tmpPath);
+        return -1;
+    }
+
+    free(tmpPath);
+
+    // Switch to the new file, the old handle refers to the replaced one
+    fclose(cps_file);
+    cps_file = fopen(cps_path, "r+");
+    if(cps_file == NULL)
+    {
+        _batchFree();
+        cpsIndex_invalidate();
+        cps_close();
+        return -1;
+    }
+
+    bool rebuild = batch.ctChanged;
+    _batchFree();
+    _loadIndex();
+
+    if(rebuild)
+        contactIndex_build();
+
+    return 0;
+}
+
+void cps_abortBatch()
+{
+    if(batch.active == false)
+        return;
+
+    bool rebuild = batch.ctChanged;
+    if(batch.chChanged)
+        cpsIndex_invalidate();
+
+    _batchFree();
+
+    if(rebuild)
+        contactIndex_build();
+}
+
 int cps_open(char *cps_name)
 {
     if (!cps_name)
@@ -217,12 +950,29 @@ int cps_open(char *cps_name)
     cps_file = fopen(cps_name, "r+");
     if (!cps_file)
         return -1;
+    free(cps_path);
+    cps_path = strdup(cps_name);
+    _loadIndex();
+    cpsIndex_open(cps_path);
     return 0;
 }
 
 void cps_close()
 {
-    fclose(cps_file);
+    cps_abortBatch();
+    cpsIndex_sync();
+    _invalidateIndex();
+    header_valid = false;
+    free(bank_hdr);
+    free(bank_offset);
+    bank_hdr    = NULL;
+    bank_offset = NULL;
+    free(cps_path);
+    cps_path = NULL;
+    if(cps_file != NULL)
+        fclose(cps_file);
+    cps_file = NULL;
+    cpsIndex_close();
 }
 
 int cps_create(char *cps_name)
@@ -252,38 +1002,85 @@ int cps_create(char *cps_name)
 
 int cps_readContact(contact_t *contact, uint16_t pos)
 {
-    cps_header_t header = { 0 };
-    if (_readHeader(&header))
-        return -1;
-    if (pos >= header.ct_count)
+    if (batch.active)
+        return _batchReadContact(contact, pos);
+
+    if ((header_valid == false) || (pos >= cps_header.ct_count))
         return -1;
-    fseek(cps_file, pos * sizeof(contact_t), SEEK_CUR);
+
+    int entry = -1;
+    if (index_valid)
+    {
+        entry = _cacheFind(ct_tag, pos);
+        if (entry >= 0)
+        {
+            *contact = ct_data[entry];
+            return 0;
+        }
+    }
+
+    fseek(cps_file, sizeof(cps_header_t) + pos * sizeof(contact_t), SEEK_SET);
     fread(contact, sizeof(contact_t), 1, cps_file);
+
+    if (index_valid)
+    {
+        entry = _cacheAlloc(ct_tag, pos);
+        ct_data[entry] = *contact;
+    }
+
     return 0;
 }
 
 int cps_readChannel(channel_t *channel, uint16_t pos)
 {
-    cps_header_t header = { 0 };
-    if (_readHeader(&header))
-        return -1;
-    if (pos >= header.ch_count)
+    if (batch.active)
+        return _batchReadChannel(channel, pos);
+
+    if ((header_valid == false) || (pos >= cps_header.ch_count))
         return -1;
+
+    int entry = -1;
+    if (index_valid)
+    {
+        entry = _cacheFind(ch_tag, pos);
+        if (entry >= 0)
+        {
+            *channel = ch_data[entry];
+            return 0;
+        }
+    }
+
     fseek(cps_file,
-          header.ct_count * sizeof(contact_t) +
+          sizeof(cps_header_t) +
+          cps_header.ct_count * sizeof(contact_t) +
           pos * sizeof(channel_t),
-          SEEK_CUR);
+          SEEK_SET);
     fread(channel, sizeof(channel_t), 1, cps_file);
+
+    if (index_valid)
+    {
+        entry = _cacheAlloc(ch_tag, pos);
+        ch_data[entry] = *channel;
+    }
+
     return 0;
 }
 
 int cps_readBankHeader(bankHdr_t *b_header, uint16_t pos)
 {
+    if (batch.active)
+        return _batchReadBankHeader(b_header, pos);
+
     cps_header_t header = { 0 };
     if (_readHeader(&header))
         return -1;
     if (pos >= header.b_count)
         return -1;
+    if (index_valid)
+    {
+        *b_header = bank_hdr[pos];
+        return 0;
+    }
     fseek(cps_file,
           header.ct_count * sizeof(contact_t) +
           header.ch_count * sizeof(channel_t) +
@@ -298,11 +1095,25 @@ int cps_readBankHeader(bankHdr_t *b_header, uint16_t pos)
 
 int cps_readBankData(uint16_t bank_pos, uint16_t pos)
 {
+    if (batch.active)
+        return _batchReadBankData(bank_pos, pos);
+
     cps_header_t header = { 0 };
     if (_readHeader(&header))
         return -1;
     if (bank_pos >= header.b_count)
         return -1;
+    if (index_valid)
+    {
+        if (pos >= bank_hdr[bank_pos].ch_count)
+            return -1;
+        fseek(cps_file,
+              bank_offset[bank_pos] + sizeof(bankHdr_t) + pos * sizeof(uint32_t),
+              SEEK_SET);
+        uint32_t ch_index = 0;
+        fread(&ch_index, sizeof(uint32_t), 1, cps_file);
+        return ch_index;
+    }
     fseek(cps_file,
           header.ct_count * sizeof(contact_t) +
           header.ch_count * sizeof(channel_t) +
@@ -323,6 +1134,12 @@ int cps_readBankData(uint16_t bank_pos, uint16_t pos)
 
 int cps_writeContact(contact_t contact, uint16_t pos)
 {
+    if (batch.active)
+        return _batchWriteContact(contact, pos);
+
+    contact_t prev;
+    if (cps_readContact(&prev, pos) < 0)
+        return -1;
     cps_header_t header = { 0 };
     if (_readHeader(&header))
         return -1;
@@ -330,11 +1147,24 @@ int cps_writeContact(contact_t contact, uint16_t pos)
         return -1;
     fseek(cps_file, pos * sizeof(contact_t), SEEK_CUR);
     fwrite(&contact, sizeof(contact_t), 1, cps_file);
+    // Keep the cached copy, if any, up to date
+    int entry = _cacheFind(ct_tag, pos);
+    if (entry >= 0)
+        ct_data[entry] = contact;
+    contactIndex_written(pos, &prev, &contact);
     return 0;
 }
 
 int cps_writeChannel(channel_t channel, uint16_t pos)
 {
+    if (batch.active)
+        return _batchWriteChannel(channel, pos);
+
+    // Channel updates done while the layout is being changed do not touch
+    // the fields tracked by the search index.
+    channel_t prev;
+    bool track = index_valid && (cps_readChannel(&prev, pos) == 0);
+
     cps_header_t header = { 0 };
     if (_readHeader(&header))
         return -1;
@@ -345,10 +1175,20 @@ int cps_writeChannel(channel_t channel, uint16_t pos)
           pos * sizeof(channel_t),
           SEEK_CUR);
     fwrite(&channel, sizeof(channel_t), 1, cps_file);
+    // Keep the cached copy, if any, up to date
+    int entry = _cacheFind(ch_tag, pos);
+    if (entry >= 0)
+        ch_data[entry] = channel;
+    if (track)
+        cpsIndex_written(pos, &prev, &channel);
     return 0;
 }
 
-int cps_writeBankHeader(bankHdr_t b_header, uint16_t pos)
+/**
+ * \internal
+ * Write a bank header, see cps_writeBankHeader().
+ */
+static int _writeBankHeader(bankHdr_t b_header, uint16_t pos)
 {
     cps_header_t header = { 0 };
     if (_readHeader(&header))
@@ -369,6 +1209,9 @@ int cps_writeBankHeader(bankHdr_t b_header, uint16_t pos)
 
 int cps_writeBankData(uint32_t ch, uint16_t bank_pos, uint16_t pos)
 {
+    if (batch.active)
+        return _batchWriteBankData(ch, bank_pos, pos);
+
     cps_header_t header = { 0 };
     if (_readHeader(&header))
         return -1;
@@ -391,7 +1234,11 @@ int cps_writeBankData(uint32_t ch, uint16_t bank_pos, uint16_t pos)
     return 0;
 }
 
-int cps_insertContact(contact_t contact, uint16_t pos)
+/**
+ * \internal
+ * Insert a contact, see cps_insertContact().
+ */
+static int _insertContact(contact_t contact, uint16_t pos)
 {
     cps_header_t header = { 0 };
     if (_readHeader(&header))
@@ -408,7 +1255,11 @@ int cps_insertContact(contact_t contact, uint16_t pos)
     return 0;
 }
 
-int cps_insertChannel(channel_t channel, uint16_t pos)
+/**
+ * \internal
+ * Insert a channel, see cps_insertChannel().
+ */
+static int _insertChannel(channel_t channel, uint16_t pos)
 {
     cps_header_t header = { 0 };
     if (_readHeader(&header))
@@ -426,7 +1277,11 @@ int cps_insertChannel(channel_t channel, uint16_t pos)
     return 0;
 }
 
-int cps_insertBankHeader(bankHdr_t b_header, uint16_t pos)
+/**
+ * \internal
+ * Insert a bank header, see cps_insertBankHeader().
+ */
+static int _insertBankHeader(bankHdr_t b_header, uint16_t pos)
 {
     cps_header_t header = { 0 };
     if (_readHeader(&header))
@@ -460,7 +1315,11 @@ int cps_insertBankHeader(bankHdr_t b_header, uint16_t pos)
     return 0;
 }
 
-int cps_insertBankData(uint32_t ch, uint16_t bank_pos, uint16_t pos)
+/**
+ * \internal
+ * Insert a channel in a bank, see cps_insertBankData().
+ */
+static int _insertBankData(uint32_t ch, uint16_t bank_pos, uint16_t pos)
 {
     cps_header_t header = { 0 };
     if (_readHeader(&header))
@@ -500,3 +1359,136 @@ int cps_insertBankData(uint32_t ch, uint16_t bank_pos, uint16_t pos)
     fwrite(&ch, sizeof(uint32_t), 1, cps_file);
     return 0;
 }
+
+int cps_writeBankHeader(bankHdr_t b_header, uint16_t pos)
+{
+    if (batch.active)
+        return _batchWriteBankHeader(b_header, pos);
+
+    _invalidateIndex();
+    int ret = _writeBankHeader(b_header, pos);
+    _loadIndex();
+    return ret;
+}
+
+int cps_insertContact(contact_t contact, uint16_t pos)
+{
+    if (batch.active)
+        return _batchInsertContact(contact, pos);
+
+    _invalidateIndex();
+    int ret = _insertContact(contact, pos);
+    _loadIndex();
+    if (ret == 0)
+        contactIndex_inserted(&contact, pos);
+    return ret;
+}
+
+int cps_insertChannel(channel_t channel, uint16_t pos)
+{
+    if (batch.active)
+        return _batchInsertChannel(channel, pos);
+
+    _invalidateIndex();
+    int ret = _insertChannel(channel, pos);
+    _loadIndex();
+    if (ret == 0)
+        cpsIndex_inserted(pos);
+    return ret;
+}
+
+int cps_insertBankHeader(bankHdr_t b_header, uint16_t pos)
+{
+    if (batch.active)
+        return _batchInsertBankHeader(b_header, pos);
+
+    _invalidateIndex();
+    int ret = _insertBankHeader(b_header, pos);
+    _loadIndex();
+    return ret;
+}
+
+int cps_insertBankData(uint32_t ch, uint16_t bank_pos, uint16_t pos)
+{
+    if (batch.active)
+        return _batchInsertBankData(ch, bank_pos, pos);
+
+    _invalidateIndex();
+    int ret = _insertBankData(ch, bank_pos, pos);
+    _loadIndex();
+    return ret;
+}
+
+int cps_deleteContact(uint16_t pos)
+{
+    if (batch.active)
+        return _batchDeleteContact(pos);
+
+    // Deletions are applied as single-operation batches
+    if (cps_beginBatch() < 0)
+        return -1;
+
+    if (_batchDeleteContact(pos) < 0)
+    {
+        cps_abortBatch();
+        return -1;
+    }
+
+    return cps_commitBatch();
+}
+
+int cps_deleteChannel(channel_t channel, uint16_t pos)
+{
+    (void) channel;
+
+    if (batch.active)
+        return _batchDeleteChannel(pos);
+
+    // Deletions are applied as single-operation batches
+    if (cps_beginBatch() < 0)
+        return -1;
+
+    if (_batchDeleteChannel(pos) < 0)
+    {
+        cps_abortBatch();
+        return -1;
+    }
+
+    return cps_commitBatch();
+}
+
+int cps_deleteBankHeader(uint16_t pos)
+{
+    if (batch.active)
+        return _batchDeleteBankHeader(pos);
+
+    // Deletions are applied as single-operation batches
+    if (cps_beginBatch() < 0)
+        return -1;
+
+    if (_batchDeleteBankHeader(pos) < 0)
+    {
+        cps_abortBatch();
+        return -1;
+    }
+
+    return cps_commitBatch();
+}
+
+int cps_deleteBankData(uint16_t bank_pos, uint16_t pos)
+{
+    if (batch.active)
+        return _batchDeleteBankData(bank_pos, pos);
+
+    // Deletions are applied as single-operation batches
+    if (cps_beginBatch() < 0)
+        return -1;
+
+    if (_batchDeleteBankData(bank_pos, pos) < 0)
+    {
+        cps_abortBatch();
+        return -1;
+    }
+
+    return cps_commitBatch();
+}
@@ -0,0 +1,842 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <interfaces/cps_io.h>
+#include <contact_index.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <time.h>
+#include "cps_index.h"
+
+/*
+ * Codeplug backend for hosted platforms, accessing the codeplug file through
+ * a shared memory mapping. The file layout is the same of the libc backend.
+ *
+ * All the operations act on a memory image of the codeplug: outside of a batch
+ * the image is the file mapping itself and modifications are done in place,
+ * during a batch the image is a private copy on the heap which replaces the
+ * file on commit.
+ */
+
+#define CPS_MAP_RESERVE (64 * 1024)
+
+/**
+ * Memory image of a codeplug.
+ */
+typedef struct
+{
+    uint8_t *data;     //< Image base address
+    size_t   size;     //< Size of the codeplug
+    size_t   cap;      //< Size of the memory area holding the codeplug
+}
+image_t;
+
+static int      cps_fd   = -1;
+static char    *cps_path = NULL;
+static bool     valid    = false;   // Open codeplug has a valid header
+static image_t  file     = { NULL, 0, 0 };
+static image_t  heap     = { NULL, 0, 0 };
+static image_t *img      = &file;
+static bool     ctChanged = false;  // Contacts modified during the batch
+static bool     chChanged = false;  // Channels modified during the batch
+
+const char *default_author = "Codeplug author.";
+const char *default_descr = "Codeplug description.";
+
+/**
+ * \internal
+ * Get the header of the current image.
+ */
+static inline cps_header_t *_header()
+{
+    return (cps_header_t *) img->data;
+}
+
+static inline size_t _contactOffset(uint16_t pos)
+{
+    return sizeof(cps_header_t) + pos * sizeof(contact_t);
+}
+
+static inline size_t _channelOffset(uint16_t pos)
+{
+    return _contactOffset(_header()->ct_count) + pos * sizeof(channel_t);
+}
+
+static inline size_t _tableOffset(uint16_t pos)
+{
+    return _channelOffset(_header()->ch_count) + pos * sizeof(uint32_t);
+}
+
+static inline uint32_t _read32(size_t offset)
+{
+    uint32_t value;
+    memcpy(&value, img->data + offset, sizeof(uint32_t));
+    return value;
+}
+
+static inline void _write32(size_t offset, uint32_t value)
+{
+    memcpy(img->data + offset, &value, sizeof(uint32_t));
+}
+
+/**
+ * \internal
+ * Compute the offset of a bank header inside the image. Bank offsets are
+ * stored relative to the end of the offset table.
+ *
+ * @param pos: bank index, if equal to the bank count the offset of the end of
+ * the bank data is returned.
+ * @return offset of the bank.
+ */
+static size_t _bankOffset(uint16_t pos)
+{
+    size_t dataStart = _tableOffset(_header()->b_count);
+    if(pos == _header()->b_count)
+        return img->size;
+
+    return dataStart + _read32(_tableOffset(pos));
+}
+
+/**
+ * \internal
+ * Get the number of channels in a bank.
+ */
+static inline uint16_t _bankCount(uint16_t pos)
+{
+    const bankHdr_t *b = (const bankHdr_t *) (img->data + _bankOffset(pos));
+    return b->ch_count;
+}
+
+/**
+ * \internal
+ * Map the codeplug file reserving some space for its growth.
+ *
+ * @param size: size of the file.
+ * @return 0 on success, -1 on failure
+ */
+static int _map(size_t size)
+{
+    size_t cap = size + CPS_MAP_RESERVE;
+    if(cap < (2 * size))
+        cap = 2 * size;
+
+    void *ptr = mmap(NULL, cap, PROT_READ | PROT_WRITE, MAP_SHARED, cps_fd, 0);
+    if(ptr == MAP_FAILED)
+        return -1;
+
+    file.data = (uint8_t *) ptr;
+    file.size = size;
+    file.cap  = cap;
+
+    return 0;
+}
+
+static void _unmap()
+{
+    if(file.data != NULL)
+        munmap(file.data, file.cap);
+
+    file.data = NULL;
+    file.size = 0;
+    file.cap  = 0;
+}
+
+/**
+ * \internal
+ * Change the size of the current image. The file is resized with ftruncate
+ * and remapped only when it outgrows the reserved space.
+ *
+ * @param size: new image size.
+ * @return 0 on success, -1 on failure
+ */
+static int _resize(size_t size)
+{
+    if(img == &heap)
+    {
+        if(size > heap.cap)
+        {
+            size_t cap = 2 * size;
+            void  *ptr = realloc(heap.data, cap);
+            if(ptr == NULL)
+                return -1;
+
+            heap.data = (uint8_t *) ptr;
+            heap.cap  = cap;
+        }
+
+        heap.size = size;
+        return 0;
+    }
+
+    if(ftruncate(cps_fd, size) < 0)
+        return -1;
+
+    if(size > file.cap)
+    {
+        _unmap();
+        return _map(size);
+    }
+
+    file.size = size;
+    return 0;
+}
+
+/**
+ * \internal
+ * Open a gap of a given size in the image, moving down all the following data.
+ *
+ * @param offset: offset of the gap.
+ * @param amount: size of the gap.
+ * @return 0 on success, -1 on failure
+ */
+static int _openGap(size_t offset, size_t amount)
+{
+    size_t oldSize = img->size;
+    if(_resize(oldSize + amount) < 0)
+        return -1;
+
+    memmove(img->data + offset + amount, img->data + offset, oldSize - offset);
+    return 0;
+}
+
+/**
+ * \internal
+ * Remove a range of data from the image, moving up all the following data.
+ *
+ * @param offset: start of the range.
+ * @param amount: size of the range.
+ * @return 0 on success, -1 on failure
+ */
+static int _closeGap(size_t offset, size_t amount)
+{
+    memmove(img->data + offset, img->data + offset + amount,
+            img->size - offset - amount);
+
+    return _resize(img->size - amount);
+}
+
+/**
+ * \internal
+ * Add a constant to the offsets of all the banks following a given one.
+ *
+ * @param pos: index of the first bank to be updated.
+ * @param delta: amount to be added.
+ */
+static void _shiftBanks(uint16_t pos, int32_t delta)
+{
+    for(uint16_t i = pos; i < _header()->b_count; i++)
+    {
+        size_t entry = _tableOffset(i);
+        _write32(entry, _read32(entry) + delta);
+    }
+}
+
+/**
+ * \internal
+ * Validate the header and check that the codeplug layout fits into the image.
+ *
+ * @return true if the codeplug is valid.
+ */
+static bool _validate()
+{
+    if(img->size < sizeof(cps_header_t))
+        return false;
+
+    const cps_header_t *hdr = _header();
+    if(hdr->magic != CPS_MAGIC)
+        return false;
+
+    if(((hdr->version_number & 0xff00) >> 8) != CPS_VERSION_MAJOR ||
+        (hdr->version_number & 0x00ff) > CPS_VERSION_MINOR)
+        return false;
+
+    if(_tableOffset(hdr->b_count) > img->size)
+        return false;
+
+    for(uint16_t i = 0; i < hdr->b_count; i++)
+    {
+        size_t offset = _bankOffset(i);
+        if(offset + sizeof(bankHdr_t) > img->size)
+            return false;
+
+        if(offset + sizeof(bankHdr_t) + _bankCount(i) * sizeof(uint32_t)
+           > img->size)
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * \internal
+ * Update the contact indices of all the channels after a contact insertion
+ * or removal.
+ *
+ * @param pos: position at which the contact was inserted or removed.
+ * @param add: if true a contact was inserted, otherwise it was removed.
+ */
+static void _updateCtNumbering(uint16_t pos, bool add)
+{
+    for(uint16_t i = 0; i < _header()->ch_count; i++)
+    {
+        channel_t *c = (channel_t *) (img->data + _channelOffset(i));
+        uint16_t index;
+
+        if(c->mode == OPMODE_M17)
+            index = c->m17.contact_index;
+        else if(c->mode == OPMODE_DMR)
+            index = c->dmr.contact_index;
+        else
+            continue;
+
+        if(add && (index >= pos))
+            index++;
+        else if((add == false) && (index > pos))
+            index--;
+
+        if(c->mode == OPMODE_M17)
+            c->m17.contact_index = index;
+        else
+            c->dmr.contact_index = index;
+    }
+}
+
+int cps_open(char *cps_name)
+{
+    if(!cps_name)
+        cps_name = "default.rtxc";
+
+    cps_fd = open(cps_name, O_RDWR);
+    if(cps_fd < 0)
+        return -1;
+
+    struct stat st;
+    if((fstat(cps_fd, &st) < 0) || (_map(st.st_size) < 0))
+    {
+        close(cps_fd);
+        cps_fd = -1;
+        return -1;
+    }
+
+    free(cps_path);
+    cps_path = strdup(cps_name);
+    img      = &file;
+    valid    = _validate();
+    cpsIndex_open(cps_path);
+
+    return 0;
+}
+
+void cps_close()
+{
+    if(cps_fd < 0)
+        return;
+
+    cps_abortBatch();
+    cpsIndex_sync();
+    msync(file.data, file.size, MS_SYNC);
+    _unmap();
+    close(cps_fd);
+    free(cps_path);
+
+    cps_fd   = -1;
+    cps_path = NULL;
+    valid    = false;
+    cpsIndex_close();
+}
+
+int cps_create(char *cps_name)
+{
+    // Clear or create cps file
+    FILE *new_cps = NULL;
+    if(!cps_name)
+        cps_name = "default.rtxc";
+    new_cps = fopen(cps_name, "w");
+    if(!new_cps)
+        return -1;
+    // Write new header
+    cps_header_t header = { 0 };
+    header.magic = CPS_MAGIC;
+    header.version_number = CPS_VERSION_MAJOR << 8 | CPS_VERSION_MINOR;
+    strncpy(header.author, default_author, 17);
+    strncpy(header.descr, default_descr, 23);
+    header.timestamp = time(NULL);
+    fwrite(&header, sizeof(cps_header_t), 1, new_cps);
+    fclose(new_cps);
+    return 0;
+}
+
+int cps_readContact(contact_t *contact, uint16_t pos)
+{
+    if((valid == false) || (pos >= _header()->ct_count))
+        return -1;
+
+    memcpy(contact, img->data + _contactOffset(pos), sizeof(contact_t));
+    return 0;
+}
+
+int cps_readChannel(channel_t *channel, uint16_t pos)
+{
+    if((valid == false) || (pos >= _header()->ch_count))
+        return -1;
+
+    memcpy(channel, img->data + _channelOffset(pos), sizeof(channel_t));
+    return 0;
+}
+
+int cps_readBankHeader(bankHdr_t *b_header, uint16_t pos)
+{
+    if((valid == false) || (pos >= _header()->b_count))
+        return -1;
+
+    memcpy(b_header, img->data + _bankOffset(pos), sizeof(bankHdr_t));
+    return 0;
+}
+
+int cps_readBankData(uint16_t bank_pos, uint16_t pos)
+{
+    if((valid == false) || (bank_pos >= _header()->b_count))
+        return -1;
+
+    if(pos >= _bankCount(bank_pos))
+        return -1;
+
+    return _read32(_bankOffset(bank_pos) + sizeof(bankHdr_t)
+                   + pos * sizeof(uint32_t));
+}
+
+int cps_writeContact(contact_t contact, uint16_t pos)
+{
+    if((valid == false) || (pos >= _header()->ct_count))
+        return -1;
+
+    contact_t prev;
+    memcpy(&prev, img->data + _contactOffset(pos), sizeof(contact_t));
+    memcpy(img->data + _contactOffset(pos), &contact, sizeof(contact_t));
+
+    if(img == &heap)
+    {
+        ctChanged = true;
+        contactIndex_invalidate();
+    }
+    else
+    {
+        contactIndex_written(pos, &prev, &contact);
+    }
+
+    return 0;
+}
+
+int cps_writeChannel(channel_t channel, uint16_t pos)
+{
+    if((valid == false) || (pos >= _header()->ch_count))
+        return -1;
+
+    channel_t prev;
+    memcpy(&prev, img->data + _channelOffset(pos), sizeof(channel_t));
+    memcpy(img->data + _channelOffset(pos), &channel, sizeof(channel_t));
+
+    if(img == &heap)
+    {
+        chChanged = true;
+        cpsIndex_invalidate();
+    }
+    else
+    {
+        cpsIndex_written(pos, &prev, &channel);
+    }
+
+    return 0;
+}
+
+int cps_writeBankHeader(bankHdr_t b_header, uint16_t pos)
+{
+    if((valid == false) || (pos >= _header()->b_count))
+        return -1;
+
+    // The channel count is owned by the bank data
+    b_header.ch_count = _bankCount(pos);
+    memcpy(img->data + _bankOffset(pos), &b_header, sizeof(bankHdr_t));
+    return 0;
+}
+
+int cps_writeBankData(uint32_t ch, uint16_t bank_pos, uint16_t pos)
+{
+    if((valid == false) || (bank_pos >= _header()->b_count))
+        return -1;
+
+    if(pos >= _bankCount(bank_pos))
+        return -1;
+
+    _write32(_bankOffset(bank_pos) + sizeof(bankHdr_t) + pos * sizeof(uint32_t),
+             ch);
+    return 0;
+}
+
+int cps_insertContact(contact_t contact, uint16_t pos)
+{
+    if((valid == false) || (pos > _header()->ct_count))
+        return -1;
+
+    if(_header()->ct_count == UINT16_MAX)
+        return -1;
+
+    size_t offset = _contactOffset(pos);
+    if(_openGap(offset, sizeof(contact_t)) < 0)
+        return -1;
+
+    memcpy(img->data + offset, &contact, sizeof(contact_t));
+    _header()->ct_count++;
+    _updateCtNumbering(pos, true);
+
+    if(img == &heap)
+    {
+        ctChanged = true;
+        contactIndex_invalidate();
+    }
+    else
+    {
+        contactIndex_inserted(&contact, pos);
+    }
+
+    return 0;
+}
+
+int cps_insertChannel(channel_t channel, uint16_t pos)
+{
+    if((valid == false) || (pos > _header()->ch_count))
+        return -1;
+
+    if(_header()->ch_count == UINT16_MAX)
+        return -1;
+
+    size_t offset = _channelOffset(pos);
+    if(_openGap(offset, sizeof(channel_t)) < 0)
+        return -1;
+
+    memcpy(img->data + offset, &channel, sizeof(channel_t));
+    _header()->ch_count++;
+
+    // Update the channel indices in the banks
+    for(uint16_t i = 0; i < _header()->b_count; i++)
+    {
+        size_t data = _bankOffset(i) + sizeof(bankHdr_t);
+        for(uint16_t j = 0; j < _bankCount(i); j++)
+        {
+            uint32_t ch = _read32(data + j * sizeof(uint32_t));
+            if(ch >= pos)
+                _write32(data + j * sizeof(uint32_t), ch + 1);
+        }
+    }
+
+    if(img == &heap)
+    {
+        chChanged = true;
+        cpsIndex_invalidate();
+    }
+    else
+    {
+        cpsIndex_inserted(pos);
+    }
+
+    return 0;
+}
+
+int cps_insertBankHeader(bankHdr_t b_header, uint16_t pos)
+{
+    if((valid == false) || (pos > _header()->b_count))
+        return -1;
+
+    if(_header()->b_count == UINT16_MAX)
+        return -1;
+
+    // Relative offset of the new bank, equal to the one of the bank currently
+    // in its position or to the end of the bank data.
+    uint32_t relOffset = _bankOffset(pos) - _tableOffset(_header()->b_count);
+
+    // New offset table entry, bank offsets are relative to the end of the
+    // table and thus they are not affected.
+    size_t entry = _tableOffset(pos);
+    if(_openGap(entry, sizeof(uint32_t)) < 0)
+        return -1;
+
+    _write32(entry, relOffset);
+    _header()->b_count++;
+
+    // A new bank is always empty, channels are added with insertBankData
+    size_t offset = _bankOffset(pos);
+    if(_openGap(offset, sizeof(bankHdr_t)) < 0)
+        return -1;
+
+    b_header.ch_count = 0;
+    memcpy(img->data + offset, &b_header, sizeof(bankHdr_t));
+    _shiftBanks(pos + 1, sizeof(bankHdr_t));
+
+    return 0;
+}
+
+int cps_insertBankData(uint32_t ch, uint16_t bank_pos, uint16_t pos)
+{
+    if((valid == false) || (bank_pos >= _header()->b_count))
+        return -1;
+
+    if((pos > _bankCount(bank_pos)) || (_bankCount(bank_pos) == UINT16_MAX))
+        return -1;
+
+    size_t bank   = _bankOffset(bank_pos);
+    size_t offset = bank + sizeof(bankHdr_t) + pos * sizeof(uint32_t);
+    if(_openGap(offset, sizeof(uint32_t)) < 0)
+        return -1;
+
+    _write32(offset, ch);
+    ((bankHdr_t *) (img->data + bank))->ch_count++;
+    _shiftBanks(bank_pos + 1, sizeof(uint32_t));
+
+    return 0;
+}
+
+int cps_deleteContact(uint16_t pos)
+{
+    if((valid == false) || (pos >= _header()->ct_count))
+        return -1;
+
+    if(_closeGap(_contactOffset(pos), sizeof(contact_t)) < 0)
+        return -1;
+
+    _header()->ct_count--;
+    _updateCtNumbering(pos, false);
+
+    if(img == &heap)
+    {
+        ctChanged = true;
+        contactIndex_invalidate();
+    }
+    else
+    {
+        contactIndex_removed(pos);
+    }
+
+    return 0;
+}
+
+int cps_deleteBankData(uint16_t bank_pos, uint16_t pos)
+{
+    if((valid == false) || (bank_pos >= _header()->b_count))
+        return -1;
+
+    if(pos >= _bankCount(bank_pos))
+        return -1;
+
+    size_t bank = _bankOffset(bank_pos);
+    if(_closeGap(bank + sizeof(bankHdr_t) + pos * sizeof(uint32_t),
+                 sizeof(uint32_t)) < 0)
+        return -1;
+
+    ((bankHdr_t *) (img->data + bank))->ch_count--;
+    _shiftBanks(bank_pos + 1, -((int32_t) sizeof(uint32_t)));
+
+    return 0;
+}
+
+int cps_deleteChannel(channel_t channel, uint16_t pos)
+{
+    (void) channel;
+
+    if((valid == false) || (pos >= _header()->ch_count))
+        return -1;
+
+    if(_closeGap(_channelOffset(pos), sizeof(channel_t)) < 0)
+        return -1;
+
+    _header()->ch_count--;
+
+    if(img == &heap)
+    {
+        chChanged = true;
+        cpsIndex_invalidate();
+    }
+    else
+    {
+        cpsIndex_removed(pos);
+    }
+
+    // Drop the deleted channel from the banks and renumber the others
+    for(uint16_t i = 0; i < _header()->b_count; i++)
+    {
+        uint16_t j = 0;
+        while(j < _bankCount(i))
+        {
+            size_t   entry = _bankOffset(i) + sizeof(bankHdr_t)
+                           + j * sizeof(uint32_t);
+            uint32_t ch    = _read32(entry);
+
+            if(ch == pos)
+            {
+                if(cps_deleteBankData(i, j) < 0)
+                    return -1;
+
+                continue;
+            }
+
+            if(ch > pos)
+                _write32(entry, ch - 1);
+
+            j++;
+        }
+    }
+
+    return 0;
+}
+
+int cps_deleteBankHeader(uint16_t pos)
+{
+    if((valid == false) || (pos >= _header()->b_count))
+        return -1;
+
+    size_t bank = _bankOffset(pos);
+    size_t len  = sizeof(bankHdr_t) + _bankCount(pos) * sizeof(uint32_t);
+    if(_closeGap(bank, len) < 0)
+        return -1;
+
+    _shiftBanks(pos + 1, -((int32_t) len));
+
+    if(_closeGap(_tableOffset(pos), sizeof(uint32_t)) < 0)
+        return -1;
+
+    _header()->b_count--;
+
+    return 0;
+}
+
+int cps_beginBatch()
+{
+    if((valid == false) || (img == &heap))
+        return -1;
+
+    heap.cap  = file.size + CPS_MAP_RESERVE;
+    heap.size = file.size;
+    heap.data = (uint8_t *) malloc(heap.cap);
+    if(heap.data == NULL)
+        return -1;
+
+    memcpy(heap.data, file.data, file.size);
+    img       = &heap;
+    ctChanged = false;
+    chChanged = false;
+
+    return 0;
+}
+
+int cps_commitBatch()
+{
+    if(img != &heap)
+        return -1;
+
+    // Write the new codeplug aside and then atomically replace the old one
+    size_t len = strlen(cps_path);
+    char  *tmpPath = (char *) malloc(len + 5);
+    if(tmpPath == NULL)
+        return -1;
+
+    memcpy(tmpPath, cps_path, len);
+    memcpy(tmpPath + len, ".tmp", 5);
+
+    int fd = open(tmpPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0)
+    {
+        free(tmpPath);
+        return -1;
+    }
+
+    size_t written = 0;
+    while(written < heap.size)
+    {
+        ssize_t ret = write(fd, heap.data + written, heap.size - written);
+        if(ret <= 0)
+            break;
+
+        written += ret;
+    }
+
+    bool ok = (written == heap.size) && (fsync(fd) == 0);
+    if((close(fd) < 0) || (ok == false) || (rename(tmpPath, cps_path) < 0))
+    {
+        remove(tmpPath);
+        free(tmpPath);
+        return -1;
+    }
+
+    free(tmpPath);
+
+    // Switch to the new file, the old mapping refers to the replaced one
+    _unmap();
+    close(cps_fd);
+
+    // Drop the heap image without triggering an index rebuild on the old file
+    size_t size = heap.size;
+    bool rebuild = ctChanged;
+    ctChanged = false;
+    chChanged = false;
+    cps_abortBatch();
+
+    cps_fd = open(cps_path, O_RDWR);
+    if((cps_fd >= 0) && (_map(size) == 0))
+    {
+        valid = _validate();
+        if(rebuild)
+            contactIndex_build();
+
+        return 0;
+    }
+
+    if(cps_fd >= 0)
+        close(cps_fd);
+
+    cps_fd = -1;
+    valid  = false;
+    return -1;
+}
+
+void cps_abortBatch()
+{
+    if(img != &heap)
+        return;
+
+    free(heap.data);
+    heap.data = NULL;
+    heap.size = 0;
+    heap.cap  = 0;
+    img       = &file;
+
+    if(chChanged)
+        cpsIndex_invalidate();
+
+    if(ctChanged)
+        contactIndex_build();
+
+    ctChanged = false;
+    chChanged = false;
+}
@@ -27,6 +27,7 @@
 #include "AT24Cx.h"
 #include "W25Qx.h"
 #include "cps_data_GDx.h"
+#include "cps_search_linear.h"
 
 //static const uint32_t zoneBaseAddr        = 0x149e0;  /**< Base address of zones                */
 //static const uint32_t vfoChannelBaseAddr  = 0x7590;   /**< Base address of VFO channel          */
@@ -81,6 +82,11 @@ int cps_create(char *cps_name)
     return 0;
 }
 
+uint16_t cps_channelSlots()
+{
+    return maxNumChannels;
+}
+
 int cps_readChannel(channel_t *channel, uint16_t pos)
 {
     if(pos >= maxNumChannels)
@@ -26,6 +26,7 @@
 #include <utils.h>
 #include "cps_data_MDUV3x0.h"
 #include "W25Qx.h"
+#include "cps_search_linear.h"
 
 extern const struct nvmDevice eflash;
 
@@ -158,6 +159,11 @@ int cps_create(char *cps_name)
     return 0;
 }
 
+uint16_t cps_channelSlots()
+{
+    return maxNumChannels;
+}
+
 int cps_readChannel(channel_t *channel, uint16_t pos)
 {
     if(pos >= maxNumChannels) return -1;
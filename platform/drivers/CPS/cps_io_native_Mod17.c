@@ -19,6 +19,7 @@
  ***************************************************************************/
 
 #include <interfaces/cps_io.h>
+#include "cps_search_linear.h"
 
 
 /**
@@ -46,6 +47,11 @@ int cps_create(char *cps_name)
     return 0;
 }
 
+uint16_t cps_channelSlots()
+{
+    return 0;
+}
+
 int cps_readChannel(channel_t *channel, uint16_t pos)
 {
     (void) channel;
@@ -0,0 +1,147 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <interfaces/cps_io.h>
+#include <strings.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "cps_search_linear.h"
+
+/*
+ * Channel search for the codeplugs stored in the radio's nonvolatile memory.
+ * These codeplugs have a fixed number of channel slots and are edited with
+ * external tools, thus there is no place to keep a persistent index: searches
+ * are done with a linear scan of all the channel slots, skipping the empty
+ * ones.
+ *
+ * The name search is run on every keypress while typing: the positions of the
+ * channels matching the last prefix are kept, so that extending the prefix
+ * only rereads those channels instead of scanning the whole memory again.
+ */
+
+#define MAX_MATCHES 128
+
+static char     lastPrefix[CPS_STR_SIZE] = { 0 };
+static uint16_t matches[MAX_MATCHES];
+static uint16_t numMatches   = 0;
+static bool     matchesValid = false;
+
+/**
+ * \internal
+ * Keep the matching channel coming first in alphabetical order.
+ */
+static void _checkName(const channel_t *channel, uint16_t pos, int *best,
+                       char *bestName)
+{
+    if((*best < 0) ||
+       (strncasecmp(channel->name, bestName, CPS_STR_SIZE) < 0))
+    {
+        *best = pos;
+        memcpy(bestName, channel->name, CPS_STR_SIZE);
+    }
+}
+
+int cps_findChannelByName(const char *prefix)
+{
+    size_t    len  = strlen(prefix);
+    int       best = -1;
+    char      bestName[CPS_STR_SIZE];
+    channel_t channel;
+
+    // The channels matching a longer prefix are a subset of the last matches
+    size_t lastLen = strlen(lastPrefix);
+    if(matchesValid && (lastLen > 0) && (len >= lastLen) &&
+       (strncasecmp(prefix, lastPrefix, lastLen) == 0))
+    {
+        uint16_t kept = 0;
+        for(uint16_t i = 0; i < numMatches; i++)
+        {
+            uint16_t pos = matches[i];
+            if(cps_readChannel(&channel, pos) < 0)
+                continue;
+
+            if(strncasecmp(channel.name, prefix, len) != 0)
+                continue;
+
+            matches[kept++] = pos;
+            _checkName(&channel, pos, &best, bestName);
+        }
+
+        numMatches = kept;
+    }
+    else
+    {
+        uint16_t slots = cps_channelSlots();
+        numMatches   = 0;
+        matchesValid = true;
+
+        for(uint16_t pos = 0; pos < slots; pos++)
+        {
+            if(cps_readChannel(&channel, pos) < 0)
+                continue;
+
+            if((channel.name[0] == '\0') ||
+               (strncasecmp(channel.name, prefix, len) != 0))
+                continue;
+
+            if(numMatches < MAX_MATCHES)
+                matches[numMatches++] = pos;
+            else
+                matchesValid = false;
+
+            _checkName(&channel, pos, &best, bestName);
+        }
+    }
+
+    strncpy(lastPrefix, prefix, CPS_STR_SIZE - 1);
+    return best;
+}
+
+int cps_findChannelByFreq(freq_t freq)
+{
+    int       best     = -1;
+    freq_t    bestFreq = 0;
+    freq_t    bestDist = 0;
+    channel_t channel;
+
+    uint16_t slots = cps_channelSlots();
+    for(uint16_t pos = 0; pos < slots; pos++)
+    {
+        if(cps_readChannel(&channel, pos) < 0)
+            continue;
+
+        freq_t rxFreq = channel.rx_frequency;
+        if(rxFreq == 0)
+            continue;
+
+        freq_t dist = (rxFreq > freq) ? (rxFreq - freq) : (freq - rxFreq);
+        if((best < 0) || (dist < bestDist) ||
+           ((dist == bestDist) && (rxFreq < bestFreq)))
+        {
+            best     = pos;
+            bestFreq = rxFreq;
+            bestDist = dist;
+        }
+    }
+
+    return best;
+}
@@ -0,0 +1,37 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef CPS_SEARCH_LINEAR_H
+#define CPS_SEARCH_LINEAR_H
+
+#include <stdint.h>
+
+/**
+ * Get the number of channel slots of the codeplug, including the empty ones.
+ * To be provided by the codeplug backends relying on the linear channel
+ * search, whose cps_readChannel() fails both on empty slots and past the end
+ * of the channel memory.
+ *
+ * @return number of channel slots.
+ */
+uint16_t cps_channelSlots();
+
+#endif /* CPS_SEARCH_LINEAR_H */
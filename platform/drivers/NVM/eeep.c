@@ -22,6 +22,7 @@
 #include <nvmem_access.h>
 #include <stdint.h>
 #include <limits.h>
+#include <string.h>
 #include <errno.h>
 #include "eeep.h"
 
@@ -32,6 +33,7 @@
 #define EEEP_PAGE_ACTIVE      (0x000000FF)
 #define EEEP_PAGE_INACTIVE    (0x00000000)
 #define EEEP_PAGE_HDR_SIZE    sizeof(uint32_t)
+#define EEEP_INDEX_FREE       (0xFFFF)
 
 enum RecordStatus
 {
@@ -48,12 +50,6 @@ struct eeepRecord
     uint16_t virtAddr;
 };
 
-struct eeepEntry
-{
-    uint32_t physAddr;
-    uint16_t virtAddr;
-};
-
 static uint32_t nextRecordAddress(const uint32_t addr, const struct eeepRecord *rec)
 {
     uint32_t nextAddr = addr;
@@ -77,11 +73,58 @@ static uint32_t nextRecordAddress(const uint32_t addr, const struct eeepRecord *
     return nextAddr + sizeof(struct eeepRecord);
 }
 
-static int findRecord(struct eeepData *priv, uint32_t *memAddr, const uint16_t virtAddr)
+/**
+ * \internal
+ * Get the index slot of a virtual address. The returned slot either contains
+ * the virtual address or is the free slot where it has to be inserted.
+ */
+static struct eeepEntry *indexSlot(struct eeepData *priv, const uint16_t virtAddr)
+{
+    uint32_t mask = EEEP_INDEX_SIZE - 1;
+    uint32_t slot = (((uint32_t) virtAddr) * 2654435761u) >> (32 - EEEP_INDEX_BITS);
+
+    while((priv->index[slot].virtAddr != EEEP_INDEX_FREE) &&
+          (priv->index[slot].virtAddr != virtAddr))
+        slot = (slot + 1) & mask;
+
+    return &priv->index[slot];
+}
+
+/**
+ * \internal
+ * Update the index with the physical address of the latest record of a given
+ * virtual address.
+ */
+static int indexUpdate(struct eeepData *priv, const uint16_t virtAddr,
+                       const uint32_t physAddr)
+{
+    struct eeepEntry *entry = indexSlot(priv, virtAddr);
+
+    if(entry->virtAddr == EEEP_INDEX_FREE)
+    {
+        if(priv->numEntries >= EEEP_INDEX_ENTRIES)
+            return -ENOSPC;
+
+        entry->virtAddr   = virtAddr;
+        priv->numEntries += 1;
+    }
+
+    entry->physAddr = physAddr;
+
+    return 0;
+}
+
+/**
+ * \internal
+ * Build the index of the records with a single scan of the active page.
+ */
+static int buildIndex(struct eeepData *priv)
 {
     struct eeepRecord rec;
     uint32_t addr = priv->readAddr;
-    *memAddr = 0xFFFFFFFF;
+
+    memset(priv->index, 0xFF, sizeof(priv->index));
+    priv->numEntries = 0;
 
     while(addr < priv->writeAddr)
     {
@@ -89,16 +132,29 @@ static int findRecord(struct eeepData *priv, uint32_t *memAddr, const uint16_t v
         if(ret < 0)
             return ret;
 
-        if((rec.status == EEEP_RECORD_VALID) && (rec.virtAddr == virtAddr))
-            *memAddr = addr;
+        if(rec.status == EEEP_RECORD_VALID)
+        {
+            ret = indexUpdate(priv, rec.virtAddr, addr);
+            if(ret < 0)
+                return ret;
+        }
 
         addr = nextRecordAddress(addr, &rec);
     }
 
-    if(*memAddr != 0xFFFFFFFF)
-        return 0;
+    return 0;
+}
+
+static int findRecord(struct eeepData *priv, uint32_t *memAddr, const uint16_t virtAddr)
+{
+    struct eeepEntry *entry = indexSlot(priv, virtAddr);
 
-    return -1;
+    if(entry->virtAddr == EEEP_INDEX_FREE)
+        return -1;
+
+    *memAddr = entry->physAddr;
+
+    return 0;
 }
 
 static int writeRecord(struct eeepData *priv, uint16_t virtAddr, const void *data,
@@ -129,8 +185,10 @@ static int writeRecord(struct eeepData *priv, uint16_t virtAddr, const void *dat
     // Finally, update the record header changing the state to "valid".
     rec.status = EEEP_RECORD_VALID;
     ret = nvm_devWrite(priv->nvm, headAddr, &rec, sizeof(struct eeepRecord));
+    if(ret < 0)
+        return ret;
 
-    return ret;
+    return indexUpdate(priv, virtAddr, headAddr);
 }
 
 static int swapBlock(struct eeepData *priv)
@@ -138,55 +196,17 @@ static int swapBlock(struct eeepData *priv)
     // Round-robin page swap.
     // Note: when computing the next block address we have to take into account
     // that readAddr points at the first record after the page header.
+    uint32_t pageSize  = priv->nvm->info->erase_size;
     uint32_t currBlock = priv->readAddr - EEEP_PAGE_HDR_SIZE;
-    uint32_t nextBlock = currBlock + priv->nvm->info->erase_size;
+    uint32_t nextBlock = currBlock + pageSize;
     if(nextBlock >= (priv->part->offset + priv->part->size))
         nextBlock = priv->part->offset;
 
     // Erase new page
-    int ret = nvm_devErase(priv->nvm, nextBlock, priv->nvm->info->erase_size);
+    int ret = nvm_devErase(priv->nvm, nextBlock, pageSize);
     if(ret < 0)
         return ret;
 
-    // Search for all the active entries
-    // TODO: use dynamic memory allocation
-    struct eeepEntry entryList[8] = {0};
-    uint32_t address = priv->readAddr;
-    uint8_t numEntries = 0;
-
-    while(address < priv->writeAddr)
-    {
-        struct eeepRecord rec;
-
-        ret = nvm_devRead(priv->nvm, address, &rec, sizeof(struct eeepRecord));
-        if(ret < 0)
-            return ret;
-
-        if(rec.status == EEEP_RECORD_VALID)
-        {
-            uint8_t pos;
-            for(pos = 0; pos < numEntries; pos++)
-            {
-                // Found record in list, update its physical address
-                if(entryList[pos].virtAddr == rec.virtAddr)
-                {
-                    entryList[pos].physAddr = address;
-                    break;
-                }
-            }
-
-            // Record not found, append it to the list
-            if(pos == numEntries)
-            {
-                entryList[pos].virtAddr = rec.virtAddr;
-                entryList[pos].physAddr = address;
-                numEntries += 1;
-            }
-        }
-
-        address = nextRecordAddress(address, &rec);
-    }
-
     // Set new write address, mark the page as a page with an ogoing copy
     priv->writeAddr = nextBlock + sizeof(uint32_t);
     uint32_t tmp    = EEEP_PAGE_COPYING;
@@ -194,12 +214,17 @@ static int swapBlock(struct eeepData *priv)
     if(ret < 0)
         return ret;
 
-    // Copy over the records to the new page,
-    for(uint8_t i = 0; i < numEntries; i++)
+    // Copy over the latest record of each virtual address to the new page.
+    // Rewriting a record updates its own slot in the index, thus the index can
+    // be walked while the copy is in progress.
+    for(uint32_t i = 0; i < EEEP_INDEX_SIZE; i++)
     {
         struct eeepRecord rec;
         uint8_t data[256];
-        uint32_t address = entryList[i].physAddr;
+        uint32_t address = priv->index[i].physAddr;
+
+        if(priv->index[i].virtAddr == EEEP_INDEX_FREE)
+            continue;
 
         ret = nvm_devRead(priv->nvm, address, &rec, sizeof(struct eeepRecord));
         if(ret < 0)
@@ -256,7 +281,7 @@ static int eeep_read(const struct nvmDevice *dev, uint32_t offset, void *data,
         len = rec.size;
 
     memAddr += sizeof(struct eeepRecord);
-    ret = nvm_devRead(priv->nvm, memAddr, data, rec.size);
+    ret = nvm_devRead(priv->nvm, memAddr, data, len);
 
     return ret;
 }
@@ -270,6 +295,12 @@ static int eeep_write(const struct nvmDevice *dev, uint32_t offset,
     if((offset >= 0xFFFF) || (len >= 255))
         return -EINVAL;
 
+    // Refuse new virtual addresses once the index is full
+    struct eeepEntry *entry = indexSlot(priv, offset);
+    if((entry->virtAddr == EEEP_INDEX_FREE) &&
+       (priv->numEntries >= EEEP_INDEX_ENTRIES))
+        return -ENOSPC;
+
     uint32_t usedSpace = (priv->writeAddr - priv->readAddr) + EEEP_PAGE_HDR_SIZE;
     uint32_t freeSpace = priv->nvm->info->erase_size - usedSpace;
     uint32_t entrySize = sizeof(struct eeepRecord) + len;
@@ -351,7 +382,7 @@ int eeep_init(const struct nvmDevice *dev, const uint32_t nvm,
         }
     }
 
-    return 0;
+    return buildIndex(priv);
 }
 
 int eeep_terminate(const struct nvmDevice* dev)
@@ -35,6 +35,28 @@
 extern const struct nvmOps  eeep_ops;
 extern const struct nvmInfo eeep_info;
 
+/**
+ * Size of the RAM index of the records, expressed as a power of two. The index
+ * can hold up to 3/4 of its slots, that is 24 different virtual addresses with
+ * the default size.
+ */
+#ifndef EEEP_INDEX_BITS
+#define EEEP_INDEX_BITS 5
+#endif
+
+#define EEEP_INDEX_SIZE    (1 << EEEP_INDEX_BITS)
+#define EEEP_INDEX_ENTRIES ((EEEP_INDEX_SIZE * 3) / 4)
+
+/**
+ * Entry of the RAM index, mapping a virtual address to the physical address of
+ * its latest valid record.
+ */
+struct eeepEntry
+{
+    uint32_t physAddr;
+    uint16_t virtAddr;
+};
+
 /**
  * Driver private data.
  */
@@ -44,6 +66,8 @@ struct eeepData
     const struct nvmPartition *part;        ///< Memory partition used for EEPROM emulation
     uint32_t                  readAddr;     ///< Physical start address for EEEPROM reads
     uint32_t                  writeAddr;    ///< Physical start address for EEEPROM writes
+    uint16_t                  numEntries;   ///< Number of entries in the record index
+    struct eeepEntry          index[EEEP_INDEX_SIZE];   ///< Record index
 };
 
 /**
@@ -0,0 +1,379 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <nvmem_access.h>
+#include <string.h>
+#include <errno.h>
+#include "nvm_cache.h"
+
+/**
+ * \internal
+ * Get the pointer to the data of a cache block.
+ */
+static inline uint8_t *blockData(struct nvmCacheData *priv,
+                                 const struct nvmCacheBlock *blk)
+{
+    return priv->buffer + ((blk - priv->blocks) * priv->blockSize);
+}
+
+/**
+ * \internal
+ * Search for a block in the cache.
+ *
+ * @param priv: cache private data.
+ * @param addr: start address of the block.
+ * @return pointer to the cached block or NULL if the block is not cached.
+ */
+static struct nvmCacheBlock *findBlock(struct nvmCacheData *priv,
+                                       const uint32_t addr)
+{
+    for(uint32_t i = 0; i < priv->numBlocks; i++)
+    {
+        struct nvmCacheBlock *blk = &priv->blocks[i];
+        if((blk->valid == true) && (blk->addr == addr))
+            return blk;
+    }
+
+    return NULL;
+}
+
+/**
+ * \internal
+ * Write back a cache block to the underlying device. A pending erase is done
+ * first, followed by the programming of the modified area, extended to whole
+ * write units.
+ *
+ * @param priv: cache private data.
+ * @param blk: block to be written back.
+ * @return zero on success, a negative error code otherwise.
+ */
+static int flushBlock(struct nvmCacheData *priv, struct nvmCacheBlock *blk)
+{
+    int ret;
+
+    if(blk->erased)
+    {
+        ret = nvm_devErase(priv->nvm, blk->addr, priv->blockSize);
+        if(ret < 0)
+            return ret;
+
+        blk->erased = false;
+    }
+
+    if(blk->dirtyEnd > blk->dirtyStart)
+    {
+        uint32_t unit  = priv->nvm->info->write_size;
+        uint32_t start = blk->dirtyStart;
+        uint32_t end   = blk->dirtyEnd;
+
+        if(unit > 1)
+        {
+            start -= (start % unit);
+            end    = ((end + unit - 1) / unit) * unit;
+            if(end > priv->blockSize)
+                end = priv->blockSize;
+        }
+
+        ret = nvm_devWrite(priv->nvm, blk->addr + start,
+                           blockData(priv, blk) + start, end - start);
+        if(ret < 0)
+            return ret;
+    }
+
+    blk->dirtyStart = priv->blockSize;
+    blk->dirtyEnd   = 0;
+
+    return 0;
+}
+
+/**
+ * \internal
+ * Get a block from the cache, allocating it if not present. When a new block
+ * is allocated the least recently used one is evicted.
+ *
+ * @param priv: cache private data.
+ * @param addr: start address of the block.
+ * @param load: if true, load the content of a newly allocated block from the
+ * underlying device.
+ * @param block: pointer to the cached block.
+ * @return zero on success, a negative error code otherwise.
+ */
+static int getBlock(struct nvmCacheData *priv, const uint32_t addr,
+                    const bool load, struct nvmCacheBlock **block)
+{
+    struct nvmCacheBlock *blk = findBlock(priv, addr);
+
+    if(blk == NULL)
+    {
+        blk = &priv->blocks[0];
+        for(uint32_t i = 0; i < priv->numBlocks; i++)
+        {
+            struct nvmCacheBlock *b = &priv->blocks[i];
+            if(b->valid == false)
+            {
+                blk = b;
+                break;
+            }
+
+            if(b->lastUse < blk->lastUse)
+                blk = b;
+        }
+
+        if(blk->valid)
+        {
+            int ret = flushBlock(priv, blk);
+            if(ret < 0)
+                return ret;
+
+            blk->valid = false;
+        }
+
+        if(load)
+        {
+            int ret = nvm_devRead(priv->nvm, addr, blockData(priv, blk),
+                                  priv->blockSize);
+            if(ret < 0)
+                return ret;
+        }
+
+        blk->addr       = addr;
+        blk->valid      = true;
+        blk->erased     = false;
+        blk->dirtyStart = priv->blockSize;
+        blk->dirtyEnd   = 0;
+    }
+
+    priv->useCount += 1;
+    blk->lastUse    = priv->useCount;
+    *block          = blk;
+
+    return 0;
+}
+
+static int nvm_api_read(const struct nvmDevice *dev, uint32_t offset,
+                        void *data, size_t len)
+{
+    struct nvmCacheData *priv = (struct nvmCacheData *) dev->priv;
+    uint8_t *dst = (uint8_t *) data;
+    int ret = 0;
+
+    pthread_mutex_lock(&priv->mutex);
+
+    while(len > 0)
+    {
+        uint32_t pos  = offset % priv->blockSize;
+        size_t   size = priv->blockSize - pos;
+        if(size > len)
+            size = len;
+
+        // Blocks not in cache are read directly, without allocating them
+        struct nvmCacheBlock *blk = findBlock(priv, offset - pos);
+        if(blk != NULL)
+        {
+            memcpy(dst, blockData(priv, blk) + pos, size);
+            priv->useCount += 1;
+            blk->lastUse    = priv->useCount;
+        }
+        else
+        {
+            ret = nvm_devRead(priv->nvm, offset, dst, size);
+            if(ret < 0)
+                break;
+
+            ret = 0;
+        }
+
+        dst    += size;
+        offset += size;
+        len    -= size;
+    }
+
+    pthread_mutex_unlock(&priv->mutex);
+
+    return ret;
+}
+
+static int nvm_api_write(const struct nvmDevice *dev, uint32_t offset,
+                         const void *data, size_t len)
+{
+    struct nvmCacheData *priv = (struct nvmCacheData *) dev->priv;
+    const uint8_t *src = (const uint8_t *) data;
+    bool program = (priv->nvm->info->device_info & NVM_ERASE) != 0;
+    int ret = 0;
+
+    pthread_mutex_lock(&priv->mutex);
+
+    while(len > 0)
+    {
+        uint32_t pos  = offset % priv->blockSize;
+        size_t   size = priv->blockSize - pos;
+        if(size > len)
+            size = len;
+
+        struct nvmCacheBlock *blk;
+        ret = getBlock(priv, offset - pos, true, &blk);
+        if(ret < 0)
+            break;
+
+        // Memories needing an erase before writing can only clear bits
+        uint8_t *dst = blockData(priv, blk) + pos;
+        if(program)
+        {
+            for(size_t i = 0; i < size; i++)
+                dst[i] &= src[i];
+        }
+        else
+        {
+            memcpy(dst, src, size);
+        }
+
+        if(pos < blk->dirtyStart)
+            blk->dirtyStart = pos;
+
+        if((pos + size) > blk->dirtyEnd)
+            blk->dirtyEnd = pos + size;
+
+        src    += size;
+        offset += size;
+        len    -= size;
+    }
+
+    pthread_mutex_unlock(&priv->mutex);
+
+    return ret;
+}
+
+static int nvm_api_erase(const struct nvmDevice *dev, uint32_t offset,
+                         size_t size)
+{
+    struct nvmCacheData *priv = (struct nvmCacheData *) dev->priv;
+    int ret = 0;
+
+    if(priv->nvm->ops->erase == NULL)
+        return -ENOTSUP;
+
+    pthread_mutex_lock(&priv->mutex);
+
+    while(size > 0)
+    {
+        uint32_t pos = offset % priv->blockSize;
+        size_t   len = priv->blockSize - pos;
+        if(len > size)
+            len = size;
+
+        struct nvmCacheBlock *blk;
+        if(len == priv->blockSize)
+        {
+            // Whole block: defer the erase, discarding any pending write
+            ret = getBlock(priv, offset, false, &blk);
+            if(ret < 0)
+                break;
+
+            memset(blockData(priv, blk), 0xFF, priv->blockSize);
+            blk->erased     = true;
+            blk->dirtyStart = priv->blockSize;
+            blk->dirtyEnd   = 0;
+        }
+        else
+        {
+            // Partial block: write back the pending data and erase directly
+            blk = findBlock(priv, offset - pos);
+            if(blk != NULL)
+            {
+                ret = flushBlock(priv, blk);
+                if(ret < 0)
+                    break;
+            }
+
+            ret = nvm_devErase(priv->nvm, offset, len);
+            if(ret < 0)
+                break;
+
+            if(blk != NULL)
+                memset(blockData(priv, blk) + pos, 0xFF, len);
+        }
+
+        offset += len;
+        size   -= len;
+    }
+
+    pthread_mutex_unlock(&priv->mutex);
+
+    return ret;
+}
+
+static int nvm_api_sync(const struct nvmDevice *dev)
+{
+    struct nvmCacheData *priv = (struct nvmCacheData *) dev->priv;
+    int ret = 0;
+
+    pthread_mutex_lock(&priv->mutex);
+
+    for(uint32_t i = 0; i < priv->numBlocks; i++)
+    {
+        if(priv->blocks[i].valid == false)
+            continue;
+
+        ret = flushBlock(priv, &priv->blocks[i]);
+        if(ret < 0)
+            break;
+    }
+
+    pthread_mutex_unlock(&priv->mutex);
+
+    if((ret == 0) && (priv->nvm->ops->sync != NULL))
+        ret = nvm_devSync(priv->nvm);
+
+    return ret;
+}
+
+int nvmCache_init(struct nvmDevice *dev)
+{
+    struct nvmCacheData *priv = (struct nvmCacheData *) dev->priv;
+    uint32_t eraseSize = priv->nvm->info->erase_size;
+
+    if((eraseSize > 0) && ((priv->blockSize % eraseSize) != 0))
+        return -EINVAL;
+
+    if((dev->size % priv->blockSize) != 0)
+        return -EINVAL;
+
+    for(uint32_t i = 0; i < priv->numBlocks; i++)
+        priv->blocks[i].valid = false;
+
+    priv->useCount = 0;
+    dev->info      = priv->nvm->info;
+
+    return 0;
+}
+
+int nvmCache_terminate(struct nvmDevice *dev)
+{
+    return nvm_api_sync(dev);
+}
+
+const struct nvmOps nvmCache_ops =
+{
+    .read   = nvm_api_read,
+    .write  = nvm_api_write,
+    .erase  = nvm_api_erase,
+    .sync   = nvm_api_sync
+};
@@ -0,0 +1,121 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef NVM_CACHE_H
+#define NVM_CACHE_H
+
+#include <interfaces/nvmem.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+/**
+ * Write-back cache for nonvolatile memory devices. The cache wraps an existing
+ * device and keeps a few blocks of its content in RAM: writes and erases are
+ * applied to the cached copy and reach the underlying device only when a
+ * block is evicted or when the cache is synced, so that many small writes to
+ * the same area result in a single erase and program cycle.
+ *
+ * The cache device exposes the same information block of the underlying one
+ * and preserves its semantics: on devices requiring an erase before writing,
+ * a write can only clear bits, exactly as it would happen on the real memory.
+ */
+
+/**
+ * Device driver for the cache.
+ */
+extern const struct nvmOps nvmCache_ops;
+
+/**
+ * State of a cached block.
+ */
+struct nvmCacheBlock
+{
+    uint32_t addr;          ///< Start address of the block
+    uint32_t lastUse;       ///< Value of the access counter at the last use
+    uint32_t dirtyStart;    ///< Start of the modified area, relative to the block
+    uint32_t dirtyEnd;      ///< End of the modified area, relative to the block
+    bool     valid;         ///< Block contains data
+    bool     erased;        ///< Block has to be erased before being written back
+};
+
+/**
+ * Driver private data.
+ */
+struct nvmCacheData
+{
+    const struct nvmDevice *nvm;        ///< Underlying NVM device
+    uint8_t                *buffer;     ///< Storage for the cached blocks
+    struct nvmCacheBlock   *blocks;     ///< Cached blocks
+    const uint32_t          blockSize;  ///< Size of a cache block, in bytes
+    const uint32_t          numBlocks;  ///< Number of cache blocks
+    uint32_t                useCount;   ///< Access counter, for LRU eviction
+    pthread_mutex_t         mutex;      ///< Mutex for concurrent access
+};
+
+/**
+ * Instantiate a write-back cache for an NVM device. The block size has to be a
+ * multiple of the erase size of the underlying device and a divisor of the
+ * device size.
+ *
+ * @param name: device name.
+ * @param dev: underlying NVM device.
+ * @param sz: size of the underlying device, in bytes.
+ * @param blkSize: size of a cache block, in bytes.
+ * @param nBlk: number of cache blocks.
+ */
+#define NVM_CACHE_DEVICE_DEFINE(name, dev, sz, blkSize, nBlk)   \
+static uint8_t nvmCacheBuf_##name[(blkSize) * (nBlk)];          \
+static struct nvmCacheBlock nvmCacheBlk_##name[nBlk];           \
+static struct nvmCacheData nvmCacheData_##name =                \
+{                                                               \
+    .nvm       = (const struct nvmDevice *) &dev,               \
+    .buffer    = nvmCacheBuf_##name,                            \
+    .blocks    = nvmCacheBlk_##name,                            \
+    .blockSize = blkSize,                                       \
+    .numBlocks = nBlk,                                          \
+    .useCount  = 0,                                             \
+    .mutex     = PTHREAD_MUTEX_INITIALIZER                      \
+};                                                              \
+struct nvmDevice name =                                         \
+{                                                               \
+    .priv = &nvmCacheData_##name,                               \
+    .ops  = &nvmCache_ops,                                      \
+    .info = NULL,                                               \
+    .size = sz                                                  \
+};
+
+/**
+ * Initialize an NVM cache instance.
+ *
+ * @param dev: pointer to the cache device descriptor.
+ * @return zero on success, a negative error code otherwise.
+ */
+int nvmCache_init(struct nvmDevice *dev);
+
+/**
+ * Shut down an NVM cache instance, writing back all the modified blocks.
+ *
+ * @param dev: pointer to the cache device descriptor.
+ * @return zero on success, a negative error code otherwise.
+ */
+int nvmCache_terminate(struct nvmDevice *dev);
+
+#endif /* NVM_CACHE_H */
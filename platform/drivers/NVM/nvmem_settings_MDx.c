@@ -19,14 +19,18 @@
  ***************************************************************************/
 
 #include <interfaces/nvmem.h>
+#include <nvmem_access.h>
 #include <string.h>
+#include <errno.h>
 #include <cps.h>
 #include <crc.h>
+#include "settings_log.h"
 #include "flash.h"
 
 /*
- * Data structures defining the memory layout used for saving and restore
- * of user settings and VFO configuration.
+ * Data structures defining the legacy memory layout used for saving and
+ * restore of user settings and VFO configuration, still read once to migrate
+ * the saved data to the settings log.
  */
 typedef struct
 {
@@ -48,16 +52,84 @@ static const uint32_t MEM_MAGIC   = 0x584E504F;    // "OPNX"
 static const uint32_t baseAddress = 0x080E0000;
 memory_t *memory = ((memory_t *) baseAddress);
 
+/*
+ * NVM device giving access to the MCU flash sector used for settings storage.
+ * On STM32F405 the settings are saved in sector 11, starting at address
+ * 0x080E0000.
+ */
+static int settingsFlash_read(const struct nvmDevice *dev, uint32_t offset,
+                              void *data, size_t len)
+{
+    (void) dev;
+
+    memcpy(data, ((const uint8_t *) baseAddress) + offset, len);
+    return 0;
+}
+
+static int settingsFlash_write(const struct nvmDevice *dev, uint32_t offset,
+                               const void *data, size_t len)
+{
+    (void) dev;
+
+    flash_write(baseAddress + offset, data, len);
+    return 0;
+}
+
+static int settingsFlash_erase(const struct nvmDevice *dev, uint32_t offset,
+                               size_t size)
+{
+    (void) dev;
+    (void) size;
+
+    if(offset != 0)
+        return -EINVAL;
+
+    return flash_eraseSector(11) ? 0 : -EIO;
+}
+
+static const struct nvmOps settingsFlash_ops =
+{
+    .read   = settingsFlash_read,
+    .write  = settingsFlash_write,
+    .erase  = settingsFlash_erase,
+    .sync   = NULL
+};
+
+static const struct nvmInfo settingsFlash_info =
+{
+    .write_size   = 1,
+    .erase_size   = 0x20000,
+    .erase_cycles = 10000,
+    .device_info  = NVM_FLASH | NVM_WRITE | NVM_BITWRITE | NVM_ERASE
+};
+
+static const struct nvmDevice settingsFlash =
+{
+    .priv = NULL,
+    .ops  = &settingsFlash_ops,
+    .info = &settingsFlash_info,
+    .size = 0x20000
+};
+
+static struct settingsLog settingsLog =
+{
+    .nvm      = &settingsFlash,
+    .baseAddr = 0,
+    .pageSize = 0x20000,
+    .numPages = 1
+};
+
+static bool logReady = false;
+
 
 /**
  * \internal
- * Utility function to find the currently active data block inside memory, that
- * is the one containing the last saved settings. Blocks containing legacy data
- * are marked with numbers starting from 4096.
+ * Utility function to find the currently active data block inside the legacy
+ * memory layout, that is the one containing the last saved settings.
  *
  * @return number currently active data block or -1 if memory data is invalid.
  */
-static int findActiveBlock()
+static int findLegacyBlock()
 {
     // Check for invalid memory data
     if(memory->magic != MEM_MAGIC)
@@ -96,73 +168,59 @@ static int findActiveBlock()
     return block;
 }
 
-
-int nvm_readVfoChannelData(channel_t *channel)
+/**
+ * \internal
+ * Load the settings log, migrating the data saved with the legacy layout.
+ */
+static int loadLog()
 {
-    int block = findActiveBlock();
+    if(logReady)
+        return 0;
+
+    int ret = settingsLog_init(&settingsLog);
+    if(ret < 0)
+        return ret;
 
-    // Invalid data found
-    if(block < 0) return -1;
+    logReady = true;
 
-    memcpy(channel, &(memory->data[block].vfoData), sizeof(channel_t));
+    if(settingsLog.valid == false)
+    {
+        int block = findLegacyBlock();
+        if(block >= 0)
+        {
+            dataBlock_t legacy;
+            memcpy(&legacy, &(memory->data[block]), sizeof(dataBlock_t));
+            settingsLog_write(&settingsLog, &legacy.settings, &legacy.vfoData);
+        }
+    }
 
     return 0;
 }
 
-int nvm_readSettings(settings_t *settings)
+
+int nvm_readVfoChannelData(channel_t *channel)
 {
-    int block = findActiveBlock();
+    if(loadLog() < 0)
+        return -1;
 
-    // Invalid data found
-    if(block < 0) return -1;
+    return settingsLog_read(&settingsLog, NULL, channel);
+}
 
-    memcpy(settings, &(memory->data[block].settings), sizeof(settings_t));
+int nvm_readSettings(settings_t *settings)
+{
+    if(loadLog() < 0)
+        return -1;
 
-    return 0;
+    return settingsLog_read(&settingsLog, settings, NULL);
 }
 
 int nvm_writeSettingsAndVfo(const settings_t *settings, const channel_t *vfo)
 {
-    uint32_t addr    = 0;
-    int      block   = findActiveBlock();
-    uint16_t prevCrc = 0;
-
-    /*
-     * Memory never initialised or save space finished: erase all the sector.
-     * On STM32F405 the settings are saved in sector 11, starting at address
-     * 0x08060000.
-     */
-    if((block < 0) || (block >= 2047))
-    {
-        flash_eraseSector(11);
-        addr = ((uint32_t) &(memory->magic));
-        flash_write(addr, &MEM_MAGIC, sizeof(MEM_MAGIC));
-        block = 0;
-    }
-    else
-    {
-        prevCrc = memory->data[block].crc;
-        block += 1;
-    }
-
-    dataBlock_t tmpBlock;
-    memcpy((&tmpBlock.settings), settings, sizeof(settings_t));
-    memcpy((&tmpBlock.vfoData), vfo, sizeof(channel_t));
-    tmpBlock.crc = crc_ccitt(&(tmpBlock.settings),
-                             sizeof(settings_t) + sizeof(channel_t));
-
-    // New data is equal to the old one, avoid saving
-    if((block != 0) && (tmpBlock.crc == prevCrc))
-        return 0;
-
-    // Save data
-    addr = ((uint32_t) &(memory->data[block]));
-    flash_write(addr, &tmpBlock, sizeof(dataBlock_t));
+    if(loadLog() < 0)
+        return -1;
 
-    // Update the flags marking used data blocks
-    uint32_t flag = ~(1 << (block % 32));
-    addr = ((uint32_t) &(memory->flags[block / 32]));
-    flash_write(addr, &flag, sizeof(uint32_t));
+    if(settingsLog_write(&settingsLog, settings, vfo) < 0)
+        return -1;
 
     return 0;
 }
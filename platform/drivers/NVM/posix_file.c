@@ -74,7 +74,7 @@ static int nvm_api_read(const struct nvmDevice *dev, uint32_t offset,
     if(pDev->fd < 0)
         return -EBADF;
 
-    if((offset + len) >= pDev->size)
+    if((offset + len) > pDev->size)
         return -EINVAL;
 
     lseek(pDev->fd, offset, SEEK_SET);
@@ -96,11 +96,40 @@ static int nvm_api_write(const struct nvmDevice *dev, uint32_t offset,
     return write(pDev->fd, data, len);
 }
 
+static int nvm_api_erase(const struct nvmDevice *dev, uint32_t offset,
+                         size_t size)
+{
+    struct nvmFileDevice *pDev = (struct nvmFileDevice *)(dev);
+    uint8_t blank[256];
+
+    if(pDev->fd < 0)
+        return -EBADF;
+
+    if((offset + size) > pDev->size)
+        return -EINVAL;
+
+    // Emulate a flash erase by filling the area with ones
+    memset(blank, 0xFF, sizeof(blank));
+    lseek(pDev->fd, offset, SEEK_SET);
+
+    while(size > 0)
+    {
+        size_t  len = (size < sizeof(blank)) ? size : sizeof(blank);
+        ssize_t ret = write(pDev->fd, blank, len);
+        if(ret < 0)
+            return -errno;
+
+        size -= ret;
+    }
+
+    return 0;
+}
+
 const struct nvmOps posix_file_ops =
 {
     .read   = nvm_api_read,
     .write  = nvm_api_write,
-    .erase  = NULL,
+    .erase  = nvm_api_erase,
     .sync   = NULL,
 };
 
@@ -0,0 +1,493 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <nvmem_access.h>
+#include <string.h>
+#include <errno.h>
+#include <crc.h>
+#include "settings_log.h"
+
+#define LOG_MAGIC       0x4C4E504F    // "OPNL"
+#define LOG_ALIGN       4
+#define LOG_MAX_PAYLOAD (SETTINGS_LOG_IMAGE_SIZE + sizeof(struct chunkHdr))
+
+/**
+ * Page header, written after the first checkpoint of the page.
+ */
+struct pageHdr
+{
+    uint32_t magic;
+    uint16_t imageSize;
+    uint16_t seq;
+};
+
+/**
+ * Record header, followed by the record payload.
+ */
+struct recordHdr
+{
+    uint16_t size;
+    uint16_t crc;
+};
+
+/**
+ * Header of a chunk of changed data inside the payload of a record.
+ */
+struct chunkHdr
+{
+    uint16_t offset;
+    uint16_t len;
+};
+
+
+static inline uint32_t alignUp(const struct settingsLog *log, uint32_t value)
+{
+    uint32_t align = log->nvm->info->write_size;
+    if(align < LOG_ALIGN)
+        align = LOG_ALIGN;
+
+    return ((value + align - 1) / align) * align;
+}
+
+static inline uint32_t pageAddr(const struct settingsLog *log, uint8_t page)
+{
+    return log->baseAddr + (page * log->pageSize);
+}
+
+/**
+ * \internal
+ * Size of the flags bitmap: one bit every eight bytes of page, records are
+ * always larger than that.
+ */
+static inline uint32_t flagsSize(const struct settingsLog *log)
+{
+    return log->pageSize / 64;
+}
+
+static inline uint32_t recordsStart(const struct settingsLog *log, uint8_t page)
+{
+    return pageAddr(log, page) + alignUp(log, sizeof(struct pageHdr) +
+                                              flagsSize(log));
+}
+
+/**
+ * \internal
+ * Read the flag of a record.
+ *
+ * @return 1 if the record has been committed, 0 if not, a negative error code
+ * on failure.
+ */
+static int readFlag(const struct settingsLog *log, uint32_t record)
+{
+    uint32_t addr = pageAddr(log, log->page) + sizeof(struct pageHdr)
+                  + (record / 8);
+    uint8_t  flags;
+
+    int ret = nvm_devRead(log->nvm, addr, &flags, 1);
+    if(ret < 0)
+        return ret;
+
+    return ((flags & (1 << (record % 8))) == 0) ? 1 : 0;
+}
+
+/**
+ * \internal
+ * Mark a record as committed, clearing its flag.
+ */
+static int commitRecord(const struct settingsLog *log, uint32_t record)
+{
+    uint32_t addr = pageAddr(log, log->page) + sizeof(struct pageHdr)
+                  + (record / 8);
+    uint8_t  flags;
+
+    int ret = nvm_devRead(log->nvm, addr, &flags, 1);
+    if(ret < 0)
+        return ret;
+
+    flags &= ~(1 << (record % 8));
+
+    return nvm_devWrite(log->nvm, addr, &flags, 1);
+}
+
+/**
+ * \internal
+ * Apply the payload of a record to the data image.
+ *
+ * @return true if the payload is well formed.
+ */
+static bool applyPayload(uint8_t *image, const uint8_t *payload, size_t size)
+{
+    size_t pos = 0;
+
+    while(pos < size)
+    {
+        struct chunkHdr chunk;
+
+        if((pos + sizeof(struct chunkHdr)) > size)
+            return false;
+
+        memcpy(&chunk, &payload[pos], sizeof(struct chunkHdr));
+        pos += sizeof(struct chunkHdr);
+
+        if(((chunk.offset + chunk.len) > SETTINGS_LOG_IMAGE_SIZE) ||
+           ((pos + chunk.len) > size))
+            return false;
+
+        memcpy(&image[chunk.offset], &payload[pos], chunk.len);
+        pos += chunk.len;
+    }
+
+    return true;
+}
+
+/**
+ * \internal
+ * Build the payload of a delta record, made of the areas changed between the
+ * old and the new image. Areas separated by less than a chunk header are
+ * merged together.
+ *
+ * @return size of the payload or zero if the delta is not smaller than a full
+ * checkpoint.
+ */
+static size_t buildDelta(const uint8_t *prev, const uint8_t *next,
+                         uint8_t *payload)
+{
+    size_t pos = 0;
+    size_t i   = 0;
+
+    while(i < SETTINGS_LOG_IMAGE_SIZE)
+    {
+        if(prev[i] == next[i])
+        {
+            i++;
+            continue;
+        }
+
+        size_t start = i;
+        size_t end   = i + 1;
+        for(size_t j = end; j < SETTINGS_LOG_IMAGE_SIZE; j++)
+        {
+            if(prev[j] != next[j])
+                end = j + 1;
+            else if((j - end) >= sizeof(struct chunkHdr))
+                break;
+        }
+
+        struct chunkHdr chunk =
+        {
+            .offset = start,
+            .len    = end - start
+        };
+
+        if((pos + sizeof(struct chunkHdr) + chunk.len) >= LOG_MAX_PAYLOAD)
+            return 0;
+
+        memcpy(&payload[pos], &chunk, sizeof(struct chunkHdr));
+        pos += sizeof(struct chunkHdr);
+        memcpy(&payload[pos], &next[start], chunk.len);
+        pos += chunk.len;
+        i    = end;
+    }
+
+    return pos;
+}
+
+/**
+ * \internal
+ * Build the payload of a checkpoint record.
+ */
+static size_t buildCheckpoint(const uint8_t *image, uint8_t *payload)
+{
+    struct chunkHdr chunk =
+    {
+        .offset = 0,
+        .len    = SETTINGS_LOG_IMAGE_SIZE
+    };
+
+    memcpy(payload, &chunk, sizeof(struct chunkHdr));
+    memcpy(&payload[sizeof(struct chunkHdr)], image, SETTINGS_LOG_IMAGE_SIZE);
+
+    return LOG_MAX_PAYLOAD;
+}
+
+/**
+ * \internal
+ * Append a record to the active page and commit it.
+ *
+ * @return zero on success, -ENOSPC if the page is full, a negative error code
+ * on failure.
+ */
+static int appendRecord(struct settingsLog *log, const uint8_t *payload,
+                        size_t size)
+{
+    uint32_t recSize = alignUp(log, sizeof(struct recordHdr) + size);
+    uint32_t pageEnd = pageAddr(log, log->page) + log->pageSize;
+
+    if(((log->writeAddr + recSize) > pageEnd) ||
+       (log->numRecords >= (flagsSize(log) * 8)))
+        return -ENOSPC;
+
+    struct recordHdr hdr =
+    {
+        .size = size,
+        .crc  = crc_ccitt(payload, size)
+    };
+
+    // From now on the space is used, even if the write fails
+    uint32_t addr    = log->writeAddr;
+    log->writeAddr  += recSize;
+    log->numRecords += 1;
+
+    int ret = nvm_devWrite(log->nvm, addr, &hdr, sizeof(struct recordHdr));
+    if(ret < 0)
+        return ret;
+
+    ret = nvm_devWrite(log->nvm, addr + sizeof(struct recordHdr), payload, size);
+    if(ret < 0)
+        return ret;
+
+    ret = commitRecord(log, log->numRecords - 1);
+    if(ret < 0)
+        return ret;
+
+    return 0;
+}
+
+/**
+ * \internal
+ * Start a new page, containing a checkpoint of the given data image. The page
+ * header is written last, so that the page becomes valid only once the
+ * checkpoint is in place.
+ */
+static int startPage(struct settingsLog *log, const uint8_t *image)
+{
+    uint8_t payload[LOG_MAX_PAYLOAD];
+    uint8_t next = (log->page + 1) % log->numPages;
+
+    int ret = nvm_devErase(log->nvm, pageAddr(log, next), log->pageSize);
+    if(ret < 0)
+        return ret;
+
+    log->page       = next;
+    log->writeAddr  = recordsStart(log, next);
+    log->numRecords = 0;
+
+    size_t size = buildCheckpoint(image, payload);
+    ret = appendRecord(log, payload, size);
+    if(ret < 0)
+        return ret;
+
+    struct pageHdr hdr =
+    {
+        .magic     = LOG_MAGIC,
+        .imageSize = SETTINGS_LOG_IMAGE_SIZE,
+        .seq       = log->seq + 1
+    };
+
+    ret = nvm_devWrite(log->nvm, pageAddr(log, next), &hdr,
+                       sizeof(struct pageHdr));
+    if(ret < 0)
+        return ret;
+
+    log->seq     += 1;
+    log->compact  = false;
+
+    return 0;
+}
+
+/**
+ * \internal
+ * Replay the records of the active page, rebuilding the data image.
+ */
+static int replayPage(struct settingsLog *log)
+{
+    uint8_t  payload[LOG_MAX_PAYLOAD];
+    uint32_t pageEnd = pageAddr(log, log->page) + log->pageSize;
+    uint32_t addr    = recordsStart(log, log->page);
+    uint32_t record  = 0;
+    bool     broken  = false;
+
+    for(; record < (flagsSize(log) * 8); record++)
+    {
+        int ret = readFlag(log, record);
+        if(ret < 0)
+            return ret;
+
+        if(ret == 0)
+            break;
+
+        struct recordHdr hdr;
+        ret = nvm_devRead(log->nvm, addr, &hdr, sizeof(struct recordHdr));
+        if(ret < 0)
+            return ret;
+
+        uint32_t recSize = alignUp(log, sizeof(struct recordHdr) + hdr.size);
+        if((hdr.size > LOG_MAX_PAYLOAD) || ((addr + recSize) > pageEnd))
+        {
+            broken = true;
+            break;
+        }
+
+        ret = nvm_devRead(log->nvm, addr + sizeof(struct recordHdr), payload,
+                          hdr.size);
+        if(ret < 0)
+            return ret;
+
+        // Damaged records are skipped, the next checkpoint restores the data.
+        // Deltas are meaningful only after a valid checkpoint.
+        bool full = (hdr.size == LOG_MAX_PAYLOAD);
+        if((crc_ccitt(payload, hdr.size) == hdr.crc) && (full || log->valid))
+        {
+            if(applyPayload(log->image, payload, hdr.size))
+            {
+                log->valid     = true;
+                log->numDeltas = full ? 0 : (log->numDeltas + 1);
+            }
+        }
+
+        addr += recSize;
+    }
+
+    log->writeAddr  = addr;
+    log->numRecords = record;
+
+    // Data after the last committed record means that a save was interrupted:
+    // its position is unknown, continue on a new page.
+    uint32_t blank = 0xFFFFFFFF;
+    if((addr + sizeof(uint32_t)) <= pageEnd)
+    {
+        int ret = nvm_devRead(log->nvm, addr, &blank, sizeof(uint32_t));
+        if(ret < 0)
+            return ret;
+    }
+
+    log->compact = broken || (blank != 0xFFFFFFFF) || (log->valid == false);
+
+    return 0;
+}
+
+int settingsLog_init(struct settingsLog *log)
+{
+    uint32_t eraseSize = log->nvm->info->erase_size;
+
+    if((log->numPages == 0) || ((eraseSize > 0) &&
+       ((log->pageSize % eraseSize) != 0)))
+        return -EINVAL;
+
+    log->page       = 0;
+    log->seq        = 0;
+    log->writeAddr  = 0;
+    log->numRecords = 0;
+    log->numDeltas  = 0;
+    log->valid      = false;
+    log->compact    = true;
+    memset(log->image, 0x00, SETTINGS_LOG_IMAGE_SIZE);
+
+    // Search for the most recent valid page
+    int active = -1;
+    for(uint8_t page = 0; page < log->numPages; page++)
+    {
+        struct pageHdr hdr;
+        int ret = nvm_devRead(log->nvm, pageAddr(log, page), &hdr,
+                              sizeof(struct pageHdr));
+        if(ret < 0)
+            return ret;
+
+        if((hdr.magic != LOG_MAGIC) ||
+           (hdr.imageSize != SETTINGS_LOG_IMAGE_SIZE))
+            continue;
+
+        if((active < 0) || (((int16_t) (hdr.seq - log->seq)) > 0))
+        {
+            active   = page;
+            log->seq = hdr.seq;
+        }
+    }
+
+    if(active < 0)
+        return 0;
+
+    log->page = active;
+
+    return replayPage(log);
+}
+
+int settingsLog_read(const struct settingsLog *log, settings_t *settings,
+                     channel_t *vfo)
+{
+    if(log->valid == false)
+        return -1;
+
+    if(settings != NULL)
+        memcpy(settings, log->image, sizeof(settings_t));
+
+    if(vfo != NULL)
+        memcpy(vfo, &log->image[sizeof(settings_t)], sizeof(channel_t));
+
+    return 0;
+}
+
+int settingsLog_write(struct settingsLog *log, const settings_t *settings,
+                      const channel_t *vfo)
+{
+    uint8_t image[SETTINGS_LOG_IMAGE_SIZE];
+    uint8_t payload[LOG_MAX_PAYLOAD];
+    size_t  size = 0;
+    int     ret  = -ENOSPC;
+
+    memcpy(image, settings, sizeof(settings_t));
+    memcpy(&image[sizeof(settings_t)], vfo, sizeof(channel_t));
+
+    // New data is equal to the old one, avoid saving
+    if(log->valid && (memcmp(image, log->image, SETTINGS_LOG_IMAGE_SIZE) == 0))
+        return 0;
+
+    if(log->compact == false)
+    {
+        if(log->numDeltas < SETTINGS_LOG_CHECKPOINT)
+            size = buildDelta(log->image, image, payload);
+
+        if(size == 0)
+            size = buildCheckpoint(image, payload);
+
+        ret = appendRecord(log, payload, size);
+    }
+
+    // Page full, or no page at all: start a new one
+    if(ret == -ENOSPC)
+    {
+        size = LOG_MAX_PAYLOAD;
+        ret  = startPage(log, image);
+    }
+
+    if(ret < 0)
+    {
+        // The state of the page is unknown, move to a new one at next save
+        log->compact = true;
+        return ret;
+    }
+
+    memcpy(log->image, image, SETTINGS_LOG_IMAGE_SIZE);
+    log->valid     = true;
+    log->numDeltas = (size == LOG_MAX_PAYLOAD) ? 0 : (log->numDeltas + 1);
+
+    return 0;
+}
@@ -0,0 +1,108 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef SETTINGS_LOG_H
+#define SETTINGS_LOG_H
+
+#include <interfaces/nvmem.h>
+#include <stdbool.h>
+
+/**
+ * Log-structured storage for radio settings and VFO channel, running over any
+ * NVM device.
+ *
+ * The storage area is divided in one or more pages, each one made of one or
+ * more erase units. A page begins with a header and a bitmap of flags marking,
+ * one bit per record, the records completely written. The records follow: each
+ * record contains either a full copy of the data (checkpoint) or only the
+ * fields changed since the previous save (delta). A new page, beginning with a
+ * checkpoint, is started when the active one is full. Checkpoints are also
+ * written periodically inside a page, to limit the effect of a damaged delta.
+ *
+ * A record is taken into account only after its flag has been cleared, thus a
+ * save interrupted by a power loss leaves the previously saved data in place.
+ * When the storage area is made of a single page, the data is lost if the power
+ * fails between the erase of the page and the write of the new checkpoint.
+ */
+
+/**
+ * Size of the data saved in the log: settings followed by VFO channel.
+ */
+#define SETTINGS_LOG_IMAGE_SIZE (sizeof(settings_t) + sizeof(channel_t))
+
+/**
+ * Number of delta records between two checkpoints.
+ */
+#define SETTINGS_LOG_CHECKPOINT 32
+
+/**
+ * Settings log instance.
+ */
+struct settingsLog
+{
+    const struct nvmDevice *nvm;        ///< Underlying NVM device
+    uint32_t                baseAddr;   ///< Start address of the storage area
+    uint32_t                pageSize;   ///< Size of a page, multiple of the erase size
+    uint8_t                 numPages;   ///< Number of pages
+
+    uint8_t                 page;       ///< Active page
+    uint16_t                seq;        ///< Sequence number of the active page
+    uint32_t                writeAddr;  ///< Address for the next record
+    uint32_t                numRecords; ///< Records in the active page
+    uint32_t                numDeltas;  ///< Deltas since the last checkpoint
+    bool                    valid;      ///< Saved data is available
+    bool                    compact;    ///< Next save has to start a new page
+    uint8_t                 image[SETTINGS_LOG_IMAGE_SIZE];   ///< Saved data
+};
+
+/**
+ * Initialize a settings log, loading the most recent data from the storage.
+ * The nvm, baseAddr, pageSize and numPages fields have to be set before.
+ *
+ * @param log: pointer to the settings log.
+ * @return zero on success, a negative error code otherwise.
+ */
+int settingsLog_init(struct settingsLog *log);
+
+/**
+ * Read the saved data.
+ *
+ * @param log: pointer to the settings log.
+ * @param settings: destination for the settings, can be NULL.
+ * @param vfo: destination for the VFO channel, can be NULL.
+ * @return zero on success, -1 if there is no saved data.
+ */
+int settingsLog_read(const struct settingsLog *log, settings_t *settings,
+                     channel_t *vfo);
+
+/**
+ * Save new data. Only the changes with respect to the previous save are
+ * written and nothing is written if the data did not change.
+ *
+ * @param log: pointer to the settings log.
+ * @param settings: settings to be saved.
+ * @param vfo: VFO channel to be saved.
+ * @return zero on success, a negative error code otherwise.
+ */
+int settingsLog_write(struct settingsLog *log, const settings_t *settings,
+                      const channel_t *vfo);
+
+#endif /* SETTINGS_LOG_H */
@@ -44,9 +44,9 @@ static const uint8_t pathCompatibilityMatrix[9][9] =
     {    0   ,   0   ,   0   ,   1   ,   0   ,   1   ,   1   ,   0   ,   1   },  // MIC-RTX
     {    0   ,   0   ,   0   ,   0   ,   1   ,   1   ,   0   ,   0   ,   1   },  // MIC-SPK
     {    0   ,   0   ,   0   ,   1   ,   1   ,   0   ,   1   ,   1   ,   0   },  // MIC-MCU
-    {    0   ,   1   ,   1   ,   0   ,   0   ,   0   ,   0   ,   1   ,   1   },  // RTX-SPK
+    {    0   ,   1   ,   1   ,   0   ,   0   ,   1   ,   0   ,   1   ,   1   },  // RTX-SPK
     {    1   ,   0   ,   1   ,   0   ,   0   ,   0   ,   1   ,   0   ,   1   },  // RTX-RTX
-    {    1   ,   1   ,   0   ,   0   ,   0   ,   0   ,   1   ,   1   ,   0   },  // RTX-MCU
+    {    1   ,   1   ,   0   ,   1   ,   0   ,   0   ,   1   ,   1   ,   0   },  // RTX-MCU
     {    0   ,   1   ,   1   ,   0   ,   1   ,   1   ,   0   ,   0   ,   0   },  // MCU-SPK
     {    0   ,   0   ,   1   ,   1   ,   0   ,   1   ,   0   ,   0   ,   0   },  // MCU-RTX
     {    1   ,   1   ,   0   ,   1   ,   1   ,   0   ,   0   ,   0   ,   0   }   // MCU-MCU
@@ -120,7 +120,12 @@ const struct audioDevice outputDevices[] =
 const struct audioDevice inputDevices[] =
 {
     {NULL,                    0,                 0,              SOURCE_MCU},
+    #ifdef PLATFORM_MD9600
+    // No analog baseband output wired to the MCU
+    {NULL,                    0,                 0,              SOURCE_RTX},
+    #else
     {&stm32_adc_audio_driver, (const void *) 13, STM32_ADC_ADC2, SOURCE_RTX},
+    #endif
     {&stm32_adc_audio_driver, (const void *) 3,  STM32_ADC_ADC2, SOURCE_MIC},
 };
 
@@ -26,6 +26,10 @@
 #include <miosix.h>
 #include <kernel/scheduler/scheduler.h>
 
+#ifndef CONFIG_PIX_FMT_RGB565_BE
+#error HX8353 driver requires a big endian RGB565 framebuffer
+#endif
+
 /**
  * LCD command set, basic and extended
  */
@@ -90,11 +94,13 @@
 
 using namespace miosix;
 static Thread *lcdWaiting = 0;
+static volatile bool renderPending = false;
 
 void __attribute__((used)) DmaImpl()
 {
     DMA2->HIFCR |= DMA_HIFCR_CTCIF7 | DMA_HIFCR_CTEIF7;    /* Clear flags */
     gpio_setPin(LCD_CS);
+    renderPending = false;
 
     if(lcdWaiting == 0) return;
     lcdWaiting->IRQwakeup();
@@ -421,8 +427,11 @@ void display_terminate()
     __DSB();
 }
 
-void display_renderRows(uint8_t startRow, uint8_t endRow, void *fb)
+void display_renderRowsAsync(uint8_t startRow, uint8_t endRow, void *fb)
 {
+    /* Only one transfer at a time */
+    display_waitRender();
+
     /*
      * Put screen data lines back to alternate function mode, since they are in
      * common with keyboard buttons and the keyboard driver sets them as inputs.
@@ -439,21 +448,10 @@ void display_renderRows(uint8_t startRow, uint8_t endRow, void *fb)
     gpio_clearPin(LCD_CS);
 
     /*
-     * First of all, convert pixels from little to big endian, for
-     * compatibility with the display driver. We do this after having brought
-     * the CS pin low, in this way user code calling the renderingInProgress
-     * function gets true as return value and does not stomp our work.
+     * Pixels are already stored in big endian order by the graphics library
+     * (CONFIG_PIX_FMT_RGB565_BE), thus the framebuffer is sent as it is.
      */
     uint16_t *frameBuffer = (uint16_t *) fb;
-    for(uint8_t y = startRow; y < endRow; y++)
-    {
-        for(uint8_t x = 0; x < CONFIG_SCREEN_WIDTH; x++)
-        {
-            size_t pos = x + y * CONFIG_SCREEN_WIDTH;
-            uint16_t pixel = frameBuffer[pos];
-            frameBuffer[pos] = __builtin_bswap16(pixel);
-        }
-    }
 
     /* Configure start and end rows in display driver */
     writeCmd(CMD_RASET);
@@ -475,30 +473,39 @@ void display_renderRows(uint8_t startRow, uint8_t endRow, void *fb)
     DMA2_Stream7->PAR  = ((uint32_t ) frameBuffer + (startRow * CONFIG_SCREEN_WIDTH
                                                      * sizeof(uint16_t)));
     DMA2_Stream7->M0AR = LCD_FSMC_ADDR_DATA;
+
+    renderPending = true;
     DMA2_Stream7->CR = DMA_SxCR_CHSEL         /* Channel 7                   */
                      | DMA_SxCR_PINC          /* Increment source pointer    */
                      | DMA_SxCR_DIR_1         /* Memory to memory            */
                      | DMA_SxCR_TCIE          /* Transfer complete interrupt */
                      | DMA_SxCR_TEIE          /* Transfer error interrupt    */
                      | DMA_SxCR_EN;           /* Start transfer              */
+}
 
+void display_waitRender()
+{
     /*
      * Put the calling thread in waiting status until render completes.
      */
+    FastInterruptDisableLock dLock;
+    while(renderPending)
     {
-        FastInterruptDisableLock dLock;
         lcdWaiting = Thread::IRQgetCurrentThread();
-        do
+        Thread::IRQwait();
         {
-            Thread::IRQwait();
-            {
-                FastInterruptEnableLock eLock(dLock);
-                Thread::yield();
-            }
-        } while(lcdWaiting);
+            FastInterruptEnableLock eLock(dLock);
+            Thread::yield();
+        }
     }
 }
 
+void display_renderRows(uint8_t startRow, uint8_t endRow, void *fb)
+{
+    display_renderRowsAsync(startRow, endRow, fb);
+    display_waitRender();
+}
+
 void display_render(void *fb)
 {
     display_renderRows(0, CONFIG_SCREEN_HEIGHT, fb);
@@ -28,39 +28,13 @@
 #include <interfaces/delays.h>
 #include "hwconfig.h"
 
-
-/**
- * \internal
- * Send one row of pixels to the display.
- * Pixels in framebuffer are stored "by rows", while display needs data to be
- * sent "by columns": this function performs the needed conversion.
- *
- * @param row: pixel row to be be sent.
+/*
+ * Pixels in framebuffer are stored by pages, in the same order used by the
+ * display controller: each page is sent as it is.
  */
-static void display_renderRow(uint8_t row, uint8_t *frameBuffer)
-{
-    /* magic stuff */
-    uint8_t *buf = (frameBuffer + 128 * row);
-    for (uint8_t i = 0; i<16; i++)
-    {
-        uint8_t tmp[8] = {0};
-        for (uint8_t j = 0; j < 8; j++)
-        {
-            uint8_t tmp_buf = buf[j*16 + i];
-            int count = __builtin_popcount(tmp_buf);
-            while (count > 0)
-            {
-                int pos = __builtin_ctz(tmp_buf);
-                tmp[pos] |= 1UL << j;
-                tmp_buf &= ~(1 << pos);
-                count--;
-            }
-        }
-
-        spi_send(&spi2, tmp, 8);
-    }
-}
-
+#ifndef CONFIG_PIX_FMT_BW_PAGED
+#error ST7567 driver requires a paged 1bpp framebuffer
+#endif
 
 void display_init()
 {
@@ -116,7 +90,8 @@ void display_renderRows(uint8_t startRow, uint8_t endRow, void *fb)
         gpio_clearPin(LCD_RS);            /* RS low -> command mode */
         spi_send(&spi2, command, 3);
         gpio_setPin(LCD_RS);              /* RS high -> data mode   */
-        display_renderRow(row, (uint8_t *) fb);
+        spi_send(&spi2, ((uint8_t *) fb) + (CONFIG_SCREEN_WIDTH * row),
+                 CONFIG_SCREEN_WIDTH);
     }
 
     gpio_setPin(LCD_CS);
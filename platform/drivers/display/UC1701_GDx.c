@@ -28,6 +28,10 @@
 #include <interfaces/delays.h>
 #include <hwconfig.h>
 
+#ifndef CONFIG_PIX_FMT_BW_PAGED
+#error UC1701 driver requires a paged 1bpp framebuffer
+#endif
+
 /**
  * \internal
  * Send one byte to display controller, via bit banging.
@@ -56,36 +60,18 @@ static void sendByteToController(uint8_t value)
 
 /**
  * \internal
- * Send one row of pixels to the display.
- * Pixels in framebuffer are stored "by rows", while display needs data to be
- * sent "by columns": this function performs the needed conversion.
+ * Send one page of pixels to the display.
+ * Pixels in framebuffer are stored by pages (CONFIG_PIX_FMT_BW_PAGED), in the
+ * same order used by the display controller: the page is sent as it is.
  *
- * @param row: pixel row to be be sent.
+ * @param page: page to be be sent.
  */
-static void display_renderRow(uint8_t row, uint8_t *frameBuffer)
+static void display_renderPage(uint8_t page, uint8_t *frameBuffer)
 {
-    /* magic stuff */
-    uint8_t *buf = (frameBuffer + 128 * row);
-    for (uint8_t i = 0; i<16; i++)
+    uint8_t *buf = frameBuffer + (CONFIG_SCREEN_WIDTH * page);
+    for(uint8_t i = 0; i < CONFIG_SCREEN_WIDTH; i++)
     {
-        uint8_t tmp[8] = {0};
-        for (uint8_t j = 0; j < 8; j++)
-        {
-            uint8_t tmp_buf = buf[j*16 + i];
-            int count = __builtin_popcount(tmp_buf);
-            while (count > 0)
-            {
-                int pos = __builtin_ctz(tmp_buf);
-                tmp[pos] |= 1UL << j;
-                tmp_buf &= ~(1 << pos);
-                count--;
-            }
-        }
-
-        for (uint8_t s = 0; s < 8; s++)
-        {
-            sendByteToController(tmp[s]);
-        }
+        sendByteToController(buf[i]);
     }
 }
 
@@ -143,7 +129,7 @@ void display_renderRows(uint8_t startRow, uint8_t endRow, void *fb)
         sendByteToController(0x10);       /* Set X position         */
         sendByteToController(0x04);
         gpio_setPin(LCD_RS);              /* RS high -> data mode   */
-        display_renderRow(row, (uint8_t *) fb);
+        display_renderPage(row, (uint8_t *) fb);
     }
 
 }
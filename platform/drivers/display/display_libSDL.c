@@ -30,6 +30,7 @@
 #include <chan.h>
 #include <stdio.h>
 #include <string.h>
+#include <pthread.h>
 #include <SDL2/SDL.h>
 
 static bool inProgress;             /* Flag to signal when rendering is in progress */
@@ -62,8 +63,13 @@ static uint32_t fetchPixelFromFb(unsigned int x, unsigned int y, void *fb)
      * each cell contains the values of eight pixels, one per bit.
      */
     uint8_t *buf = (uint8_t *)(fb);
+    #ifdef CONFIG_PIX_FMT_BW_PAGED
+    unsigned int cell = x + (y / 8)*CONFIG_SCREEN_WIDTH;
+    unsigned int elem = y % 8;
+    #else
     unsigned int cell = (x + y*CONFIG_SCREEN_WIDTH) / 8;
     unsigned int elem = (x + y*CONFIG_SCREEN_WIDTH) % 8;
+    #endif
     if(buf[cell] & (1 << elem)) pixel = 0xFFFFFFFF;
     #endif
 
@@ -82,6 +88,99 @@ static uint32_t fetchPixelFromFb(unsigned int x, unsigned int y, void *fb)
 }
 #endif
 
+/**
+ * @internal
+ * Copy framebuffer content to the pixel map of the SDL texture, converting it
+ * to the texture pixel format if needed.
+ */
+static void copyToPixelMap(void *pixelMap, uint8_t startRow, uint8_t endRow,
+                           void *fb)
+{
+    #ifdef CONFIG_PIX_FMT_RGB565
+    (void) startRow;
+    (void) endRow;
+    memcpy(pixelMap, fb, sizeof(PIXEL_SIZE) * CONFIG_SCREEN_HEIGHT * CONFIG_SCREEN_WIDTH);
+    #else
+    uint32_t *pixels = (uint32_t *) pixelMap;
+    for (unsigned int x = 0; x < CONFIG_SCREEN_WIDTH; x++)
+    {
+        for (unsigned int y = startRow; y < endRow; y++)
+        {
+            pixels[x + y * CONFIG_SCREEN_WIDTH] = fetchPixelFromFb(x, y, fb);
+        }
+    }
+    #endif
+}
+
+#ifdef CONFIG_GFX_DOUBLE_BUFFER
+/*
+ * Asynchronous rendering: the framebuffer is handed to the SDL main loop, which
+ * copies it to the texture at its next iteration. Only one frame at a time can
+ * be pending.
+ */
+static pthread_mutex_t renderMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  renderCond  = PTHREAD_COND_INITIALIZER;
+static void           *pendingFb   = NULL;
+static uint8_t         pendingStart;
+static uint8_t         pendingEnd;
+
+void display_renderRowsAsync(uint8_t startRow, uint8_t endRow, void *fb)
+{
+    if(!sdl_ready)
+    {
+        sdl_ready = sdlEngine_ready();
+    }
+
+    pthread_mutex_lock(&renderMutex);
+
+    while(pendingFb != NULL)
+        pthread_cond_wait(&renderCond, &renderMutex);
+
+    // Frames are dropped until the SDL main loop is running
+    if(sdl_ready)
+    {
+        pendingFb    = fb;
+        pendingStart = startRow;
+        pendingEnd   = endRow;
+    }
+
+    pthread_mutex_unlock(&renderMutex);
+}
+
+void display_waitRender()
+{
+    pthread_mutex_lock(&renderMutex);
+
+    while(pendingFb != NULL)
+        pthread_cond_wait(&renderCond, &renderMutex);
+
+    pthread_mutex_unlock(&renderMutex);
+}
+
+bool sdlDisplay_framePending()
+{
+    pthread_mutex_lock(&renderMutex);
+    bool pending = (pendingFb != NULL);
+    pthread_mutex_unlock(&renderMutex);
+
+    return pending;
+}
+
+void sdlDisplay_present(void *pixelMap)
+{
+    pthread_mutex_lock(&renderMutex);
+
+    if(pendingFb != NULL)
+    {
+        copyToPixelMap(pixelMap, pendingStart, pendingEnd, pendingFb);
+        pendingFb = NULL;
+        pthread_cond_broadcast(&renderCond);
+    }
+
+    pthread_mutex_unlock(&renderMutex);
+}
+#endif
+
 void display_init()
 {
     inProgress = false;
@@ -89,6 +188,10 @@ void display_init()
 
 void display_terminate()
 {
+    #ifdef CONFIG_GFX_DOUBLE_BUFFER
+    display_waitRender();
+    #endif
+
     while (inProgress){ }         /* Wait until current render finishes */
     chan_close(&fb_sync);
     chan_terminate(&fb_sync);
@@ -96,8 +199,6 @@ void display_terminate()
 
 void display_renderRows(uint8_t startRow, uint8_t endRow, void *fb)
 {
-    (void) startRow;
-    (void) endRow;
     inProgress = true;
     if(!sdl_ready)
     {
@@ -109,18 +210,7 @@ void display_renderRows(uint8_t startRow, uint8_t endRow, void *fb)
         // receive a texture pixel map
         void *pixelMap;
         chan_recv(&fb_sync, &pixelMap);
-        #ifdef CONFIG_PIX_FMT_RGB565
-        memcpy(pixelMap, fb, sizeof(PIXEL_SIZE) * CONFIG_SCREEN_HEIGHT * CONFIG_SCREEN_WIDTH);
-        #else
-        uint32_t *pixels = (uint32_t *) pixelMap;
-        for (unsigned int x = 0; x < CONFIG_SCREEN_WIDTH; x++)
-        {
-            for (unsigned int y = startRow; y < endRow; y++)
-            {
-                pixels[x + y * CONFIG_SCREEN_WIDTH] = fetchPixelFromFb(x, y, fb);
-            }
-        }
-        #endif
+        copyToPixelMap(pixelMap, startRow, endRow, fb);
         // signal the SDL main loop to proceed with rendering
         void *done = {0};
         chan_send(&fb_sync, done);
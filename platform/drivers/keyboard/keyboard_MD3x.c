@@ -24,6 +24,7 @@
 #include <interfaces/delays.h>
 #include <interfaces/keyboard.h>
 #include <interfaces/platform.h>
+#include <interfaces/display.h>
 #include "hwconfig.h"
 
 static int8_t old_pos = 0;
@@ -84,6 +85,11 @@ keyboard_t kbd_getKeys()
      * that any residual charge on both the display controller's inputs and in
      * the capacitors in parallel to the Dx lines is dissipated.
      */
+    #ifdef CONFIG_GFX_DOUBLE_BUFFER
+    /* Display transfers run in background, wait for the current one to end */
+    display_waitRender();
+    #endif
+
     gpio_setMode(LCD_D0, OUTPUT);
     gpio_setMode(LCD_D1, OUTPUT);
     gpio_setMode(LCD_D2, OUTPUT);
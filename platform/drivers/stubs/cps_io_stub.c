@@ -171,3 +171,32 @@ int cps_deleteBankData(uint16_t bank_pos, uint16_t pos)
 
     return -1;
 }
+
+int cps_findChannelByName(const char *prefix)
+{
+    (void) prefix;
+
+    return -1;
+}
+
+int cps_findChannelByFreq(freq_t freq)
+{
+    (void) freq;
+
+    return -1;
+}
+
+int cps_beginBatch()
+{
+    return -1;
+}
+
+int cps_commitBatch()
+{
+    return -1;
+}
+
+void cps_abortBatch()
+{
+
+}
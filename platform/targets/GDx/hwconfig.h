@@ -42,6 +42,7 @@ extern const struct spiDevice c6000_spi;
 
 /* Screen pixel format */
 #define CONFIG_PIX_FMT_BW
+#define CONFIG_PIX_FMT_BW_PAGED
 
 /* Screen has adjustable contrast */
 #define CONFIG_SCREEN_CONTRAST
@@ -47,6 +47,7 @@ extern const struct sky73210 pll;
 
 /* Screen pixel format */
 #define CONFIG_PIX_FMT_RGB565
+#define CONFIG_PIX_FMT_RGB565_BE
 
 /* Screen has adjustable brightness */
 #define CONFIG_SCREEN_BRIGHTNESS
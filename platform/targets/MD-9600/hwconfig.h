@@ -46,6 +46,7 @@ extern const struct spiDevice spi2;
 
 /* Screen pixel format */
 #define CONFIG_PIX_FMT_BW
+#define CONFIG_PIX_FMT_BW_PAGED
 
 /* Battery type */
 #define CONFIG_BAT_NONE
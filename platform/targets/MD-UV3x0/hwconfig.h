@@ -48,6 +48,7 @@ extern const struct spiDevice nvm_spi;
 
 /* Screen pixel format */
 #define CONFIG_PIX_FMT_RGB565
+#define CONFIG_PIX_FMT_RGB565_BE
 
 /* Battery type */
 #define CONFIG_BAT_LIPO_2S
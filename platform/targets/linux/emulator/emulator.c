@@ -19,6 +19,7 @@
  ***************************************************************************/
 
 #include <pthread.h>
+#include <stdatomic.h>
 #include <unistd.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -68,8 +69,11 @@ static keyboard_t _shellkeyq[25] = {0};
 static int _skq_cap = 25;
 static int _skq_head;
 static int _skq_tail;
-static int _skq_in;
-static int _skq_out;
+
+// Single producer (CLI thread) single consumer (keyboard driver) queue: the
+// element counters are atomic to publish the queue content between threads.
+static atomic_int _skq_in;
+static atomic_int _skq_out;
 
 // NOTE: unused function
 // static void _dump_skq()
@@ -99,7 +103,7 @@ static void shellkeyq_put(keyboard_t keys)
     // (well, often) want [1,0,1,0,1,0] to simulate separate keypresses
     // this, of course, relies on the kbd_thread getting just one element off
     // the queue for every kbd_getKeys().
-    if(_skq_in > _skq_out + _skq_cap)
+    if(_skq_in >= _skq_out + _skq_cap)
     {
         printf("too many keys!\n");
         return;
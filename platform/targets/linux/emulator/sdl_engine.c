@@ -373,6 +373,26 @@ void sdlEngine_run()
             SDL_RenderCopy(renderer, displayTexture, NULL, NULL);
             SDL_RenderPresent(renderer);
         }
+        #ifdef CONFIG_GFX_DOUBLE_BUFFER
+        // Frames sent asynchronously do not block the UI thread
+        else if (sdlDisplay_framePending())
+        {
+            PIXEL_SIZE *pixels;
+            int pitch = 0;
+
+            if (SDL_LockTexture(displayTexture, NULL,
+                                (void **) &pixels, &pitch) < 0)
+            {
+                SDL_Log("SDL_lock failed: %s", SDL_GetError());
+            }
+
+            sdlDisplay_present(pixels);
+
+            SDL_UnlockTexture(displayTexture);
+            SDL_RenderCopy(renderer, displayTexture, NULL, NULL);
+            SDL_RenderPresent(renderer);
+        }
+        #endif
     }
 
     printf("Terminating SDL display emulator, goodbye!\n");
@@ -66,4 +66,23 @@ bool sdlEngine_ready();
  */
 keyboard_t sdlEngine_getKeys();
 
+#ifdef CONFIG_GFX_DOUBLE_BUFFER
+/**
+ * Check if the display driver has a frame waiting to be presented, provided by
+ * the SDL display driver.
+ *
+ * @return true if a frame is waiting to be presented.
+ */
+bool sdlDisplay_framePending();
+
+/**
+ * Copy the pending frame to the pixel map of the display texture and notify the
+ * display driver that its framebuffer is no longer in use. Provided by the SDL
+ * display driver, must be called in the Main Thread.
+ *
+ * @param pixelMap: pixel map of the locked display texture.
+ */
+void sdlDisplay_present(void *pixelMap);
+#endif
+
 #endif /* SDL_ENGINE_H */
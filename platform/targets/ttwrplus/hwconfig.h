@@ -29,6 +29,7 @@
 #define CONFIG_SCREEN_WIDTH  DT_PROP(DISPLAY, width)
 #define CONFIG_SCREEN_HEIGHT DT_PROP(DISPLAY, height)
 #define CONFIG_PIX_FMT_BW
+#define CONFIG_PIX_FMT_BW_PAGED
 #define CONFIG_GPS
 
 #define CONFIG_BAT_LIPO_1S
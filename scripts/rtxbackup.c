@@ -0,0 +1,188 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/*
+ * Host tool for the external flash backups: converts a raw image of the
+ * external flash memory to a backup stream and vice versa.
+ *
+ * Usage:
+ *   rtxbackup dump <image> <backup> [first sector]
+ *   rtxbackup restore <backup> <image> [image size]
+ */
+
+#include <interfaces/nvmem.h>
+#include <nvmem_access.h>
+#include <flash_backup.h>
+#include <posix_file.h>
+#include <sys/stat.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdio.h>
+
+#define DEFAULT_SIZE (16 * 1024 * 1024)
+
+static struct flashBackup ctx;
+
+const struct nvmDescriptor *nvm_getDesc(const size_t index)
+{
+    (void) index;
+
+    return NULL;
+}
+
+static void printStats(const char *op)
+{
+    printf("%s: %u sectors, %u erased, %u compressed, %u written, "
+           "%u unchanged, stream size %zu bytes\n", op,
+           (unsigned) ctx.stats.sectors, (unsigned) ctx.stats.erased,
+           (unsigned) ctx.stats.compressed, (unsigned) ctx.stats.written,
+           (unsigned) ctx.stats.skipped, ctx.stats.streamSize);
+}
+
+static int dump(const char *imagePath, const char *backupPath, uint32_t first)
+{
+    struct stat st;
+    if(stat(imagePath, &st) < 0)
+    {
+        perror(imagePath);
+        return -1;
+    }
+
+    struct nvmFileDevice image =
+    {
+        .ops  = &posix_file_ops,
+        .info = &posix_file_info,
+        .size = st.st_size,
+        .fd   = -1
+    };
+
+    FILE *out = fopen(backupPath, "wb");
+    if(out == NULL)
+    {
+        perror(backupPath);
+        return -1;
+    }
+
+    int ret = posixFile_init(&image, imagePath);
+    if(ret == 0)
+        ret = flashBackup_startExport(&ctx, (struct nvmDevice *) &image, first);
+
+    while(ret == 0)
+    {
+        uint8_t buf[1024];
+        ssize_t len = flashBackup_read(&ctx, buf, sizeof(buf));
+        if(len <= 0)
+        {
+            ret = len;
+            break;
+        }
+
+        fwrite(buf, 1, len, out);
+    }
+
+    fclose(out);
+    posixFile_terminate(&image);
+
+    if(ret < 0)
+    {
+        fprintf(stderr, "Backup failed: %s\n", strerror(-ret));
+        return -1;
+    }
+
+    printStats("Backup");
+
+    return 0;
+}
+
+static int restore(const char *backupPath, const char *imagePath, size_t size)
+{
+    struct stat st;
+    if(size == 0)
+        size = (stat(imagePath, &st) == 0) ? (size_t) st.st_size : DEFAULT_SIZE;
+
+    struct nvmFileDevice image =
+    {
+        .ops  = &posix_file_ops,
+        .info = &posix_file_info,
+        .size = size,
+        .fd   = -1
+    };
+
+    FILE *in = fopen(backupPath, "rb");
+    if(in == NULL)
+    {
+        perror(backupPath);
+        return -1;
+    }
+
+    int ret = posixFile_init(&image, imagePath);
+    if(ret == 0)
+        ret = flashBackup_startImport(&ctx, (struct nvmDevice *) &image);
+
+    while(ret == 0)
+    {
+        uint8_t buf[1024];
+        size_t len = fread(buf, 1, sizeof(buf), in);
+        if(len == 0)
+        {
+            ret = -EIO;
+            break;
+        }
+
+        ret = flashBackup_write(&ctx, buf, len);
+    }
+
+    fclose(in);
+    posixFile_terminate(&image);
+
+    if(ret < 0)
+    {
+        fprintf(stderr, "Restore failed: %s\n", strerror(-ret));
+        return -1;
+    }
+
+    printStats("Restore");
+
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    if((argc >= 4) && (strcmp(argv[1], "dump") == 0))
+    {
+        uint32_t first = (argc > 4) ? strtoul(argv[4], NULL, 0) : 0;
+        return dump(argv[2], argv[3], first);
+    }
+
+    if((argc >= 4) && (strcmp(argv[1], "restore") == 0))
+    {
+        size_t size = (argc > 4) ? strtoul(argv[4], NULL, 0) : 0;
+        return restore(argv[2], argv[3], size);
+    }
+
+    fprintf(stderr, "Usage:\n"
+                    "  %s dump <image> <backup> [first sector]\n"
+                    "  %s restore <backup> <image> [image size]\n",
+                    argv[0], argv[0]);
+
+    return -1;
+}
@@ -18,15 +18,202 @@
  *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
  ***************************************************************************/
 
-#include <interfaces/graphics.h>
+/*
+ * Benchmark of the graphics primitives and of the display rendering.
+ *
+ * The primitives benchmark only draws into the framebuffer, thus it can be run
+ * also on the Linux host, both for the RGB565 and the 1bpp pixel formats, by
+ * building this test with the 'linux' and 'linux_small' targets.
+ * On MDx targets, the time taken by gfx_render() is measured as well.
+ */
+
 #include <interfaces/platform.h>
 #include <interfaces/keyboard.h>
+#include <interfaces/delays.h>
+#include <graphics.h>
 #include <hwconfig.h>
 #include <stdint.h>
 #include <stdio.h>
+#ifndef PLATFORM_LINUX
 #include <os.h>
+#endif
+
+#define BENCH_TIME_MS 1000
+
+typedef void (*primitive_t)(uint32_t i);
+
+static const color_t color_red   = {255,   0,   0, 255};
+static const color_t color_white = {255, 255, 255, 255};
+
+static void fillScreen(uint32_t i)
+{
+    gfx_fillScreen((i & 1) ? color_red : color_white);
+}
+
+static void fillRect(uint32_t i)
+{
+    point_t origin = {(int16_t) (i % 32), (int16_t) (i % 64)};
+    gfx_drawRect(origin, CONFIG_SCREEN_WIDTH / 2, CONFIG_SCREEN_HEIGHT / 2,
+                 color_red, true);
+}
+
+static void outlineRect(uint32_t i)
+{
+    point_t origin = {(int16_t) (i % 32), (int16_t) (i % 64)};
+    gfx_drawRect(origin, CONFIG_SCREEN_WIDTH / 2, CONFIG_SCREEN_HEIGHT / 2,
+                 color_white, false);
+}
+
+static void hLine(uint32_t i)
+{
+    gfx_drawHLine(i % CONFIG_SCREEN_HEIGHT, 1, color_white);
+}
+
+static void vLine(uint32_t i)
+{
+    gfx_drawVLine(i % CONFIG_SCREEN_WIDTH, 1, color_white);
+}
+
+static void diagLine(uint32_t i)
+{
+    point_t start = {0, (int16_t) (i % CONFIG_SCREEN_HEIGHT)};
+    point_t end   = {CONFIG_SCREEN_WIDTH - 1,
+                     (int16_t) (CONFIG_SCREEN_HEIGHT - 1 - (i % CONFIG_SCREEN_HEIGHT))};
+    gfx_drawLine(start, end, color_white);
+}
+
+static void circle(uint32_t i)
+{
+    point_t center = {CONFIG_SCREEN_WIDTH / 2, CONFIG_SCREEN_HEIGHT / 2};
+    gfx_drawCircle(center, 10 + (i % (CONFIG_SCREEN_HEIGHT / 4)), color_white);
+}
+
+static void text(uint32_t i)
+{
+    point_t origin = {0, (int16_t) (20 + (i % 32))};
+    gfx_print(origin, FONT_SIZE_8PT, TEXT_ALIGN_CENTER, color_white, "KEK %u",
+              i % 100);
+}
+
+/*
+ * Approximation of the main VFO screen of the default UI: top bar with clock
+ * and battery, channel and mode information, frequency in large font and
+ * S-meter.
+ */
+#if CONFIG_SCREEN_HEIGHT >= 128
+#define VFO_SMALL_FONT FONT_SIZE_8PT
+#define VFO_LARGE_FONT FONT_SIZE_16PT
+#else
+#define VFO_SMALL_FONT FONT_SIZE_6PT
+#define VFO_LARGE_FONT FONT_SIZE_10PT
+#endif
+
+static void vfoScreen(uint32_t i)
+{
+    static const color_t color_grey = {60, 60, 60, 255};
+    static const color_t color_yellow = {250, 180, 19, 255};
+    const int16_t line = CONFIG_SCREEN_HEIGHT / 8;
+
+    gfx_clearScreen();
+    gfx_drawHLine(line, 1, color_grey);
+    gfx_drawHLine(CONFIG_SCREEN_HEIGHT - line - 1, 1, color_grey);
+
+    point_t pos = {0, line - 3};
+    gfx_print(pos, VFO_SMALL_FONT, TEXT_ALIGN_CENTER, color_red,
+              "%02lu:%02lu:%02lu", (unsigned long) (i / 3600) % 24,
+              (unsigned long) (i / 60) % 60, (unsigned long) i % 60);
 
-uint64_t benchmark(uint32_t n);
+    point_t bat = {CONFIG_SCREEN_WIDTH - 20, 3};
+    gfx_drawBattery(bat, 18, line - 6, 80);
+
+    pos.y = 2 * line + 4;
+    gfx_print(pos, VFO_SMALL_FONT, TEXT_ALIGN_CENTER, color_white,
+              "0-001: Repeater");
+
+    pos.y = 3 * line + 6;
+    gfx_print(pos, VFO_SMALL_FONT, TEXT_ALIGN_CENTER, color_white,
+              "Tone 88.5 DCS 023");
+
+    pos.y = 5 * line + 6;
+    gfx_print(pos, VFO_LARGE_FONT, TEXT_ALIGN_CENTER, color_white,
+              "433.%03lu", (unsigned long) i % 1000);
+
+    point_t meter = {4, CONFIG_SCREEN_HEIGHT - line + 1};
+    gfx_drawSmeter(meter, CONFIG_SCREEN_WIDTH - 8, line - 2, -127 + (i % 80),
+                   4, 8, true, color_yellow);
+}
+
+static const struct
+{
+    const char  *name;
+    primitive_t  func;
+}
+primitives[] =
+{
+    {"fillScreen",     fillScreen},
+    {"drawRect fill",  fillRect},
+    {"drawRect",       outlineRect},
+    {"drawHLine",      hLine},
+    {"drawVLine",      vLine},
+    {"drawLine",       diagLine},
+    {"drawCircle",     circle},
+    {"print",          text},
+    {"VFO screen",     vfoScreen}
+};
+
+/**
+ * Run a primitive for BENCH_TIME_MS milliseconds and return the number of
+ * calls per second.
+ */
+static uint32_t benchPrimitive(primitive_t func)
+{
+    uint32_t  count = 0;
+    long long start = getTick();
+    long long now   = start;
+
+    while((now - start) < BENCH_TIME_MS)
+    {
+        // Check the time only every few calls, to reduce the overhead
+        for(uint32_t i = 0; i < 16; i++)
+        {
+            func(count);
+            count++;
+        }
+
+        now = getTick();
+    }
+
+    return (uint32_t) ((count * 1000LL) / (now - start));
+}
+
+static void benchPrimitives()
+{
+    #ifdef CONFIG_PIX_FMT_RGB565
+    printf("Graphics primitives, RGB565 %dx%d:\r\n", CONFIG_SCREEN_WIDTH,
+           CONFIG_SCREEN_HEIGHT);
+    #else
+    printf("Graphics primitives, 1bpp %dx%d:\r\n", CONFIG_SCREEN_WIDTH,
+           CONFIG_SCREEN_HEIGHT);
+    #endif
+
+    for(size_t i = 0; i < sizeof(primitives)/sizeof(primitives[0]); i++)
+    {
+        uint32_t rate = benchPrimitive(primitives[i].func);
+        printf("- %-14s %8lu/s\r\n", primitives[i].name, (unsigned long) rate);
+    }
+}
+
+#ifdef PLATFORM_LINUX
+
+int main()
+{
+    benchPrimitives();
+    return 0;
+}
+
+#else
+
+uint64_t benchRender(uint32_t n);
 
 int main()
 {
@@ -58,16 +245,18 @@ int main()
     {
         getchar();
 
-        uint64_t tot_ticks = benchmark(numIterations);
+        benchPrimitives();
+
+        uint64_t tot_ticks = benchRender(numIterations);
 
         float totalTime_s = ((float)(tot_ticks * clkDivider))/168000000.0f;
-        printf("Average values over %ld iterations:\r\n", numIterations);
+        printf("gfx_render(), average values over %ld iterations:\r\n",
+               numIterations);
         printf("- %lld ticks\r\n- %f ms\r\n", tot_ticks, totalTime_s*1000.0f);
-
     }
 }
 
-uint64_t benchmark(uint32_t n)
+uint64_t benchRender(uint32_t n)
 {
     uint64_t totalTime = 0;
     uint32_t dummy = 0;
@@ -76,11 +265,8 @@ uint64_t benchmark(uint32_t n)
     {
         gfx_clearScreen();
         point_t origin = {0, i % 128};
-        color_t color_red = {255, 0, 0, 255};
-        color_t color_white = {255, 255, 255, 255};
         gfx_drawRect(origin, 160, 20, color_red, 1);
-        gfx_print(origin, buffer, FONT_SIZE_24PT, TEXT_ALIGN_LEFT,
-                  color_white, "KEK");
+        gfx_print(origin, FONT_SIZE_16PT, TEXT_ALIGN_LEFT, color_white, "KEK");
 
         dummy += kbd_getKeys();
 
@@ -92,3 +278,5 @@ uint64_t benchmark(uint32_t n)
 
     return totalTime/n;
 }
+
+#endif
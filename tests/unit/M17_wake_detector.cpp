@@ -0,0 +1,208 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/*
+ * M17 wake-up test: M17 transmissions are synthesized passing a 4FSK
+ * modulated carrier plus gaussian noise through an FM discriminator, at
+ * different carrier to noise ratios, and the receiver duty cycle configured
+ * for OpMode_M17 is simulated over them. The test reports the wake latency
+ * from the beginning of the transmission, the number of missed preambles,
+ * the false wake-ups on noise and on symbol data and the duty-cycled RX
+ * current, as a fraction of the current drawn with the receiver always on.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <complex>
+#include <random>
+#include <vector>
+#include <M17/M17WakeDetector.hpp>
+#include <M17/M17DSP.hpp>
+#include <OpMode_M17.hpp>
+
+using namespace std;
+using namespace M17;
+
+static constexpr size_t SAMPLE_RATE  = M17WakeDetector::SAMPLE_RATE;
+static constexpr size_t SAMPLES_SYM  = SAMPLE_RATE / M17_SYMBOL_RATE;
+static constexpr size_t SAMPLES_MS   = SAMPLE_RATE / 1000;
+static constexpr size_t PERIOD       = CONFIG_M17_WAKE_PERIOD * SAMPLES_MS;
+static constexpr size_t WINDOW       = CONFIG_M17_WAKE_WINDOW * SAMPLES_MS;
+static constexpr size_t SETTLE       = 5 * SAMPLES_MS;    // RADIO_SETTLE_MS
+static constexpr size_t PREAMBLE_SYM = 192;
+static constexpr size_t DATA_SYM     = 960;
+static constexpr float  NO_CARRIER   = -100.0f;
+
+static M17WakeDetector            detector;
+static mt19937                    rng(1);
+static normal_distribution<float> gauss(0.0f, 1.0f);
+static complex<float>             prevSample(1.0f, 0.0f);
+static float                      phase = 0.0f;
+
+/**
+ * Append a block of discriminator output to a baseband buffer.
+ *
+ * @param bb: baseband buffer.
+ * @param symbols: 4FSK symbols to transmit, empty for noise only.
+ * @param len: number of samples, when transmitting noise only.
+ * @param cnr: carrier to noise ratio over the sampling bandwidth, in dB.
+ */
+static void modulate(vector< int16_t >& bb, const vector< int8_t >& symbols,
+                     size_t len, const float cnr)
+{
+    const float fs  = SAMPLE_RATE;
+    const float amp = (cnr > NO_CARRIER) ? sqrt(pow(10.0f, cnr / 10.0f)) : 0.0f;
+
+    if(symbols.empty() == false)
+        len = symbols.size() * SAMPLES_SYM;
+
+    for(size_t i = 0; i < len; i++)
+    {
+        // Zero-stuffed symbols through the RRC filter, 2.4kHz outer deviation
+        float dev = 0.0f;
+        if((symbols.empty() == false) && ((i % SAMPLES_SYM) == 0))
+            dev = symbols[i / SAMPLES_SYM];
+
+        dev    = rrc_24k(dev) * 2840.0f;
+        phase += 2.0f * M_PI * dev / fs;
+
+        complex<float> noise(gauss(rng), gauss(rng));
+        complex<float> sample = amp * polar(1.0f, phase) + noise * 0.7071f;
+
+        float freq = arg(sample * conj(prevSample)) * fs / (2.0f * M_PI);
+        prevSample = sample;
+
+        bb.push_back(static_cast< int16_t >(freq));
+    }
+}
+
+/**
+ * Run the detector on a window of samples, as done by OpMode_M17 at each
+ * wake-up.
+ */
+static bool scan(const vector< int16_t >& bb, const size_t start)
+{
+    return detector.process(bb.data() + start, WINDOW);
+}
+
+int main()
+{
+    // Weakest carrier to noise ratio at which no preamble can be missed, when
+    // the scan windows are close enough to always hit the preamble
+    static constexpr float MIN_CNR = 10.0f;
+    static constexpr bool  NO_MISS = (CONFIG_M17_WAKE_PERIOD +
+                                      CONFIG_M17_WAKE_WINDOW) <= 40;
+    static constexpr size_t TRIALS = 100;
+
+    uniform_int_distribution< int >    symbol(0, 3);
+    uniform_int_distribution< size_t > offset(0, PERIOD - 1);
+    const int8_t levels[] = {-3, -1, +1, +3};
+
+    // False wake-ups on noise only
+    vector< int16_t > noise;
+    modulate(noise, {}, 20000 * WINDOW, NO_CARRIER);
+
+    size_t noiseWakes = 0;
+    for(size_t i = 0; i + WINDOW <= noise.size(); i += WINDOW)
+    {
+        if(scan(noise, i)) noiseWakes += 1;
+    }
+
+    printf("Duty cycle: %u ms period, %u ms window, %u ms settling\n",
+           CONFIG_M17_WAKE_PERIOD, CONFIG_M17_WAKE_WINDOW, 5);
+    printf("Duty-cycled RX current: %.1f%% of continuous RX\n",
+           (100.0f * (SETTLE + WINDOW)) / PERIOD);
+    printf("Noise: %u false wake-ups in %u scans\n",
+           static_cast< unsigned >(noiseWakes),
+           static_cast< unsigned >(noise.size() / WINDOW));
+
+    if(noiseWakes != 0)
+        return -1;
+
+    for(float cnr : {0.0f, 3.0f, 6.0f, 10.0f, 20.0f})
+    {
+        size_t missed    = 0;
+        size_t dataWakes = 0;
+        size_t maxLat    = 0;
+        size_t sumLat    = 0;
+
+        for(size_t t = 0; t < TRIALS; t++)
+        {
+            vector< int8_t > preamble(PREAMBLE_SYM);
+            for(size_t i = 0; i < PREAMBLE_SYM; i++)
+                preamble[i] = ((i % 2) == 0) ? +3 : -3;
+
+            vector< int8_t > data(DATA_SYM);
+            for(auto& sym : data)
+                sym = levels[symbol(rng)];
+
+            // Transmission starts at a random point of the scan period
+            vector< int16_t > bb;
+            const size_t txStart = PERIOD + offset(rng);
+            modulate(bb, {}, txStart, NO_CARRIER);
+            modulate(bb, preamble, 0, cnr);
+            const size_t dataStart = bb.size();
+            modulate(bb, data, 0, cnr);
+
+            bool woken = false;
+            for(size_t wake = 0; wake + SETTLE + WINDOW <= bb.size(); wake += PERIOD)
+            {
+                const size_t start = wake + SETTLE;
+                if(scan(bb, start) == false)
+                    continue;
+
+                // Windows starting inside the symbol data
+                if(start >= dataStart)
+                {
+                    dataWakes += 1;
+                    continue;
+                }
+
+                if(woken == false)
+                {
+                    size_t latency = (start + WINDOW - txStart) / SAMPLES_MS;
+                    sumLat += latency;
+                    if(latency > maxLat) maxLat = latency;
+                    woken = true;
+                }
+            }
+
+            if(woken == false)
+                missed += 1;
+        }
+
+        size_t detected = TRIALS - missed;
+        printf("CNR %4.1fdB: %3u/%u preambles detected, latency avg %u ms max "
+               "%u ms, %u wake-ups on data\n", cnr,
+               static_cast< unsigned >(detected), static_cast< unsigned >(TRIALS),
+               static_cast< unsigned >((detected > 0) ? (sumLat / detected) : 0),
+               static_cast< unsigned >(maxLat), static_cast< unsigned >(dataWakes));
+
+        if(dataWakes != 0)
+            return -1;
+
+        if(NO_MISS && (cnr >= MIN_CNR) && (missed != 0))
+            return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,245 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <interfaces/cps_io.h>
+#include <strings.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+#define CPS_PATH     "/tmp/test_chidx.rtxc"
+#define NUM_CHANNELS 20000
+#define NUM_LOOKUPS  100000
+#define NUM_SCANS    20
+
+static const char *prefixes[] = {"Rpt", "Simplex", "APRS", "Marine", "Zz"};
+
+static void makeChannel(channel_t *ch, uint32_t n)
+{
+    memset(ch, 0x00, sizeof(channel_t));
+
+    // Mix the names so that the channel list is not already sorted
+    uint32_t v = (n * 2654435761u) >> 8;
+    snprintf(ch->name, sizeof(ch->name), "%s %05u", prefixes[n % 4],
+             (unsigned) (v % 100000));
+    ch->mode         = OPMODE_FM;
+    ch->rx_frequency = 144000000 + ((v % 40000) * 12500);
+    ch->tx_frequency = ch->rx_frequency;
+}
+
+static int scanName(const char *prefix)
+{
+    size_t    len  = strlen(prefix);
+    int       best = -1;
+    channel_t ch;
+    char      bestName[CPS_STR_SIZE];
+
+    for(int pos = 0; cps_readChannel(&ch, pos) == 0; pos++)
+    {
+        if(strncasecmp(ch.name, prefix, len) != 0)
+            continue;
+
+        if((best < 0) || (strncasecmp(ch.name, bestName, CPS_STR_SIZE) < 0))
+        {
+            best = pos;
+            memcpy(bestName, ch.name, CPS_STR_SIZE);
+        }
+    }
+
+    return best;
+}
+
+static freq_t scanFreqDist(freq_t freq)
+{
+    freq_t    best = UINT32_MAX;
+    channel_t ch;
+
+    for(int pos = 0; cps_readChannel(&ch, pos) == 0; pos++)
+    {
+        freq_t d = (ch.rx_frequency > freq) ? (ch.rx_frequency - freq)
+                                            : (freq - ch.rx_frequency);
+        if(d < best)
+            best = d;
+    }
+
+    return best;
+}
+
+static freq_t freqDist(int pos, freq_t freq)
+{
+    channel_t ch;
+    cps_readChannel(&ch, pos);
+
+    return (ch.rx_frequency > freq) ? (ch.rx_frequency - freq)
+                                    : (freq - ch.rx_frequency);
+}
+
+static int checkConsistency(const char *step)
+{
+    const char *names[] = {"rpt 1", "Simplex 9", "marine", "APRS 000", "Zz",
+                           "Test", "Rpt 4", ""};
+
+    for(size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+    {
+        int idx  = cps_findChannelByName(names[i]);
+        int scan = scanName(names[i]);
+        if(idx != scan)
+        {
+            printf("Error (%s): prefix \"%s\" found at %d, expected %d\n",
+                   step, names[i], idx, scan);
+            return -1;
+        }
+    }
+
+    for(freq_t f = 143000000; f < 146000000; f += 123457)
+    {
+        int idx = cps_findChannelByFreq(f);
+        if((idx < 0) || (freqDist(idx, f) != scanFreqDist(f)))
+        {
+            printf("Error (%s): wrong nearest channel for %u Hz\n", step,
+                   (unsigned) f);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int main()
+{
+    remove(CPS_PATH);
+    remove(CPS_PATH ".idx");
+    cps_create(CPS_PATH);
+    if(cps_open(CPS_PATH))
+        return -1;
+
+    if((cps_findChannelByName("") != -1) || (cps_findChannelByFreq(0) != -1))
+    {
+        printf("Error: channel found in an empty codeplug\n");
+        return -1;
+    }
+
+    channel_t ch;
+    cps_beginBatch();
+    for(uint32_t i = 0; i < NUM_CHANNELS; i++)
+    {
+        makeChannel(&ch, i);
+        cps_insertChannel(ch, i);
+    }
+    cps_commitBatch();
+
+    // First search after the import rebuilds the index
+    clock_t start = clock();
+    cps_findChannelByName("Rpt");
+    double buildTime = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    if(checkConsistency("import"))
+        return -1;
+
+    // Lookup cost against a linear scan
+    volatile int sink = 0;
+    start = clock();
+    for(uint32_t i = 0; i < NUM_LOOKUPS; i++)
+    {
+        sink += cps_findChannelByName(prefixes[i % 5]);
+        sink += cps_findChannelByFreq(144000000 + (i * 7919) % 500000000);
+    }
+    double lookupTime = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for(uint32_t i = 0; i < NUM_SCANS; i++)
+    {
+        sink += scanName(prefixes[i % 5]);
+        sink += scanFreqDist(144000000 + (i * 7919) % 500000000);
+    }
+    double scanTime = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    printf("Index of %d channels built in %.3f s\n", NUM_CHANNELS, buildTime);
+    printf("Lookup: %.2f us indexed, %.1f us linear scan\n",
+           (lookupTime * 1e6) / (2 * NUM_LOOKUPS),
+           (scanTime * 1e6) / (2 * NUM_SCANS));
+
+    // Incremental updates
+    makeChannel(&ch, NUM_CHANNELS + 1);
+    strcpy(ch.name, "AAA first");
+    ch.rx_frequency = 100000000;
+    cps_insertChannel(ch, 5);
+    if((cps_findChannelByName("aaa") != 5) ||
+       (cps_findChannelByFreq(90000000) != 5))
+    {
+        printf("Error: inserted channel not found\n");
+        return -1;
+    }
+
+    if(checkConsistency("insert"))
+        return -1;
+
+    strcpy(ch.name, "Test renamed");
+    ch.rx_frequency = 900000000;
+    cps_writeChannel(ch, 5);
+    if((cps_findChannelByName("aaa") != -1) ||
+       (cps_findChannelByName("test") != 5) ||
+       (cps_findChannelByFreq(950000000) != 5))
+    {
+        printf("Error: rewritten channel not updated\n");
+        return -1;
+    }
+
+    if(checkConsistency("write"))
+        return -1;
+
+    cps_deleteChannel(ch, 5);
+    cps_deleteChannel(ch, 100);
+    if(cps_findChannelByName("test") != -1)
+    {
+        printf("Error: deleted channel still found\n");
+        return -1;
+    }
+
+    if(checkConsistency("delete"))
+        return -1;
+
+    cps_close();
+
+    // Reopening loads the index saved on close, no rebuild needed
+    start = clock();
+    cps_open(CPS_PATH);
+    int pos = cps_findChannelByName("Simplex");
+    double loadTime = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    if(pos != scanName("Simplex"))
+    {
+        printf("Error: wrong result from the persisted index\n");
+        return -1;
+    }
+
+    printf("Reopen and first search: %.3f s (rebuild %.3f s)\n", loadTime,
+           buildTime);
+
+    if(checkConsistency("reopen"))
+        return -1;
+
+    cps_close();
+    remove(CPS_PATH);
+    remove(CPS_PATH ".idx");
+
+    return 0;
+}
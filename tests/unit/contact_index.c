@@ -0,0 +1,202 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <interfaces/cps_io.h>
+#include <contact_index.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+#define NUM_CONTACTS 50000
+#define NUM_LOOKUPS  1000000
+#define NUM_SCANS    100
+
+static void makeAddress(uint8_t *addr, uint32_t n)
+{
+    // Spread the values a bit, real addresses are not sequential
+    uint64_t v = ((uint64_t) n * 2654435761u) + 12345;
+    for(int i = 5; i >= 0; i--)
+    {
+        addr[i] = v & 0xFF;
+        v >>= 8;
+    }
+}
+
+static void makeContact(contact_t *ct, uint32_t n)
+{
+    memset(ct, 0x00, sizeof(contact_t));
+    snprintf(ct->name, sizeof(ct->name), "Contact %u", (unsigned) n);
+    ct->mode = OPMODE_M17;
+    makeAddress(ct->info.m17.address, n);
+}
+
+static int linearScan(const uint8_t *addr)
+{
+    contact_t ct;
+    for(int pos = 0; cps_readContact(&ct, pos) == 0; pos++)
+    {
+        if((ct.mode == OPMODE_M17) &&
+           (memcmp(ct.info.m17.address, addr, 6) == 0))
+            return pos;
+    }
+
+    return -1;
+}
+
+int main()
+{
+    cps_create("/tmp/test_cidx.rtxc");
+    if(cps_open("/tmp/test_cidx.rtxc"))
+        return -1;
+
+    // Contact 0 is a DMR one, it must not be indexed
+    contact_t ct;
+    memset(&ct, 0x00, sizeof(contact_t));
+    ct.mode = OPMODE_DMR;
+
+    cps_beginBatch();
+    cps_insertContact(ct, 0);
+    for(uint32_t i = 0; i < NUM_CONTACTS; i++)
+    {
+        makeContact(&ct, i);
+        cps_insertContact(ct, i + 1);
+    }
+    cps_commitBatch();
+
+    clock_t start = clock();
+    if(contactIndex_build())
+    {
+        printf("Error: index build failed\n");
+        return -1;
+    }
+
+    double buildTime = (double)(clock() - start) / CLOCKS_PER_SEC;
+    printf("Index of %d contacts built in %.3f s, %zu bytes\n",
+           NUM_CONTACTS, buildTime, contactIndex_size());
+
+    // Lookup all the contacts
+    uint8_t addr[6];
+    for(uint32_t i = 0; i < NUM_CONTACTS; i++)
+    {
+        makeAddress(addr, i);
+        if(contactIndex_lookupM17(addr) != (int)(i + 1))
+        {
+            printf("Error: wrong lookup result for contact %u\n", (unsigned) i);
+            return -1;
+        }
+    }
+
+    makeAddress(addr, NUM_CONTACTS + 1);
+    if(contactIndex_lookupM17(addr) != -1)
+    {
+        printf("Error: unknown address found\n");
+        return -1;
+    }
+
+    // Lookup cost, hits and misses
+    volatile unsigned sink = 0;
+    start = clock();
+    for(uint32_t i = 0; i < NUM_LOOKUPS; i++)
+    {
+        makeAddress(addr, (i * 7919) % (2 * NUM_CONTACTS));
+        sink += contactIndex_lookupM17(addr);
+    }
+
+    double lookupTime = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for(uint32_t i = 0; i < NUM_SCANS; i++)
+    {
+        makeAddress(addr, (i * 7919) % (2 * NUM_CONTACTS));
+        sink += linearScan(addr);
+    }
+
+    double scanTime = (double)(clock() - start) / CLOCKS_PER_SEC;
+    printf("Lookup: %.1f ns indexed, %.1f us linear scan\n",
+           (lookupTime * 1e9) / NUM_LOOKUPS, (scanTime * 1e6) / NUM_SCANS);
+
+    // Insertion and removal shift the positions of the following contacts
+    makeContact(&ct, NUM_CONTACTS + 1);
+    cps_insertContact(ct, 1);
+    makeAddress(addr, NUM_CONTACTS + 1);
+    if(contactIndex_lookupM17(addr) != 1)
+    {
+        printf("Error: inserted contact not found\n");
+        return -1;
+    }
+
+    makeAddress(addr, 0);
+    if(contactIndex_lookupM17(addr) != 2)
+    {
+        printf("Error: contact not renumbered after insertion\n");
+        return -1;
+    }
+
+    cps_deleteContact(1);
+    makeAddress(addr, NUM_CONTACTS + 1);
+    if(contactIndex_lookupM17(addr) != -1)
+    {
+        printf("Error: deleted contact still found\n");
+        return -1;
+    }
+
+    for(uint32_t i = 0; i < NUM_CONTACTS; i += 97)
+    {
+        makeAddress(addr, i);
+        if(contactIndex_lookupM17(addr) != linearScan(addr))
+        {
+            printf("Error: index out of sync after removal\n");
+            return -1;
+        }
+    }
+
+    // Overwriting a contact moves its entry to the new address
+    makeContact(&ct, NUM_CONTACTS + 2);
+    cps_writeContact(ct, 1);
+    makeAddress(addr, 0);
+    if(contactIndex_lookupM17(addr) != -1)
+    {
+        printf("Error: overwritten contact still found\n");
+        return -1;
+    }
+
+    makeAddress(addr, NUM_CONTACTS + 2);
+    if(contactIndex_lookupM17(addr) != 1)
+    {
+        printf("Error: overwritten contact not found\n");
+        return -1;
+    }
+
+    // Removing a contact must not hide another one with the same address
+    makeContact(&ct, NUM_CONTACTS + 2);
+    cps_writeContact(ct, 2);
+    cps_deleteContact(1);
+    if(contactIndex_lookupM17(addr) != 1)
+    {
+        printf("Error: duplicate address lost after removal\n");
+        return -1;
+    }
+
+    cps_close();
+    contactIndex_clear();
+
+    return 0;
+}
@@ -1,6 +1,14 @@
 #include <interfaces/cps_io.h>
 #include <string.h>
 #include <stdio.h>
+#include <time.h>
+
+#define SCROLL_CHANNELS 1000
+#define SCROLL_ROWS     6
+#define IMPORT_CHANNELS 2000
+#define IMPORT_CONTACTS 10000
+#define BENCH_READS     200000
+#define BENCH_WRITES    20000
 
 int test_initCPS() {
     // Initialize a new cps
@@ -152,6 +160,260 @@ int test_createOOOCPS() {
     return 0;
 }
 
+int test_readComplexCPS(char *name) {
+    if (cps_open(name))
+        return -1;
+    bankHdr_t b = { 0 };
+    if (cps_readBankHeader(&b, 0) || strncmp(b.name, "Test Bank 1", 32L) ||
+        b.ch_count != 2)
+        return -1;
+    if (cps_readBankHeader(&b, 1) || strncmp(b.name, "Test Bank 2", 32L) ||
+        b.ch_count != 3)
+        return -1;
+    for(int i = 0; i < 5; i++)
+    {
+        int bank = (i < 2) ? 0 : 1;
+        int pos  = (i < 2) ? i : i - 2;
+        if (cps_readBankData(bank, pos) != i)
+            return -1;
+    }
+    if (cps_readBankData(0, 2) != -1)
+        return -1;
+    channel_t c = { 0 };
+    cps_readChannel(&c, 4);
+    if(strncmp("Test channel 5", c.name, 32L))
+        return -1;
+    cps_close();
+    return 0;
+}
+
+int test_menuScroll() {
+    cps_create("/tmp/test7.rtxc");
+
+    cps_open("/tmp/test7.rtxc");
+    channel_t ch = { 0 };
+    for(int i = 0; i < SCROLL_CHANNELS; i++)
+    {
+        snprintf(ch.name, sizeof(ch.name), "Channel %d", i);
+        cps_insertChannel(ch, i);
+    }
+
+    // Scroll the whole channel list down and back up, reading all the rows
+    // visible on screen at each step as the channel menu does.
+    clock_t start = clock();
+    long reads = 0;
+    for(int pass = 0; pass < 10; pass++)
+    {
+        for(int step = 0; step < 2 * SCROLL_CHANNELS; step++)
+        {
+            int sel = (step < SCROLL_CHANNELS) ? step
+                                               : 2 * SCROLL_CHANNELS - step - 1;
+            for(int row = 0; row < SCROLL_ROWS; row++)
+            {
+                char name[32];
+                int  pos = sel + row;
+                if (cps_readChannel(&ch, pos) < 0)
+                    break;
+                snprintf(name, sizeof(name), "Channel %d", pos);
+                if (strncmp(name, ch.name, 32L))
+                    return -1;
+                reads++;
+            }
+        }
+    }
+    double elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+    printf("Menu scroll: %ld channel reads in %.3f s (%.2f us/read)\n",
+           reads, elapsed, (elapsed * 1e6) / reads);
+
+    // Cached records must follow writes and insertions
+    cps_readChannel(&ch, 10);
+    strncpy(ch.name, "Renamed", sizeof(ch.name));
+    cps_writeChannel(ch, 10);
+    cps_readChannel(&ch, 10);
+    if (strncmp("Renamed", ch.name, 32L))
+        return -1;
+    strncpy(ch.name, "First", sizeof(ch.name));
+    cps_insertChannel(ch, 0);
+    cps_readChannel(&ch, 11);
+    if (strncmp("Renamed", ch.name, 32L))
+        return -1;
+    cps_readChannel(&ch, 0);
+    if (strncmp("First", ch.name, 32L))
+        return -1;
+    if (cps_readChannel(&ch, SCROLL_CHANNELS + 1) != -1)
+        return -1;
+    cps_close();
+    return 0;
+}
+
+int test_batchComplexCPS() {
+    cps_create("/tmp/test8.rtxc");
+
+    cps_open("/tmp/test8.rtxc");
+    contact_t ct1 = { "Test contact 1", 0, {{0}} };
+    contact_t ct2 = { "Test contact 2", 0, {{0}} };
+    channel_t ch1 = { 2, 0, 0, 0, 0, 0, 0, 0, 0, "Test channel 1", "", {0}, {{0}} };
+    channel_t ch2 = { 2, 0, 0, 0, 0, 0, 0, 0, 0, "Test channel 2", "", {0}, {{0}} };
+    channel_t ch3 = { 2, 0, 0, 0, 0, 0, 0, 0, 0, "Test channel 3", "", {0}, {{0}} };
+    channel_t ch4 = { 2, 0, 0, 0, 0, 0, 0, 0, 0, "Test channel 4", "", {0}, {{0}} };
+    channel_t ch5 = { 2, 0, 0, 0, 0, 0, 0, 0, 0, "Test channel 5", "", {0}, {{0}} };
+    bankHdr_t b1 = { "Test Bank 1", 0 };
+    bankHdr_t b2 = { "Test Bank 2", 0 };
+    if (cps_beginBatch())
+        return -1;
+    // Nested batches are not allowed
+    if (cps_beginBatch() != -1)
+        return -1;
+    cps_insertBankHeader(b1, 0);
+    cps_insertBankHeader(b2, 1);
+    cps_insertChannel(ch5, 0);
+    cps_insertBankData(0, 1, 0);
+    cps_insertChannel(ch4, 0);
+    cps_insertBankData(0, 1, 0);
+    cps_insertChannel(ch3, 0);
+    cps_insertBankData(0, 1, 0);
+    cps_insertChannel(ch2, 0);
+    cps_insertBankData(0, 0, 0);
+    cps_insertChannel(ch1, 0);
+    cps_insertBankData(0, 0, 0);
+    cps_insertContact(ct2, 0);
+    cps_insertContact(ct1, 0);
+    if (cps_commitBatch())
+        return -1;
+    cps_close();
+    if (test_readComplexCPS("/tmp/test8.rtxc"))
+        return -1;
+
+    // Aborted edits must not reach the file
+    cps_open("/tmp/test8.rtxc");
+    cps_beginBatch();
+    cps_deleteBankHeader(0);
+    cps_abortBatch();
+    cps_close();
+    if (test_readComplexCPS("/tmp/test8.rtxc"))
+        return -1;
+
+    // Deleting a channel drops it from the banks and renumbers the others
+    cps_open("/tmp/test8.rtxc");
+    if (cps_deleteChannel(ch1, 0))
+        return -1;
+    channel_t c = { 0 };
+    cps_readChannel(&c, 0);
+    if (strncmp("Test channel 2", c.name, 32L))
+        return -1;
+    bankHdr_t b = { 0 };
+    cps_readBankHeader(&b, 0);
+    if ((b.ch_count != 1) || (cps_readBankData(0, 0) != 0))
+        return -1;
+    if (cps_readBankData(1, 0) != 1 || cps_readBankData(1, 2) != 3)
+        return -1;
+    cps_close();
+    return 0;
+}
+
+int test_batchImport() {
+    cps_create("/tmp/test9.rtxc");
+
+    cps_open("/tmp/test9.rtxc");
+    clock_t start = clock();
+    if (cps_beginBatch())
+        return -1;
+    contact_t ct = { 0 };
+    for(int i = 0; i < IMPORT_CONTACTS; i++)
+    {
+        snprintf(ct.name, sizeof(ct.name), "Contact %d", i);
+        if (cps_insertContact(ct, i))
+            return -1;
+    }
+    channel_t ch = { 0 };
+    ch.mode = OPMODE_M17;
+    for(int i = 0; i < IMPORT_CHANNELS; i++)
+    {
+        snprintf(ch.name, sizeof(ch.name), "Channel %d", i);
+        ch.m17.contact_index = i;
+        if (cps_insertChannel(ch, i))
+            return -1;
+    }
+    // A contact inserted in front shifts all the channel references
+    strncpy(ct.name, "First", sizeof(ct.name));
+    cps_insertContact(ct, 0);
+    if (cps_commitBatch())
+        return -1;
+    double elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+    printf("Batch import: %d channels, %d contacts in %.3f s\n",
+           IMPORT_CHANNELS, IMPORT_CONTACTS + 1, elapsed);
+
+    for(int i = 0; i < IMPORT_CHANNELS; i++)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "Channel %d", i);
+        if (cps_readChannel(&ch, i) || strncmp(name, ch.name, 32L))
+            return -1;
+        if (ch.m17.contact_index != i + 1)
+            return -1;
+    }
+    if (cps_readContact(&ct, IMPORT_CONTACTS) ||
+        strncmp("Contact 9999", ct.name, 32L))
+        return -1;
+    cps_close();
+    return 0;
+}
+
+int test_randomAccess() {
+    // Reuse the codeplug built by the batch import test
+    if (cps_open("/tmp/test9.rtxc"))
+        return -1;
+
+    uint32_t seed = 1;
+    channel_t ch = { 0 };
+    clock_t start = clock();
+    for(int i = 0; i < BENCH_READS; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        if (cps_readChannel(&ch, (seed >> 16) % IMPORT_CHANNELS))
+            return -1;
+    }
+    double readTime = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for(int i = 0; i < BENCH_WRITES; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        uint16_t pos = (seed >> 16) % IMPORT_CHANNELS;
+        cps_readChannel(&ch, pos);
+        ch.rx_frequency = i;
+        if (cps_writeChannel(ch, pos))
+            return -1;
+    }
+    double writeTime = (double)(clock() - start) / CLOCKS_PER_SEC;
+    printf("Random access: %.1f ns/read, %.1f ns/write\n",
+           (readTime * 1e9) / BENCH_READS, (writeTime * 1e9) / BENCH_WRITES);
+    cps_close();
+
+    // Written data must survive closing the codeplug
+    cps_open("/tmp/test9.rtxc");
+    seed = 1;
+    for(int i = 0; i < BENCH_READS; i++)
+        seed = seed * 1103515245 + 12345;
+    uint32_t last[IMPORT_CHANNELS] = { 0 };
+    bool     seen[IMPORT_CHANNELS] = { false };
+    for(int i = 0; i < BENCH_WRITES; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        uint16_t pos = (seed >> 16) % IMPORT_CHANNELS;
+        last[pos] = i;
+        seen[pos] = true;
+    }
+    for(int i = 0; i < IMPORT_CHANNELS; i++)
+    {
+        cps_readChannel(&ch, i);
+        if (seen[i] && (ch.rx_frequency != last[i]))
+            return -1;
+    }
+    cps_close();
+    return 0;
+}
+
 int main() {
     if (test_initCPS())
     {
@@ -178,9 +440,34 @@ int main() {
         printf("Error in creation of complex CPS!\n");
         return -1;
     }
+    if (test_readComplexCPS("/tmp/test5.rtxc"))
+    {
+        printf("Error in read back of complex CPS!\n");
+        return -1;
+    }
     if (test_createOOOCPS())
     {
         printf("Error in creation of Out-Of-Order CPS!\n");
         return -1;
     }
+    if (test_menuScroll())
+    {
+        printf("Error in menu scroll over large CPS!\n");
+        return -1;
+    }
+    if (test_batchComplexCPS())
+    {
+        printf("Error in batch creation of complex CPS!\n");
+        return -1;
+    }
+    if (test_batchImport())
+    {
+        printf("Error in batch import!\n");
+        return -1;
+    }
+    if (test_randomAccess())
+    {
+        printf("Error in random access!\n");
+        return -1;
+    }
 }
@@ -0,0 +1,151 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/*
+ * CTCSS decoder test: synthetic baseband signals made of a CTCSS tone, an
+ * in-band voice-like signal and noise are fed to the decoder, checking the
+ * detection time of each tone of the table and the rejection of the adjacent
+ * ones.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <ctcss_decoder.hpp>
+
+static constexpr size_t BLOCK_SIZE = 240;    // 30ms blocks
+static constexpr size_t MAX_DETECT = 150;    // Maximum detection time, in ms
+
+static CtcssDecoder decoder;
+static uint32_t     sampleCount;
+
+/**
+ * Generate a block of baseband samples and feed them to the decoder.
+ *
+ * @param tone: CTCSS tone frequency in Hz, zero for no tone.
+ * @param noise: amplitude of the white noise.
+ */
+static void feedBlock(const float tone, const float noise)
+{
+    stream_sample_t block[BLOCK_SIZE];
+
+    for(size_t i = 0; i < BLOCK_SIZE; i++)
+    {
+        float t      = static_cast< float >(sampleCount) / CtcssDecoder::SAMPLE_RATE;
+        float sample = 1000.0f;     // ADC offset
+
+        if(tone > 0.0f)
+            sample += 800.0f * std::sin(2.0f * M_PI * tone * t);
+
+        // Voice band components, 15dB above the tone
+        sample += 2500.0f * std::sin(2.0f * M_PI * 720.0f * t);
+        sample += 2500.0f * std::sin(2.0f * M_PI * 1130.0f * t);
+
+        sample += noise * ((static_cast< float >(rand()) / RAND_MAX) - 0.5f);
+
+        block[i]     = static_cast< stream_sample_t >(sample);
+        sampleCount += 1;
+    }
+
+    decoder.process(block, BLOCK_SIZE);
+}
+
+/**
+ * Feed a tone to the decoder and return the time taken to detect it, in ms,
+ * or -1 if it has not been detected within one second.
+ */
+static int detectionTime(const float tone, const float noise)
+{
+    for(size_t ms = BLOCK_SIZE / 8; ms <= 1000; ms += BLOCK_SIZE / 8)
+    {
+        feedBlock(tone, noise);
+        if(decoder.toneDetected())
+            return ms;
+    }
+
+    return -1;
+}
+
+int main()
+{
+    srand(0);
+
+    for(size_t i = 0; i < MAX_TONE_INDEX; i++)
+    {
+        float tone = static_cast< float >(ctcss_tone[i]) / 10.0f;
+
+        // Detection of the tone, starting from a clean decoder state
+        decoder.reset();
+        decoder.setTone(ctcss_tone[i]);
+        feedBlock(0.0f, 500.0f);
+
+        int time = detectionTime(tone, 500.0f);
+        if((time < 0) || (static_cast< size_t >(time) > MAX_DETECT + 30))
+        {
+            printf("Tone %.1fHz: detection time %dms\n", tone, time);
+            return -1;
+        }
+
+        // Tone release
+        for(size_t j = 0; j < 5; j++)
+            feedBlock(0.0f, 500.0f);
+
+        if(decoder.toneDetected())
+        {
+            printf("Tone %.1fHz: not released\n", tone);
+            return -1;
+        }
+
+        // Rejection of the adjacent tones
+        for(int adj = -1; adj <= 1; adj += 2)
+        {
+            int k = static_cast< int >(i) + adj;
+            if((k < 0) || (k >= MAX_TONE_INDEX))
+                continue;
+
+            decoder.reset();
+            decoder.setTone(ctcss_tone[k]);
+
+            if(detectionTime(tone, 500.0f) >= 0)
+            {
+                printf("Tone %.1fHz: detected as %.1fHz\n", tone,
+                       static_cast< float >(ctcss_tone[k]) / 10.0f);
+                return -1;
+            }
+        }
+    }
+
+    // No tone, only noise and voice
+    decoder.reset();
+    decoder.setTone(ctcss_tone[0]);
+    for(size_t i = 0; i < 200; i++)
+    {
+        feedBlock(0.0f, 4000.0f);
+        if(decoder.lastTone() >= 0)
+        {
+            printf("False detection of %.1fHz on noise\n",
+                   static_cast< float >(ctcss_tone[decoder.lastTone()]) / 10.0f);
+            return -1;
+        }
+    }
+
+    return 0;
+}
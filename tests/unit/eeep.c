@@ -0,0 +1,188 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <interfaces/nvmem.h>
+#include <nvmem_access.h>
+#include <posix_file.h>
+#include <eeep.h>
+#include <string.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <stdio.h>
+#include <time.h>
+
+#define STORAGE_PATH "/tmp/test_eeep.bin"
+#define PAGE_SIZE    4096
+#define NUM_PAGES    4
+#define NUM_ADDRS    16
+#define NUM_WRITES   5000
+#define NUM_READS    200000
+
+/*
+ * File-backed storage with flash-like page erase, used as the underlying
+ * device of the emulated EEPROM.
+ */
+static const struct nvmInfo flashInfo =
+{
+    .write_size   = 1,
+    .erase_size   = PAGE_SIZE,
+    .erase_cycles = INT_MAX,
+    .device_info  = NVM_FLASH | NVM_WRITE | NVM_BITWRITE
+};
+
+static struct nvmFileDevice flashDevice =
+{
+    .ops  = &posix_file_ops,
+    .info = &flashInfo,
+    .size = PAGE_SIZE * NUM_PAGES,
+    .fd   = -1
+};
+
+static const struct nvmPartition flashPartitions[] =
+{
+    {
+        .offset = 0x0000,
+        .size   = PAGE_SIZE * NUM_PAGES
+    }
+};
+
+static const struct nvmDescriptor flashNvm =
+{
+    .name       = "Test flash",
+    .dev        = (const struct nvmDevice *) &flashDevice,
+    .partNum    = 1,
+    .partitions = flashPartitions
+};
+
+const struct nvmDescriptor *nvm_getDesc(const size_t index)
+{
+    if(index > 0)
+        return NULL;
+
+    return &flashNvm;
+}
+
+EEEP_DEVICE_DEFINE(eeep)
+
+static uint8_t model[NUM_ADDRS][64];
+static uint8_t sizes[NUM_ADDRS];
+
+static int checkContent(const char *step)
+{
+    for(uint16_t addr = 0; addr < NUM_ADDRS; addr++)
+    {
+        uint8_t buf[64];
+        if(sizes[addr] == 0)
+            continue;
+
+        if(nvm_devRead(&eeep, addr * 10, buf, sizes[addr]) < 0)
+        {
+            printf("Error (%s): read of address %u failed\n", step, addr * 10);
+            return -1;
+        }
+
+        if(memcmp(buf, model[addr], sizes[addr]) != 0)
+        {
+            printf("Error (%s): wrong data at address %u\n", step, addr * 10);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int main()
+{
+    remove(STORAGE_PATH);
+    if(posixFile_init(&flashDevice, STORAGE_PATH) < 0)
+        return -1;
+
+    if(eeep_init(&eeep, 0, 0) < 0)
+        return -1;
+
+    uint8_t buf[64];
+    if(nvm_devRead(&eeep, 10, buf, sizeof(buf)) >= 0)
+    {
+        printf("Error: read from an empty memory succeeded\n");
+        return -1;
+    }
+
+    // Random writes, wrapping around all the pages several times
+    srand(1234);
+    for(uint32_t i = 0; i < NUM_WRITES; i++)
+    {
+        uint16_t addr = rand() % NUM_ADDRS;
+        sizes[addr]   = 1 + (rand() % 64);
+        for(uint8_t j = 0; j < sizes[addr]; j++)
+            model[addr][j] = rand();
+
+        if(nvm_devWrite(&eeep, addr * 10, model[addr], sizes[addr]) < 0)
+        {
+            printf("Error: write %u failed\n", (unsigned) i);
+            return -1;
+        }
+
+        if(((i % 97) == 0) && checkContent("write"))
+            return -1;
+    }
+
+    if(checkContent("writes"))
+        return -1;
+
+    // Fill the active page with rewrites of the same entry, then measure the
+    // read time: without the index it grows with the number of records.
+    struct eeepData *priv = (struct eeepData *) eeep.priv;
+    uint32_t pageEnd = priv->readAddr - sizeof(uint32_t) + PAGE_SIZE;
+    while((pageEnd - priv->writeAddr) > 64)
+        nvm_devWrite(&eeep, 0, model[0], 8);
+
+    sizes[0] = 8;
+
+    volatile int sink = 0;
+    clock_t start = clock();
+    for(uint32_t i = 0; i < NUM_READS; i++)
+        sink += nvm_devRead(&eeep, (i % NUM_ADDRS) * 10, buf, 8);
+
+    double readTime = (double)(clock() - start) / CLOCKS_PER_SEC;
+    printf("Read with a full page: %.2f us\n", (readTime * 1e6) / NUM_READS);
+
+    // Reinitialization rebuilds the index from the storage
+    eeep_terminate(&eeep);
+    if(eeep_init(&eeep, 0, 0) < 0)
+        return -1;
+
+    if(checkContent("reinit"))
+        return -1;
+
+    // The index has a limited number of entries
+    int ret = 0;
+    for(uint16_t addr = 1000; ret >= 0; addr++)
+        ret = nvm_devWrite(&eeep, addr, buf, 4);
+
+    if(checkContent("index full"))
+        return -1;
+
+    eeep_terminate(&eeep);
+    posixFile_terminate(&flashDevice);
+    remove(STORAGE_PATH);
+
+    return 0;
+}
@@ -0,0 +1,342 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <interfaces/nvmem.h>
+#include <nvmem_access.h>
+#include <flash_backup.h>
+#include <posix_file.h>
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <stdio.h>
+#include <time.h>
+#include "flash_sim.h"
+
+#define SOURCE_PATH  "/tmp/test_flash_backup_src.bin"
+#define TARGET_PATH  "/tmp/test_flash_backup_dst.bin"
+#define SECT_SIZE    FLASH_BACKUP_SECTOR
+#define MEM_SIZE     (1024 * 1024)
+#define NUM_SECTORS  (MEM_SIZE / SECT_SIZE)
+
+FLASH_SIM_DEVICE_DEFINE(source, MEM_SIZE)
+FLASH_SIM_DEVICE_DEFINE(target, MEM_SIZE)
+
+#define SRC ((const struct nvmDevice *) &source)
+#define DST ((const struct nvmDevice *) &target)
+
+static struct flashBackup ctx;
+static uint8_t stream[2 * MEM_SIZE];
+static uint8_t bufA[MEM_SIZE];
+static uint8_t bufB[MEM_SIZE];
+
+/*
+ * Fill the source memory with a mix of content resembling the one of the
+ * external flash: erased areas, structured records and incompressible data.
+ */
+static void fillSource()
+{
+    memset(bufA, 0xFF, MEM_SIZE);
+
+    for(size_t sect = 0; sect < NUM_SECTORS; sect++)
+    {
+        uint8_t *ptr = &bufA[sect * SECT_SIZE];
+
+        switch(sect % 8)
+        {
+            // Codeplug-like records: names, frequencies and padding
+            case 0:
+            case 1:
+            case 2:
+                for(size_t i = 0; i < SECT_SIZE; i += 64)
+                {
+                    uint32_t freq = 430000000 + (rand() % 400) * 12500;
+                    snprintf((char *) &ptr[i], 16, "CH%04u",
+                             (unsigned) (sect * 64 + i / 64));
+                    memcpy(&ptr[i + 16], &freq, sizeof(freq));
+                    memcpy(&ptr[i + 20], &freq, sizeof(freq));
+                    memset(&ptr[i + 24], 0x00, 8);
+                }
+                break;
+
+            // Compressed audio data
+            case 3:
+                for(size_t i = 0; i < SECT_SIZE; i++)
+                    ptr[i] = rand();
+                break;
+
+            // Erased
+            default:
+                break;
+        }
+    }
+
+    nvm_devErase(SRC, 0, MEM_SIZE);
+    nvm_devWrite(SRC, 0, bufA, MEM_SIZE);
+}
+
+static size_t exportStream(uint32_t first)
+{
+    size_t size = 0;
+    ssize_t ret;
+
+    if(flashBackup_startExport(&ctx, SRC, first) < 0)
+        return 0;
+
+    do
+    {
+        size_t chunk = 1 + (rand() % 1500);
+        ret   = flashBackup_read(&ctx, &stream[size], chunk);
+        size += (ret > 0) ? ret : 0;
+    }
+    while(ret > 0);
+
+    if((ret < 0) || (size != ctx.stats.streamSize))
+        return 0;
+
+    return size;
+}
+
+static int importStream(size_t size)
+{
+    size_t pos = 0;
+    int    ret = 0;
+
+    if(flashBackup_startImport(&ctx, DST) < 0)
+        return -1;
+
+    while((pos < size) && (ret == 0))
+    {
+        size_t chunk = 1 + (rand() % 1500);
+        if(chunk > (size - pos))
+            chunk = size - pos;
+
+        ret  = flashBackup_write(&ctx, &stream[pos], chunk);
+        pos += chunk;
+    }
+
+    return ret;
+}
+
+static bool sameContent()
+{
+    nvm_devRead(SRC, 0, bufA, MEM_SIZE);
+    nvm_devRead(DST, 0, bufB, MEM_SIZE);
+
+    return memcmp(bufA, bufB, MEM_SIZE) == 0;
+}
+
+static void copySource()
+{
+    nvm_devRead(SRC, 0, bufA, MEM_SIZE);
+    nvm_devErase(DST, 0, MEM_SIZE);
+    nvm_devWrite(DST, 0, bufA, MEM_SIZE);
+}
+
+/*
+ * Full backup and restore over an erased memory.
+ */
+static int testFull()
+{
+    clock_t start = clock();
+    size_t  size  = exportStream(0);
+    clock_t end   = clock();
+
+    if(size == 0)
+        return -1;
+
+    printf("Backup: %u sectors, %u erased, %u compressed\n",
+           (unsigned) ctx.stats.sectors, (unsigned) ctx.stats.erased,
+           (unsigned) ctx.stats.compressed);
+    printf("Stream size: %zu bytes over %u raw (%.1f%%), %.1f ms\n", size,
+           MEM_SIZE, (100.0 * size) / MEM_SIZE,
+           (1000.0 * (end - start)) / CLOCKS_PER_SEC);
+
+    if(ctx.stats.sectors != NUM_SECTORS)
+        return -1;
+
+    nvm_devErase(DST, 0, MEM_SIZE);
+    flashSim_reset();
+
+    if((importStream(size) != 1) || (sameContent() == false))
+        return -1;
+
+    // Erased sectors are already in place
+    printf("Restore over erased memory: %u written, %u skipped, %u erases\n",
+           (unsigned) ctx.stats.written, (unsigned) ctx.stats.skipped,
+           (unsigned) flashSim.numErases);
+
+    if(ctx.stats.skipped != ctx.stats.erased)
+        return -1;
+
+    return 0;
+}
+
+/*
+ * Restore over an almost identical memory: only the modified sectors are
+ * erased and written.
+ */
+static int testIncremental()
+{
+    static const uint32_t changed[] = {0, 3, 17, 100, 101, 255};
+    size_t size = exportStream(0);
+
+    if(size == 0)
+        return -1;
+
+    copySource();
+    for(size_t i = 0; i < sizeof(changed) / sizeof(changed[0]); i++)
+    {
+        uint8_t data[4] = {0x00, 0x12, 0x34, 0x56};
+        nvm_devWrite(DST, changed[i] * SECT_SIZE + 100, data, sizeof(data));
+    }
+
+    flashSim_reset();
+
+    if((importStream(size) != 1) || (sameContent() == false))
+        return -1;
+
+    printf("Restore over modified memory: %u written, %u skipped, %u erases\n",
+           (unsigned) ctx.stats.written, (unsigned) ctx.stats.skipped,
+           (unsigned) flashSim.numErases);
+
+    if((ctx.stats.written != 6) || (flashSim.numErases != 6) ||
+       (ctx.stats.skipped != (NUM_SECTORS - 6)))
+        return -1;
+
+    return 0;
+}
+
+/*
+ * Interrupted transfer: the restore of a truncated stream leaves the
+ * remaining sectors untouched, a backup resumed from a given sector completes
+ * the job.
+ */
+static int testResume()
+{
+    size_t size = exportStream(0);
+
+    if(size == 0)
+        return -1;
+
+    nvm_devErase(DST, 0, MEM_SIZE);
+
+    // Transfer interrupted half way
+    if(importStream(size / 2) != 0)
+        return -1;
+
+    uint32_t restored = ctx.stats.sectors;
+    if((restored == 0) || (restored >= NUM_SECTORS))
+        return -1;
+
+    size = exportStream(restored);
+    if(size == 0)
+        return -1;
+
+    if((importStream(size) != 1) || (sameContent() == false))
+        return -1;
+
+    if(ctx.stats.sectors != (NUM_SECTORS - restored))
+        return -1;
+
+    return 0;
+}
+
+/*
+ * Corrupted streams are rejected.
+ */
+static int testCorrupted()
+{
+    size_t size = exportStream(0);
+
+    if(size == 0)
+        return -1;
+
+    // Bad header
+    stream[0] ^= 0x01;
+    if(importStream(size) != -EINVAL)
+        return -1;
+
+    stream[0] ^= 0x01;
+
+    // Flip a bit in every position of the first records: the restore must
+    // either fail or complete with the correct content.
+    copySource();
+    for(size_t i = 16; i < 2048; i += 13)
+    {
+        stream[i] ^= 0x10;
+        int ret = importStream(size);
+        stream[i] ^= 0x10;
+
+        if((ret == 1) && (sameContent() == false))
+            return -1;
+
+        if(ret != 1)
+            copySource();
+    }
+
+    return 0;
+}
+
+int main()
+{
+    srand(1);
+
+    if(posixFile_init(&source, SOURCE_PATH) < 0)
+        return -1;
+
+    if(posixFile_init(&target, TARGET_PATH) < 0)
+        return -1;
+
+    fillSource();
+
+    int ret = 0;
+
+    if(testFull() < 0)
+    {
+        printf("Error in full backup and restore\n");
+        ret = -1;
+    }
+
+    if(testIncremental() < 0)
+    {
+        printf("Error in incremental restore\n");
+        ret = -1;
+    }
+
+    if(testResume() < 0)
+    {
+        printf("Error in resumed backup\n");
+        ret = -1;
+    }
+
+    if(testCorrupted() < 0)
+    {
+        printf("Error in corrupted stream handling\n");
+        ret = -1;
+    }
+
+    posixFile_terminate(&source);
+    posixFile_terminate(&target);
+    remove(SOURCE_PATH);
+    remove(TARGET_PATH);
+
+    return ret;
+}
@@ -0,0 +1,127 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <errno.h>
+#include "flash_sim.h"
+
+struct flashSimStatus flashSim = { 0, 0, 0, -1, false };
+
+static const struct nvmDescriptor *nvmDesc = NULL;
+
+static int flashSim_read(const struct nvmDevice *dev, uint32_t offset,
+                         void *data, size_t len)
+{
+    int ret = posix_file_ops.read(dev, offset, data, len);
+    return (ret < 0) ? ret : 0;
+}
+
+static int flashSim_write(const struct nvmDevice *dev, uint32_t offset,
+                          const void *data, size_t len)
+{
+    uint8_t buf[256];
+    const uint8_t *src = (const uint8_t *) data;
+
+    if(flashSim.powerLost)
+        return -EIO;
+
+    // Power loss in the middle of the write
+    size_t toWrite = len;
+    if((flashSim.writeBudget >= 0) && (len > (size_t) flashSim.writeBudget))
+    {
+        toWrite = flashSim.writeBudget;
+        flashSim.powerLost = true;
+    }
+
+    if(flashSim.writeBudget >= 0)
+        flashSim.writeBudget -= toWrite;
+
+    flashSim.numWrites += 1;
+
+    while(toWrite > 0)
+    {
+        size_t size = (toWrite > sizeof(buf)) ? sizeof(buf) : toWrite;
+        posix_file_ops.read(dev, offset, buf, size);
+        for(size_t i = 0; i < size; i++)
+            buf[i] &= src[i];
+
+        int ret = posix_file_ops.write(dev, offset, buf, size);
+        if(ret < 0)
+            return ret;
+
+        flashSim.bytesWritten += size;
+        offset  += size;
+        src     += size;
+        toWrite -= size;
+    }
+
+    return flashSim.powerLost ? -EIO : 0;
+}
+
+static int flashSim_erase(const struct nvmDevice *dev, uint32_t offset,
+                          size_t size)
+{
+    if(flashSim.powerLost || (flashSim.writeBudget == 0))
+    {
+        flashSim.powerLost = true;
+        return -EIO;
+    }
+
+    flashSim.numErases += size / FLASH_SIM_SECTOR;
+    return posix_file_ops.erase(dev, offset, size);
+}
+
+const struct nvmOps flashSim_ops =
+{
+    .read   = flashSim_read,
+    .write  = flashSim_write,
+    .erase  = flashSim_erase,
+    .sync   = NULL
+};
+
+const struct nvmInfo flashSim_info =
+{
+    .write_size   = 1,
+    .erase_size   = FLASH_SIM_SECTOR,
+    .erase_cycles = 100000,
+    .device_info  = NVM_FLASH | NVM_WRITE | NVM_BITWRITE | NVM_ERASE
+};
+
+void flashSim_reset()
+{
+    flashSim.numErases    = 0;
+    flashSim.numWrites    = 0;
+    flashSim.bytesWritten = 0;
+    flashSim.writeBudget  = -1;
+    flashSim.powerLost    = false;
+}
+
+void flashSim_setDesc(const struct nvmDescriptor *desc)
+{
+    nvmDesc = desc;
+}
+
+const struct nvmDescriptor *nvm_getDesc(const size_t index)
+{
+    if(index > 0)
+        return NULL;
+
+    return nvmDesc;
+}
@@ -0,0 +1,84 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef FLASH_SIM_H
+#define FLASH_SIM_H
+
+#include <interfaces/nvmem.h>
+#include <nvmem_access.h>
+#include <posix_file.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * File-backed flash memory for the unit tests: writes can only clear bits and
+ * the storage has to be erased one sector at a time. Erases and writes are
+ * counted and a power loss can be injected after a given number of bytes
+ * written, after which every operation fails.
+ */
+
+#define FLASH_SIM_SECTOR 4096
+
+/**
+ * Counters and fault injection, shared by all the simulated devices.
+ */
+struct flashSimStatus
+{
+    uint32_t numErases;     ///< Number of sectors erased
+    uint32_t numWrites;     ///< Number of write operations
+    uint32_t bytesWritten;  ///< Number of bytes written
+    int32_t  writeBudget;   ///< Bytes left before a power loss, -1 for none
+    bool     powerLost;     ///< Set once the power loss happened
+};
+
+extern struct flashSimStatus flashSim;
+extern const struct nvmOps   flashSim_ops;
+extern const struct nvmInfo  flashSim_info;
+
+/**
+ * Instantiate a simulated flash memory device, to be initialized with
+ * posixFile_init().
+ *
+ * @param name: device name.
+ * @param dim: size of the memory, in bytes.
+ */
+#define FLASH_SIM_DEVICE_DEFINE(name, dim) \
+static struct nvmFileDevice name =         \
+{                                          \
+    .ops  = &flashSim_ops,                 \
+    .info = &flashSim_info,                \
+    .size = dim,                           \
+    .fd   = -1                             \
+};
+
+/**
+ * Clear the counters and restore the power.
+ */
+void flashSim_reset();
+
+/**
+ * Set the descriptor returned by nvm_getDesc(0), which otherwise returns NULL.
+ *
+ * @param desc: NVM descriptor.
+ */
+void flashSim_setDesc(const struct nvmDescriptor *desc);
+
+#endif /* FLASH_SIM_H */
@@ -0,0 +1,101 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/*
+ * Framebuffer layout test: the same reference screens are drawn by instances
+ * of the graphics module using the default framebuffer layout and the display
+ * native one, then the content of the two framebuffers is compared pixel by
+ * pixel. The font descent used to lay out the UI text lines is checked against
+ * the rows actually drawn by the glyphs.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define DECLARE_INSTANCE(name)                              \
+    void     name ## _drawScreen(uint32_t seed);            \
+    uint16_t name ## _getPixel(int16_t x, int16_t y);    \
+    int      name ## _checkFontDescent();
+
+DECLARE_INSTANCE(rgb565)
+DECLARE_INSTANCE(rgb565_native)
+DECLARE_INSTANCE(bw)
+DECLARE_INSTANCE(bw_native)
+
+typedef void     (*drawScreen_t)(uint32_t seed);
+typedef uint16_t (*getPixel_t)(int16_t x, int16_t y);
+
+#define NUM_SCREENS 256
+
+static int compareLayouts(const char *name, int16_t width, int16_t height,
+                          drawScreen_t drawRef, getPixel_t getRef,
+                          drawScreen_t drawNative, getPixel_t getNative)
+{
+    for(uint32_t screen = 0; screen < NUM_SCREENS; screen++)
+    {
+        drawRef(screen);
+        drawNative(screen);
+
+        for(int16_t y = 0; y < height; y++)
+        {
+            for(int16_t x = 0; x < width; x++)
+            {
+                uint16_t ref    = getRef(x, y);
+                uint16_t native = getNative(x, y);
+
+                if(ref != native)
+                {
+                    printf("%s: screen %u differs at (%d, %d): %04x != %04x\n",
+                           name, screen, x, y, ref, native);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
+int main()
+{
+    if(compareLayouts("RGB565", 160, 128, rgb565_drawScreen, rgb565_getPixel,
+                      rgb565_native_drawScreen, rgb565_native_getPixel))
+    {
+        printf("Error in big endian RGB565 layout!\n");
+        return -1;
+    }
+
+    if(compareLayouts("1bpp", 128, 64, bw_drawScreen, bw_getPixel,
+                      bw_native_drawScreen, bw_native_getPixel))
+    {
+        printf("Error in paged 1bpp layout!\n");
+        return -1;
+    }
+
+    if(rgb565_checkFontDescent() || bw_checkFontDescent())
+    {
+        printf("Error in font descent!\n");
+        return -1;
+    }
+
+    printf("PASS\n");
+    return 0;
+}
@@ -0,0 +1,246 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/*
+ * Instance of the graphics module for the framebuffer layout test.
+ *
+ * This file is built once for each framebuffer layout under test, with GFX_COPY
+ * defined to a different name each time. All the public symbols of the
+ * graphics module get prefixed with that name, thus the instances can be
+ * linked together in the same test executable.
+ */
+
+#define GFX_CONCAT(p, n)  p ## _ ## n
+#define GFX_PREFIX(p, n)  GFX_CONCAT(p, n)
+#define GFX_NAME(n)       GFX_PREFIX(GFX_COPY, n)
+
+#define gfx_clearRows       GFX_NAME(gfx_clearRows)
+#define gfx_clearScreen     GFX_NAME(gfx_clearScreen)
+#define gfx_drawBattery     GFX_NAME(gfx_drawBattery)
+#define gfx_drawCircle      GFX_NAME(gfx_drawCircle)
+#define gfx_drawGPScompass  GFX_NAME(gfx_drawGPScompass)
+#define gfx_drawGPSgraph    GFX_NAME(gfx_drawGPSgraph)
+#define gfx_drawHLine       GFX_NAME(gfx_drawHLine)
+#define gfx_drawLine        GFX_NAME(gfx_drawLine)
+#define gfx_drawRect        GFX_NAME(gfx_drawRect)
+#define gfx_drawSmeter      GFX_NAME(gfx_drawSmeter)
+#define gfx_drawSmeterLevel GFX_NAME(gfx_drawSmeterLevel)
+#define gfx_drawSymbol      GFX_NAME(gfx_drawSymbol)
+#define gfx_drawVLine       GFX_NAME(gfx_drawVLine)
+#define gfx_drawVolume      GFX_NAME(gfx_drawVolume)
+#define gfx_fillScreen      GFX_NAME(gfx_fillScreen)
+#define gfx_getFontDescent  GFX_NAME(gfx_getFontDescent)
+#define gfx_getFontHeight   GFX_NAME(gfx_getFontHeight)
+#define gfx_init            GFX_NAME(gfx_init)
+#define gfx_plotData        GFX_NAME(gfx_plotData)
+#define gfx_print           GFX_NAME(gfx_print)
+#define gfx_printBuffer     GFX_NAME(gfx_printBuffer)
+#define gfx_printError      GFX_NAME(gfx_printError)
+#define gfx_printLine       GFX_NAME(gfx_printLine)
+#define gfx_render          GFX_NAME(gfx_render)
+#define gfx_renderDirty     GFX_NAME(gfx_renderDirty)
+#define gfx_renderRows      GFX_NAME(gfx_renderRows)
+#define gfx_setPixel        GFX_NAME(gfx_setPixel)
+#define gfx_terminate       GFX_NAME(gfx_terminate)
+
+#include "../../openrtx/src/core/graphics.c"
+
+/**
+ * Simple linear congruential generator, giving the same sequence on all the
+ * instances.
+ */
+static uint32_t nextRand(uint32_t *state)
+{
+    *state = (*state * 1103515245u) + 12345u;
+    return (*state >> 16) & 0x7FFF;
+}
+
+static color_t randColor(uint32_t *state)
+{
+    color_t color;
+    color.r     = nextRand(state) & 0xFF;
+    color.g     = nextRand(state) & 0xFF;
+    color.b     = nextRand(state) & 0xFF;
+    color.alpha = (nextRand(state) % 4 == 0) ? (nextRand(state) & 0xFF) : 255;
+
+    // Black is the background on color screens and white on 1bpp ones
+    if(nextRand(state) % 8 == 0)
+    {
+        color.r = 0;
+        color.g = 0;
+        color.b = 0;
+    }
+
+    return color;
+}
+
+static point_t randPoint(uint32_t *state)
+{
+    point_t point;
+    point.x = (nextRand(state) % (CONFIG_SCREEN_WIDTH  + 40)) - 20;
+    point.y = (nextRand(state) % (CONFIG_SCREEN_HEIGHT + 40)) - 20;
+
+    return point;
+}
+
+void GFX_NAME(drawScreen)(uint32_t seed)
+{
+    static const char *strings[] =
+    {
+        "433.125", "M17 #OPENRTX", "12:34:56", "Tone 88.5",
+        "0-001: Repeater", "Line\nbreak", "Lorem ipsum dolor sit amet"
+    };
+
+    uint32_t state = seed;
+
+    gfx_clearScreen();
+
+    for(int i = 0; i < 64; i++)
+    {
+        color_t color = randColor(&state);
+        point_t p0    = randPoint(&state);
+        point_t p1    = randPoint(&state);
+
+        switch(nextRand(&state) % 11)
+        {
+            case 0:
+                gfx_drawLine(p0, p1, color);
+                break;
+
+            case 1:
+                gfx_drawRect(p0, nextRand(&state) % CONFIG_SCREEN_WIDTH,
+                             nextRand(&state) % CONFIG_SCREEN_HEIGHT, color,
+                             nextRand(&state) % 2);
+                break;
+
+            case 2:
+                gfx_drawCircle(p0, nextRand(&state) % (CONFIG_SCREEN_HEIGHT / 2),
+                               color);
+                break;
+
+            case 3:
+                gfx_drawHLine(p0.y, 1 + nextRand(&state) % 3, color);
+                break;
+
+            case 4:
+                gfx_drawVLine(p0.x, 1 + nextRand(&state) % 3, color);
+                break;
+
+            case 5:
+                gfx_setPixel(p0, color);
+                break;
+
+            case 6:
+                gfx_printBuffer(p0, nextRand(&state) % FONT_SIZE_NUM,
+                                nextRand(&state) % 3, color,
+                                strings[nextRand(&state) % 7]);
+                break;
+
+            case 7:
+                gfx_drawSymbol(p0, nextRand(&state) % 3, TEXT_ALIGN_LEFT, color,
+                               SYMBOL_LOCK);
+                break;
+
+            case 8:
+                gfx_drawBattery(p0, 8 + nextRand(&state) % 24,
+                                4 + nextRand(&state) % 12,
+                                nextRand(&state) % 101);
+                break;
+
+            case 9:
+                gfx_clearRows(nextRand(&state) % CONFIG_SCREEN_HEIGHT,
+                              nextRand(&state) % CONFIG_SCREEN_HEIGHT);
+                break;
+
+            case 10:
+                if(nextRand(&state) % 16 == 0)
+                    gfx_fillScreen(color);
+                break;
+        }
+    }
+}
+
+uint16_t GFX_NAME(getPixel)(int16_t x, int16_t y);
+
+/**
+ * Draw each glyph of the text fonts on its own and check that the lowest row
+ * reached below the baseline matches the font descent used for the layout of
+ * the UI text lines.
+ */
+int GFX_NAME(checkFontDescent)()
+{
+    static const color_t white = {255, 255, 255, 255};
+    const int16_t baseline     = CONFIG_SCREEN_HEIGHT - 16;
+
+    for(int size = 0; size < FONT_SIZE_NUM; size++)
+    {
+        const GFXfont *f = &fonts[size];
+        int16_t lowest   = baseline;
+
+        for(uint16_t c = f->first; c <= f->last; c++)
+        {
+            char    text[2] = {(char) c, '\0'};
+            point_t start   = {8, baseline};
+
+            gfx_clearScreen();
+            uint16_t background = GFX_NAME(getPixel)(0, 0);
+            gfx_printBuffer(start, size, TEXT_ALIGN_LEFT, white, text);
+
+            for(int16_t y = baseline; y < CONFIG_SCREEN_HEIGHT; y++)
+            {
+                for(int16_t x = 0; x < CONFIG_SCREEN_WIDTH; x++)
+                {
+                    if(GFX_NAME(getPixel)(x, y) != background)
+                    {
+                        if(y + 1 > lowest)
+                            lowest = y + 1;
+                    }
+                }
+            }
+        }
+
+        int16_t descent = gfx_getFontDescent(size);
+        if((lowest - baseline) != descent)
+        {
+            printf("Font %d: glyphs reach %d rows below the baseline, descent is %d\n",
+                   size, lowest - baseline, descent);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+uint16_t GFX_NAME(getPixel)(int16_t x, int16_t y)
+{
+    #ifdef CONFIG_PIX_FMT_RGB565
+    uint16_t value = ((pix16_t *) framebuffer)[x + y * CONFIG_SCREEN_WIDTH];
+    return PIX_ORDER(value);
+    #else
+    #ifdef CONFIG_PIX_FMT_BW_PAGED
+    uint8_t cell = framebuffer[x + (y / 8) * CONFIG_SCREEN_WIDTH];
+    return (cell >> (y % 8)) & 0x01;
+    #else
+    uint32_t pos = x + y * CONFIG_SCREEN_WIDTH;
+    return (framebuffer[pos / 8] >> (pos % 8)) & 0x01;
+    #endif
+    #endif
+}
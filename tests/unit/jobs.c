@@ -0,0 +1,141 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <jobs.h>
+
+static unsigned int fastRuns;
+static unsigned int slowRuns;
+static unsigned int selfRuns;
+static int          slowId;
+static int          selfId;
+static long long    now;
+static long long    selfTime;
+
+static void fastJob()
+{
+    fastRuns++;
+}
+
+static void slowJob()
+{
+    slowRuns++;
+}
+
+static void selfJob()
+{
+    // Slow down from inside the job, as done when a peripheral is turned off
+    selfRuns++;
+    selfTime = now;
+    jobs_setPeriod(selfId, 500);
+}
+
+int main()
+{
+    if(jobs_register(fastJob, 10) < 0)
+        return -1;
+
+    slowId = jobs_register(slowJob, 100);
+    if(slowId < 0)
+        return -1;
+
+    // Both jobs run at the first call, the scheduler then asks to be woken up
+    // at the deadline of the fastest one.
+    long long next = jobs_run(1000);
+    if((fastRuns != 1) || (slowRuns != 1) || (next != 1010))
+    {
+        printf("Error in first run: %u %u %lld\n", fastRuns, slowRuns, next);
+        return -1;
+    }
+
+    // Follow the deadlines returned for one second
+    while(next < 2000)
+        next = jobs_run(next);
+
+    if((fastRuns != 100) || (slowRuns != 10))
+    {
+        printf("Error in periodic runs: %u %u\n", fastRuns, slowRuns);
+        return -1;
+    }
+
+    // Running early does nothing
+    if((jobs_run(next - 5) != next) || (fastRuns != 100))
+    {
+        printf("Error in early run\n");
+        return -1;
+    }
+
+    // A late job runs only once and is rescheduled from the current time
+    next = jobs_run(next + 55);
+    if((fastRuns != 101) || (slowRuns != 11) || (next != 2065))
+    {
+        printf("Error in late run: %u %lld\n", fastRuns, next);
+        return -1;
+    }
+
+    // Period change is applied starting from the next run of the job, which
+    // is still due at 2100
+    jobs_setPeriod(slowId, 20);
+    while(slowRuns < 13)
+    {
+        now  = next;
+        next = jobs_run(now);
+    }
+
+    if(now != 2120)
+    {
+        printf("Error in period change: %lld\n", now);
+        return -1;
+    }
+
+    // Period change from inside the job
+    selfId = jobs_register(selfJob, 20);
+    if(selfId < 0)
+        return -1;
+
+    now  = next;
+    next = jobs_run(now);
+    long long firstRun = selfTime;
+    while(selfRuns < 2)
+    {
+        now  = next;
+        next = jobs_run(now);
+    }
+
+    if((selfTime - firstRun) != 500)
+    {
+        printf("Error in period change from the job: %lld\n",
+               selfTime - firstRun);
+        return -1;
+    }
+
+    // The job table has a fixed size
+    for(int i = 3; i < MAX_NUM_JOBS; i++)
+        jobs_register(fastJob, 10);
+
+    if(jobs_register(fastJob, 10) >= 0)
+    {
+        printf("Error: job table overflow\n");
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,177 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/*
+ * Noise squelch test: FM baseband signals are synthesized passing a modulated
+ * carrier plus gaussian noise through an FM discriminator, at different
+ * carrier to noise ratios. The test reports the opening and closing latency
+ * of the squelch and the number of false openings on noise only.
+ *
+ * When a file name is given, the file is read as raw 16 bit, 8kHz baseband
+ * samples, for example a recording of the RX baseband, and the squelch
+ * transitions are printed.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <complex>
+#include <random>
+#include <noise_squelch.hpp>
+
+using namespace std;
+
+static constexpr size_t BLOCK_SIZE = 240;       // 30ms blocks
+static constexpr float  NO_CARRIER = -100.0f;
+
+static NoiseSquelch               squelch;
+static mt19937                    rng(1);
+static normal_distribution<float> gauss(0.0f, 1.0f);
+static complex<float>             prevSample(1.0f, 0.0f);
+static float                      phase = 0.0f;
+static uint32_t                   sampleCount = 0;
+
+/**
+ * Generate a block of discriminator output and feed it to the squelch.
+ *
+ * @param cnr: carrier to noise ratio over the sampling bandwidth, in dB.
+ */
+static void feedBlock(const float cnr)
+{
+    stream_sample_t block[BLOCK_SIZE];
+    const float     fs  = NoiseSquelch::SAMPLE_RATE;
+    const float     amp = (cnr > NO_CARRIER) ? sqrt(pow(10.0f, cnr / 10.0f)) : 0.0f;
+
+    for(size_t i = 0; i < BLOCK_SIZE; i++)
+    {
+        // Voice-like modulation plus a CTCSS tone
+        float t   = static_cast< float >(sampleCount) / fs;
+        float dev = 2500.0f * sin(2.0f * M_PI * 800.0f * t)
+                  + 300.0f  * sin(2.0f * M_PI * 88.5f * t);
+
+        phase += 2.0f * M_PI * dev / fs;
+
+        complex<float> noise(gauss(rng), gauss(rng));
+        complex<float> sample = amp * polar(1.0f, phase) + noise * 0.7071f;
+
+        float freq = arg(sample * conj(prevSample)) * fs / (2.0f * M_PI);
+        prevSample = sample;
+
+        block[i]     = static_cast< stream_sample_t >(freq * 4.0f);
+        sampleCount += 1;
+    }
+
+    squelch.process(block, BLOCK_SIZE);
+}
+
+static int processFile(const char *name)
+{
+    FILE *file = fopen(name, "rb");
+    if(file == NULL)
+    {
+        printf("Cannot open %s\n", name);
+        return -1;
+    }
+
+    stream_sample_t block[BLOCK_SIZE];
+    size_t          blocks = 0;
+    bool            open   = false;
+
+    while(fread(block, sizeof(stream_sample_t), BLOCK_SIZE, file) == BLOCK_SIZE)
+    {
+        squelch.process(block, BLOCK_SIZE);
+        blocks += 1;
+
+        if(squelch.isOpen() != open)
+        {
+            open = squelch.isOpen();
+            printf("%7.2fs: squelch %s, quieting %.1fdB\n",
+                   (blocks * BLOCK_SIZE) / static_cast< float >(NoiseSquelch::SAMPLE_RATE),
+                   open ? "open" : "closed", squelch.quieting());
+        }
+    }
+
+    fclose(file);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    if(argc > 1)
+        return processFile(argv[1]);
+
+    // Weakest carrier to noise ratio to be detected
+    static constexpr float MIN_CNR = 6.0f;
+
+    for(float cnr : {0.0f, 3.0f, 6.0f, 10.0f, 20.0f})
+    {
+        squelch.reset();
+
+        // Learn the noise floor, then count false openings
+        for(size_t i = 0; i < 100; i++)
+            feedBlock(NO_CARRIER);
+
+        size_t falseOpen = 0;
+        for(size_t i = 0; i < 300; i++)
+        {
+            feedBlock(NO_CARRIER);
+            if(squelch.isOpen()) falseOpen += 1;
+        }
+
+        int openLatency = -1;
+        for(size_t i = 1; i <= 50; i++)
+        {
+            feedBlock(cnr);
+            if(squelch.isOpen() && (openLatency < 0))
+                openLatency = i;
+        }
+
+        size_t dropouts = 0;
+        for(size_t i = 0; i < 300; i++)
+        {
+            feedBlock(cnr);
+            if(squelch.isOpen() == false) dropouts += 1;
+        }
+
+        int closeLatency = -1;
+        for(size_t i = 1; i <= 50; i++)
+        {
+            feedBlock(NO_CARRIER);
+            if((squelch.isOpen() == false) && (closeLatency < 0))
+                closeLatency = i;
+        }
+
+        printf("CNR %4.1fdB: open %d blocks, close %d blocks, %u false openings, "
+               "%u dropouts\n", cnr, openLatency, closeLatency,
+               static_cast< unsigned >(falseOpen), static_cast< unsigned >(dropouts));
+
+        if(falseOpen != 0)
+            return -1;
+
+        if(cnr >= MIN_CNR)
+        {
+            if((openLatency != 1) || (closeLatency != 1) || (dropouts != 0))
+                return -1;
+        }
+    }
+
+    return 0;
+}
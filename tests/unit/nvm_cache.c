@@ -0,0 +1,243 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <interfaces/nvmem.h>
+#include <nvmem_access.h>
+#include <posix_file.h>
+#include <nvm_cache.h>
+#include <eeep.h>
+#include <string.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <stdio.h>
+#include "flash_sim.h"
+
+#define STORAGE_PATH "/tmp/test_nvm_cache.bin"
+#define SECT_SIZE    FLASH_SIM_SECTOR
+#define NUM_SECT     8
+#define MEM_SIZE     (SECT_SIZE * NUM_SECT)
+#define NUM_OPS      20000
+#define NUM_RECORDS  2000
+#define NUM_UPDATES  256
+
+FLASH_SIM_DEVICE_DEFINE(flashDevice, MEM_SIZE)
+
+NVM_CACHE_DEVICE_DEFINE(cacheDevice, flashDevice, MEM_SIZE, SECT_SIZE, 2)
+
+static const struct nvmPartition partitions[] =
+{
+    {
+        .offset = 0x0000,
+        .size   = MEM_SIZE
+    }
+};
+
+static const struct nvmDescriptor flashNvm =
+{
+    .name       = "Test flash",
+    .dev        = (const struct nvmDevice *) &flashDevice,
+    .partNum    = 1,
+    .partitions = partitions
+};
+
+static const struct nvmDescriptor cacheNvm =
+{
+    .name       = "Test flash, cached",
+    .dev        = &cacheDevice,
+    .partNum    = 1,
+    .partitions = partitions
+};
+
+EEEP_DEVICE_DEFINE(eeep)
+
+static uint8_t model[MEM_SIZE];
+
+static void printCounters(const char *name)
+{
+    printf("%-24s %6u erases, %6u writes, %8u bytes written\n", name,
+           (unsigned) flashSim.numErases, (unsigned) flashSim.numWrites,
+           (unsigned) flashSim.bytesWritten);
+}
+
+static int checkContent(const struct nvmDevice *dev, const char *step)
+{
+    static uint8_t buf[MEM_SIZE];
+
+    if(nvm_devRead(dev, 0, buf, MEM_SIZE) < 0)
+        return -1;
+
+    if(memcmp(buf, model, MEM_SIZE) != 0)
+    {
+        printf("Error: memory content mismatch (%s)\n", step);
+        return -1;
+    }
+
+    return 0;
+}
+
+/*
+ * Random writes, erases and reads through the cache, checked against a model
+ * of the flash memory.
+ */
+static int testConsistency()
+{
+    const struct nvmDevice *dev = &cacheDevice;
+
+    nvm_devErase((const struct nvmDevice *) &flashDevice, 0, MEM_SIZE);
+    memset(model, 0xFF, MEM_SIZE);
+    srand(42);
+
+    for(uint32_t i = 0; i < NUM_OPS; i++)
+    {
+        uint32_t op = rand() % 100;
+        if(op < 5)
+        {
+            uint32_t sect = rand() % NUM_SECT;
+            nvm_devErase(dev, sect * SECT_SIZE, SECT_SIZE);
+            memset(&model[sect * SECT_SIZE], 0xFF, SECT_SIZE);
+        }
+        else if(op < 80)
+        {
+            uint8_t  data[300];
+            uint32_t len    = 1 + rand() % sizeof(data);
+            uint32_t offset = rand() % (MEM_SIZE - len);
+            for(uint32_t j = 0; j < len; j++)
+            {
+                data[j] = rand();
+                model[offset + j] &= data[j];
+            }
+
+            if(nvm_devWrite(dev, offset, data, len) < 0)
+            {
+                printf("Error: write failed\n");
+                return -1;
+            }
+        }
+        else
+        {
+            uint8_t  data[300];
+            uint32_t len    = 1 + rand() % sizeof(data);
+            uint32_t offset = rand() % (MEM_SIZE - len);
+            nvm_devRead(dev, offset, data, len);
+            if(memcmp(data, &model[offset], len) != 0)
+            {
+                printf("Error: wrong data read at offset %u\n", offset);
+                return -1;
+            }
+        }
+    }
+
+    if(checkContent(dev, "cached"))
+        return -1;
+
+    nvm_devSync(dev);
+
+    return checkContent((const struct nvmDevice *) &flashDevice, "after sync");
+}
+
+/*
+ * Emulated EEPROM workload: each record is written as header, data and header
+ * again.
+ */
+static int eeepWorkload(const struct nvmDescriptor *desc)
+{
+    nvm_devErase((const struct nvmDevice *) &flashDevice, 0, MEM_SIZE);
+    flashSim_setDesc(desc);
+
+    if(eeep_init(&eeep, 0, 0) < 0)
+        return -1;
+
+    nvm_devSync(desc->dev);
+    flashSim_reset();
+    for(uint32_t i = 0; i < NUM_RECORDS; i++)
+    {
+        uint8_t data[16];
+        memset(data, i, sizeof(data));
+        if(nvm_devWrite(&eeep, i % 8, data, sizeof(data)) < 0)
+            return -1;
+    }
+
+    nvm_devSync(desc->dev);
+    eeep_terminate(&eeep);
+    printCounters(desc->name);
+
+    return 0;
+}
+
+/*
+ * Settings-like workload: small updates done with a read-modify-write of the
+ * whole sector, synced every 16 updates.
+ */
+static int rmwWorkload(const struct nvmDevice *dev, const char *name)
+{
+    static uint8_t sect[SECT_SIZE];
+
+    nvm_devErase((const struct nvmDevice *) &flashDevice, 0, MEM_SIZE);
+    flashSim_reset();
+
+    for(uint32_t i = 0; i < NUM_UPDATES; i++)
+    {
+        nvm_devRead(dev, 0, sect, SECT_SIZE);
+        memset(&sect[(i % 128) * 32], i, 32);
+        nvm_devErase(dev, 0, SECT_SIZE);
+        nvm_devWrite(dev, 0, sect, SECT_SIZE);
+
+        if((i % 16) == 15)
+            nvm_devSync(dev);
+    }
+
+    nvm_devRead(dev, 0, sect, SECT_SIZE);
+    if(sect[(NUM_UPDATES - 1) % 128 * 32] != ((NUM_UPDATES - 1) & 0xFF))
+    {
+        printf("Error: wrong content after read-modify-write\n");
+        return -1;
+    }
+
+    printCounters(name);
+
+    return 0;
+}
+
+int main()
+{
+    remove(STORAGE_PATH);
+    if(posixFile_init(&flashDevice, STORAGE_PATH) < 0)
+        return -1;
+
+    if(nvmCache_init(&cacheDevice) < 0)
+        return -1;
+
+    if(testConsistency())
+        return -1;
+
+    if(eeepWorkload(&flashNvm) || eeepWorkload(&cacheNvm))
+        return -1;
+
+    if(rmwWorkload((const struct nvmDevice *) &flashDevice, "RMW, uncached") ||
+       rmwWorkload(&cacheDevice, "RMW, cached"))
+        return -1;
+
+    nvmCache_terminate(&cacheDevice);
+    posixFile_terminate(&flashDevice);
+    remove(STORAGE_PATH);
+
+    return 0;
+}
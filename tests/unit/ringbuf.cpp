@@ -0,0 +1,144 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <cstdio>
+#include <cstdint>
+#include <chrono>
+#include <pthread.h>
+#include <ringbuf.hpp>
+
+using namespace std;
+
+#define NUM_ITEMS 2000000
+#define BUF_LEN   64
+#define CODEC_LEN 4
+
+static RingBuffer< uint32_t, BUF_LEN >       lockedBuf;
+static SPSCRingBuffer< uint32_t, BUF_LEN >   spscBuf;
+static RingBuffer< uint32_t, 16 * BUF_LEN >     lockedBufLarge;
+static SPSCRingBuffer< uint32_t, 16 * BUF_LEN > spscBufLarge;
+static RingBuffer< uint32_t, CODEC_LEN >        lockedBufCodec;
+static SPSCRingBuffer< uint32_t, CODEC_LEN >    spscBufCodec;
+
+template < class B >
+static void *producer(void *arg)
+{
+    B *buf = reinterpret_cast< B * >(arg);
+
+    for(uint32_t i = 0; i < NUM_ITEMS; i++)
+        buf->push(i, true);
+
+    return NULL;
+}
+
+/**
+ * Run a producer and a consumer thread contending on the same buffer, check
+ * that all the elements are received in order and return the throughput in
+ * millions of elements per second, or a negative value on error.
+ */
+template < class B >
+static double runBenchmark(B& buf)
+{
+    pthread_t prod;
+
+    buf.reset();
+    auto start = chrono::steady_clock::now();
+    pthread_create(&prod, NULL, producer< B >, &buf);
+
+    bool ok = true;
+    for(uint32_t i = 0; i < NUM_ITEMS; i++)
+    {
+        uint32_t value = 0;
+        buf.pop(value, true);
+        if(value != i) ok = false;
+    }
+
+    pthread_join(prod, NULL);
+    auto end = chrono::steady_clock::now();
+
+    if((ok == false) || (buf.empty() == false))
+        return -1.0;
+
+    chrono::duration< double > elapsed = end - start;
+    return (NUM_ITEMS / elapsed.count()) / 1e6;
+}
+
+/**
+ * Check the non-blocking behaviour when empty and full.
+ */
+static bool checkBounds()
+{
+    uint32_t value;
+
+    spscBuf.reset();
+    if(spscBuf.pop(value, false) == true) return false;
+
+    for(uint32_t i = 0; i < BUF_LEN; i++)
+    {
+        if(spscBuf.push(i, false) == false) return false;
+    }
+
+    if(spscBuf.full() == false) return false;
+    if(spscBuf.push(0, false) == true) return false;
+
+    spscBuf.eraseElement();
+    if(spscBuf.full() == true) return false;
+    if(spscBuf.pop(value, false) == false) return false;
+
+    return (value == 1);
+}
+
+int main()
+{
+    if(checkBounds() == false)
+    {
+        printf("SPSC ring buffer bound check: FAIL\n");
+        return -1;
+    }
+
+    double locked      = runBenchmark(lockedBuf);
+    double spsc        = runBenchmark(spscBuf);
+    double lockedLarge = runBenchmark(lockedBufLarge);
+    double spscLarge   = runBenchmark(spscBufLarge);
+    double lockedCodec = runBenchmark(lockedBufCodec);
+    double spscCodec   = runBenchmark(spscBufCodec);
+
+    printf("Mutex ring buffer, %d elements: %.2f Melem/s\n", CODEC_LEN,
+           lockedCodec);
+    printf("SPSC ring buffer,  %d elements: %.2f Melem/s\n", CODEC_LEN,
+           spscCodec);
+
+    printf("Mutex ring buffer, %d elements: %.2f Melem/s\n", BUF_LEN, locked);
+    printf("SPSC ring buffer,  %d elements: %.2f Melem/s\n", BUF_LEN, spsc);
+    printf("Mutex ring buffer, %d elements: %.2f Melem/s\n", 16 * BUF_LEN,
+           lockedLarge);
+    printf("SPSC ring buffer,  %d elements: %.2f Melem/s\n", 16 * BUF_LEN,
+           spscLarge);
+
+    if((locked < 0.0) || (spsc < 0.0) || (lockedLarge < 0.0) ||
+       (spscLarge < 0.0) || (lockedCodec < 0.0) || (spscCodec < 0.0))
+    {
+        printf("Elements lost or out of order: FAIL\n");
+        return -1;
+    }
+
+    return 0;
+}
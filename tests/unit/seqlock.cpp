@@ -0,0 +1,104 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <cstdio>
+#include <cstdint>
+#include <atomic>
+#include <pthread.h>
+#include <seqlock.hpp>
+
+using namespace std;
+
+#define NUM_UPDATES 2000000
+#define DATA_LEN    32
+
+struct TestData
+{
+    uint32_t value[DATA_LEN];
+};
+
+static SeqLock< TestData > snapshot;
+static atomic< bool >      done(false);
+
+static void *writer(void *arg)
+{
+    (void) arg;
+
+    for(uint32_t i = 1; i <= NUM_UPDATES; i++)
+    {
+        TestData data;
+        for(size_t j = 0; j < DATA_LEN; j++)
+            data.value[j] = i;
+
+        snapshot.publish(data);
+    }
+
+    done = true;
+    return NULL;
+}
+
+/**
+ * Read snapshots while a writer thread publishes new ones as fast as possible
+ * and check that each snapshot is consistent and carries the data published
+ * with its generation.
+ */
+int main()
+{
+    pthread_t wr;
+    pthread_create(&wr, NULL, writer, NULL);
+
+    size_t   reads   = 0;
+    uint32_t lastGen = 0;
+    bool     ok      = true;
+
+    while(done == false)
+    {
+        TestData data;
+        uint32_t gen = snapshot.read(data);
+
+        for(size_t j = 0; j < DATA_LEN; j++)
+        {
+            if(data.value[j] != gen) ok = false;
+        }
+
+        if(gen < lastGen) ok = false;
+
+        lastGen = gen;
+        reads  += 1;
+    }
+
+    pthread_join(wr, NULL);
+
+    TestData data;
+    uint32_t gen = snapshot.read(data);
+    if((gen != NUM_UPDATES) || (data.value[0] != NUM_UPDATES))
+        ok = false;
+
+    printf("%zu consistent reads during %u updates\n", reads, NUM_UPDATES);
+
+    if(ok == false)
+    {
+        printf("Inconsistent snapshot read\n");
+        return -1;
+    }
+
+    return 0;
+}
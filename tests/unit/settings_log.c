@@ -0,0 +1,221 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <interfaces/nvmem.h>
+#include <nvmem_access.h>
+#include <posix_file.h>
+#include <settings_log.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "flash_sim.h"
+
+#define STORAGE_PATH "/tmp/test_settings_log.bin"
+#define SECT_SIZE    FLASH_SIM_SECTOR
+#define MEM_SIZE     0x20000
+#define NUM_SAVES    20000
+#define NUM_FAULTS   2000
+
+FLASH_SIM_DEVICE_DEFINE(flashDevice, MEM_SIZE)
+
+static settings_t settings;
+static channel_t  vfo;
+
+/*
+ * Typical changes between two saves: a setting or the VFO frequency.
+ */
+static void changeData(uint32_t i)
+{
+    switch(rand() % 4)
+    {
+        case 0:
+            settings.brightness = rand();
+            break;
+
+        case 1:
+            settings.sqlLevel = rand() % 16;
+            break;
+
+        case 2:
+            snprintf(settings.callsign, sizeof(settings.callsign), "N%uCALL",
+                     (unsigned) (i % 100));
+            break;
+
+        default:
+            vfo.rx_frequency = 430000000 + (rand() % 1000) * 12500;
+            vfo.tx_frequency = vfo.rx_frequency;
+            break;
+    }
+}
+
+static bool sameData(const struct settingsLog *log, const settings_t *s,
+                     const channel_t *c)
+{
+    settings_t rs;
+    channel_t  rc;
+
+    if(settingsLog_read(log, &rs, &rc) < 0)
+        return false;
+
+    return (memcmp(&rs, s, sizeof(settings_t)) == 0) &&
+           (memcmp(&rc, c, sizeof(channel_t)) == 0);
+}
+
+/*
+ * Saves per erase and bytes written per save, over a 128kB storage area.
+ */
+static int benchmark()
+{
+    struct settingsLog log =
+    {
+        .nvm      = (const struct nvmDevice *) &flashDevice,
+        .baseAddr = 0,
+        .pageSize = MEM_SIZE,
+        .numPages = 1
+    };
+
+    nvm_devErase(log.nvm, 0, MEM_SIZE);
+    if(settingsLog_init(&log) < 0)
+        return -1;
+
+    flashSim_reset();
+    uint32_t saves = 0;
+
+    for(uint32_t i = 0; i < NUM_SAVES; i++)
+    {
+        changeData(i);
+        if(settingsLog_write(&log, &settings, &vfo) < 0)
+            return -1;
+
+        saves++;
+    }
+
+    // Reload from the storage
+    if(settingsLog_init(&log) < 0)
+        return -1;
+
+    if(sameData(&log, &settings, &vfo) == false)
+    {
+        printf("Error: wrong data after reload\n");
+        return -1;
+    }
+
+    // Sector erases are counted in 4kB units
+    float erases = (float) flashSim.numErases / (MEM_SIZE / SECT_SIZE);
+    printf("Log: %.0f saves per erase, %.1f bytes per save\n",
+           saves / erases, (float) flashSim.bytesWritten / saves);
+    printf("Legacy: 1024 saves per erase, %u bytes per save\n",
+           (unsigned) (sizeof(uint16_t) + SETTINGS_LOG_IMAGE_SIZE + 4));
+
+    return 0;
+}
+
+/*
+ * Random power losses during the saves: after each one the storage must hold
+ * either the previous or the new data.
+ */
+static int powerLossTest()
+{
+    struct settingsLog log =
+    {
+        .nvm      = (const struct nvmDevice *) &flashDevice,
+        .baseAddr = 0,
+        .pageSize = SECT_SIZE,
+        .numPages = 2
+    };
+
+    nvm_devErase(log.nvm, 0, 2 * SECT_SIZE);
+    if(settingsLog_init(&log) < 0)
+        return -1;
+
+    settingsLog_write(&log, &settings, &vfo);
+
+    uint32_t oldData = 0;
+    uint32_t newData = 0;
+
+    for(uint32_t i = 0; i < NUM_FAULTS; i++)
+    {
+        settings_t prevSettings = settings;
+        channel_t  prevVfo      = vfo;
+
+        // Some saves without faults, then one interrupted
+        for(uint32_t j = rand() % 20; j > 0; j--)
+        {
+            prevSettings = settings;
+            prevVfo      = vfo;
+            changeData(j);
+            if(settingsLog_write(&log, &settings, &vfo) < 0)
+                return -1;
+        }
+
+        prevSettings = settings;
+        prevVfo      = vfo;
+        changeData(i);
+
+        flashSim.writeBudget = rand() % 128;
+        settingsLog_write(&log, &settings, &vfo);
+        flashSim_reset();
+
+        // Reboot
+        if(settingsLog_init(&log) < 0)
+            return -1;
+
+        if(sameData(&log, &settings, &vfo))
+        {
+            newData++;
+        }
+        else if(sameData(&log, &prevSettings, &prevVfo))
+        {
+            settings = prevSettings;
+            vfo      = prevVfo;
+            oldData++;
+        }
+        else
+        {
+            printf("Error: data lost after power loss %u\n", (unsigned) i);
+            return -1;
+        }
+    }
+
+    printf("Power losses: %u recovered previous data, %u new data\n",
+           (unsigned) oldData, (unsigned) newData);
+
+    return 0;
+}
+
+int main()
+{
+    remove(STORAGE_PATH);
+    if(posixFile_init(&flashDevice, STORAGE_PATH) < 0)
+        return -1;
+
+    memcpy(&settings, &default_settings, sizeof(settings_t));
+    memset(&vfo, 0x00, sizeof(channel_t));
+    srand(7);
+
+    if(benchmark() || powerLossTest())
+        return -1;
+
+    posixFile_terminate(&flashDevice);
+    remove(STORAGE_PATH);
+
+    return 0;
+}
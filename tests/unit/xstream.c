@@ -0,0 +1,458 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#define _GNU_SOURCE
+#include <sys/time.h>
+#include <usb_vcom.h>
+#include <xstream.h>
+#include <xmodem.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <stdio.h>
+#include <poll.h>
+
+#define DUMP_SIZE   (16 * 1024 * 1024)  // Full external flash
+#define LOSSY_SIZE  (1024 * 1024)
+#define DELAY_SIZE  (1024 * 1024)
+#define LATENCY     0.001               // One-way latency of the slow link, s
+#define QUEUE_LEN   1024
+
+/*
+ * The two endpoints communicate over a pseudo terminal pair, the sender runs
+ * on the master side in a separate thread and the receiver on the slave side.
+ * A fraction of the writes can be corrupted to exercise the retransmissions.
+ *
+ * To emulate the round trip time of an USB link, the endpoints can instead be
+ * connected to two pseudo terminal pairs with a thread relaying the data
+ * between the two master sides after a fixed delay.
+ */
+static int      masterFd;
+static int      slaveFd;
+static int      delayFd[4];     // Sender slave, sender master, receiver master
+                                // and receiver slave
+static int      senderFd;
+static int      receiverFd;
+static volatile bool relayRun;
+static uint32_t corruptRate;    // One write out of corruptRate is corrupted
+static uint32_t corrupted;
+
+static __thread int      portFd;
+static __thread uint32_t seed;
+
+static uint8_t *source;
+static uint8_t *dest;
+static size_t   srcPos;
+static size_t   dstPos;
+static size_t   xferSize;
+static size_t   failPos = SIZE_MAX; // Receiver fails when reaching it
+static ssize_t  txResult;
+static ssize_t  rxResult;
+
+static ssize_t fdRead(void *buf, size_t len, uint32_t timeout)
+{
+    struct pollfd pfd = { .fd = portFd, .events = POLLIN };
+
+    int ret = poll(&pfd, 1, timeout);
+    if(ret <= 0)
+        return (ret < 0) ? -errno : 0;
+
+    ssize_t num = read(portFd, buf, len);
+    if(num < 0)
+        return (errno == EAGAIN) ? 0 : -errno;
+
+    return num;
+}
+
+static ssize_t fdWrite(const void *buf, size_t len)
+{
+    static __thread uint8_t copy[XSTREAM_FRAME_SIZE + 8];
+    const uint8_t *ptr = (const uint8_t *) buf;
+
+    if((corruptRate > 0) && (len <= sizeof(copy)) &&
+       ((rand_r(&seed) % corruptRate) == 0))
+    {
+        memcpy(copy, buf, len);
+        copy[rand_r(&seed) % len] ^= 0x5A;
+        ptr = copy;
+        __atomic_add_fetch(&corrupted, 1, __ATOMIC_RELAXED);
+    }
+
+    size_t sent = 0;
+    while(sent < len)
+    {
+        ssize_t num = write(portFd, ptr + sent, len - sent);
+        if(num < 0)
+        {
+            if(errno != EAGAIN)
+                return -errno;
+
+            struct pollfd pfd = { .fd = portFd, .events = POLLOUT };
+            poll(&pfd, 1, 10);
+            continue;
+        }
+
+        sent += num;
+    }
+
+    return len;
+}
+
+static const struct xstreamPort port =
+{
+    .read  = fdRead,
+    .write = fdWrite
+};
+
+/*
+ * USB virtual COM port emulation, for the XMODEM implementation.
+ */
+ssize_t vcom_writeBlock(const void *buf, size_t len)
+{
+    return fdWrite(buf, len);
+}
+
+ssize_t vcom_readBlock(void *buf, size_t len)
+{
+    ssize_t num = read(portFd, buf, len);
+    if(num < 0)
+        return (errno == EAGAIN) ? 0 : -errno;
+
+    return num;
+}
+
+static int getData(uint8_t *ptr, size_t size)
+{
+    memcpy(ptr, &source[srcPos], size);
+    srcPos += size;
+    return 0;
+}
+
+static int putBlock(uint8_t *ptr, size_t size)
+{
+    if((dstPos + size) > xferSize)
+        return 0;
+
+    if((dstPos + size) > failPos)
+        return -1;
+
+    memcpy(&dest[dstPos], ptr, size);
+    dstPos += size;
+    return 0;
+}
+
+static void putData(uint8_t *ptr, size_t size)
+{
+    putBlock(ptr, size);
+}
+
+static void *xstreamSender(void *arg)
+{
+    struct xstream *ctx = (struct xstream *) arg;
+
+    portFd = senderFd;
+    seed   = 1;
+
+    return (void *) xstream_sendData(ctx, xferSize, getData);
+}
+
+static void *xmodemSender(void *arg)
+{
+    (void) arg;
+
+    portFd = senderFd;
+    seed   = 1;
+
+    return (void *) xmodem_sendData(xferSize, getData);
+}
+
+static int openPty(int *master, int *slave)
+{
+    *master = posix_openpt(O_RDWR | O_NOCTTY);
+    if((*master < 0) || (grantpt(*master) < 0) || (unlockpt(*master) < 0))
+        return -1;
+
+    *slave = open(ptsname(*master), O_RDWR | O_NOCTTY);
+    if(*slave < 0)
+        return -1;
+
+    struct termios tty;
+    tcgetattr(*slave, &tty);
+    cfmakeraw(&tty);
+    tcsetattr(*slave, TCSANOW, &tty);
+
+    fcntl(*master, F_SETFL, fcntl(*master, F_GETFL) | O_NONBLOCK);
+    fcntl(*slave,  F_SETFL, fcntl(*slave,  F_GETFL) | O_NONBLOCK);
+
+    return 0;
+}
+
+static double now()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + (tv.tv_usec / 1e6);
+}
+
+struct chunk
+{
+    double  due;
+    size_t  len;
+    uint8_t data[4096];
+};
+
+struct delayLine
+{
+    int           in;
+    int           out;
+    size_t        head;
+    size_t        tail;
+    struct chunk *queue;
+};
+
+static void *relay(void *arg)
+{
+    struct delayLine *lines = (struct delayLine *) arg;
+    struct timespec   tick  = { .tv_sec = 0, .tv_nsec = 100000 };
+
+    portFd = -1;
+
+    while(relayRun)
+    {
+        struct pollfd pfd[2] =
+        {
+            { .fd = lines[0].in, .events = POLLIN },
+            { .fd = lines[1].in, .events = POLLIN }
+        };
+
+        ppoll(pfd, 2, &tick, NULL);
+
+        for(int i = 0; i < 2; i++)
+        {
+            struct delayLine *line = &lines[i];
+
+            // Data entering the line
+            if(((line->tail + 1) % QUEUE_LEN) != line->head)
+            {
+                struct chunk *c = &line->queue[line->tail];
+                ssize_t num = read(line->in, c->data, sizeof(c->data));
+                if(num > 0)
+                {
+                    c->len     = num;
+                    c->due     = now() + LATENCY;
+                    line->tail = (line->tail + 1) % QUEUE_LEN;
+                }
+            }
+
+            // Data leaving the line
+            while((line->head != line->tail) &&
+                  (line->queue[line->head].due <= now()))
+            {
+                portFd = line->out;
+                fdWrite(line->queue[line->head].data,
+                        line->queue[line->head].len);
+                line->head = (line->head + 1) % QUEUE_LEN;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Run a transfer, return the throughput in MB/s or a negative value on
+ * failure.
+ */
+static double transfer(bool windowed, size_t size, uint32_t rate)
+{
+    static struct xstream txCtx;
+    static struct xstream rxCtx;
+    pthread_t sender;
+    void     *txRet;
+    ssize_t   rxRet;
+
+    srcPos      = 0;
+    dstPos      = 0;
+    xferSize    = size;
+    corruptRate = rate;
+    corrupted   = 0;
+    portFd      = receiverFd;
+    seed        = 2;
+    memset(dest, 0x00, size);
+
+    double start = now();
+
+    if(windowed)
+    {
+        xstream_init(&txCtx, &port);
+        xstream_init(&rxCtx, &port);
+        txCtx.timeout = 100;
+        rxCtx.timeout = 100;
+
+        pthread_create(&sender, NULL, xstreamSender, &txCtx);
+        rxRet = xstream_receiveData(&rxCtx, size, putBlock);
+    }
+    else
+    {
+        pthread_create(&sender, NULL, xmodemSender, NULL);
+        rxRet = xmodem_receiveData(size, putData);
+    }
+
+    pthread_join(sender, &txRet);
+
+    double elapsed = now() - start;
+    txResult = (ssize_t) txRet;
+    rxResult = rxRet;
+
+    if(windowed && (rate > 0))
+    {
+        printf("  %u frames corrupted, %u retransmits, %u NAKs, "
+               "%u timeouts, %u bad frames\n", corrupted,
+               txCtx.stats.retransmits, rxCtx.stats.naks,
+               txCtx.stats.timeouts + rxCtx.stats.timeouts,
+               txCtx.stats.badFrames + rxCtx.stats.badFrames);
+    }
+
+    if(((ssize_t) txRet != (ssize_t) size) || (rxRet != (ssize_t) size) ||
+       (dstPos != size) || (memcmp(source, dest, size) != 0))
+        return -1.0;
+
+    return (size / (1024.0 * 1024.0)) / elapsed;
+}
+
+int main()
+{
+    if((openPty(&masterFd, &slaveFd) < 0) ||
+       (openPty(&delayFd[1], &delayFd[0]) < 0) ||
+       (openPty(&delayFd[2], &delayFd[3]) < 0))
+    {
+        printf("Error opening the pseudo terminal\n");
+        return -1;
+    }
+
+    source = malloc(DUMP_SIZE);
+    dest   = malloc(DUMP_SIZE);
+
+    srand(1);
+    for(size_t i = 0; i < DUMP_SIZE; i++)
+        source[i] = rand();
+
+    int ret = 0;
+
+    senderFd   = masterFd;
+    receiverFd = slaveFd;
+
+    double speed = transfer(true, LOSSY_SIZE + 123, 20);
+    if(speed < 0)
+    {
+        printf("Error in transfer over lossy link\n");
+        ret = -1;
+    }
+
+    // A failure while consuming the data aborts the transfer on both sides
+    failPos = LOSSY_SIZE / 2;
+    transfer(true, LOSSY_SIZE, 0);
+    failPos = SIZE_MAX;
+    if((txResult >= 0) || (rxResult >= 0) || (dstPos > (LOSSY_SIZE / 2)))
+    {
+        printf("Error in aborted transfer\n");
+        ret = -1;
+    }
+
+    speed = transfer(true, DUMP_SIZE, 0);
+    if(speed < 0)
+    {
+        printf("Error in windowed transfer\n");
+        ret = -1;
+    }
+    else
+    {
+        printf("Windowed: %.2f MB/s\n", speed);
+    }
+
+    speed = transfer(false, DUMP_SIZE, 0);
+    if(speed < 0)
+    {
+        printf("Error in XMODEM transfer\n");
+        ret = -1;
+    }
+    else
+    {
+        printf("XMODEM:   %.2f MB/s\n", speed);
+    }
+
+    // Link with latency, to emulate the USB round trip time
+    struct delayLine lines[2] =
+    {
+        { .in = delayFd[1], .out = delayFd[2] },
+        { .in = delayFd[2], .out = delayFd[1] }
+    };
+
+    lines[0].queue = malloc(QUEUE_LEN * sizeof(struct chunk));
+    lines[1].queue = malloc(QUEUE_LEN * sizeof(struct chunk));
+    senderFd       = delayFd[0];
+    receiverFd     = delayFd[3];
+    relayRun       = true;
+
+    pthread_t relayThread;
+    pthread_create(&relayThread, NULL, relay, lines);
+
+    printf("With %.1f ms latency:\n", LATENCY * 1000.0);
+
+    for(int i = 0; i < 2; i++)
+    {
+        bool windowed = (i == 0);
+
+        speed = transfer(windowed, DELAY_SIZE, 0);
+        if(speed < 0)
+        {
+            printf("Error in %s transfer with latency\n",
+                   windowed ? "windowed" : "XMODEM");
+            ret = -1;
+            continue;
+        }
+
+        printf("%s %.2f MB/s, %.1f s for a full dump\n",
+               windowed ? "Windowed:" : "XMODEM:  ", speed,
+               (DUMP_SIZE / (1024.0 * 1024.0)) / speed);
+    }
+
+    relayRun = false;
+    pthread_join(relayThread, NULL);
+
+    free(lines[0].queue);
+    free(lines[1].queue);
+    free(source);
+    free(dest);
+
+    close(slaveFd);
+    close(masterFd);
+    for(int i = 0; i < 4; i++)
+        close(delayFd[i]);
+
+    return ret;
+}